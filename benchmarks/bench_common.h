@@ -0,0 +1,148 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* DATA */
+
+/**
+ * @brief A batch of per-operation latency samples.
+ *
+ * Latencies are recorded in nanoseconds and sorted once at report time so
+ * that percentiles can be read straight out of the array.
+ */
+struct bench_samples {
+    uint64_t *lat;   // per-operation latencies in nanoseconds
+    size_t count;    // samples recorded so far
+    size_t capacity; // allocated size of the sample array
+};
+
+/* FUNCTIONS */
+
+/**
+ * @brief Read the monotonic clock in nanoseconds.
+ *
+ * @return uint64_t current monotonic time in nanoseconds
+ */
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Allocate a sample batch for the given number of operations.
+ *
+ * Exits the benchmark on allocation failure; a partially measured run
+ * would only produce misleading numbers.
+ *
+ * @param samples pointer to the sample batch
+ * @param capacity number of samples to reserve
+ */
+static inline void bench_samples_init(struct bench_samples *samples,
+                                      size_t capacity) {
+    samples->lat = malloc(capacity * sizeof(*samples->lat));
+    if (samples->lat == NULL) {
+        fprintf(stderr, "bench: failed to allocate %zu samples\n", capacity);
+        exit(1);
+    }
+    samples->count = 0;
+    samples->capacity = capacity;
+}
+
+/**
+ * @brief Record one latency sample.
+ *
+ * Samples past the reserved capacity are dropped rather than reallocating
+ * mid-measurement.
+ *
+ * @param samples pointer to the sample batch
+ * @param start_ns operation start time from bench_now_ns()
+ */
+static inline void bench_samples_record(struct bench_samples *samples,
+                                        uint64_t start_ns) {
+    if (samples->count < samples->capacity) {
+        samples->lat[samples->count++] = bench_now_ns() - start_ns;
+    }
+}
+
+/**
+ * @brief qsort comparator for latency samples.
+ */
+static inline int bench_lat_cmp(const void *a, const void *b) {
+    uint64_t lhs = *(const uint64_t *)a;
+    uint64_t rhs = *(const uint64_t *)b;
+    return lhs < rhs ? -1 : lhs > rhs;
+}
+
+/**
+ * @brief Read a percentile out of a sorted sample array.
+ *
+ * @param samples pointer to the sorted sample batch
+ * @param pct percentile to read, 0-100
+ * @return uint64_t latency at that percentile in nanoseconds
+ */
+static inline uint64_t bench_percentile(const struct bench_samples *samples,
+                                        unsigned pct) {
+    if (samples->count == 0) {
+        return 0;
+    }
+    size_t idx = samples->count * pct / 100;
+    if (idx >= samples->count) {
+        idx = samples->count - 1;
+    }
+    return samples->lat[idx];
+}
+
+/**
+ * @brief Report one benchmark case as a machine-parseable CSV row.
+ *
+ * Every harness emits the same columns so that two runs can be diffed or
+ * joined by the first three fields:
+ *
+ *   bench,case,size,ops,ops_per_sec,p50_ns,p90_ns,p99_ns,max_ns
+ *
+ * The sample array is sorted in place.
+ *
+ * @param bench name of the harness
+ * @param name name of the case within the harness
+ * @param size problem size the case ran at
+ * @param ops total operations performed
+ * @param elapsed_ns wall time for the whole case
+ * @param samples per-operation latency samples, may be NULL
+ */
+static inline void bench_report(const char *bench, const char *name,
+                                size_t size, size_t ops, uint64_t elapsed_ns,
+                                struct bench_samples *samples) {
+    double ops_per_sec =
+        elapsed_ns == 0 ? 0.0 : (double)ops * 1e9 / (double)elapsed_ns;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t max = 0;
+    if (samples != NULL && samples->count > 0) {
+        qsort(samples->lat, samples->count, sizeof(*samples->lat),
+              bench_lat_cmp);
+        p50 = bench_percentile(samples, 50);
+        p90 = bench_percentile(samples, 90);
+        p99 = bench_percentile(samples, 99);
+        max = samples->lat[samples->count - 1];
+    }
+    printf("%s,%s,%zu,%zu,%.0f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+           "\n",
+           bench, name, size, ops, ops_per_sec, p50, p90, p99, max);
+    fflush(stdout);
+}
+
+/**
+ * @brief Print the CSV header once at the top of a harness.
+ */
+static inline void bench_header(void) {
+    puts("bench,case,size,ops,ops_per_sec,p50_ns,p90_ns,p99_ns,max_ns");
+}
+
+#endif /* BENCH_COMMON_H */
@@ -0,0 +1,101 @@
+#include "bench_common.h"
+#include "hash_table.h"
+#include <string.h>
+
+/* DATA */
+
+#define KEY_LEN 24
+
+/* PRIVATE FUNCTIONS */
+
+static int cmp_str(const void *a, const void *b) { return strcmp(a, b); }
+
+/**
+ * @brief Generate distinct fixed-width string keys.
+ *
+ * Keys are laid out in one contiguous block so that the benchmark measures
+ * table behavior, not allocator behavior.
+ *
+ * @param count number of keys to generate
+ * @param tag single character distinguishing key populations
+ * @return char* block of count keys, KEY_LEN bytes apart
+ */
+static char *make_keys(size_t count, char tag) {
+    char *keys = malloc(count * KEY_LEN);
+    if (keys == NULL) {
+        fprintf(stderr, "bench: failed to allocate keys\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < count; i++) {
+        snprintf(&keys[i * KEY_LEN], KEY_LEN, "%c%014zx", tag, i);
+    }
+    return keys;
+}
+
+/**
+ * @brief Measure set/lookup/miss rates at one table size.
+ *
+ * @param size number of entries to load into the table
+ */
+static void run_size(size_t size) {
+    int err = 0;
+    hash_table_t *table = hash_table_init(0, NULL, cmp_str, &err);
+    if (table == NULL) {
+        fprintf(stderr, "bench: hash_table_init failed '%d'\n", err);
+        exit(1);
+    }
+    char *keys = make_keys(size, 'k');
+    char *misses = make_keys(size, 'm');
+
+    struct bench_samples samples;
+    bench_samples_init(&samples, size);
+    uint64_t begin = bench_now_ns();
+    for (size_t i = 0; i < size; i++) {
+        char *key = &keys[i * KEY_LEN];
+        uint64_t start = bench_now_ns();
+        hash_table_set(table, key, key);
+        bench_samples_record(&samples, start);
+    }
+    bench_report("hash_table", "set", size, size, bench_now_ns() - begin,
+                 &samples);
+
+    samples.count = 0;
+    begin = bench_now_ns();
+    for (size_t i = 0; i < size; i++) {
+        uint64_t start = bench_now_ns();
+        void *found = hash_table_lookup(table, &keys[i * KEY_LEN]);
+        bench_samples_record(&samples, start);
+        if (found == NULL) {
+            fprintf(stderr, "bench: lost key %zu\n", i);
+            exit(1);
+        }
+    }
+    bench_report("hash_table", "lookup_hit", size, size, bench_now_ns() - begin,
+                 &samples);
+
+    samples.count = 0;
+    begin = bench_now_ns();
+    for (size_t i = 0; i < size; i++) {
+        uint64_t start = bench_now_ns();
+        hash_table_lookup(table, &misses[i * KEY_LEN]);
+        bench_samples_record(&samples, start);
+    }
+    bench_report("hash_table", "lookup_miss", size, size,
+                 bench_now_ns() - begin, &samples);
+
+    free(samples.lat);
+    free(misses);
+    free(keys);
+    hash_table_destroy(&table);
+}
+
+/* MAIN */
+
+int main(void) {
+    bench_header();
+    size_t sizes[] = {1 << 10, 1 << 14, 1 << 17};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        run_size(sizes[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "bench_common.h"
+#include "queue_concurrent.h"
+#include <pthread.h>
+
+/* DATA */
+
+#define ITEMS_PER_PRODUCER 200000
+
+/**
+ * @brief Shared state for one producer/consumer configuration.
+ *
+ * @param queue queue under test
+ * @param items number of items each producer enqueues
+ * @param consumed total items drained, across all consumers
+ */
+struct bench_ctx {
+    queue_c_t *queue;
+    size_t items;
+    size_t consumed;
+};
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * @brief Producer thread: enqueue a fixed number of items.
+ *
+ * @param arg pointer to the shared context
+ * @return void* always NULL
+ */
+static void *producer(void *arg) {
+    struct bench_ctx *ctx = arg;
+    for (size_t i = 0; i < ctx->items; i++) {
+        // the payload is irrelevant, only the handoff is measured
+        while (queue_c_enqueue(ctx->queue, (void *)(i + 1)) != 0) {
+            queue_c_wait_for_not_full(ctx->queue);
+            queue_c_unlock(ctx->queue);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Consumer thread: drain the queue until it is closed and empty.
+ *
+ * @param arg pointer to the shared context
+ * @return void* count of items this consumer drained
+ */
+static void *consumer(void *arg) {
+    struct bench_ctx *ctx = arg;
+    size_t drained = 0;
+    for (;;) {
+        if (queue_c_wait_for_not_empty(ctx->queue) != 0) {
+            // EPIPE once the queue is closed and fully drained
+            break;
+        }
+        int err = 0;
+        void *item = queue_c_dequeue(ctx->queue, &err);
+        queue_c_unlock(ctx->queue);
+        if (item != NULL) {
+            drained++;
+        }
+    }
+    return (void *)drained;
+}
+
+/**
+ * @brief Run one N-producer/M-consumer configuration.
+ *
+ * @param producers number of producer threads
+ * @param consumers number of consumer threads
+ * @param capacity queue capacity, 0 for unbounded
+ * @param name case label for the report
+ */
+static void run_config(size_t producers, size_t consumers, size_t capacity,
+                       const char *name) {
+    int err = 0;
+    queue_c_t *queue = queue_c_init(capacity, NULL, &err);
+    if (queue == NULL) {
+        fprintf(stderr, "bench: queue_c_init failed '%d'\n", err);
+        exit(1);
+    }
+    struct bench_ctx ctx = {.queue = queue, .items = ITEMS_PER_PRODUCER};
+    pthread_t prod[8];
+    pthread_t cons[8];
+
+    uint64_t begin = bench_now_ns();
+    for (size_t i = 0; i < consumers; i++) {
+        pthread_create(&cons[i], NULL, consumer, &ctx);
+    }
+    for (size_t i = 0; i < producers; i++) {
+        pthread_create(&prod[i], NULL, producer, &ctx);
+    }
+    for (size_t i = 0; i < producers; i++) {
+        pthread_join(prod[i], NULL);
+    }
+    // closing wakes the consumers once the backlog is gone
+    queue_c_close(queue);
+    size_t drained = 0;
+    for (size_t i = 0; i < consumers; i++) {
+        void *count = NULL;
+        pthread_join(cons[i], &count);
+        drained += (size_t)count;
+    }
+    uint64_t elapsed = bench_now_ns() - begin;
+
+    size_t expected = producers * ITEMS_PER_PRODUCER;
+    if (drained != expected) {
+        fprintf(stderr, "bench: drained %zu of %zu items\n", drained, expected);
+        exit(1);
+    }
+    bench_report("queue_c", name, producers + consumers, expected, elapsed,
+                 NULL);
+    queue_c_destroy(&queue);
+}
+
+/* MAIN */
+
+int main(void) {
+    bench_header();
+    run_config(1, 1, 1024, "1p_1c");
+    run_config(2, 2, 1024, "2p_2c");
+    run_config(4, 4, 1024, "4p_4c");
+    run_config(4, 1, 1024, "4p_1c");
+    run_config(1, 4, 1024, "1p_4c");
+    return 0;
+}
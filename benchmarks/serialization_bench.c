@@ -0,0 +1,125 @@
+#include "bench_common.h"
+#include "serialization.h"
+#include <pthread.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* DATA */
+
+#define PACKETS 50000
+
+/**
+ * @brief Arguments for the echo thread.
+ *
+ * @param io_info reader end of the socket pair
+ * @param packets number of packets to consume
+ */
+struct echo_ctx {
+    io_info_t *io_info;
+    size_t packets;
+};
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * @brief Reader thread: consume packets and echo a 1-byte ack.
+ *
+ * The ack keeps the writer honest: each sample covers a full
+ * write_pkt_data/read_pkt round trip instead of just filling the socket
+ * buffer.
+ *
+ * @param arg pointer to the echo context
+ * @return void* NULL on success, the context pointer on failure
+ */
+static void *echo_loop(void *arg) {
+    struct echo_ctx *ctx = arg;
+    struct packet pkt = {0};
+    for (size_t i = 0; i < ctx->packets; i++) {
+        if (read_pkt_into(ctx->io_info, &pkt) != 0) {
+            free_packet_buffers(&pkt);
+            return arg;
+        }
+        char ack = 1;
+        if (write_pkt_data(ctx->io_info, &ack, sizeof(ack), 0) != 0) {
+            free_packet_buffers(&pkt);
+            return arg;
+        }
+    }
+    free_packet_buffers(&pkt);
+    return NULL;
+}
+
+/**
+ * @brief Measure packet round trips at one payload size.
+ *
+ * @param payload_len bytes of payload per packet
+ */
+static void run_size(size_t payload_len) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        perror("bench: socketpair");
+        exit(1);
+    }
+    int err = 0;
+    // FILE_IO drives the descriptor directly; a socketpair end needs no
+    // connection state
+    io_info_t *writer = new_io_info(fds[0], FILE_IO, &err);
+    io_info_t *reader = new_io_info(fds[1], FILE_IO, &err);
+    if (writer == NULL || reader == NULL) {
+        fprintf(stderr, "bench: new_io_info failed '%d'\n", err);
+        exit(1);
+    }
+    char *payload = calloc(1, payload_len);
+    if (payload == NULL) {
+        fprintf(stderr, "bench: failed to allocate payload\n");
+        exit(1);
+    }
+
+    struct echo_ctx ctx = {.io_info = reader, .packets = PACKETS};
+    pthread_t echo;
+    pthread_create(&echo, NULL, echo_loop, &ctx);
+
+    struct bench_samples samples;
+    bench_samples_init(&samples, PACKETS);
+    struct packet ack = {0};
+    uint64_t begin = bench_now_ns();
+    for (size_t i = 0; i < PACKETS; i++) {
+        uint64_t start = bench_now_ns();
+        if (write_pkt_data(writer, payload, payload_len, 0) != 0 ||
+            read_pkt_into(writer, &ack) != 0) {
+            fprintf(stderr, "bench: packet %zu failed\n", i);
+            exit(1);
+        }
+        bench_samples_record(&samples, start);
+    }
+    uint64_t elapsed = bench_now_ns() - begin;
+    void *echo_err = NULL;
+    pthread_join(echo, &echo_err);
+    if (echo_err != NULL) {
+        fprintf(stderr, "bench: echo thread failed\n");
+        exit(1);
+    }
+    bench_report("serialization", "pkt_round_trip", payload_len, PACKETS,
+                 elapsed, &samples);
+
+    free_packet_buffers(&ack);
+    free(samples.lat);
+    free(payload);
+    free_io_info(writer);
+    free_io_info(reader);
+    // io_info objects built from raw descriptors do not close them
+    close(fds[0]);
+    close(fds[1]);
+}
+
+/* MAIN */
+
+int main(void) {
+    bench_header();
+    size_t sizes[] = {64, 1024, 16384};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        run_size(sizes[i]);
+    }
+    return 0;
+}
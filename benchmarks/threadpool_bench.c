@@ -0,0 +1,141 @@
+#include "bench_common.h"
+#include "threadpool.h"
+
+/* DATA */
+
+#define TASKS 100000
+#define PARALLEL_RANGE 10000000
+#define PARALLEL_ROUNDS 50
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * @brief Minimal task: one atomic increment.
+ *
+ * The task body is deliberately tiny so the numbers reflect dispatch
+ * overhead, not work.
+ *
+ * @param arg pointer to the completion counter
+ * @return int always 0
+ */
+static int count_task(void *arg) {
+    size_t *done = arg;
+    __atomic_fetch_add(done, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+/**
+ * @brief parallel_for body: sum the indices of the sub-range.
+ *
+ * @param start first index of the sub-range
+ * @param end one past the last index
+ * @param arg pointer to the shared accumulator
+ * @return int always 0
+ */
+static int sum_range(size_t start, size_t end, void *arg) {
+    size_t local = 0;
+    for (size_t i = start; i < end; i++) {
+        local += i;
+    }
+    __atomic_fetch_add((size_t *)arg, local, __ATOMIC_RELAXED);
+    return 0;
+}
+
+/**
+ * @brief Measure task dispatch rate through the shared queue.
+ *
+ * @param pool pool under test
+ * @param workers worker count, for the report
+ * @param name case label for the report
+ */
+static void run_tasks(threadpool_t *pool, size_t workers, const char *name) {
+    size_t done = 0;
+    struct bench_samples samples;
+    bench_samples_init(&samples, TASKS);
+    uint64_t begin = bench_now_ns();
+    for (size_t i = 0; i < TASKS; i++) {
+        uint64_t start = bench_now_ns();
+        while (threadpool_add_work(pool, count_task, &done) != 0) {
+            // full queue: let the workers catch up
+        }
+        bench_samples_record(&samples, start);
+    }
+    threadpool_wait(pool);
+    uint64_t elapsed = bench_now_ns() - begin;
+    if (__atomic_load_n(&done, __ATOMIC_RELAXED) != TASKS) {
+        fprintf(stderr, "bench: completed %zu of %d tasks\n", done, TASKS);
+        exit(1);
+    }
+    bench_report("threadpool", name, workers, TASKS, elapsed, &samples);
+    free(samples.lat);
+}
+
+/**
+ * @brief Measure parallel_for throughput in indices per second.
+ *
+ * @param pool pool under test
+ * @param workers worker count, for the report
+ * @param name case label for the report
+ */
+static void run_parallel_for(threadpool_t *pool, size_t workers,
+                             const char *name) {
+    size_t sum = 0;
+    struct bench_samples samples;
+    bench_samples_init(&samples, PARALLEL_ROUNDS);
+    uint64_t begin = bench_now_ns();
+    for (size_t round = 0; round < PARALLEL_ROUNDS; round++) {
+        uint64_t start = bench_now_ns();
+        int res = threadpool_parallel_for(pool, 0, PARALLEL_RANGE, 0, sum_range,
+                                          &sum);
+        bench_samples_record(&samples, start);
+        if (res != 0) {
+            fprintf(stderr, "bench: parallel_for failed '%d'\n", res);
+            exit(1);
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - begin;
+    size_t range = PARALLEL_RANGE;
+    if (sum != PARALLEL_ROUNDS * (range * (range - 1) / 2)) {
+        fprintf(stderr, "bench: parallel_for sum mismatch\n");
+        exit(1);
+    }
+    bench_report("threadpool", name, workers,
+                 (size_t)PARALLEL_ROUNDS * PARALLEL_RANGE, elapsed, &samples);
+    free(samples.lat);
+}
+
+/**
+ * @brief Run all cases at one worker count.
+ *
+ * @param workers number of worker threads
+ * @param steal whether to enable work-stealing deques
+ */
+static void run_pool(size_t workers, int steal) {
+    int err = 0;
+    threadpool_attr_t attr;
+    threadpool_attr_init(&attr);
+    threadpool_attr_set_thread_count(&attr, workers);
+    threadpool_attr_set_work_steal(
+        &attr, steal ? WORK_STEAL_ENABLED : WORK_STEAL_DISABLED);
+    threadpool_t *pool = threadpool_create(&attr, &err);
+    if (pool == NULL) {
+        fprintf(stderr, "bench: threadpool_create failed '%d'\n", err);
+        exit(1);
+    }
+    run_tasks(pool, workers, steal ? "tasks_steal" : "tasks");
+    run_parallel_for(pool, workers,
+                     steal ? "parallel_for_steal" : "parallel_for");
+    threadpool_destroy(pool, SHUTDOWN_GRACEFUL);
+}
+
+/* MAIN */
+
+int main(void) {
+    bench_header();
+    size_t workers[] = {1, 2, 4, 8};
+    for (size_t i = 0; i < sizeof(workers) / sizeof(workers[0]); i++) {
+        run_pool(workers[i], 0);
+        run_pool(workers[i], 1);
+    }
+    return 0;
+}
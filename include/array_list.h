@@ -1,6 +1,7 @@
 #ifndef ARRAY_LIST_H
 #define ARRAY_LIST_H
 
+#include "buildingblocks.h"
 #include <unistd.h>
 
 /* DATA */
@@ -46,6 +47,13 @@ typedef struct arr_list_t arr_list_t;
  * allocate an array. The free_f and cmp_f functions will be used to free and
  * compare data stored in the array.
  *
+ * Elements are stored by value: every insert copies size bytes from the
+ * given data pointer directly into one contiguous backing array. The list
+ * never allocates per element, and iteration walks adjacent memory, so
+ * small structs can be stored inline instead of behind a pointer. Accessor
+ * functions return pointers into the backing array; those pointers are
+ * invalidated when the list is resized or elements are shifted.
+ *
  * If free_f is NULL, then data stored in the list will not be free'd when the
  * list is cleared. If cmp_f is NULL, then certain functions that require a
  * compare function will not be available. If any of these functions are called,
@@ -68,6 +76,36 @@ typedef struct arr_list_t arr_list_t;
 arr_list_t *arr_list_new(FREE_F free_f, CMP_F cmp_f, size_t nmemb, size_t size,
                          int *err);
 
+/**
+ * @brief Create a new array list with a custom memory allocator.
+ *
+ * Identical to arr_list_new, except that the list struct and its backing
+ * array are allocated through the given allocator, including later
+ * resizes. A request-scoped arena can therefore discard the whole list by
+ * resetting the arena, though arr_list_delete must still be called when
+ * the stored data has a free function. If allocator is NULL, the standard
+ * heap is used, matching arr_list_new. Lists created with arr_list_wrap
+ * always use the standard heap because the caller owns the array.
+ *
+ * In case of an error, this function will return NULL and set the error
+ * pointer if given. The error pointer may be NULL, in which case the error
+ * will not be stored.
+ * Possible errors:
+ * - ENOMEM: Memory allocation error
+ * - EINVAL: Invalid size or nmemb value
+ *
+ * @param free_f pointer to the free function to be used with that list
+ * @param cmp_f pointer to the compare function to be used with that list
+ * @param nmemb number of elements to allocate for the list
+ * @param size size of each element in the list
+ * @param allocator memory allocator for the list internals, or NULL
+ * @param err where to store the error code
+ * @returns pointer to allocated list on success or NULL on failure
+ */
+arr_list_t *arr_list_new_alloc(FREE_F free_f, CMP_F cmp_f, size_t nmemb,
+                               size_t size, const allocator_t *allocator,
+                               int *err);
+
 /**
  * @brief Wrap an array in a list.
  *
@@ -124,12 +162,14 @@ arr_list_t *arr_list_wrap(FREE_F free_f, CMP_F cmp_f, size_t nmemb, size_t size,
  * - QUERY_CAPACITY: Get the capacity of the array.
  * - QUERY_IS_EMPTY: Check if the array is empty.
  * - QUERY_IS_FULL: Check if the array is full.
+ * - QUERY_ELEM_SIZE: Get the size of each element in bytes.
  *
  * Possible results:
  * - QUERY_SIZE: The number of nodes in the array.
  * - QUERY_CAPACITY: The capacity of the array.
  * - QUERY_IS_EMPTY: 0 if the array is not empty, non-zero if the array is
  * - QUERY_IS_FULL: 0 if the array is not full, non-zero if the array is full
+ * - QUERY_ELEM_SIZE: The size of each element in bytes.
  * empty.
  *
  * Possible errors:
@@ -191,6 +231,47 @@ int arr_list_trim(arr_list_t *list);
  */
 int arr_list_insert(arr_list_t *list, void *data, size_t position);
 
+/**
+ * @brief Append a batch of items to the end of the list.
+ *
+ * Copies nmemb elements from the given array onto the end of the list with
+ * a single grow and a single copy, instead of per-item bounds checks and
+ * shifts. The source array must hold elements of the size the list was
+ * created with. The list will be resized at most once. Note that if the
+ * list wraps a static array, then this function will have undefined
+ * behavior if the list needs to be resized.
+ *
+ * Possible errors:
+ * - EINVAL: list is NULL, or data is NULL while nmemb is non-zero
+ * - ENOMEM: Memory allocation error
+ *
+ * @param list list to append the items to
+ * @param data array of items to be appended
+ * @param nmemb number of items in the array
+ * @returns 0 on success, non-zero on failure
+ */
+int arr_list_extend(arr_list_t *list, const void *data, size_t nmemb);
+
+/**
+ * @brief Move all items from one list onto the end of another.
+ *
+ * Appends every element of src to dst with a single grow and a single
+ * copy, then leaves src empty. Ownership of the elements transfers to
+ * dst, so src's free function is not called on them. Both lists must
+ * store elements of the same size. Note that if dst wraps a static
+ * array, then this function will have undefined behavior if it needs to
+ * be resized.
+ *
+ * Possible errors:
+ * - EINVAL: either list is NULL, or the element sizes differ
+ * - ENOMEM: Memory allocation error
+ *
+ * @param dst list to append the items to
+ * @param src list to take the items from
+ * @returns 0 on success, non-zero on failure
+ */
+int arr_list_splice(arr_list_t *dst, arr_list_t *src);
+
 /**
  * @brief Set the item at a specific position in the list.
  *
@@ -237,6 +318,27 @@ void *arr_list_get(const arr_list_t *list, size_t position);
  */
 int arr_list_pop(arr_list_t *list, size_t position, void *old);
 
+/**
+ * @brief Remove an item in O(1) by swapping in the last element.
+ *
+ * Behaves like arr_list_pop, except the hole left by the removed item is
+ * filled with the last element of the list instead of shifting the entire
+ * tail forward. This does not preserve the order of the remaining
+ * elements, so it is suited to order-insensitive lists, where it makes
+ * draining a large list linear instead of quadratic. The removed item
+ * will be stored in the old pointer.
+ *
+ * In the event of error, an appropriate error code is returned.
+ * Possible errors:
+ * - EINVAL: list is NULL or position is outside the range of the list
+ *
+ * @param list list to remove the node from
+ * @param position position in the list to remove
+ * @param old where to store the removed item
+ * @return 0 on success, non-zero on failure
+ */
+int arr_list_swap_remove(arr_list_t *list, size_t position, void *old);
+
 /**
  * @brief Search for an item and remove it from the list.
  *
@@ -316,6 +418,48 @@ void *arr_list_iterator_next(arr_list_t *list);
  */
 int arr_list_index_of(const arr_list_t *list, const void *data, ssize_t *idx);
 
+/**
+ * @brief Binary search for an item in a sorted list.
+ *
+ * The list tracks whether it is currently sorted by its own compare
+ * function: a freshly created or cleared list is sorted, arr_list_sort
+ * marks it sorted, and positional inserts or overwrites mark it unsorted.
+ * While sorted, this function finds the lowest index of an item in
+ * O(log n) instead of the linear scan of arr_list_index_of, which also
+ * uses the binary search automatically in that state. If the item is not
+ * found, then the index is set to negative.
+ *
+ * Possible errors:
+ * - EINVAL: list or idx is NULL
+ * - ENOTSUP: list does not support comparisons, or is not sorted
+ *
+ * @param list list to search through
+ * @param data is the pointer to the address of the data to be searched for
+ * @param idx where to store the index of the found item
+ * @return 0 on success, non-zero on failure
+ */
+int arr_list_bsearch(const arr_list_t *list, const void *data, ssize_t *idx);
+
+/**
+ * @brief Insert a new item into a sorted list, keeping it sorted.
+ *
+ * The item is inserted before the first element that does not order ahead
+ * of it, so the sorted invariant holds without re-sorting and duplicates
+ * stay grouped. The list will be resized as needed. Note that if the list
+ * wraps a static array, then this function will have undefined behavior if
+ * the list needs to be resized.
+ *
+ * Possible errors:
+ * - EINVAL: list is NULL
+ * - ENOTSUP: list does not support comparisons, or is not sorted
+ * - ENOMEM: Memory allocation error
+ *
+ * @param list list to insert the item into
+ * @param data data to be inserted
+ * @returns 0 on success, non-zero on failure
+ */
+int arr_list_insert_sorted(arr_list_t *list, void *data);
+
 /**
  * @brief Sort list as per user defined compare function in ascending order.
  *
@@ -327,6 +471,30 @@ int arr_list_index_of(const arr_list_t *list, const void *data, ssize_t *idx);
  */
 int arr_list_sort(arr_list_t *list);
 
+/**
+ * @brief Sort the list with an ad-hoc comparator, optionally in parallel.
+ *
+ * Behaves like arr_list_sort, except the given compare function is used
+ * instead of the list's own; if cmp is NULL, the list's compare function is
+ * used. When n_threads is greater than 1 and the list is large enough to
+ * benefit, the list is split into chunks that are sorted concurrently on a
+ * threadpool and then merged, so large sorts scale with cores. Smaller
+ * lists, or an n_threads of 0 or 1, sort serially. If the threadpool
+ * cannot be created, the sort falls back to running serially rather than
+ * failing.
+ *
+ * Possible errors:
+ * - EINVAL: The list is NULL.
+ * - ENOTSUP: cmp is NULL and the list has no compare function.
+ * - ENOMEM: Memory allocation error.
+ *
+ * @param list The array list.
+ * @param cmp The compare function to sort with, or NULL.
+ * @param n_threads Number of threads to sort with.
+ * @return int 0 if successful, non-zero error code on error.
+ */
+int arr_list_sort_with(arr_list_t *list, CMP_F cmp, size_t n_threads);
+
 /**
  * @brief Clear all items out of a list.
  *
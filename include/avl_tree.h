@@ -1,6 +1,7 @@
 #ifndef AVL_TREE_H
 #define AVL_TREE_H
 
+#include "buildingblocks.h"
 #include <unistd.h>
 
 /* DATA */
@@ -61,6 +62,71 @@ typedef struct tree_t tree_t;
  */
 tree_t *tree_new(FREE_F free_func, CMP_F cmp_func, int *err);
 
+/**
+ * @brief Create a new tree with a custom memory allocator.
+ *
+ * Identical to tree_new(), except that the tree struct, its node blocks,
+ * and its iterator are allocated through the given allocator. A
+ * request-scoped arena can therefore discard the whole tree by resetting
+ * the arena, though tree_delete() must still be called when the stored
+ * data has a free function. If allocator is NULL, the standard heap is
+ * used, matching tree_new().
+ *
+ * Errors are stored in the optional *err pointer.
+ * Possible errors:
+ * - ENOMEM: Memory allocation failed.
+ * - EINVAL: The compare function or tree pointers are NULL.
+ *
+ * @param free_func A user-defined free function.
+ * @param cmp_func A user-defined compare function.
+ * @param allocator A memory allocator for the tree internals, or NULL.
+ * @param err A pointer to the error code.
+ * @return tree_t* A pointer to the tree or NULL on error.
+ */
+tree_t *tree_new_alloc(FREE_F free_func, CMP_F cmp_func,
+                       const allocator_t *allocator, int *err);
+
+/**
+ * @brief Create a new tree using high-fanout (B-tree) nodes.
+ *
+ * The tree supports the same operations as one created with tree_new() and
+ * orders data the same way. Each node packs many keys, so lookups and range
+ * scans over large trees touch far fewer cache lines than the binary layout;
+ * prefer this variant for large, read-heavy sorted indexes.
+ *
+ * Errors are stored in the optional *err pointer.
+ * Possible errors:
+ * - ENOMEM: Memory allocation failed.
+ * - EINVAL: The compare function or tree pointers are NULL.
+ *
+ * @param free_func A user-defined free function.
+ * @param cmp_func A user-defined compare function.
+ * @param err A pointer to the error code.
+ * @return tree_t* A pointer to the tree or NULL on error.
+ */
+tree_t *tree_new_btree(FREE_F free_func, CMP_F cmp_func, int *err);
+
+/**
+ * @brief Create a new high-fanout tree with a custom memory allocator.
+ *
+ * Combines tree_new_btree() with tree_new_alloc(): high-fanout nodes,
+ * every internal allocation routed through the given allocator. If
+ * allocator is NULL, the standard heap is used.
+ *
+ * Errors are stored in the optional *err pointer.
+ * Possible errors:
+ * - ENOMEM: Memory allocation failed.
+ * - EINVAL: The compare function or tree pointers are NULL.
+ *
+ * @param free_func A user-defined free function.
+ * @param cmp_func A user-defined compare function.
+ * @param allocator A memory allocator for the tree internals, or NULL.
+ * @param err A pointer to the error code.
+ * @return tree_t* A pointer to the tree or NULL on error.
+ */
+tree_t *tree_new_btree_alloc(FREE_F free_func, CMP_F cmp_func,
+                             const allocator_t *allocator, int *err);
+
 /**
  * @brief Query the tree.
  *
@@ -208,6 +274,63 @@ tree_t *tree_find_all(tree_t *tree, void *data, int *err);
  */
 int tree_foreach(tree_t *tree, ACT_F act_func, void *addl_data);
 
+/**
+ * @brief Perform an action on all the data in the range [lo, hi].
+ *
+ * The act_func is called on each node whose data compares greater than or
+ * equal to lo and less than or equal to hi, in sorted order. Subtrees that
+ * fall entirely outside the range are never visited, so the cost is
+ * proportional to the height of the tree plus the number of matches. The
+ * addl_data pointer can be used to pass in any additional data that the user
+ * may need. If the act_func returns non-zero, then the traversal will stop
+ * and return the status code. If lo compares greater than hi, then the range
+ * is empty and the function will return 0.
+ *
+ * If tree or act_func is NULL, then the function will return -1.
+ *
+ * @param tree A pointer to the tree.
+ * @param lo A pointer to the lower bound of the range, inclusive.
+ * @param hi A pointer to the upper bound of the range, inclusive.
+ * @param act_func A pointer to the user-defined action function.
+ * @param addl_data A pointer to any additional data needed by the
+ *                  act_func.
+ * @return int 0 on success, non-zero on failure.
+ */
+int tree_range(tree_t *tree, void *lo, void *hi, ACT_F act_func,
+               void *addl_data);
+
+/**
+ * @brief Find the smallest data greater than or equal to the given data.
+ *
+ * The comparison function given at tree creation is used to compare the
+ * data. The lookup follows a single path from the root, so it costs the
+ * same as tree_contains().
+ *
+ * If tree is NULL, or no data in the tree compares greater than or equal to
+ * the given data, then the function will return NULL.
+ *
+ * @param tree A pointer to the tree.
+ * @param data A pointer to the data to be compared against.
+ * @return void* A pointer to the data found or NULL.
+ */
+void *tree_ceiling(tree_t *tree, void *data);
+
+/**
+ * @brief Find the largest data less than or equal to the given data.
+ *
+ * The comparison function given at tree creation is used to compare the
+ * data. The lookup follows a single path from the root, so it costs the
+ * same as tree_contains().
+ *
+ * If tree is NULL, or no data in the tree compares less than or equal to
+ * the given data, then the function will return NULL.
+ *
+ * @param tree A pointer to the tree.
+ * @param data A pointer to the data to be compared against.
+ * @return void* A pointer to the data found or NULL.
+ */
+void *tree_floor(tree_t *tree, void *data);
+
 /**
  * @brief Reset the tree iterator to the first node in the tree.
  *
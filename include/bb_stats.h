@@ -0,0 +1,153 @@
+#ifndef BB_STATS_H
+#define BB_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* DATA */
+
+/**
+ * @brief Identifiers of the runtime performance counters.
+ *
+ * Each counter accumulates a count of events and a sum of the recorded
+ * values, so a snapshot can report both totals and averages (average
+ * probe length, mean wait time, and so on).
+ *
+ * - BB_STAT_HASH_PROBE_LEN: open-addressing probes; one event per probe
+ *   sequence, the value is the number of slots inspected.
+ * - BB_STAT_HASH_RESIZES: hash table resizes; the value is the new
+ *   capacity.
+ * - BB_STAT_QUEUE_C_WAIT_NS: concurrent queue condition waits; the value
+ *   is the nanoseconds spent blocked.
+ * - BB_STAT_QUEUE_C_DEPTH: concurrent queue enqueues; the value is the
+ *   queue depth after the enqueue.
+ * - BB_STAT_THREADPOOL_QUEUE_NS: tasks started by a worker; the value is
+ *   the nanoseconds the task sat in the work queue.
+ * - BB_STAT_THREADPOOL_TASK_NS: tasks completed by a worker; the value
+ *   is the nanoseconds the routine ran.
+ */
+enum bb_stat_id {
+    BB_STAT_HASH_PROBE_LEN,
+    BB_STAT_HASH_RESIZES,
+    BB_STAT_QUEUE_C_WAIT_NS,
+    BB_STAT_QUEUE_C_DEPTH,
+    BB_STAT_THREADPOOL_QUEUE_NS,
+    BB_STAT_THREADPOOL_TASK_NS,
+    BB_STAT_ID_COUNT,
+};
+
+/**
+ * @brief One counter of a statistics snapshot.
+ *
+ * @param count number of recorded events
+ * @param sum total of the recorded values
+ */
+typedef struct bb_stat_t {
+    uint64_t count;
+    uint64_t sum;
+} bb_stat_t;
+
+#ifndef __STDC_NO_ATOMICS__
+#include <stdatomic.h>
+extern atomic_bool bb_stats_on;
+#else
+extern volatile int bb_stats_on;
+#endif
+
+/* FUNCTIONS */
+
+/**
+ * @brief Turn statistics collection on.
+ *
+ * Collection starts disabled; until this is called every recording site
+ * costs a single flag check. Enabling is safe while other threads are
+ * running, though events on their hot paths may take a moment to start
+ * being counted.
+ */
+void bb_stats_enable(void);
+
+/**
+ * @brief Turn statistics collection off.
+ *
+ * Counters keep their accumulated values and can still be read with
+ * bb_stats_snapshot.
+ */
+void bb_stats_disable(void);
+
+/**
+ * @brief Reset every counter to zero.
+ */
+void bb_stats_reset(void);
+
+/**
+ * @brief Sum the per-thread counters into one snapshot.
+ *
+ * The snapshot is consistent per counter, not across counters: threads
+ * recording while the snapshot is taken may land on either side of it.
+ *
+ * Possible error codes:
+ * - EINVAL: snapshot is NULL
+ *
+ * @param snapshot array of BB_STAT_ID_COUNT entries to fill
+ * @return int 0 on success, non-zero on failure
+ */
+int bb_stats_snapshot(bb_stat_t snapshot[BB_STAT_ID_COUNT]);
+
+/**
+ * @brief Get the printable name of a counter.
+ *
+ * @param stat one of enum bb_stat_id
+ * @return const char* the counter name, NULL if stat is out of range
+ */
+const char *bb_stats_name(int stat);
+
+/**
+ * @brief Read the monotonic clock in nanoseconds.
+ *
+ * Intended for recording sites that measure durations; the value is only
+ * meaningful relative to other calls.
+ *
+ * @return uint64_t current monotonic time in nanoseconds
+ */
+uint64_t bb_stats_now_ns(void);
+
+/**
+ * @brief Accumulate one event into a counter.
+ *
+ * This is the slow path behind bb_stats_record; it does not check the
+ * enable flag. Out-of-range stat values are ignored.
+ *
+ * @param stat one of enum bb_stat_id
+ * @param value the value to accumulate
+ */
+void bb_stats_add(int stat, uint64_t value);
+
+/**
+ * @brief Check whether statistics collection is enabled.
+ *
+ * @return int non-zero if enabled, 0 otherwise
+ */
+static inline int bb_stats_active(void) {
+#ifndef __STDC_NO_ATOMICS__
+    return atomic_load_explicit(&bb_stats_on, memory_order_relaxed);
+#else
+    return bb_stats_on;
+#endif
+}
+
+/**
+ * @brief Accumulate one event into a counter if collection is enabled.
+ *
+ * When collection is disabled this is a single relaxed flag check, so
+ * recording sites can stay on hot paths in release builds.
+ *
+ * @param stat one of enum bb_stat_id
+ * @param value the value to accumulate
+ */
+static inline void bb_stats_record(int stat, uint64_t value) {
+    if (bb_stats_active()) {
+        bb_stats_add(stat, value);
+    }
+}
+
+#endif /* BB_STATS_H */
@@ -1,6 +1,10 @@
 #ifndef BUILDINGBLOCKS_H
 #define BUILDINGBLOCKS_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
 /* DATA */
 
 enum query_cmds {
@@ -8,8 +12,48 @@ enum query_cmds {
     QUERY_CAPACITY,
     QUERY_IS_EMPTY,
     QUERY_IS_FULL,
+    QUERY_ELEM_SIZE,
 };
 
+/**
+ * @brief A pointer to a user-defined allocation function.
+ *
+ * The ctx pointer is the allocator's own state (an arena, a pool, a
+ * jemalloc arena index) passed through unchanged on every call. The
+ * function should return NULL when the allocation cannot be satisfied.
+ */
+typedef void *(*ALLOC_F)(size_t size, void *ctx);
+
+/**
+ * @brief A pointer to a user-defined deallocation function.
+ *
+ * The ctx pointer is the same state given to the matching ALLOC_F. An
+ * arena allocator may make this a no-op and release everything at once
+ * by resetting the arena.
+ */
+typedef void (*DEALLOC_F)(void *ptr, void *ctx);
+
+/**
+ * @brief A pluggable memory allocator.
+ *
+ * Containers that accept an allocator route every internal allocation —
+ * the container struct itself, its nodes, and its scratch arrays —
+ * through these callbacks instead of malloc/free. Passing NULL where an
+ * allocator is accepted selects the standard heap.
+ *
+ * The allocator is copied into the container at creation, but the state
+ * behind ctx must stay valid until the container is destroyed.
+ *
+ * @param alloc allocation callback
+ * @param free deallocation callback
+ * @param ctx opaque allocator state passed to both callbacks
+ */
+typedef struct allocator_t {
+    ALLOC_F alloc;
+    DEALLOC_F free;
+    void *ctx;
+} allocator_t;
+
 /* FUNCTIONS */
 
 #ifdef DEBUG
@@ -39,4 +83,132 @@ void set_err(int *err, int value);
  */
 int check_flag(int bit_flags, int position);
 
+/**
+ * @brief Allocate memory through an allocator.
+ *
+ * If allocator is NULL or has no alloc callback, the standard heap is
+ * used.
+ *
+ * @param allocator The allocator, may be NULL.
+ * @param size The number of bytes to allocate.
+ * @return void* The allocation, or NULL on failure.
+ */
+void *mem_alloc(const allocator_t *allocator, size_t size);
+
+/**
+ * @brief Allocate zero-initialized memory through an allocator.
+ *
+ * If allocator is NULL or has no alloc callback, the standard heap is
+ * used.
+ *
+ * @param allocator The allocator, may be NULL.
+ * @param size The number of bytes to allocate.
+ * @return void* The zeroed allocation, or NULL on failure.
+ */
+void *mem_zalloc(const allocator_t *allocator, size_t size);
+
+/**
+ * @brief Resize an allocation made through an allocator.
+ *
+ * The default heap resizes in place when it can; custom allocators have
+ * no realloc hook, so the old contents are copied into a fresh
+ * allocation and the old one is released. The old size must be the size
+ * the block was allocated with. On failure the old block is left intact
+ * and NULL is returned.
+ *
+ * @param allocator The allocator, may be NULL.
+ * @param ptr The block to resize, may be NULL.
+ * @param old_size The current size of the block in bytes.
+ * @param new_size The requested size in bytes.
+ * @return void* The resized allocation, or NULL on failure.
+ */
+void *mem_resize(const allocator_t *allocator, void *ptr, size_t old_size,
+                 size_t new_size);
+
+/**
+ * @brief Built-in comparator for 32-bit unsigned keys.
+ *
+ * Usable anywhere a compare function is accepted; both pointers must
+ * point at a uint32_t. Containers recognize this comparator and replace
+ * the indirect call with an inline compare on their scan paths, so it
+ * should be preferred over a hand-written equivalent for integer keys.
+ *
+ * @param a The value to find.
+ * @param b The value to compare against.
+ * @return int negative, zero, or positive as a is less than, equal to,
+ * or greater than b.
+ */
+int cmp_u32(const void *a, const void *b);
+
+/**
+ * @brief Built-in comparator for 64-bit unsigned keys.
+ *
+ * The 64-bit counterpart of cmp_u32(), recognized by the containers the
+ * same way.
+ *
+ * @param a The value to find.
+ * @param b The value to compare against.
+ * @return int negative, zero, or positive as a is less than, equal to,
+ * or greater than b.
+ */
+int cmp_u64(const void *a, const void *b);
+
+/**
+ * @brief Find a 32-bit value in a contiguous array.
+ *
+ * The scan compares a fixed-width block of elements per loop iteration
+ * with no branches inside the block, so the compiler vectorizes it; on
+ * x86-64 glibc builds the kernel is additionally cloned for wider vector
+ * units and the fastest clone is picked at load time.
+ *
+ * @param arr The array to scan.
+ * @param nmemb The number of elements.
+ * @param key The value to find.
+ * @return ssize_t The index of the first match, -1 if absent or arr is
+ * NULL.
+ */
+ssize_t scan_u32(const uint32_t *arr, size_t nmemb, uint32_t key);
+
+/**
+ * @brief Find a 64-bit value in a contiguous array.
+ *
+ * The 64-bit counterpart of scan_u32(), vectorized the same way.
+ *
+ * @param arr The array to scan.
+ * @param nmemb The number of elements.
+ * @param key The value to find.
+ * @return ssize_t The index of the first match, -1 if absent or arr is
+ * NULL.
+ */
+ssize_t scan_u64(const uint64_t *arr, size_t nmemb, uint64_t key);
+
+/**
+ * @brief Find a fixed-size element in a contiguous array by its bytes.
+ *
+ * Elements are compared with memcmp, so the match is byte equality; use
+ * it for binary keys without padding. elem_size of 0 finds nothing.
+ *
+ * @param arr The array to scan.
+ * @param nmemb The number of elements.
+ * @param elem_size The size of each element in bytes.
+ * @param key The element to find.
+ * @return ssize_t The index of the first match, -1 if absent or arr or
+ * key is NULL.
+ */
+ssize_t scan_mem(const void *arr, size_t nmemb, size_t elem_size,
+                 const void *key);
+
+/**
+ * @brief Release memory obtained through an allocator.
+ *
+ * If allocator is NULL or has no alloc callback, the standard heap is
+ * used. An allocator with an alloc callback but no free callback is an
+ * arena: the release is a no-op and the memory lives until the arena
+ * itself is reset. Freeing NULL does nothing.
+ *
+ * @param allocator The allocator, may be NULL.
+ * @param ptr The block to release.
+ */
+void mem_free(const allocator_t *allocator, void *ptr);
+
 #endif /* BUILDINGBLOCKS_H */
@@ -0,0 +1,199 @@
+#ifndef CONTAINER_SERIALIZE_H
+#define CONTAINER_SERIALIZE_H
+
+#include "array_list.h"
+#include "avl_tree.h"
+#include "hash_table.h"
+#include "serialization.h"
+
+/* DATA */
+
+// data_type flags of the packets making up a container stream
+#define CONTAINER_PKT_HEADER 0xBB01
+#define CONTAINER_PKT_DATA 0xBB02
+
+/**
+ * @brief A user-defined element encoder.
+ *
+ * Called once per element while serializing. The function exposes the
+ * wire bytes of the element by setting *bytes and *len; the bytes are
+ * copied before the next element is encoded, so they may point into the
+ * element itself or into a buffer reused across calls. Returning non-zero
+ * stops the serialization and the value is returned to the caller.
+ *
+ * @param elem the element being serialized
+ * @param bytes where to store the pointer to the element's wire bytes
+ * @param len where to store the number of wire bytes
+ * @return int 0 on success, non-zero to abort
+ */
+typedef int (*SERIALIZE_F)(const void *elem, const void **bytes, size_t *len);
+
+/**
+ * @brief A user-defined element decoder.
+ *
+ * Called once per element while deserializing, with the wire bytes
+ * produced by the matching SERIALIZE_F. The bytes live in a packet buffer
+ * that is reused for the next read, so the function must build an element
+ * that owns its own storage. On failure the function returns NULL and
+ * sets the error code.
+ *
+ * @param bytes the element's wire bytes
+ * @param len the number of wire bytes
+ * @param err pointer to error code
+ * @return void* the decoded element, or NULL on failure
+ */
+typedef void *(*DESERIALIZE_F)(const void *bytes, size_t len, int *err);
+
+/* FUNCTIONS */
+
+/**
+ * @brief Write a hash table to an io_info object as a packet stream.
+ *
+ * The stream is one header packet carrying the entry count followed by
+ * data packets of length-prefixed key/value entries, batched so that a
+ * large table becomes a small number of large writes. The table itself is
+ * not modified. Entry order on the wire is unspecified.
+ *
+ * Possible error codes:
+ * - EINVAL: table, io_info, key_ser, or val_ser are NULL
+ * - ENOMEM: memory allocation fails
+ * - any error returned by the encoders or the packet layer
+ *
+ * @param table the table to serialize
+ * @param io_info the i/o object to write to
+ * @param key_ser encoder for keys
+ * @param val_ser encoder for values
+ * @return int 0 on success, non-zero on failure
+ */
+int hash_table_serialize(hash_table_t *table, io_info_t *io_info,
+                         SERIALIZE_F key_ser, SERIALIZE_F val_ser);
+
+/**
+ * @brief Read a hash table written by hash_table_serialize.
+ *
+ * The table is created with the given parameters — they mirror
+ * hash_table_init_hash — and its capacity is reserved from the entry
+ * count in the stream header before any entry is decoded, so loading
+ * never pays per-insert resize passes. Entries are inserted in bulk, one
+ * batch per data packet.
+ *
+ * Keys and values are built by the decoders and follow the table's usual
+ * ownership rules: values are released through free_f, keys belong to the
+ * caller. On a mid-stream failure the partial table is destroyed, which
+ * releases decoded values through free_f; keys decoded up to that point
+ * cannot be reached and are lost, so key decoders that allocate should
+ * only be used on streams the caller can re-request.
+ *
+ * If an error occurs, NULL is returned and the output variable is set
+ * appropriately. Possible error codes include:
+ * - EINVAL: io_info, key_des, val_des, or cmp_f are NULL
+ * - EPROTO: the stream is not a hash table stream
+ * - ENOMEM: memory allocation fails
+ * - any error returned by the decoders or the packet layer
+ *
+ * @param io_info the i/o object to read from
+ * @param key_des decoder for keys
+ * @param val_des decoder for values
+ * @param free_f pointer to the user defined free function
+ * @param cmp_f pointer to the user defined key compare function
+ * @param hash_f pointer to the user defined hash function, or NULL
+ * @param key_len length of every key in bytes, or 0 for string keys
+ * @param mode storage mode for the table
+ * @param err pointer to error code
+ * @return hash_table_t* the loaded table, or NULL on failure
+ */
+hash_table_t *hash_table_deserialize(io_info_t *io_info, DESERIALIZE_F key_des,
+                                     DESERIALIZE_F val_des, FREE_F free_f,
+                                     CMP_F cmp_f, HASH_F hash_f,
+                                     size_t key_len, int mode, int *err);
+
+/**
+ * @brief Write a tree to an io_info object as a packet stream.
+ *
+ * The stream is one header packet carrying the node count followed by
+ * data packets of length-prefixed elements in sorted order. Both tree
+ * variants produce the same stream.
+ *
+ * Possible error codes:
+ * - EINVAL: tree, io_info, or ser are NULL
+ * - ENOMEM: memory allocation fails
+ * - any error returned by the encoder or the packet layer
+ *
+ * @param tree the tree to serialize
+ * @param io_info the i/o object to write to
+ * @param ser encoder for elements
+ * @return int 0 on success, non-zero on failure
+ */
+int tree_serialize(tree_t *tree, io_info_t *io_info, SERIALIZE_F ser);
+
+/**
+ * @brief Read a tree written by tree_serialize.
+ *
+ * The tree is created with the given parameters, which mirror tree_new;
+ * the receiver chooses the variant, so a tree serialized from the binary
+ * layout can be loaded into the high-fanout one by passing true for
+ * high_fanout. On a mid-stream failure the partial tree is destroyed,
+ * releasing decoded elements through free_f.
+ *
+ * If an error occurs, NULL is returned and the output variable is set
+ * appropriately. Possible error codes include:
+ * - EINVAL: io_info, des, or cmp_f are NULL
+ * - EPROTO: the stream is not a tree stream
+ * - ENOMEM: memory allocation fails
+ * - any error returned by the decoder or the packet layer
+ *
+ * @param io_info the i/o object to read from
+ * @param des decoder for elements
+ * @param free_f pointer to the user defined free function
+ * @param cmp_f pointer to the user defined compare function
+ * @param high_fanout true to load into the high-fanout variant
+ * @param err pointer to error code
+ * @return tree_t* the loaded tree, or NULL on failure
+ */
+tree_t *tree_deserialize(io_info_t *io_info, DESERIALIZE_F des, FREE_F free_f,
+                         CMP_F cmp_f, bool high_fanout, int *err);
+
+/**
+ * @brief Write an array list to an io_info object as a packet stream.
+ *
+ * Because the list stores its elements by value in one contiguous array,
+ * the stream is one header packet carrying the element count and size
+ * followed by data packets copied straight out of the backing array — no
+ * per-element encoding. Elements are shipped as raw bytes, so lists whose
+ * elements contain pointers cannot be moved between processes this way.
+ *
+ * Possible error codes:
+ * - EINVAL: list or io_info are NULL
+ * - any error returned by the packet layer
+ *
+ * @param list the list to serialize
+ * @param io_info the i/o object to write to
+ * @return int 0 on success, non-zero on failure
+ */
+int arr_list_serialize(arr_list_t *list, io_info_t *io_info);
+
+/**
+ * @brief Read an array list written by arr_list_serialize.
+ *
+ * The list is created with the given parameters — they mirror
+ * arr_list_new — sized to the element count in the stream header, and
+ * filled by copying each data packet straight into the backing array. On
+ * a mid-stream failure the partial list is destroyed.
+ *
+ * If an error occurs, NULL is returned and the output variable is set
+ * appropriately. Possible error codes include:
+ * - EINVAL: io_info is NULL
+ * - EPROTO: the stream is not an array list stream
+ * - ENOMEM: memory allocation fails
+ * - any error returned by the packet layer
+ *
+ * @param io_info the i/o object to read from
+ * @param free_f pointer to the free function to be used with that list
+ * @param cmp_f pointer to the compare function to be used with that list
+ * @param err pointer to error code
+ * @return arr_list_t* the loaded list, or NULL on failure
+ */
+arr_list_t *arr_list_deserialize(io_info_t *io_info, FREE_F free_f,
+                                 CMP_F cmp_f, int *err);
+
+#endif /* CONTAINER_SERIALIZE_H */
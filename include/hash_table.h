@@ -1,12 +1,27 @@
 #ifndef HASH_TABLE_H
 #define HASH_TABLE_H
 
+#include "buildingblocks.h"
+#include <stdint.h>
 #include <unistd.h>
 
 /* DATA */
 
 #define HASH_TABLE_DEFAULT_CAPACITY 16 // default capacity of table
 
+/**
+ * @brief Storage modes supported by the table.
+ *
+ * HASH_TABLE_MODE_CHAINED stores colliding entries in per-bucket linked
+ * lists. HASH_TABLE_MODE_OPEN stores every entry in one contiguous slot
+ * array and resolves collisions by linear probing, so a lookup touches one
+ * or two cache lines instead of chasing list nodes across the heap.
+ */
+enum hash_table_mode {
+    HASH_TABLE_MODE_CHAINED,
+    HASH_TABLE_MODE_OPEN,
+};
+
 /**
  * @brief A function pointer to a custom-defined delete function
  *        required to support deletion/memory deallocation of
@@ -25,6 +40,17 @@ typedef void (*FREE_F)(void *data);
  */
 typedef int (*CMP_F)(const void *value_to_find, const void *node_data);
 
+/**
+ * @brief A user-defined hash function.
+ *
+ * Called with a key and the table's key length to produce the hash used to
+ * place the key. key_len is the value given at table creation; it is 0 for
+ * tables keyed by NUL-terminated strings. A good hash function distributes
+ * keys uniformly; the table caches each computed hash so the function is
+ * called once per key per operation, never during resizing.
+ */
+typedef size_t (*HASH_F)(const void *key, size_t key_len);
+
 /**
  * @brief A user-defined function that gets called in the iterate call.
  *
@@ -41,6 +67,17 @@ typedef int (*CMP_F)(const void *value_to_find, const void *node_data);
 typedef int (*ACT_TABLE_F)(const void *key, void **data, void *addl_data);
 
 typedef struct hash_table_t hash_table_t;
+
+/**
+ * @brief One key/value pair for hash_table_set_bulk.
+ *
+ * @param key key for data to be stored at
+ * @param data data to be stored at that key value
+ */
+typedef struct hash_table_kv_t {
+    const void *key;
+    void *data;
+} hash_table_kv_t;
 /* FUNCTIONS */
 
 /**
@@ -66,6 +103,93 @@ typedef struct hash_table_t hash_table_t;
 hash_table_t *hash_table_init(size_t capacity, FREE_F free_f, CMP_F cmp_f,
                               int *err);
 
+/**
+ * @brief Initialize hash table with a specific storage mode.
+ *
+ * Identical to hash_table_init, except that the storage mode is selected by
+ * the caller. hash_table_init is equivalent to calling this function with
+ * HASH_TABLE_MODE_CHAINED. All other table functions behave the same
+ * regardless of the mode of the table they are given.
+ *
+ * If an error occurs, NULL is returned and the output variable is set
+ * appropriately. Possible error codes include:
+ * - EINVAL: cmp_f is NULL
+ * - ENOTSUP: mode is not a valid storage mode
+ * - ENOMEM: memory allocation fails
+ *
+ * @param capacity initial capacity of the table
+ * @param free_f pointer to the user defined free function
+ * @param cmp_f pointer to the user defined key compare function
+ * @param mode storage mode for the table
+ * @param err pointer to error code
+ * @return hash_table_t pointer to allocated table
+ */
+hash_table_t *hash_table_init_mode(size_t capacity, FREE_F free_f, CMP_F cmp_f,
+                                   int mode, int *err);
+
+/**
+ * @brief Initialize hash table with a custom hash function and key length.
+ *
+ * Identical to hash_table_init_mode, except that keys are hashed with the
+ * given function and may be fixed-length binary values. If hash_f is NULL,
+ * the built-in hash is used. If key_len is 0, keys are treated as
+ * NUL-terminated strings; otherwise every key is exactly key_len bytes and
+ * never needs a terminator. The computed hash of each key is cached with
+ * its entry, so entries are never re-hashed when the table grows and full
+ * key compares are skipped when hashes differ.
+ *
+ * If an error occurs, NULL is returned and the output variable is set
+ * appropriately. Possible error codes include:
+ * - EINVAL: cmp_f is NULL
+ * - ENOTSUP: mode is not a valid storage mode
+ * - ENOMEM: memory allocation fails
+ *
+ * @param capacity initial capacity of the table
+ * @param free_f pointer to the user defined free function
+ * @param cmp_f pointer to the user defined key compare function
+ * @param hash_f pointer to the user defined hash function, or NULL
+ * @param key_len length of every key in bytes, or 0 for string keys
+ * @param mode storage mode for the table
+ * @param err pointer to error code
+ * @return hash_table_t pointer to allocated table
+ */
+hash_table_t *hash_table_init_hash(size_t capacity, FREE_F free_f, CMP_F cmp_f,
+                                   HASH_F hash_f, size_t key_len, int mode,
+                                   int *err);
+
+/**
+ * @brief Initialize hash table with a custom memory allocator.
+ *
+ * Identical to hash_table_init_hash, except that the table struct, its
+ * bucket or slot arrays, and every entry node are allocated through the
+ * given allocator. A request-scoped arena can therefore discard the whole
+ * table by resetting the arena, though hash_table_destroy must still be
+ * called when the stored data has a free function. If allocator is NULL,
+ * the standard heap is used, matching hash_table_init_hash. Snapshots
+ * produced by hash_table_freeze always come from the standard heap because
+ * the caller releases them with free.
+ *
+ * If an error occurs, NULL is returned and the output variable is set
+ * appropriately. Possible error codes include:
+ * - EINVAL: cmp_f is NULL
+ * - ENOTSUP: mode is not a valid storage mode
+ * - ENOMEM: memory allocation fails
+ *
+ * @param capacity initial capacity of the table
+ * @param free_f pointer to the user defined free function
+ * @param cmp_f pointer to the user defined key compare function
+ * @param hash_f pointer to the user defined hash function, or NULL
+ * @param key_len length of every key in bytes, or 0 for string keys
+ * @param mode storage mode for the table
+ * @param allocator memory allocator for the table internals, or NULL
+ * @param err pointer to error code
+ * @return hash_table_t pointer to allocated table
+ */
+hash_table_t *hash_table_init_alloc(size_t capacity, FREE_F free_f,
+                                    CMP_F cmp_f, HASH_F hash_f, size_t key_len,
+                                    int mode, const allocator_t *allocator,
+                                    int *err);
+
 /**
  * @brief Query the table.
  *
@@ -99,6 +223,10 @@ int hash_table_query(const hash_table_t *table, int query, ssize_t *result);
  * the data will be added to the table. A reference to the key is stored in the
  * table, so the key must remain valid for the lifetime of the table.
  *
+ * When the table grows past its load threshold, entries are migrated to the
+ * larger storage a few buckets per call rather than all at once, so the
+ * worst-case latency of a single set stays bounded.
+ *
  * If an error occurs, an appropriate error code is returned.
  * Possible error codes include:
  * - EINVAL: table or key are NULL
@@ -111,6 +239,48 @@ int hash_table_query(const hash_table_t *table, int query, ssize_t *result);
  */
 int hash_table_set(hash_table_t *table, void *data, const void *key);
 
+/**
+ * @brief Pre-size the table for an expected number of entries.
+ *
+ * Grows the table's storage in one step so that at least total entries can
+ * be held without crossing the load threshold. Entries already in the
+ * table are kept, and any in-progress incremental migration is completed
+ * first. If the table is already large enough, nothing is done. The table
+ * never shrinks.
+ *
+ * If an error occurs, an appropriate error code is returned.
+ * Possible error codes include:
+ * - EINVAL: table is NULL
+ * - ENOMEM: memory allocation fails
+ *
+ * @param table pointer to table address
+ * @param total expected total number of entries
+ * @return int 0 on success, non-zero on failure
+ */
+int hash_table_reserve(hash_table_t *table, size_t total);
+
+/**
+ * @brief Add a batch of items to the table.
+ *
+ * Behaves as if hash_table_set were called for each pair in order, but the
+ * table capacity is checked and grown once up front instead of per insert,
+ * so bulk loads never pay repeated resize passes. Keys that already exist
+ * have their data updated. On failure, pairs earlier in the array may
+ * already have been added.
+ *
+ * If an error occurs, an appropriate error code is returned.
+ * Possible error codes include:
+ * - EINVAL: table or pairs are NULL, or a pair's key is NULL
+ * - ENOMEM: memory allocation fails
+ *
+ * @param table pointer to table address
+ * @param pairs array of key/value pairs to add
+ * @param count number of pairs in the array
+ * @return int 0 on success, non-zero on failure
+ */
+int hash_table_set_bulk(hash_table_t *table, const hash_table_kv_t *pairs,
+                        size_t count);
+
 /**
  * @brief Look up an item in the table by key.
  *
@@ -124,6 +294,62 @@ int hash_table_set(hash_table_t *table, void *data, const void *key);
  */
 void *hash_table_lookup(const hash_table_t *table, const void *key);
 
+/**
+ * @brief Compact the table into one contiguous, relocatable buffer.
+ *
+ * The returned buffer holds a header, an open-addressed slot array of
+ * cached hashes, and the key (and optionally value) bytes, all referenced
+ * by offsets rather than pointers. It can therefore be written out with
+ * write_all() from serialization.h, memory-mapped back in a later process,
+ * and searched with hash_table_frozen_lookup with zero parsing and no
+ * per-entry allocations. The source table is not modified.
+ *
+ * If value_len is non-zero, value_len bytes are copied from each entry's
+ * data pointer into the buffer, making the snapshot fully self-contained.
+ * If value_len is 0, the data pointer values themselves are stored; such a
+ * snapshot is only meaningful within the process that created it.
+ *
+ * The buffer is allocated with malloc and owned by the caller.
+ *
+ * If an error occurs, an appropriate error code is returned.
+ * Possible error codes include:
+ * - EINVAL: table, buf, or buf_size are NULL
+ * - ENOMEM: memory allocation fails
+ *
+ * @param table pointer to table address
+ * @param value_len bytes to copy per value, or 0 to store raw pointers
+ * @param buf output pointer for the allocated buffer
+ * @param buf_size output pointer for the buffer size in bytes
+ * @return int 0 on success, non-zero on failure
+ */
+int hash_table_freeze(hash_table_t *table, size_t value_len, uint8_t **buf,
+                      size_t *buf_size);
+
+/**
+ * @brief Look up a key in a frozen snapshot buffer.
+ *
+ * The buffer must have been produced by hash_table_freeze (possibly in an
+ * earlier process and memory-mapped back in). The compare and hash
+ * functions must match the ones the source table was created with; pass a
+ * NULL hash_f for tables that used the built-in hash.
+ *
+ * If the snapshot was created with a non-zero value_len, the returned
+ * pointer addresses the value bytes inside the buffer. If it was created
+ * with value_len 0, the original data pointer value is returned, exactly
+ * as hash_table_lookup would have returned it.
+ *
+ * If frozen or key are NULL, the buffer is not a valid snapshot, or the
+ * key is not found, NULL is returned.
+ *
+ * @param frozen pointer to the snapshot buffer
+ * @param key key for data being searched for
+ * @param cmp_f pointer to the user defined key compare function
+ * @param hash_f pointer to the user defined hash function, or NULL
+ * @return void * the stored value, or NULL
+ */
+void *hash_table_frozen_lookup(const void *frozen, const void *key,
+                               CMP_F cmp_f, HASH_F hash_f);
+
 /**
  * @brief Iterate over the hash table.
  *
@@ -0,0 +1,200 @@
+#ifndef HASH_TABLE_CONCURRENT_H
+#define HASH_TABLE_CONCURRENT_H
+
+#include "hash_table.h"
+#include <unistd.h>
+
+/* DATA */
+
+#define HASH_TABLE_C_DEFAULT_STRIPES 16 // default number of lock stripes
+
+typedef struct hash_table_c_t hash_table_c_t;
+
+/* FUNCTIONS */
+
+/**
+ * @brief Initialize a concurrent hash table.
+ *
+ * This function allocates memory for a new table object designed to be
+ * thread safe. The key space is partitioned into independent stripes, each
+ * guarded by its own read/write lock, so lookups from many threads proceed
+ * in parallel and writers only contend with other writers of the same
+ * stripe. It can be used in a single threaded application, but it is
+ * recommended to use a hash_table_t object instead.
+ *
+ * The table is initialized with the given total capacity, spread across the
+ * stripes. If a capacity of 0 is given, the default capacity will be used.
+ * If a stripe count of 0 is given, HASH_TABLE_C_DEFAULT_STRIPES stripes are
+ * created. The customfree function is used to free the data stored in the
+ * table; if it is NULL, the data will not be freed when the table is
+ * destroyed. The given compare function is used for looking up keys.
+ *
+ * If an error occurs, NULL is returned and the output variable is set
+ * appropriately. Possible error codes include:
+ * - EINVAL: cmp_f is NULL
+ * - ENOMEM: memory allocation fails
+ *
+ * @param capacity initial total capacity of the table
+ * @param stripes number of lock stripes, or 0 for the default
+ * @param free_f pointer to the user defined free function
+ * @param cmp_f pointer to the user defined key compare function
+ * @param err pointer to error code
+ * @return hash_table_c_t pointer to allocated table
+ */
+hash_table_c_t *hash_table_c_init(size_t capacity, size_t stripes,
+                                  FREE_F free_f, CMP_F cmp_f, int *err);
+
+/**
+ * @brief Initialize a concurrent hash table with a custom hash function.
+ *
+ * Identical to hash_table_c_init, except that keys are hashed with the
+ * given function and may be fixed-length binary values, with the same
+ * semantics as hash_table_init_hash. The hash function is also used to
+ * select the stripe a key belongs to.
+ *
+ * If an error occurs, NULL is returned and the output variable is set
+ * appropriately. Possible error codes include:
+ * - EINVAL: cmp_f is NULL
+ * - ENOMEM: memory allocation fails
+ *
+ * @param capacity initial total capacity of the table
+ * @param stripes number of lock stripes, or 0 for the default
+ * @param free_f pointer to the user defined free function
+ * @param cmp_f pointer to the user defined key compare function
+ * @param hash_f pointer to the user defined hash function, or NULL
+ * @param key_len length of every key in bytes, or 0 for string keys
+ * @param err pointer to error code
+ * @return hash_table_c_t pointer to allocated table
+ */
+hash_table_c_t *hash_table_c_init_hash(size_t capacity, size_t stripes,
+                                       FREE_F free_f, CMP_F cmp_f,
+                                       HASH_F hash_f, size_t key_len,
+                                       int *err);
+
+/**
+ * @brief Query the table.
+ *
+ * The query command is used to get information about the table. The result
+ * pointer is used to store the result of the query. Stripes are read-locked
+ * one at a time, so the result is a consistent sum only when no writers are
+ * active.
+ *
+ * Possible queries:
+ * - QUERY_SIZE: Get the number of key/value pairs in the table.
+ * - QUERY_IS_EMPTY: Check if the table is empty.
+ *
+ * Possible errors:
+ * - EINVAL: The table or result pointers are NULL.
+ * - ENOTSUP: The query command is invalid.
+ *
+ * @param table A pointer to the table.
+ * @param query The query command.
+ * @param result A pointer to the result of the query.
+ * @return int 0 on success, non-zero on failure.
+ */
+int hash_table_c_query(hash_table_c_t *table, int query, ssize_t *result);
+
+/**
+ * @brief Add an item to the table.
+ *
+ * If the key already exists in the table, the data will be updated.
+ * Otherwise, the data will be added to the table. A reference to the key is
+ * stored in the table, so the key must remain valid for the lifetime of the
+ * table. Only the stripe the key hashes to is write-locked.
+ *
+ * If an error occurs, an appropriate error code is returned.
+ * Possible error codes include:
+ * - EINVAL: table or key are NULL
+ * - ENOMEM: memory allocation fails
+ *
+ * @param table pointer to table address
+ * @param data data to be stored at that key value
+ * @param key key for data to be stored at
+ * @return int 0 on success, non-zero on failure
+ */
+int hash_table_c_set(hash_table_c_t *table, void *data, const void *key);
+
+/**
+ * @brief Look up an item in the table by key.
+ *
+ * If table or key are NULL, NULL is returned. If the key is not found in
+ * the table, NULL is also returned. The user should check to tell the
+ * difference between a NULL return value and a NULL table/key error. The
+ * stripe the key hashes to is read-locked, so concurrent lookups never
+ * block each other.
+ *
+ * @param table pointer to table address
+ * @param key key for data being searched for
+ * @return void * the data stored at that key, or NULL
+ */
+void *hash_table_c_lookup(hash_table_c_t *table, const void *key);
+
+/**
+ * @brief Iterate over the hash table.
+ *
+ * Iterates over the hash table and calls the action function on each item.
+ * Stripes are write-locked one at a time while their items are visited, so
+ * the action function may modify item data but must not touch the table
+ * itself. If the function returns non-zero, then the iterate call will stop
+ * and return the error code.
+ *
+ * If an error occurs, an appropriate error code is returned.
+ * Possible error codes include:
+ * - EINVAL: table or action are NULL
+ *
+ * @param table pointer to table address
+ * @param action pointer to function to be called on each item
+ * @param addl_data additional data that the user may need
+ * @return int the return value of the action function, or non-zero on failure
+ */
+int hash_table_c_iterate(hash_table_c_t *table, ACT_TABLE_F action,
+                         void *addl_data);
+
+/**
+ * @brief Remove an item from the hash table.
+ *
+ * If table or key are NULL, NULL is returned. If the key is not found in
+ * the table, NULL is also returned. The user should check to tell the
+ * difference between a NULL return value and a NULL table/key error. Only
+ * the stripe the key hashes to is write-locked.
+ *
+ * @param table the table to remove the item from
+ * @param key key of data to be removed
+ * @return void * data that was removed, or NULL
+ */
+void *hash_table_c_remove(hash_table_c_t *table, const void *key);
+
+/**
+ * @brief Clear all data from hash table.
+ *
+ * The customfree function is used to free the data stored in the table. If
+ * the customfree function is NULL, the data will not be freed when the
+ * table is cleared. Every stripe is write-locked while it is cleared.
+ *
+ * If an error occurs, an appropriate error code is returned.
+ * Possible error codes include:
+ * - EINVAL: table is NULL
+ *
+ * @param table the table to clear
+ * @return int 0 on success, non-zero on failure
+ */
+int hash_table_c_clear(hash_table_c_t *table);
+
+/**
+ * @brief Destroy hash table.
+ *
+ * The customfree function is used to free the data stored in the table. If
+ * the customfree function is NULL, the data will not be freed when the
+ * table is destroyed. The caller must ensure no other thread is still using
+ * the table when it is destroyed.
+ *
+ * If an error occurs, an appropriate error code is returned.
+ * Possible error codes include:
+ * - EINVAL: table is NULL
+ *
+ * @param table_addr pointer to table address
+ * @return int 0 on success, non-zero on failure
+ */
+int hash_table_c_destroy(hash_table_c_t **table_addr);
+
+#endif /* HASH_TABLE_CONCURRENT_H */
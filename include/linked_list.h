@@ -1,6 +1,7 @@
 #ifndef LINKED_LIST_H
 #define LINKED_LIST_H
 
+#include "buildingblocks.h"
 #include <unistd.h>
 
 /* DATA */
@@ -38,6 +39,9 @@ typedef int (*CMP_F)(const void *value_to_find, const void *node_data);
 typedef int (*ACT_F)(void **node_data, void *addl_data);
 
 typedef struct list_t list_t;
+
+typedef struct list_cursor_t list_cursor_t;
+
 /**
  * @brief Create a new list.
  *
@@ -57,6 +61,80 @@ typedef struct list_t list_t;
  */
 list_t *list_new(FREE_F free_f, CMP_F cmp_f, int *err);
 
+/**
+ * @brief Create a new list backed by a custom allocator.
+ *
+ * Identical to list_new, except every internal allocation — the list
+ * struct, its node pool blocks, and the cursors created from it — goes
+ * through the given allocator. An arena allocator lets the whole list be
+ * discarded by resetting the arena, though list_delete must still be
+ * called when the data has a free function. Passing a NULL allocator is
+ * the same as calling list_new.
+ *
+ * If an error occurs, then NULL will be returned.
+ * Possible error codes are:
+ * - ENOMEM: memory allocation failed
+ *
+ * @param free_f pointer to the free function to be used with that list
+ * @param cmp_f pointer to the compare function to be used with that list
+ * @param allocator pointer to the allocator to draw memory from
+ * @param err pointer to the error code
+ * @returns pointer to allocated list on success or NULL on failure
+ */
+list_t *list_new_alloc(FREE_F free_f, CMP_F cmp_f,
+                       const allocator_t *allocator, int *err);
+
+/**
+ * @brief Create a new linked list with a chosen node pool block size.
+ *
+ * Identical to list_new, except the number of nodes allocated per pool
+ * block is given by the caller. List nodes are carved out of slab blocks
+ * instead of being malloc'd one at a time: allocation is a pointer bump,
+ * popped nodes are recycled through a free list, and nodes from one block
+ * are contiguous in memory. list_new uses a default block size; lists that
+ * are known to grow very large can pass a larger value here to reduce the
+ * number of block allocations.
+ *
+ * In case of an error, this function will return NULL and set the error
+ * pointer if given. The error pointer may be NULL, in which case the error
+ * will not be stored.
+ * Possible errors:
+ * - ENOMEM: Memory allocation error
+ * - EINVAL: nodes_per_block is 0
+ *
+ * @param free_f pointer to the free function to be used with that list
+ * @param cmp_f pointer to the compare function to be used with that list
+ * @param nodes_per_block number of nodes to allocate per pool block
+ * @param err where to store the error code
+ * @returns pointer to allocated list on success or NULL on failure
+ */
+list_t *list_new_pooled(FREE_F free_f, CMP_F cmp_f, size_t nodes_per_block,
+                        int *err);
+
+/**
+ * @brief Create a new linked list with a positional index.
+ *
+ * Identical to list_new, except the list additionally maintains a
+ * position -> node index so list_get and list_insert resolve a position
+ * with a single array load instead of a forward walk. The index is built
+ * lazily by the first positional access after a structural change, in one
+ * O(n) pass; pushes onto the tail keep it fresh, so read-mostly workloads
+ * that append see O(1) positional reads. Lists that are mutated on every
+ * access gain nothing from the index and should use list_new instead.
+ *
+ * In case of an error, this function will return NULL and set the error
+ * pointer if given. The error pointer may be NULL, in which case the error
+ * will not be stored.
+ * Possible errors:
+ * - ENOMEM: Memory allocation error
+ *
+ * @param free_f pointer to the free function to be used with that list
+ * @param cmp_f pointer to the compare function to be used with that list
+ * @param err where to store the error code
+ * @returns pointer to allocated list on success or NULL on failure
+ */
+list_t *list_new_indexed(FREE_F free_f, CMP_F cmp_f, int *err);
+
 /**
  * @brief Query the list.
  *
@@ -269,6 +347,108 @@ int list_iterator_reset(list_t *list);
  */
 void *list_iterator_next(list_t *list, int *err);
 
+/**
+ * @brief Create a cursor positioned on the head of the list.
+ *
+ * Unlike the single embedded iterator, any number of cursors can traverse
+ * one list at the same time, and a cursor supports O(1) insertion and
+ * removal at its position, with no walk from the head. Modifying the list
+ * through one cursor, or through the list functions directly, invalidates
+ * every other cursor on that list; invalidated cursors must be reset
+ * before reuse.
+ *
+ * In case of an error, this function will return NULL and set the error
+ * pointer if given. The error pointer may be NULL, in which case the error
+ * will not be stored.
+ * Possible errors:
+ * - EINVAL: list is NULL
+ * - ENOMEM: Memory allocation error
+ *
+ * @param list list to traverse
+ * @param err where to store the error code
+ * @return pointer to the new cursor on success or NULL on failure
+ */
+list_cursor_t *list_cursor_new(list_t *list, int *err);
+
+/**
+ * @brief Reposition the cursor on the head of the list.
+ *
+ * @param cursor cursor to reset
+ * @return 0 on success, EINVAL if cursor is NULL
+ */
+int list_cursor_reset(list_cursor_t *cursor);
+
+/**
+ * @brief Get the data of the node the cursor is on.
+ *
+ * If the cursor is NULL or has moved past the end of the list, NULL is
+ * returned. Note that if the list allows NULL values, then it is up to the
+ * user to differentiate between a NULL value in the list and an error.
+ *
+ * @param cursor cursor to read
+ * @return the data of the current node, or NULL
+ */
+void *list_cursor_get(const list_cursor_t *cursor);
+
+/**
+ * @brief Advance the cursor one node and get the new node's data.
+ *
+ * If an error occurs, then NULL will be returned.
+ * Possible error codes are:
+ * - EINVAL: cursor is NULL
+ * - ENOTSUP: the cursor has moved past the end of the list
+ *
+ * @param cursor cursor to advance
+ * @param err where to store the error code
+ * @return the data of the new current node on success, or NULL
+ */
+void *list_cursor_next(list_cursor_t *cursor, int *err);
+
+/**
+ * @brief Insert a new node directly after the cursor in O(1).
+ *
+ * The cursor stays on its current node. As a special case, inserting with
+ * a cursor on an empty list creates the sole node and leaves the cursor
+ * on it.
+ *
+ * Possible error codes are:
+ * - EINVAL: cursor is NULL, or it has moved past the end of a non-empty
+ *           list
+ * - ENOMEM: memory allocation failed
+ *
+ * @param cursor cursor to insert at
+ * @param data data to be stored in the new node
+ * @return 0 on success, non-zero on failure
+ */
+int list_cursor_insert_after(list_cursor_t *cursor, void *data);
+
+/**
+ * @brief Remove the node the cursor is on in O(1) and return its data.
+ *
+ * The cursor moves to the node after the removed one, or past the end if
+ * the tail was removed, so removal can be repeated while traversing.
+ *
+ * If an error occurs, then NULL will be returned.
+ * Possible error codes are:
+ * - EINVAL: cursor is NULL
+ * - ENOTSUP: the cursor has moved past the end of the list
+ *
+ * @param cursor cursor to remove at
+ * @param err where to store the error code
+ * @return the data of the removed node on success, or NULL
+ */
+void *list_cursor_remove(list_cursor_t *cursor, int *err);
+
+/**
+ * @brief Delete a cursor.
+ *
+ * The list itself is not affected. The cursor pointer is set to NULL.
+ *
+ * @param cursor_address pointer to the address of the cursor
+ * @return 0 on success, EINVAL if the cursor is NULL
+ */
+int list_cursor_delete(list_cursor_t **cursor_address);
+
 /**
  * @brief Find the first occurrence of a node containing the search_data.
  *
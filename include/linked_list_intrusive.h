@@ -0,0 +1,276 @@
+#ifndef LINKED_LIST_INTRUSIVE_H
+#define LINKED_LIST_INTRUSIVE_H
+
+#include <stddef.h>
+#include <unistd.h>
+
+/* DATA */
+
+/**
+ * @brief A user-defined compare function.
+ *
+ * Positive return value indicates that the first argument is greater than the
+ * second argument. Negative return value indicates that the first argument is
+ * less than the second argument. Zero return value indicates that the first
+ * argument is equal to the second argument.
+ */
+typedef int (*ICMP_F)(const void *value_to_find, const void *item);
+
+/**
+ * @brief A user-defined function that gets called in the foreach_call.
+ *
+ * The addl_data pointer can be used to pass in any additional data that the
+ * user may need. If no additional data is needed, then the pointer can be
+ * NULL. The return value of the function should be 0 on success and non-zero
+ * on failure. If the function returns non-zero, then the foreach_call will
+ * stop and return the error code.
+ */
+typedef int (*IACT_F)(void *item, void *addl_data);
+
+/**
+ * @brief The link fields embedded in the user's struct.
+ *
+ * Place one of these inside the struct that is to be stored in the list and
+ * pass its offset (via offsetof) to ilist_new. The link belongs to the list
+ * while the item is in it; an item may only be in one ilist per embedded
+ * link at a time.
+ */
+typedef struct ilist_link_t {
+    struct ilist_link_t *next;
+} ilist_link_t;
+
+typedef struct ilist_t ilist_t;
+
+/**
+ * @brief Create a new intrusive list.
+ *
+ * An intrusive list never allocates nodes: the link fields live inside the
+ * user's struct at the given offset, so every push and pop is pure pointer
+ * manipulation and touches only the cache line the item already occupies.
+ * The API mirrors linked_list.h, but items are not owned by the list and
+ * are never freed by it.
+ *
+ * If cmp_f is NULL, then certain functions that require a compare function
+ * will not be available. If any of these functions are called, they will
+ * result in an ENOTSUP error.
+ *
+ * If an error occurs, then NULL will be returned.
+ * Possible error codes are:
+ * - ENOMEM: memory allocation failed
+ *
+ * @param link_offset offset of the embedded ilist_link_t within the item
+ * @param cmp_f pointer to the compare function to be used with that list
+ * @param err pointer to the error code
+ * @returns pointer to allocated list on success or NULL on failure
+ */
+ilist_t *ilist_new(size_t link_offset, ICMP_F cmp_f, int *err);
+
+/**
+ * @brief Query the list.
+ *
+ * The query command is used to get information about the list. The result
+ * pointer is used to store the result of the query.
+ *
+ * Possible queries:
+ * - QUERY_SIZE: Get the number of items in the list.
+ * - QUERY_IS_EMPTY: Check if the list is empty.
+ *
+ * Possible errors:
+ * - EINVAL: The list or result pointers are NULL.
+ * - ENOTSUP: The query command is invalid.
+ *
+ * @param list A pointer to the list.
+ * @param query The query command.
+ * @param result A pointer to the result of the query.
+ * @return int 0 on success, non-zero on failure.
+ */
+int ilist_query(const ilist_t *list, int query, ssize_t *result);
+
+/**
+ * @brief Push an item onto the head of list.
+ *
+ * The item's embedded link is taken over by the list; it must not already
+ * be in a list through that link.
+ *
+ * Possible error codes are:
+ * - EINVAL: list or item is NULL
+ *
+ * @param list list to push the item into
+ * @param item item to be pushed
+ * @returns 0 on success, non-zero on failure
+ */
+int ilist_push_head(ilist_t *list, void *item);
+
+/**
+ * @brief Push an item onto the tail of list.
+ *
+ * The item's embedded link is taken over by the list; it must not already
+ * be in a list through that link.
+ *
+ * Possible error codes are:
+ * - EINVAL: list or item is NULL
+ *
+ * @param list list to push the item into
+ * @param item item to be pushed
+ * @return 0 on success, non-zero on failure
+ */
+int ilist_push_tail(ilist_t *list, void *item);
+
+/**
+ * @brief Get the size of the list.
+ *
+ * If list is NULL, then -1 will be returned.
+ *
+ * @param list list to get the size of
+ * @return the size of the list on success, -1 on failure
+ */
+ssize_t ilist_size(const ilist_t *list);
+
+/**
+ * @brief Check if the list object is empty.
+ *
+ * If list is NULL, then -1 will be returned.
+ *
+ * @param list pointer to list object to be checked
+ * @returns 0 if list is not empty, non-zero if list is empty, -1 on error
+ */
+int ilist_is_empty(const ilist_t *list);
+
+/**
+ * @brief Pop the head item out of the list.
+ *
+ * If list is NULL or empty, then NULL will be returned.
+ *
+ * @param list list to pop out of
+ * @return the popped item on success, NULL on failure
+ */
+void *ilist_pop_head(ilist_t *list);
+
+/**
+ * @brief Pop the tail item out of the list.
+ *
+ * If list is NULL or empty, then NULL will be returned.
+ *
+ * @param list list to pop out of
+ * @return the popped item on success, NULL on failure
+ */
+void *ilist_pop_tail(ilist_t *list);
+
+/**
+ * @brief Get the item at the head of the list without popping.
+ *
+ * If list is NULL or empty, then NULL will be returned.
+ *
+ * @param list list to peek into
+ * @return the head item on success, NULL on failure
+ */
+void *ilist_peek_head(const ilist_t *list);
+
+/**
+ * @brief Get the item at the tail of the list without popping.
+ *
+ * If list is NULL or empty, then NULL will be returned.
+ *
+ * @param list list to peek into
+ * @return the tail item on success, NULL on failure
+ */
+void *ilist_peek_tail(const ilist_t *list);
+
+/**
+ * @brief Unlink a specific item from the list.
+ *
+ * The item is located by pointer identity, so no compare function is
+ * needed; the item itself is untouched apart from its link fields.
+ *
+ * If an error occurs, then NULL will be returned.
+ * Possible error codes are:
+ * - EINVAL: list or item is NULL
+ *
+ * @param list list to remove the item from
+ * @param item the item to be unlinked
+ * @param err pointer to the error code
+ * @return the item if it was found and unlinked, NULL otherwise
+ */
+void *ilist_unlink(ilist_t *list, void *item, int *err);
+
+/**
+ * @brief Search for an item and remove it from the list.
+ *
+ * If the item is found by the compare function, it is unlinked from the
+ * list. If the list allows duplicates, then only the first item found will
+ * be removed.
+ *
+ * If an error occurs, then NULL will be returned.
+ * Possible error codes are:
+ * - EINVAL: list is NULL
+ * - ENOTSUP: list does not support comparisons
+ *
+ * @param list list to remove the item from
+ * @param item_to_remove the data object to be searched for
+ * @param err pointer to the error code
+ * @return the removed item on success, NULL otherwise
+ */
+void *ilist_remove(ilist_t *list, void *item_to_remove, int *err);
+
+/**
+ * @brief Perform a user defined action on every item in the list.
+ *
+ * If the action function returns non-zero, then the foreach_call will stop
+ * and return the error code. The action must not push to or pop from the
+ * list.
+ *
+ * Possible error codes are:
+ * - EINVAL: list or action_function is NULL
+ *
+ * @param list list to perform actions on
+ * @param action_function pointer to user defined action function
+ * @param addl_data pointer to additional data for the action function
+ * @return 0 if all actions were successful, non-zero if an action failed
+ */
+int ilist_foreach_call(ilist_t *list, IACT_F action_function, void *addl_data);
+
+/**
+ * @brief Reset the list iterator to the head of the list.
+ *
+ * @param list list to reset the iterator of
+ * @return 0 on success, EINVAL if list is NULL
+ */
+int ilist_iterator_reset(ilist_t *list);
+
+/**
+ * @brief Get the next item in the list.
+ *
+ * If an error occurs, then NULL will be returned.
+ * Possible error codes are:
+ * - EINVAL: list is NULL
+ * - ENOTSUP: the iterator is at the end of the list
+ *
+ * @param list list to iterate through
+ * @param err pointer to the error code
+ * @return the next item on success, or NULL
+ */
+void *ilist_iterator_next(ilist_t *list, int *err);
+
+/**
+ * @brief Clear all items out of the list.
+ *
+ * Every item is unlinked, but since the list does not own its items, no
+ * memory is freed.
+ *
+ * @param list list to clear
+ * @return 0 on success, EINVAL if list is NULL
+ */
+int ilist_clear(ilist_t *list);
+
+/**
+ * @brief Delete the list object.
+ *
+ * Items still in the list are unlinked but not freed. The list pointer is
+ * set to NULL.
+ *
+ * @param list_address pointer to the address of the list
+ * @return 0 on success, EINVAL if the list is NULL
+ */
+int ilist_delete(ilist_t **list_address);
+
+#endif /* LINKED_LIST_INTRUSIVE_H */
@@ -14,12 +14,41 @@
 enum service_flags {
     THREADED_SESSIONS = 1 << 0, // Run each client session in a separate thread
     ENABLE_SSL = 1 << 1,        // Enable SSL for the service
+    EVENT_SESSIONS = 1 << 2,    // Invoke the service per readable event
 };
 
 typedef struct server server_t;
 
 typedef int (*service_f)(io_info_t *client);
 
+// number of buckets in the per-service latency histogram
+#define SERVICE_LATENCY_BUCKETS 12
+
+/**
+ * @brief Server-wide counters.
+ *
+ * @param accepts - connections accepted since the server was created
+ * @param active_sessions - client sessions currently open
+ * @param queue_depth - sessions waiting for a threadpool thread
+ */
+struct server_stats {
+    size_t accepts;
+    size_t active_sessions;
+    size_t queue_depth;
+};
+
+/**
+ * @brief Per-service latency counters.
+ *
+ * @param calls - completed service invocations
+ * @param latency - invocations by duration: bucket 0 counts calls under
+ * 1 ms, bucket i calls under 2^i ms, the last bucket everything slower
+ */
+struct service_stats {
+    size_t calls;
+    size_t latency[SERVICE_LATENCY_BUCKETS];
+};
+
 /* FUNCTIONS */
 
 /**
@@ -91,6 +120,35 @@ int destroy_server(server_t *server);
 int open_inet_socket(server_t *server, const char *name, const char *port,
                      int *err_type);
 
+/**
+ * @brief Open an Inet server socket backed by several listeners.
+ *
+ * Works like open_inet_socket(), but opens nsockets listening sockets on
+ * the same port with SO_REUSEPORT so the kernel spreads incoming
+ * connections between them. run_server() watches every listener, so
+ * accepts for a busy service are no longer serialized through a single
+ * accept queue and throughput scales with the threadpool workers
+ * handling the sessions. A reasonable nsockets is the number of cores
+ * expected to accept connections; nsockets of 1 behaves like
+ * open_inet_socket() aside from the socket option.
+ *
+ * On platforms without SO_REUSEPORT the call fails with ENOTSUP.
+ *
+ * The error types and codes match open_inet_socket(), plus:
+ * - SYS:
+ *      EINVAL: nsockets is 0
+ *      ENOTSUP: SO_REUSEPORT is not available
+ *
+ * @param server - The server to store the sockets.
+ * @param name - The identifier of the service.
+ * @param port - The port number.
+ * @param nsockets - The number of listening sockets to open.
+ * @param err_type - The error code type.
+ * @return int - 0 on success, non-zero on failure.
+ */
+int open_inet_socket_n(server_t *server, const char *name, const char *port,
+                       size_t nsockets, int *err_type);
+
 /**
  * @brief Open a Unix domain server socket.
  *
@@ -120,6 +178,14 @@ int open_unix_socket(server_t *server, const char *name, const char *path);
  * Possible flags:
  * - THREADED_SESSIONS: Run each client session in a separate thread.
  * - ENABLE_SSL: Enable SSL for the service.
+ * - EVENT_SESSIONS: Keep client connections open and invoke the service
+ *   once per readable event instead of handing each client to a thread
+ *   for its whole session. The service should handle one request per
+ *   call and return 0 to keep the session open or non-zero to close it;
+ *   an idle connection costs only its io_info_t, so many mostly-idle
+ *   clients can be multiplexed over the threadpool. Only honored by
+ *   run_server() on platforms with epoll; otherwise each session is
+ *   handled as a regular accept.
  * Unknown flags are ignored.
  *
  * Possible errors:
@@ -137,6 +203,42 @@ int open_unix_socket(server_t *server, const char *name, const char *path);
 int register_service(server_t *server, const char *name, service_f service,
                      int flags);
 
+/**
+ * @brief Read the server-wide counters.
+ *
+ * The counters are always on and are updated by the accept and session
+ * paths with atomic operations, so reading them does not disturb a
+ * running server. An accepts-per-second rate can be derived by sampling
+ * the accepts counter periodically.
+ *
+ * Possible errors:
+ * - EINVAL: server or stats is NULL.
+ *
+ * @param server - The server to read the counters from.
+ * @param stats - Where to store the counters.
+ * @return int - 0 on success, non-zero on failure.
+ */
+int server_stats(server_t *server, struct server_stats *stats);
+
+/**
+ * @brief Read the latency histogram of a service.
+ *
+ * Each completed invocation of the service function is timed and counted
+ * into a power-of-two millisecond bucket, making tail latency visible
+ * without any debug build or logging.
+ *
+ * Possible errors:
+ * - EINVAL: server, name, or stats is NULL.
+ * - ENOENT: The service with the given name does not exist.
+ *
+ * @param server - The server the service is registered with.
+ * @param name - The name of the service.
+ * @param stats - Where to store the counters.
+ * @return int - 0 on success, non-zero on failure.
+ */
+int service_stats(server_t *server, const char *name,
+                  struct service_stats *stats);
+
 /**
  * @brief Run a service.
  *
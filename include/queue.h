@@ -1,6 +1,7 @@
 #ifndef QUEUE_H
 #define QUEUE_H
 
+#include "buildingblocks.h"
 #include <unistd.h>
 
 /* DATA */
@@ -56,6 +57,60 @@ typedef struct queue_t queue_t;
 queue_t *queue_init(size_t capacity, FREE_F customfree, CMP_F compare,
                     int *err);
 
+/**
+ * @brief Create a new queue with a custom memory allocator.
+ *
+ * Identical to queue_init, except that the queue struct and its backing
+ * storage — the ring buffer of a fixed-capacity queue or the node blocks
+ * of an unlimited one — are allocated through the given allocator. A
+ * request-scoped arena can therefore discard the whole queue by resetting
+ * the arena, though queue_destroy must still be called when the stored
+ * data has a free function. If allocator is NULL, the standard heap is
+ * used, matching queue_init.
+ *
+ * If an error occurs, NULL will be returned.
+ * Possible error codes are:
+ * - ENOMEM: memory allocation failed
+ *
+ * @param capacity max number of nodes the queue will hold
+ * @param customfree pointer to user defined free function
+ * @note if the user passes in NULL, the queue will not free the data
+ * @param compare pointer to user defined compare function
+ * @param allocator memory allocator for the queue internals, or NULL
+ * @param err pointer to integer to store error code
+ * @returns pointer to allocated queue on success or NULL on failure
+ */
+queue_t *queue_init_alloc(size_t capacity, FREE_F customfree, CMP_F compare,
+                          const allocator_t *allocator, int *err);
+
+/**
+ * @brief Create a new queue that stores elements by value.
+ *
+ * Each enqueue copies mem_sz bytes from the caller's pointer into the
+ * queue's own storage, so small messages do not need a heap allocation
+ * just to pass their address. Dequeue, peek, and get return a pointer to
+ * the queue-owned copy; a dequeued copy stays readable until a later
+ * enqueue reuses its slot, so callers should copy it out if they need it
+ * longer. Because the queue owns the storage there is no free function.
+ * A by-value queue requires a fixed capacity.
+ *
+ * The compare function, if given, is called with the address of the
+ * stored copy as its second argument.
+ *
+ * If an error occurs, NULL will be returned.
+ * Possible error codes are:
+ * - EINVAL: capacity is QUEUE_UNLIMITED or mem_sz is 0
+ * - ENOMEM: memory allocation failed
+ *
+ * @param capacity max number of elements the queue will hold
+ * @param mem_sz size of each element in bytes
+ * @param compare pointer to user defined compare function
+ * @param err pointer to integer to store error code
+ * @returns pointer to allocated queue on success or NULL on failure
+ */
+queue_t *queue_init_sized(size_t capacity, size_t mem_sz, CMP_F compare,
+                          int *err);
+
 /**
  * @brief Check if queue is full.
  *
@@ -6,7 +6,8 @@
 
 /* DATA */
 
-#define QUEUE_C_UNLIMITED 0 // Unlimited capacity for queue
+#define QUEUE_C_UNLIMITED 0   // Unlimited capacity for queue
+#define QUEUE_C_DEFAULT_PRI 0 // Priority used by plain enqueues
 
 /**
  * @brief A pointer to a user-defined free function.  This is used to free
@@ -42,6 +43,57 @@ typedef struct queue_c_t queue_c_t;
  */
 queue_c_t *queue_c_init(size_t capacity, FREE_F customfree, int *err);
 
+/**
+ * @brief Create a new concurrent queue with a lock-free backend.
+ *
+ * The queue behaves like one created by queue_c_init(), but elements are
+ * stored in a bounded lock-free ring: enqueue and dequeue never take the
+ * queue mutex, so producers and consumers on different threads do not
+ * serialize against each other on the fast path. The blocking wait and
+ * manual lock functions still work and remain the recommended way to
+ * sleep until the queue changes state.
+ *
+ * The capacity is rounded up to the next power of two and must not be
+ * QUEUE_C_UNLIMITED; the ring is bounded by construction. Because
+ * elements can be claimed concurrently, queue_c_peek() is best effort in
+ * this mode: the returned element may already be dequeued by another
+ * thread by the time the caller inspects it.
+ *
+ * Possible error values:
+ * - EINVAL: capacity is QUEUE_C_UNLIMITED
+ * - ENOMEM: malloc failed to allocate memory
+ * - ENOTSUP: the platform has no C11 atomics
+ *
+ * @param capacity max number of nodes the queue will hold
+ * @param customfree pointer to user defined free function
+ * @note if the user passes in NULL, the queue will not free the data
+ * @param err pointer to error code
+ * @returns pointer to allocated queue on success or NULL on failure
+ */
+queue_c_t *queue_c_init_lockfree(size_t capacity, FREE_F customfree, int *err);
+
+/**
+ * @brief Create a new concurrent queue with a priority-ordered backend.
+ *
+ * The queue behaves like one created by queue_c_init(), but elements are
+ * dequeued highest priority first instead of in insertion order. Elements
+ * with equal priority keep their insertion order. Priorities are assigned
+ * with queue_c_enqueue_pri(); the plain queue_c_enqueue() functions enqueue
+ * at QUEUE_C_DEFAULT_PRI.
+ *
+ * A capacity of 0 will create a queue with unlimited capacity.
+ *
+ * Possible error values:
+ * - ENOMEM: malloc failed to allocate memory
+ *
+ * @param capacity max number of nodes the queue will hold
+ * @param customfree pointer to user defined free function
+ * @note if the user passes in NULL, the queue will not free the data
+ * @param err pointer to error code
+ * @returns pointer to allocated queue on success or NULL on failure
+ */
+queue_c_t *queue_c_init_priority(size_t capacity, FREE_F customfree, int *err);
+
 /**
  * @brief Check if queue is full.
  *
@@ -276,6 +328,29 @@ int queue_c_timed_wait_for_not_empty(queue_c_t *queue, time_t timeout);
  */
 int queue_c_cancel_wait(queue_c_t *queue);
 
+/**
+ * @brief Close a queue to new data.
+ *
+ * This function wakes all waiting threads exactly once and marks the
+ * queue closed. After the close, enqueues fail with EPIPE and dequeues
+ * drain the items still in the queue, then fail: queue_c_dequeue()
+ * returns NULL with the error set to EPIPE, and the batch functions
+ * return -1 once the queue is empty. Waits whose condition a closed
+ * queue can never satisfy return EPIPE instead of blocking. Intended as
+ * the shutdown path for consumer pools: one close replaces the repeated
+ * cancel/retry loop otherwise needed to flush every worker.
+ *
+ * Closing an already closed queue does nothing and returns 0.
+ *
+ * Possible error values:
+ * - EINVAL: queue is NULL or destroyed before this function is called
+ * - EINTR: queue is destroyed while waiting to lock
+ *
+ * @param queue pointer queue object
+ * @return int 0 on success, non-zero on failure
+ */
+int queue_c_close(queue_c_t *queue);
+
 /**
  * @brief Lock the queue.
  *
@@ -347,7 +422,8 @@ ssize_t queue_c_size(queue_c_t *queue);
  *
  * If queue is NULL, EINVAL is returned. If the queue is full, EOVERFLOW is
  * returned. If malloc fails, ENOMEM is returned. If the queue is destroyed
- * while this function is waiting to lock, EINTR will be returned.
+ * while this function is waiting to lock, EINTR will be returned. If the
+ * queue has been closed with queue_c_close(), EPIPE will be returned.
  *
  * @param queue pointer to queue pointer to push the node into
  * @param data data to be pushed into node
@@ -355,6 +431,45 @@ ssize_t queue_c_size(queue_c_t *queue);
  */
 int queue_c_enqueue(queue_c_t *queue, void *data);
 
+/**
+ * @brief Push a new node into the queue at a given priority.
+ *
+ * Only valid on queues created with queue_c_init_priority(); on any other
+ * queue ENOTSUP is returned. A higher priority value is dequeued sooner,
+ * and elements with equal priority are dequeued in insertion order.
+ * Locking, signalling and the remaining error values match
+ * queue_c_enqueue().
+ *
+ * @param queue pointer to queue to push the node into
+ * @param data data to be pushed into node
+ * @param priority priority of the new node
+ * @return the 0 on success, non-zero on failure
+ */
+int queue_c_enqueue_pri(queue_c_t *queue, void *data, double priority);
+
+/**
+ * @brief Push a batch of items into the queue.
+ *
+ * Up to n items from the items array are enqueued under a single lock
+ * acquisition, and the condition variables are signalled once for the
+ * whole batch instead of once per item. If the queue fills up part way
+ * through, the items enqueued so far stay in the queue and the count of
+ * enqueued items is returned; the caller can retry the remainder.
+ *
+ * As with queue_c_enqueue(), if the queue is already locked on this
+ * thread from a previous call to a wait/lock function, this function
+ * will continue operation and leave the queue locked when it is done.
+ *
+ * If the queue or items is NULL, the queue has been destroyed, or the
+ * queue is destroyed while waiting to lock, -1 will be returned.
+ *
+ * @param queue pointer to queue to push the items into
+ * @param items array of items to be pushed into the queue
+ * @param n number of items in the array
+ * @return number of items enqueued, -1 on failure
+ */
+ssize_t queue_c_enqueue_n(queue_c_t *queue, void **items, size_t n);
+
 /**
  * @brief Pop the front node out of the queue.
  *
@@ -377,6 +492,28 @@ int queue_c_enqueue(queue_c_t *queue, void *data);
  */
 void *queue_c_dequeue(queue_c_t *queue, int *err);
 
+/**
+ * @brief Pop a batch of items out of the queue.
+ *
+ * Up to max_n items are dequeued into the items array under a single
+ * lock acquisition, and the condition variables are signalled once for
+ * the whole batch instead of once per item. If the queue runs empty
+ * part way through, the count of dequeued items is returned.
+ *
+ * As with queue_c_dequeue(), if the queue is already locked on this
+ * thread from a previous call to a wait/lock function, this function
+ * will continue operation and leave the queue locked when it is done.
+ *
+ * If the queue or items is NULL, the queue has been destroyed, or the
+ * queue is destroyed while waiting to lock, -1 will be returned.
+ *
+ * @param queue pointer to queue to pop the items off of
+ * @param items caller array receiving the dequeued items
+ * @param max_n capacity of the caller array
+ * @return number of items dequeued, -1 on failure
+ */
+ssize_t queue_c_dequeue_n(queue_c_t *queue, void **items, size_t max_n);
+
 /**
  * @brief Get the data from the node at the front of the queue without popping.
  *
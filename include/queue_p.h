@@ -136,6 +136,27 @@ int queue_p_enqueue(queue_p_t *queue, void *data, double priority);
  */
 queue_p_node_t *queue_p_dequeue(queue_p_t *queue);
 
+/**
+ * @brief Dequeue every node at or above a priority threshold in one pass.
+ *
+ * Nodes are written to the caller's buffer in dequeue order (descending
+ * priority, FIFO within a priority) until the first node below
+ * min_priority, the queue is empty, or max_n nodes have been drained. A
+ * deadline tick that releases a large batch of due events makes one call
+ * instead of a dequeue per event. As with queue_p_dequeue, each returned
+ * node must be freed by the caller after use.
+ *
+ * If queue or nodes is NULL, this function will return -1.
+ *
+ * @param queue pointer to queue to drain
+ * @param min_priority lowest priority that should still be drained
+ * @param nodes caller buffer receiving the drained nodes
+ * @param max_n capacity of the caller buffer
+ * @return number of nodes drained, -1 on error
+ */
+ssize_t queue_p_drain_until(queue_p_t *queue, double min_priority,
+                            queue_p_node_t **nodes, size_t max_n);
+
 /**
  * @brief Get the data from the node at a specific position in the queue.
  *
@@ -2,8 +2,10 @@
 #define SERIALIZATION_H
 
 #include <poll.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 /* DATA */
 
@@ -59,10 +61,13 @@ struct pkt_hdr {
  *
  * @param hdr - the packet header
  * @param data - the packet data
+ * @param data_cap - allocated size of data, managed by read_pkt_into; 0 when
+ * data is NULL or aliases a file mapping owned by the io_info object
  */
 struct packet {
     struct pkt_hdr *hdr; // packet header
     void *data;          // packet data
+    size_t data_cap;     // allocated size of data, managed by read_pkt_into
 };
 
 /* FUNCTIONS */
@@ -98,6 +103,26 @@ io_info_t *new_io_info(int fd, int type, int *err);
 io_info_t *new_file_io_info(const char *filename, int flags, mode_t mode,
                             int *err);
 
+/**
+ * @brief Create a memory-mapped io_info object for reading a file.
+ *
+ * The file is opened read-only and mapped into memory, with the kernel
+ * advised that access will be sequential. Reads consume the mapping instead
+ * of copying through the file descriptor, and packets produced by
+ * read_pkt()/read_pkt_into() have their data pointer alias the mapping
+ * directly (zero-copy). Aliased packet data remains valid until the io_info
+ * object is freed and is marked by a data_cap of 0, which the packet free
+ * functions use to know the data is not theirs to release.
+ *
+ * Reading past the end of the file reports ENODATA. The mapping and the
+ * underlying file descriptor are released when the io_info object is freed.
+ *
+ * @param filename - The name of the file.
+ * @param err - Where to store the error code.
+ * @return io_info_t* - The io_info object.
+ */
+io_info_t *new_file_mmap_io_info(const char *filename, int *err);
+
 /**
  * @brief Create a new io_info object for accepting network connections.
  *
@@ -110,6 +135,25 @@ io_info_t *new_file_io_info(const char *filename, int flags, mode_t mode,
  */
 io_info_t *new_accept_io_info(const char *port, int *err, int *err_type);
 
+/**
+ * @brief Create a new io_info object for accepting network connections,
+ * sharing its port with other listeners.
+ *
+ * The listening socket is bound with SO_REUSEPORT, so several io_info
+ * objects may listen on the same port at once and the kernel spreads
+ * incoming connections between them. On platforms without SO_REUSEPORT
+ * the call fails with ENOTSUP.
+ *
+ * Any underlying socket will be closed when the io_info object is freed.
+ *
+ * @param port - The port to listen on.
+ * @param err - Where to store the error code.
+ * @param err_type - Where to store the error type.
+ * @return io_info_t* - The io_info object.
+ */
+io_info_t *new_accept_io_info_reuseport(const char *port, int *err,
+                                        int *err_type);
+
 /**
  * @brief Create a new io_info object for connecting to remote hosts.
  *
@@ -124,6 +168,45 @@ io_info_t *new_accept_io_info(const char *port, int *err, int *err_type);
 io_info_t *new_connect_io_info(const char *host, const char *port, int *err,
                                int *err_type);
 
+/**
+ * @brief Start connecting to a remote host without blocking.
+ *
+ * Works like new_connect_io_info(), but only starts the TCP handshake and
+ * returns immediately; name resolution is still performed synchronously.
+ * The returned object is not usable for reads or writes until
+ * io_connect_status() reports the connection established. Wait for the
+ * object to become writable with poll_io_info() (POLLOUT) before checking,
+ * or check periodically.
+ *
+ * Any underlying socket will be closed when the io_info object is freed.
+ *
+ * @param host - The host to connect to.
+ * @param port - The port to connect to.
+ * @param err - Where to store the error code.
+ * @param err_type - Where to store the error type.
+ * @return io_info_t* - The io_info object.
+ */
+io_info_t *new_connect_io_info_async(const char *host, const char *port,
+                                     int *err, int *err_type);
+
+/**
+ * @brief Check whether an asynchronous connection has been established.
+ *
+ * Once the connection is established the object behaves like one created
+ * with new_connect_io_info() and the call keeps returning 0. While the
+ * handshake is still in flight EINPROGRESS is returned; any other value is
+ * the error that made the connection fail.
+ *
+ * Possible errors:
+ * - EINVAL: io_info is NULL or not a connection object
+ * - EINPROGRESS: the connection is not established yet
+ * See connect(2) for additional possible errors.
+ *
+ * @param io_info - The io_info object to check.
+ * @return int - 0 when connected, non-zero otherwise.
+ */
+int io_connect_status(io_info_t *io_info);
+
 /**
  * @brief Create a new SSL loader.
  *
@@ -150,6 +233,24 @@ void free_io_info(io_info_t *io_info);
  */
 void free_ssl_loader(ssl_loader_t *loader);
 
+/**
+ * @brief Enable kernel TLS offload for connections made through a loader.
+ *
+ * Once the handshake completes, record encryption moves into the kernel
+ * where supported, so bulk reads and writes skip the userspace copy through
+ * the TLS library. Connections fall back to the normal path silently when
+ * the kernel or cipher does not support offload. Call before connections
+ * are made; contexts already created by the loader are updated as well.
+ *
+ * Possible errors:
+ * - EINVAL: loader is NULL
+ * - ENOTSUP: the TLS library or build has no kernel TLS support
+ *
+ * @param loader - The SSL loader to enable offload on.
+ * @return int - 0 on success, non-zero on failure.
+ */
+int ssl_loader_enable_ktls(ssl_loader_t *loader);
+
 /**
  * @brief Get the file descriptor from an io_info object.
  *
@@ -227,6 +328,32 @@ int poll_io_info(struct pollio *ios, nfds_t nfds, int timeout);
  */
 io_info_t *io_accept(io_info_t *io_info, int *err);
 
+/**
+ * @brief Accept every pending connection on a socket io_info in one go.
+ *
+ * Drains the accept queue into the clients array without blocking: the
+ * function returns as soon as the queue is empty or the array is full,
+ * whichever comes first. On Linux the connections are delivered with
+ * accept4(2), avoiding per-connection fcntl round-trips. An empty queue is
+ * not an error; *count is simply 0 on return.
+ *
+ * On entry *count must hold the capacity of the clients array; on return it
+ * holds the number of connections accepted. If an error occurs mid-batch,
+ * the connections accepted before it are still reported in *count and the
+ * error is returned.
+ *
+ * Possible errors:
+ * - EINVAL: io_info, clients, or count is NULL, or *count is 0
+ * - ENOMEM: Insufficient memory is available.
+ * See accept(2) for additional possible errors.
+ *
+ * @param io_info - The io_info object to accept on.
+ * @param clients - Array to store the accepted connections.
+ * @param count - In: capacity of clients. Out: connections accepted.
+ * @return int - 0 on success, non-zero on failure.
+ */
+int io_accept_batch(io_info_t *io_info, io_info_t **clients, size_t *count);
+
 /**
  * @brief Read a fixed amount of data from an io_info object.
  *
@@ -258,6 +385,72 @@ int read_exact(io_info_t *io_info, void *buff, size_t read_sz);
  */
 int write_all(io_info_t *io_info, const void *buf, size_t len);
 
+/**
+ * @brief Enable or disable buffered (corked) writes on an io_info object.
+ *
+ * While buffering is enabled, writes are collected in a userspace buffer and
+ * pushed to the descriptor when the buffer fills, when io_flush() is called,
+ * or when buffering is disabled. A packet built from many small writes then
+ * costs a single syscall (or TLS record) instead of one per write. Writes at
+ * least as large as the buffer bypass it after flushing any pending bytes,
+ * so ordering is always preserved.
+ *
+ * Disabling buffering flushes any pending bytes before releasing the buffer.
+ *
+ * Possible errors:
+ * - EINVAL: io_info is NULL
+ * - ENOMEM: buffer allocation failed
+ * - any error from io_flush() when disabling
+ *
+ * @param io_info - the io_info object
+ * @param enabled - true to enable buffering, false to disable
+ * @return int - 0 on success, non-zero on failure
+ */
+int io_set_buffered(io_info_t *io_info, bool enabled);
+
+/**
+ * @brief Flush any buffered writes on an io_info object.
+ *
+ * Has no effect if buffering is not enabled or no bytes are pending. On
+ * failure the pending bytes are discarded, because part of them may already
+ * have reached the descriptor; the stream should be considered broken.
+ *
+ * Possible errors:
+ * - EINVAL: io_info is NULL
+ * - any error from write(2)
+ *
+ * @param io_info - the io_info object
+ * @return int - 0 on success, non-zero on failure
+ */
+int io_flush(io_info_t *io_info);
+
+/**
+ * @brief Copy data from one io_info object to another.
+ *
+ * Copies len bytes from src to dest. When src is a file, offset is the file
+ * position to copy from and the file position of src is left untouched; for
+ * any other source offset must be 0.
+ *
+ * When the platform allows it (a file source and a destination without an SSL
+ * layer on Linux), the copy is performed in the kernel with sendfile(2) and
+ * the data never passes through userspace. Otherwise the copy falls back to a
+ * buffered read/write loop, which handles SSL-enabled objects through their
+ * normal read and write paths.
+ *
+ * Possible errors:
+ * - EINVAL: dest or src is NULL, or offset is negative
+ * - ESPIPE: offset is non-zero and src is not a file
+ * - ENODATA: src ended before len bytes were copied
+ * See read(2), write(2), and sendfile(2) for additional possible errors.
+ *
+ * @param dest - the io_info object to write to
+ * @param src - the io_info object to read from
+ * @param offset - the position in src to copy from
+ * @param len - the number of bytes to copy
+ * @return int - 0 on success, non-zero on failure
+ */
+int io_copy(io_info_t *dest, io_info_t *src, off_t offset, size_t len);
+
 /**
  * @brief Free a packet.
  *
@@ -267,6 +460,18 @@ int write_all(io_info_t *io_info, const void *buf, size_t len);
  */
 void free_packet(struct packet *pkt);
 
+/**
+ * @brief Free the buffers of a caller-owned packet.
+ *
+ * Releases the header and data buffers accumulated by read_pkt_into and
+ * resets the packet to its empty state, without freeing the packet itself.
+ * Use this for packets the caller allocated (e.g. on the stack) and
+ * free_packet for packets returned by read_pkt or recv_pkt_data.
+ *
+ * @param pkt - the packet whose buffers to free
+ */
+void free_packet_buffers(struct packet *pkt);
+
 /**
  * @brief Write packet data to an io_info object.
  *
@@ -287,6 +492,31 @@ void free_packet(struct packet *pkt);
 int write_pkt_data(io_info_t *io_info, void *data, size_t len,
                    uint32_t data_type);
 
+/**
+ * @brief Write packet data gathered from multiple fragments.
+ *
+ * Works like write_pkt_data(), but the payload is gathered from iovcnt
+ * fragments; the header describes the combined length, so the receiver sees
+ * one packet regardless of how the sender assembled it. The header and all
+ * fragments are pushed out in a single writev(2) call (a single SSL record
+ * in the SSL build), so small packets cost one syscall instead of one per
+ * fragment.
+ *
+ * Possible errors:
+ * - EINVAL: io_info is NULL, or iov is NULL with a non-zero iovcnt
+ * - EOVERFLOW: the combined payload cannot be described by the header
+ * - ENOMEM: Insufficient memory is available.
+ * See writev(2) for additional possible errors.
+ *
+ * @param io_info - the io_info object
+ * @param iov - the payload fragments
+ * @param iovcnt - the number of fragments
+ * @param data_type - flag for the type of the data
+ * @return int - 0 on success, non-zero on failure
+ */
+int write_pkt_datav(io_info_t *io_info, struct iovec *iov, size_t iovcnt,
+                    uint32_t data_type);
+
 /**
  * @brief Receive packet data from an io_info object.
  *
@@ -306,6 +536,33 @@ int write_pkt_data(io_info_t *io_info, void *data, size_t len,
  */
 struct packet *read_pkt(io_info_t *io_info, int *err);
 
+/**
+ * @brief Receive a packet into a caller-owned packet object.
+ *
+ * Works like read_pkt(), but reuses the given packet instead of allocating a
+ * new one: the header buffer is allocated once and the data buffer grows
+ * geometrically, so a connection receiving many packets stops paying for
+ * allocations once the buffer has seen its largest message. Start with a
+ * zeroed packet, reuse it across reads, and release it with
+ * free_packet_buffers() when done. On failure the packet's buffers are kept
+ * for the next read; their contents are unspecified.
+ *
+ * When reading from a memory-mapped io_info (new_file_mmap_io_info()), the
+ * packet's data pointer aliases the mapping instead of using an owned buffer;
+ * see that constructor for the lifetime rules.
+ *
+ * Possible errors:
+ *      EINVAL: io_info or pkt is NULL, or invalid reported header length
+ *      ENODATA: The socket has reached the end of the file early.
+ *      ENOMEM: Out of memory.
+ * See read(2) for more details.
+ *
+ * @param io_info - the io_info object
+ * @param pkt - the packet to read into
+ * @return int - 0 on success, non-zero on failure
+ */
+int read_pkt_into(io_info_t *io_info, struct packet *pkt);
+
 /**
  * @brief Receive packet data from an io_info object.
  *
@@ -330,4 +587,171 @@ struct packet *read_pkt(io_info_t *io_info, int *err);
  */
 struct packet *recv_pkt_data(io_info_t *io_info, int timeout, int *err);
 
+/**
+ * @brief Receive packet data into a caller-owned packet object.
+ *
+ * Works like recv_pkt_data(), but reuses the given packet the same way
+ * read_pkt_into() does instead of allocating a new one per message.
+ *
+ * Possible errors:
+ *      ETIMEDOUT: The poll timed out.
+ *      ENODATA: The other end closed the connection.
+ *      EINVAL: io_info or pkt is NULL, or invalid reported header length
+ *      ENOMEM: Out of memory.
+ * See poll(2) and read(2) for more details.
+ *
+ * @param io_info - the io_info object
+ * @param timeout - the timeout in milliseconds
+ * @param pkt - the packet to read into
+ * @return int - 0 on success, non-zero on failure
+ */
+int recv_pkt_data_into(io_info_t *io_info, int timeout, struct packet *pkt);
+
+/**
+ * @brief Batched submission engine backed by io_uring.
+ *
+ * A ring collects read/write/accept operations on io_info objects and hands
+ * them to the kernel in a single syscall, with completions harvested from
+ * shared memory; at high packet rates this replaces the poll-plus-transfer
+ * syscall pair per operation. Only available on Linux with the plain file
+ * descriptor serialization backend; elsewhere the constructors report
+ * ENOTSUP.
+ */
+typedef struct io_ring io_ring_t;
+
+/**
+ * @brief A completed ring operation.
+ *
+ * @param user_data - the tag supplied when the operation was queued
+ * @param res - bytes transferred (or the accepted file descriptor); negative
+ * values are a negated errno describing the failure
+ */
+struct io_completion {
+    void *user_data; // tag supplied when the operation was queued
+    ssize_t res;     // result of the operation, negative errno on failure
+};
+
+/**
+ * @brief Create a new io_uring submission engine.
+ *
+ * Possible errors:
+ *      EINVAL: entries is 0.
+ *      ENOMEM: Out of memory.
+ *      ENOTSUP: io_uring is not available on this platform or backend.
+ * See io_uring_setup(2) for more details.
+ *
+ * @param entries - requested submission queue depth
+ * @param err - where to store the error code
+ * @return io_ring_t* - the ring on success, NULL on failure
+ */
+io_ring_t *new_io_ring(unsigned entries, int *err);
+
+/**
+ * @brief Free an io_uring submission engine.
+ *
+ * Operations still in flight are abandoned; their buffers must outlive the
+ * kernel's use of them, so submit and drain the ring before freeing it.
+ *
+ * @param ring - the ring to free
+ */
+void free_io_ring(io_ring_t *ring);
+
+/**
+ * @brief Queue a read on the ring.
+ *
+ * The operation is only queued; nothing reaches the kernel until
+ * io_ring_submit() is called. The buffer must stay valid until the matching
+ * completion is harvested. The offset is used for file io and ignored for
+ * sockets.
+ *
+ * Possible errors:
+ *      EINVAL: ring, io_info, or buf is NULL.
+ *      EBUSY: The submission queue is full; submit the batch first.
+ *
+ * @param ring - the ring to queue on
+ * @param io_info - the io_info object to read from
+ * @param buf - the buffer to read into
+ * @param len - the number of bytes to read
+ * @param offset - the file offset to read from
+ * @param user_data - tag returned with the completion
+ * @return int - 0 on success, non-zero on failure
+ */
+int io_ring_read(io_ring_t *ring, io_info_t *io_info, void *buf, size_t len,
+                 off_t offset, void *user_data);
+
+/**
+ * @brief Queue a write on the ring.
+ *
+ * The operation is only queued; nothing reaches the kernel until
+ * io_ring_submit() is called. The buffer must stay valid until the matching
+ * completion is harvested. The offset is used for file io and ignored for
+ * sockets.
+ *
+ * Possible errors:
+ *      EINVAL: ring, io_info, or buf is NULL.
+ *      EBUSY: The submission queue is full; submit the batch first.
+ *
+ * @param ring - the ring to queue on
+ * @param io_info - the io_info object to write to
+ * @param buf - the data to write
+ * @param len - the number of bytes to write
+ * @param offset - the file offset to write at
+ * @param user_data - tag returned with the completion
+ * @return int - 0 on success, non-zero on failure
+ */
+int io_ring_write(io_ring_t *ring, io_info_t *io_info, const void *buf,
+                  size_t len, off_t offset, void *user_data);
+
+/**
+ * @brief Queue an accept on the ring.
+ *
+ * The completion's res field holds the connected file descriptor, ready to
+ * be wrapped with new_io_info().
+ *
+ * Possible errors:
+ *      EINVAL: ring or io_info is NULL, or io_info is not an accept object.
+ *      EBUSY: The submission queue is full; submit the batch first.
+ *
+ * @param ring - the ring to queue on
+ * @param io_info - the accepting io_info object
+ * @param user_data - tag returned with the completion
+ * @return int - 0 on success, non-zero on failure
+ */
+int io_ring_accept(io_ring_t *ring, io_info_t *io_info, void *user_data);
+
+/**
+ * @brief Hand all queued operations to the kernel.
+ *
+ * The whole batch is submitted with a single syscall. The call does not wait
+ * for any of the operations to complete.
+ *
+ * Possible errors:
+ *      EINVAL: ring is NULL.
+ * See io_uring_enter(2) for more details.
+ *
+ * @param ring - the ring to submit
+ * @return int - 0 on success, non-zero on failure
+ */
+int io_ring_submit(io_ring_t *ring);
+
+/**
+ * @brief Harvest completed operations from the ring.
+ *
+ * Copies up to *count completions into the given array, blocking until at
+ * least one is available. On return *count holds the number harvested. Each
+ * completion carries the user_data tag of its operation and the operation's
+ * result; failures are reported per-operation through a negative res rather
+ * than through the return value.
+ *
+ * Possible errors:
+ *      EINVAL: ring, comps, or count is NULL, or *count is 0.
+ * See io_uring_enter(2) for more details.
+ *
+ * @param ring - the ring to harvest from
+ * @param comps - array to store the completions
+ * @param count - in: capacity of comps; out: completions harvested
+ * @return int - 0 on success, non-zero on failure
+ */
+int io_ring_wait(io_ring_t *ring, struct io_completion *comps, size_t *count);
+
 #endif /* SERIALIZATION_H */
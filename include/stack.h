@@ -35,6 +35,22 @@ typedef struct stack_t stack_t;
  */
 stack_t *stack_init(size_t capacity, FREE_F customfree);
 
+/**
+ * @brief Create a new stack that stores elements by value.
+ *
+ * Each push copies mem_sz bytes from the caller's pointer into the
+ * stack's own storage, so small frames do not need a heap allocation just
+ * to pass their address. Pop, peek, and get return a pointer to the
+ * stack-owned copy; a popped copy stays readable until the next push
+ * reuses its slot, so callers should copy it out if they need it longer.
+ * Because the stack owns the storage there is no free function.
+ *
+ * @param capacity max number of elements the stack will hold, not 0
+ * @param mem_sz size of each element in bytes, not 0
+ * @returns pointer to allocated stack on SUCCESS, NULL on failure
+ */
+stack_t *stack_init_sized(size_t capacity, size_t mem_sz);
+
 /**
  * @brief Get the max capacity of the stack.
  *
@@ -2,6 +2,7 @@
 #define THREADPOOL_H
 
 #include "threadpool_attributes.h"
+#include <stdbool.h>
 
 /* DATA */
 
@@ -43,8 +44,25 @@ enum shutdown_flags {
  */
 typedef int (*ROUTINE)(void *arg);
 
+/**
+ * @brief Function pointer for the body of a parallel_for loop.
+ *
+ * The body is called once per sub-range with the half-open interval
+ * [start, end) it should process, along with the shared context passed to
+ * threadpool_parallel_for. The return value is treated like a ROUTINE's:
+ * zero for success, non-zero for an error.
+ *
+ * @param start The first index of the sub-range.
+ * @param end One past the last index of the sub-range.
+ * @param arg The shared context.
+ * @return int The return value of the body.
+ */
+typedef int (*RANGE_ROUTINE)(size_t start, size_t end, void *arg);
+
 typedef struct threadpool_t threadpool_t;
 
+typedef struct threadpool_future_t threadpool_future_t;
+
 struct thread_info {
     size_t index;         // thread index
     ROUTINE action;       // routine to execute
@@ -133,6 +151,210 @@ int threadpool_add_work(threadpool_t *pool, ROUTINE action, void *arg);
 int threadpool_timed_add_work(threadpool_t *pool, ROUTINE action, void *arg,
                               time_t timeout);
 
+/**
+ * @brief Add a new task to the threadpool at a given priority.
+ *
+ * Only valid on a threadpool created with TASK_PRIORITY_ENABLED; on any
+ * other pool ENOTSUP is returned. A task with a higher priority value is
+ * executed sooner, and tasks with equal priority keep their submission
+ * order. Tasks added with threadpool_add_work() run at the default
+ * priority of 0. Full-queue handling follows the BLOCK_ON_ADD and
+ * TIMED_WAIT flags exactly as in threadpool_add_work().
+ *
+ * If THREAD_CREATE_LAZY is set on the threadpool, the function will attempt
+ * to create a new thread if there are no available threads to execute the task.
+ * In this case, since the check for the thread is done after the task is added
+ * to the queue, even if the thread creation fails the task will still be added
+ * to the queue.
+ *
+ * Possible error codes:
+ *      ENOMEM: memory allocation failed
+ *      EOVERFLOW: queue is full and BLOCK_ON_ADD is not set
+ *      EINVAL: pool or action is NULL
+ *      ENOTSUP: the pool does not order tasks by priority
+ *      ETIMEDOUT: TIMED_WAIT is enabled and the timeout elapses
+ *      EAGAIN: THREAD_CREATE_LAZY is set and thread creation failed
+ *
+ * @param pool The threadpool to add the task to.
+ * @param action The routine to be executed by the threadpool.
+ * @param arg The argument to be passed to the routine.
+ * @param priority The priority of the task.
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_add_work_pri(threadpool_t *pool, ROUTINE action, void *arg,
+                            double priority);
+
+/**
+ * @brief Schedule deferred or periodic work on the threadpool.
+ *
+ * The routine is submitted to the regular work queue after delay_ms
+ * milliseconds. If interval_ms is non-zero, the task is re-armed after
+ * each expiry so it runs every interval_ms milliseconds; intervals
+ * missed while the pool is saturated are skipped rather than run back
+ * to back. All timers share one deadline heap serviced by a single
+ * internal thread, which is created on the first call, so scheduled
+ * work never ties up a worker while waiting.
+ *
+ * Expiry hands the task to threadpool_add_work(), so the pool's
+ * full-queue handling applies at that point. Timers that have not
+ * expired when the pool is destroyed are discarded; periodic timers
+ * run until then.
+ *
+ * Possible error codes:
+ *      ENOMEM: memory allocation failed
+ *      EINVAL: pool or action is NULL, or delay_ms or interval_ms is
+ *              negative
+ *      EAGAIN: the timer thread could not be created
+ *
+ * @param pool The threadpool to schedule the task on.
+ * @param action The routine to be executed by the threadpool.
+ * @param arg The argument to be passed to the routine.
+ * @param delay_ms Milliseconds before the first run.
+ * @param interval_ms Milliseconds between runs, 0 for one-shot work.
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_schedule(threadpool_t *pool, ROUTINE action, void *arg,
+                        time_t delay_ms, time_t interval_ms);
+
+/**
+ * @brief Add a new task to the threadpool and return a completion handle.
+ *
+ * The task is added exactly as with threadpool_add_work, but the returned
+ * future can be used to wait for that specific task and read its routine's
+ * return value, instead of barrier-syncing on the whole pool with
+ * threadpool_wait. The future must be released with future_destroy once it
+ * is no longer needed.
+ *
+ * If the threadpool is destroyed before the task runs, the future is
+ * marked cancelled and any waiters are released; future_get will then
+ * return ECANCELED.
+ *
+ * If THREAD_CREATE_LAZY is set and thread creation fails after the task
+ * has been queued, the error is ignored and the future is still returned,
+ * since the task remains queued.
+ *
+ * Possible error codes:
+ *      ENOMEM: memory allocation failed
+ *      EOVERFLOW: queue is full and BLOCK_ON_ADD is not set
+ *      EINVAL: pool or action is NULL
+ *      ETIMEDOUT: TIMED_WAIT is enabled and the timeout elapses
+ *
+ * @param pool The threadpool to add the task to.
+ * @param action The routine to be executed by the threadpool.
+ * @param arg The argument to be passed to the routine.
+ * @param err Where to store the error code.
+ * @return threadpool_future_t* A handle for the task, or NULL on failure.
+ */
+threadpool_future_t *threadpool_submit(threadpool_t *pool, ROUTINE action,
+                                       void *arg, int *err);
+
+/**
+ * @brief Wait for a submitted task to complete.
+ *
+ * Blocks until the task attached to the future has completed or been
+ * cancelled. If the future is already ready, the function returns
+ * immediately.
+ *
+ * Possible error codes:
+ *      EINVAL: future is NULL
+ *
+ * @param future The future to wait on.
+ * @return int 0 on success, non-zero on failure.
+ */
+int future_wait(threadpool_future_t *future);
+
+/**
+ * @brief Wait for a submitted task to complete.
+ *
+ * Blocks until the task attached to the future has completed or been
+ * cancelled, or the given timeout has elapsed.
+ *
+ * Possible error codes:
+ *      EINVAL: future is NULL or timeout is negative
+ *      ETIMEDOUT: The given timeout elapses
+ *
+ * @param future The future to wait on.
+ * @param timeout The number of seconds to wait.
+ * @return int 0 on success, non-zero on failure.
+ */
+int future_timed_wait(threadpool_future_t *future, time_t timeout);
+
+/**
+ * @brief Check whether a submitted task has completed.
+ *
+ * Non-blocking; returns true once the task has completed or been
+ * cancelled. Returns false if future is NULL.
+ *
+ * @param future The future to check.
+ * @return bool true if the future is ready.
+ */
+bool future_ready(threadpool_future_t *future);
+
+/**
+ * @brief Get the result of a submitted task.
+ *
+ * Blocks until the task attached to the future has completed, then stores
+ * the routine's return value in result. The result argument may be NULL if
+ * the return value is not needed.
+ *
+ * Possible error codes:
+ *      EINVAL: future is NULL
+ *      ECANCELED: the task was discarded before running
+ *
+ * @param future The future to get the result of.
+ * @param result Where to store the routine's return value.
+ * @return int 0 on success, non-zero on failure.
+ */
+int future_get(threadpool_future_t *future, int *result);
+
+/**
+ * @brief Destroy a future.
+ *
+ * Releases the resources held by the future. The future must be ready
+ * before it can be destroyed, since the threadpool still holds a reference
+ * to a pending future; wait on it first, or check with future_ready.
+ *
+ * Possible error codes:
+ *      EINVAL: future is NULL
+ *      EBUSY: the task attached to the future has not completed
+ *
+ * @param future The future to destroy.
+ * @return int 0 on success, non-zero on failure.
+ */
+int future_destroy(threadpool_future_t *future);
+
+/**
+ * @brief Run a loop body over an index range in parallel.
+ *
+ * The range [start, end) is split into sub-ranges of at most grain
+ * iterations, each queued as an ordinary task, and the function blocks
+ * until the whole range has been processed. The calling thread works on
+ * sub-ranges itself rather than idling, and any sub-range that cannot be
+ * queued is run inline, so the whole range is always attempted. If grain
+ * is 0, an adaptive grain is chosen that creates several sub-ranges per
+ * worker thread, letting idle workers pick up the slack when iteration
+ * costs are skewed; in work-stealing mode the sub-ranges additionally
+ * rebalance through deque steals.
+ *
+ * An empty range (start >= end) returns 0 without calling the body.
+ *
+ * Possible error codes:
+ *      EINVAL: pool or body is NULL
+ *      ENOMEM: memory allocation failed
+ *      ECANCELED: the threadpool was destroyed while the loop was running
+ *      any non-zero value returned by the body (first one encountered)
+ *
+ * @param pool The threadpool to run the loop on.
+ * @param start The first index of the range.
+ * @param end One past the last index of the range.
+ * @param grain Maximum iterations per sub-range, or 0 for adaptive.
+ * @param body The loop body to run on each sub-range.
+ * @param arg The shared context passed to every body call.
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_parallel_for(threadpool_t *pool, size_t start, size_t end,
+                            size_t grain, RANGE_ROUTINE body, void *arg);
+
 /**
  * @brief Lock an idle or stopped thread in the threadpool.
  *
@@ -1,7 +1,9 @@
 #ifndef WEIGHTED_GRAPH_H
 #define WEIGHTED_GRAPH_H
 
+#include "hash_table.h"
 #include "linked_list.h"
+#include "threadpool.h"
 #include <unistd.h>
 
 /* DATA */
@@ -37,6 +39,28 @@ typedef int (*CMP_F)(const void *value_to_find, const void *node_data);
  */
 typedef int (*ACT_F)(void **node_data, void *addl_data);
 
+/**
+ * @brief A user-defined function called for each node reached by a
+ *        breadth-first traversal.
+ *
+ * The depth is the number of edges on the shortest (unweighted) route from
+ * the start node. The addl_data pointer can be used to pass in any additional
+ * data that the user may need. If the function returns non-zero, then the
+ * traversal will stop and return the error code.
+ */
+typedef int (*BFS_F)(void *node_data, size_t depth, void *addl_data);
+
+/**
+ * @brief A user-defined function called for each node reached by a
+ *        single-source shortest path computation.
+ *
+ * The distance is the summed weight of the cheapest route from the start
+ * node. The addl_data pointer can be used to pass in any additional data
+ * that the user may need. If the function returns non-zero, then the
+ * traversal will stop and return the error code.
+ */
+typedef int (*SSSP_F)(void *node_data, double distance, void *addl_data);
+
 typedef struct weighted_graph_t weighted_graph_t;
 
 /* FUNCTIONS */
@@ -46,6 +70,11 @@ typedef struct weighted_graph_t weighted_graph_t;
  *
  * If free_f is NULL, then data stored in the queue will not be free'd.
  *
+ * Node data is treated as fully opaque and is never dereferenced: the
+ * internal node index hashes pointer identity and falls back to the
+ * compare function when a lookup uses a different-but-equal pointer.
+ * Graphs that want content hashing should use graph_create_hash.
+ *
  * On error, the function will return NULL. Possible error codes are:
  * - EINVAL: compare function is NULL
  * - ENOMEM: memory allocation failed
@@ -57,6 +86,58 @@ typedef struct weighted_graph_t weighted_graph_t;
  */
 weighted_graph_t *graph_create(CMP_F cmp, FREE_F free_f, int *err);
 
+/**
+ * @brief Create a weighted graph with a custom node hash.
+ *
+ * Identical to graph_create, except the internal node index hashes the
+ * content of the node data instead of its identity, so equal data always
+ * resolves in O(1) regardless of which pointer the caller holds. By
+ * default the data is hashed as a NUL-terminated string, so graphs keyed
+ * by binary structs must supply a hash function (or a key_len bounding
+ * the bytes to hash). See hash_table_init_hash for the hash contract.
+ *
+ * On error, the function will return NULL. Possible error codes are:
+ * - EINVAL: compare function is NULL
+ * - ENOMEM: memory allocation failed
+ *
+ * @param compare pointer to user defined compare function
+ * @param free_f pointer to a function to free graph data
+ * @param hash_f pointer to a user defined hash function, or NULL
+ * @param key_len bytes of the data to hash, or 0 for string data
+ * @param err pointer to an integer to store the error code
+ * @return A pointer to a weighted graph.
+ */
+weighted_graph_t *graph_create_hash(CMP_F cmp, FREE_F free_f, HASH_F hash_f,
+                                    size_t key_len, int *err);
+
+/**
+ * @brief Create a weighted graph with a custom memory allocator.
+ *
+ * Identical to graph_create_hash, except that the graph struct, its node
+ * index, its node and edge objects, and any CSR snapshot are allocated
+ * through the given allocator. Path lists returned by the query functions
+ * share the allocator as well. A request-scoped arena can therefore
+ * discard the whole graph by resetting the arena, though graph_destroy
+ * must still be called when the stored data has a free function. If
+ * allocator is NULL, the standard heap is used, matching
+ * graph_create_hash.
+ *
+ * On error, the function will return NULL. Possible error codes are:
+ * - EINVAL: compare function is NULL
+ * - ENOMEM: memory allocation failed
+ *
+ * @param compare pointer to user defined compare function
+ * @param free_f pointer to a function to free graph data
+ * @param hash_f pointer to a user defined hash function, or NULL
+ * @param key_len bytes of the data to hash, or 0 for string data
+ * @param allocator memory allocator for the graph internals, or NULL
+ * @param err pointer to an integer to store the error code
+ * @return A pointer to a weighted graph.
+ */
+weighted_graph_t *graph_create_alloc(CMP_F cmp, FREE_F free_f, HASH_F hash_f,
+                                     size_t key_len,
+                                     const allocator_t *allocator, int *err);
+
 /**
  * @brief Return the number of nodes in the graph.
  *
@@ -76,6 +157,7 @@ ssize_t graph_size(const weighted_graph_t *graph);
  * Possible error codes are:
  * - EINVAL: graph or data are NULL
  * - ENOMEM: memory allocation failed
+ * - EBUSY: graph is frozen
  *
  * @param graph pointer to a weighted graph
  * @param data pointer to data to be added to the graph
@@ -92,6 +174,7 @@ int graph_add_node(weighted_graph_t *graph, void *data);
  * Possible error codes are:
  * - EINVAL: graph or data are NULL
  * - ENOENT: data is not in the graph
+ * - EBUSY: graph is frozen
  *
  * @param graph pointer to a weighted graph
  * @param data pointer to data to be removed from the graph
@@ -100,6 +183,41 @@ int graph_add_node(weighted_graph_t *graph, void *data);
  */
 void *graph_remove_node(weighted_graph_t *graph, void *data, int *err);
 
+/**
+ * @brief Freeze the graph into a read-optimized snapshot.
+ *
+ * The current nodes and edges are packed into contiguous arrays
+ * (compressed sparse row form) and the query functions run against that
+ * layout until the graph is unfrozen. Build the graph first, then freeze
+ * it when the topology is settled and queries dominate; traversals over a
+ * frozen graph read sequential memory instead of chasing list nodes.
+ *
+ * While frozen, functions that change the topology return EBUSY. Freezing
+ * an already frozen graph has no effect.
+ *
+ * Possible error codes are:
+ * - EINVAL: graph is NULL
+ * - ENOMEM: memory allocation failed
+ *
+ * @param graph pointer to a weighted graph
+ * @return 0 on success, non-zero on failure
+ */
+int graph_freeze(weighted_graph_t *graph);
+
+/**
+ * @brief Return a frozen graph to its mutable form.
+ *
+ * The snapshot is released and all functions operate on the linked
+ * structures again. Unfreezing a graph that is not frozen has no effect.
+ *
+ * Possible error codes are:
+ * - EINVAL: graph is NULL
+ *
+ * @param graph pointer to a weighted graph
+ * @return 0 on success, non-zero on failure
+ */
+int graph_unfreeze(weighted_graph_t *graph);
+
 /**
  * @brief Iterate over all nodes in the graph.
  *
@@ -164,6 +282,86 @@ int graph_iterate_neighbors(weighted_graph_t *graph, void *center, ACT_F func,
 list_t *graph_find_path(weighted_graph_t *graph, const void *start,
                         const void *end, int *err);
 
+/**
+ * @brief Find the shortest path between 2 nodes and report its cost.
+ *
+ * Identical to graph_find_path, except the summed weight of the returned
+ * path is additionally stored in *cost. If no path exists, then the
+ * function will return an empty list and *cost will be INFINITY. The cost
+ * pointer may be NULL when the cost is not needed.
+ *
+ * If an error occurs, then the function will return NULL.
+ * Possible error codes are:
+ * - EINVAL: graph, start, or end are NULL
+ * - ENOENT: start or end are not in the graph
+ * - ENOMEM: memory allocation failed
+ *
+ * @param graph pointer to a weighted graph
+ * @param start pointer to the start node
+ * @param end pointer to the end node
+ * @param cost pointer to a double to store the path cost
+ * @param err pointer to an integer to store the error code
+ * @return list_t* a list of nodes representing the shortest path, NULL on error
+ */
+list_t *graph_find_path_cost(weighted_graph_t *graph, const void *start,
+                             const void *end, double *cost, int *err);
+
+/**
+ * @brief Breadth-first traversal of a frozen graph on a thread pool.
+ *
+ * The frontier of each level is expanded in parallel across the workers of
+ * the given pool, so large graphs are traversed at memory bandwidth rather
+ * than one node at a time. The graph must be frozen with graph_freeze before
+ * calling; the traversal reads the packed snapshot and never modifies the
+ * graph. After the traversal completes, visit is called once for each node
+ * reachable from start (including start itself at depth 0), from a single
+ * thread. Unreachable nodes are not visited. If visit returns non-zero, then
+ * the iteration will stop and return that code.
+ *
+ * Possible error codes are:
+ * - EINVAL: graph, start, pool, or visit are NULL
+ * - ENOTSUP: the graph is not frozen
+ * - ENOENT: start is not in the graph
+ * - ENOMEM: memory allocation failed
+ *
+ * @param graph pointer to a frozen weighted graph
+ * @param start pointer to the start node
+ * @param pool pointer to the thread pool to run on
+ * @param visit pointer to a function to be called on each reached node
+ * @param obj pointer to additional data to be passed to visit
+ * @return 0 on success, non-zero on failure or if visit returns non-zero
+ */
+int graph_bfs_parallel(weighted_graph_t *graph, const void *start,
+                       threadpool_t *pool, BFS_F visit, void *obj);
+
+/**
+ * @brief Single-source shortest paths over a frozen graph on a thread pool.
+ *
+ * Computes the cheapest weighted distance from start to every reachable node
+ * by relaxing the edges of each frontier in parallel across the workers of
+ * the given pool. Unlike graph_find_path_cost, which answers one query, this
+ * produces distances for the whole graph in one pass. The graph must be
+ * frozen with graph_freeze before calling. After the distances converge,
+ * visit is called once for each reachable node (including start itself at
+ * distance 0) from a single thread. Unreachable nodes are not visited. If
+ * visit returns non-zero, then the iteration will stop and return that code.
+ *
+ * Possible error codes are:
+ * - EINVAL: graph, start, pool, or visit are NULL
+ * - ENOTSUP: the graph is not frozen
+ * - ENOENT: start is not in the graph
+ * - ENOMEM: memory allocation failed
+ *
+ * @param graph pointer to a frozen weighted graph
+ * @param start pointer to the start node
+ * @param pool pointer to the thread pool to run on
+ * @param visit pointer to a function to be called on each reached node
+ * @param obj pointer to additional data to be passed to visit
+ * @return 0 on success, non-zero on failure or if visit returns non-zero
+ */
+int graph_sssp_parallel(weighted_graph_t *graph, const void *start,
+                        threadpool_t *pool, SSSP_F visit, void *obj);
+
 /**
  * @brief Check if the graph contains a node.
  *
@@ -186,6 +384,7 @@ int graph_contains(const weighted_graph_t *graph, const void *data);
  * - EINVAL: graph, src, or dst are NULL
  * - ENOENT: src or dst are not in the graph
  * - ENOMEM: memory allocation failed
+ * - EBUSY: graph is frozen
  *
  * @param graph pointer to a weighted graph
  * @param src pointer to the source node
@@ -224,6 +423,7 @@ double graph_get_edge_weight(const weighted_graph_t *graph, const void *src,
  * Possible error codes are:
  * - EINVAL: graph, src, or dst are NULL
  * - ENOENT: src or dst are not in the graph, or src not pointing to dst
+ * - EBUSY: graph is frozen
  *
  * @param graph pointer to a weighted graph
  * @param src pointer to the source node
@@ -2,6 +2,7 @@
 #define THREADPOOL_ATTRIBUTES_H
 
 #include "threadpool_types.h"
+#include <stdint.h>
 #include <time.h>
 
 /* DATA */
@@ -10,6 +11,9 @@
 #define MAX_THREADS 64    // maximum number of threads
 #define DEFAULT_QUEUE 16  // default queue size
 #define DEFAULT_WAIT 10   // default wait time for blocking calls (in seconds)
+#define DEFAULT_MIN_THREADS 0  // default worker floor for idle scale-down
+#define DEFAULT_IDLE_TIMEOUT 0 // by default idle workers never exit
+#define DEFAULT_CPU_MASK 0     // by default workers may use every online CPU
 
 /* attribute flags */
 
@@ -31,6 +35,21 @@ enum thread_creation_flags {
     THREAD_CREATE_LAZY,   // operations continue if threads cannot be created
 };
 
+enum work_steal_flags {
+    WORK_STEAL_DISABLED, // all workers share one task queue
+    WORK_STEAL_ENABLED,  // each worker owns a deque, idle workers steal
+};
+
+enum task_priority_flags {
+    TASK_PRIORITY_DISABLED, // tasks run in submission order
+    TASK_PRIORITY_ENABLED,  // higher priority tasks run first
+};
+
+enum affinity_flags {
+    AFFINITY_DISABLED, // workers may migrate between CPUs
+    AFFINITY_ENABLED,  // each worker is pinned to one CPU
+};
+
 /**
  * @brief Initialize a threadpool attribute object.
  *
@@ -213,6 +232,201 @@ int threadpool_attr_set_thread_creation(threadpool_attr_t *attr,
  */
 int threadpool_attr_get_thread_creation(threadpool_attr_t *attr,
                                         int *thread_creation);
+
+/**
+ * @brief Set the work stealing flag for the threadpool attribute object.
+ *
+ * The work stealing flag will be set to either WORK_STEAL_DISABLED or
+ * WORK_STEAL_ENABLED. If enabled, each worker thread owns a local task
+ * deque: added work is spread round-robin over the deques and an idle
+ * worker steals the oldest task from another worker's deque, so
+ * fine-grained tasks do not all contend on one shared queue lock. The
+ * deques are unbounded, so the queue size attribute and the block on
+ * add flag do not apply to work added in this mode.
+ *
+ * Possible return values:
+ * - EINVAL: attr is NULL, or work_steal is not WORK_STEAL_DISABLED or
+ *   WORK_STEAL_ENABLED
+ *
+ * @param attr pointer to threadpool_attr_t
+ * @param work_steal WORK_STEAL_DISABLED or WORK_STEAL_ENABLED
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_attr_set_work_steal(threadpool_attr_t *attr, int work_steal);
+
+/**
+ * @brief Get the work stealing flag for the threadpool attribute object.
+ *
+ * The work stealing flag will be returned in work_steal. If attr or
+ * work_steal are NULL, the function will return EINVAL.
+ *
+ * @param attr pointer to threadpool_attr_t
+ * @param work_steal pointer to hold the value of the flag
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_attr_get_work_steal(threadpool_attr_t *attr, int *work_steal);
+
+/**
+ * @brief Set the task priority flag for the threadpool attribute object.
+ *
+ * The task priority flag will be set to either TASK_PRIORITY_DISABLED or
+ * TASK_PRIORITY_ENABLED. If enabled, the pool's task queue is ordered by
+ * priority instead of submission order: work added with
+ * threadpool_add_work_pri() with a higher priority is executed sooner, and
+ * work added without a priority runs at the default priority. Tasks with
+ * equal priority keep their submission order. Task priorities cannot be
+ * combined with work stealing; threadpool_create() will fail with EINVAL
+ * if both flags are enabled.
+ *
+ * Possible return values:
+ * - EINVAL: attr is NULL, or task_priority is not TASK_PRIORITY_DISABLED
+ *   or TASK_PRIORITY_ENABLED
+ *
+ * @param attr pointer to threadpool_attr_t
+ * @param task_priority TASK_PRIORITY_DISABLED or TASK_PRIORITY_ENABLED
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_attr_set_task_priority(threadpool_attr_t *attr,
+                                      int task_priority);
+
+/**
+ * @brief Get the task priority flag for the threadpool attribute object.
+ *
+ * The task priority flag will be returned in task_priority. If attr or
+ * task_priority are NULL, the function will return EINVAL.
+ *
+ * @param attr pointer to threadpool_attr_t
+ * @param task_priority pointer to hold the value of the flag
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_attr_get_task_priority(threadpool_attr_t *attr,
+                                      int *task_priority);
+
+/**
+ * @brief Set the minimum number of threads for the threadpool attribute
+ *        object.
+ *
+ * The minimum number of threads will be set to the given value. This is
+ * the floor for idle scale-down: a worker that reaches the idle timeout
+ * only exits while the pool holds more than min_threads workers. It has
+ * no effect unless an idle timeout is also set with
+ * threadpool_attr_set_idle_timeout(). If attr is NULL or min_threads is
+ * greater than MAX_THREADS, the function will return EINVAL.
+ *
+ * @param attr pointer to threadpool_attr_t
+ * @param min_threads number of threads to keep alive when idle
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_attr_set_min_threads(threadpool_attr_t *attr,
+                                    size_t min_threads);
+
+/**
+ * @brief Get the minimum number of threads for the threadpool attribute
+ *        object.
+ *
+ * The minimum number of threads will be returned in min_threads. If attr or
+ * min_threads are NULL, the function will return EINVAL.
+ *
+ * @param attr pointer to threadpool_attr_t
+ * @param min_threads pointer to number of threads
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_attr_get_min_threads(threadpool_attr_t *attr,
+                                    size_t *min_threads);
+
+/**
+ * @brief Set the idle timeout for the threadpool attribute object.
+ *
+ * A worker that finds no work for timeout seconds exits instead of
+ * staying parked, releasing its stack until new work makes the pool grow
+ * again; the pool never drops below the minimum set with
+ * threadpool_attr_set_min_threads(). A timeout of 0 (the default)
+ * disables idle scale-down. The pool only grows back on demand when
+ * THREAD_CREATE_LAZY is set, so the idle timeout should be combined with
+ * lazy thread creation. If attr is NULL or timeout is negative, the
+ * function will return EINVAL.
+ *
+ * @param attr pointer to threadpool_attr_t
+ * @param timeout number of seconds a worker may sit idle before exiting
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_attr_set_idle_timeout(threadpool_attr_t *attr, time_t timeout);
+
+/**
+ * @brief Get the idle timeout for the threadpool attribute object.
+ *
+ * The idle timeout will be returned in timeout. If attr or timeout are
+ * NULL, the function will return EINVAL.
+ *
+ * @param attr pointer to threadpool_attr_t
+ * @param timeout pointer to number of seconds
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_attr_get_idle_timeout(threadpool_attr_t *attr, time_t *timeout);
+
+/**
+ * @brief Set the CPU affinity flag for the threadpool attribute object.
+ *
+ * The affinity flag will be set to either AFFINITY_DISABLED or
+ * AFFINITY_ENABLED. If enabled, each worker pins itself to a single CPU
+ * when it starts, spreading the workers round-robin over the allowed
+ * CPUs instead of letting the scheduler migrate them. The allowed CPUs
+ * default to every online CPU and can be restricted with
+ * threadpool_attr_set_affinity_mask(). Pinning pairs well with the work
+ * stealing flag: the per-worker deques then stay local to the CPU that
+ * consumes them.
+ *
+ * Possible return values:
+ * - EINVAL: attr is NULL, or affinity is not AFFINITY_DISABLED or
+ *   AFFINITY_ENABLED
+ *
+ * @param attr pointer to threadpool_attr_t
+ * @param affinity AFFINITY_DISABLED or AFFINITY_ENABLED
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_attr_set_affinity(threadpool_attr_t *attr, int affinity);
+
+/**
+ * @brief Get the CPU affinity flag for the threadpool attribute object.
+ *
+ * The affinity flag will be returned in affinity. If attr or affinity
+ * are NULL, the function will return EINVAL.
+ *
+ * @param attr pointer to threadpool_attr_t
+ * @param affinity pointer to hold the value of the flag
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_attr_get_affinity(threadpool_attr_t *attr, int *affinity);
+
+/**
+ * @brief Set the CPU mask for the threadpool attribute object.
+ *
+ * Bit N of the mask allows workers on CPU N, covering the first 64
+ * CPUs. A mask of 0 (the default) allows every online CPU. The mask is
+ * only used when the affinity flag is enabled; restricting it to the
+ * CPUs of one NUMA node keeps the workers and their task memory on that
+ * node. If attr is NULL, the function will return EINVAL.
+ *
+ * @param attr pointer to threadpool_attr_t
+ * @param cpu_mask bit mask of allowed CPUs, 0 for all
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_attr_set_affinity_mask(threadpool_attr_t *attr,
+                                      uint64_t cpu_mask);
+
+/**
+ * @brief Get the CPU mask for the threadpool attribute object.
+ *
+ * The CPU mask will be returned in cpu_mask. If attr or cpu_mask are
+ * NULL, the function will return EINVAL.
+ *
+ * @param attr pointer to threadpool_attr_t
+ * @param cpu_mask pointer to hold the mask
+ * @return int 0 on success, non-zero on failure.
+ */
+int threadpool_attr_get_affinity_mask(threadpool_attr_t *attr,
+                                      uint64_t *cpu_mask);
+
 /**
  * @brief Set the number of threads for the threadpool attribute object.
  *
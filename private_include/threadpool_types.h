@@ -3,7 +3,7 @@
 
 /* DATA */
 
-#define THREADPOOL_ATTR_SIZE 28
+#define THREADPOOL_ATTR_SIZE 64
 
 typedef union {
     char __size[THREADPOOL_ATTR_SIZE];
@@ -1,6 +1,7 @@
 #define _DEFAULT_SOURCE
 #include "array_list.h"
 #include "buildingblocks.h"
+#include "threadpool.h"
 #include <errno.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -12,6 +13,47 @@
 #define SUCCESS 0  // no error
 #define INVALID -1 // invalid input
 
+#define SORT_PARALLEL_MIN 1024 // below this size, serial qsort wins
+
+/**
+ * @brief One chunk of the list to be sorted by a pool thread.
+ *
+ * @param base The first element of the chunk.
+ * @param nmemb The number of elements in the chunk.
+ * @param mem_sz The size of each element.
+ * @param cmp The compare function to sort with.
+ */
+struct sort_task_t {
+    uint8_t *base;
+    size_t nmemb;
+    size_t mem_sz;
+    CMP_F cmp;
+};
+
+/**
+ * @brief Two adjacent sorted runs to be merged by a pool thread.
+ *
+ * Merges src[left, mid) and src[mid, right) into dst[left, right); indices
+ * are in elements.
+ *
+ * @param src The array holding the two sorted runs.
+ * @param dst The array the merged run is written to.
+ * @param left The first element of the first run.
+ * @param mid The first element of the second run.
+ * @param right One past the last element of the second run.
+ * @param mem_sz The size of each element.
+ * @param cmp The compare function to merge with.
+ */
+struct merge_task_t {
+    uint8_t *src;
+    uint8_t *dst;
+    size_t left;
+    size_t mid;
+    size_t right;
+    size_t mem_sz;
+    CMP_F cmp;
+};
+
 /**
  * @brief The array list structure.
  *
@@ -22,6 +64,8 @@
  * @param size The number of elements in the array.
  * @param mem_sz The size of each element.
  * @param capacity The capacity of the array.
+ * @param sorted Whether the list is sorted by its compare function.
+ * @param allocator The memory allocator for the list internals.
  */
 struct arr_list_t {
     void **wrap;
@@ -32,6 +76,8 @@ struct arr_list_t {
     size_t mem_sz;
     size_t capacity;
     size_t iter_pos;
+    bool sorted;
+    allocator_t allocator;
 };
 
 /* PRIVATE FUNCTIONS */
@@ -51,7 +97,12 @@ static int adjust_size(arr_list_t *list, size_t new_size) {
     if (list == NULL) {
         return EINVAL;
     }
-    void *new_array = reallocarray(list->array, new_size, list->mem_sz);
+    if (new_size > SIZE_MAX / list->mem_sz) {
+        return ENOMEM;
+    }
+    void *new_array =
+        mem_resize(&list->allocator, list->array,
+                   list->capacity * list->mem_sz, new_size * list->mem_sz);
     if (new_array == NULL) {
         return ENOMEM;
     }
@@ -109,23 +160,107 @@ static void *shift_back(arr_list_t *list, size_t position) {
     return dest;
 }
 
+/**
+ * @brief Find the first index whose element is not less than the given data.
+ *
+ * The list must be sorted in ascending order of cmp. If all elements are
+ * less than the data, the list size is returned.
+ *
+ * @param list The array list.
+ * @param data The data to search for.
+ * @param cmp The compare function to search with.
+ * @return size_t The first index not ordered before data.
+ */
+static size_t lower_bound(const arr_list_t *list, const void *data, CMP_F cmp) {
+    size_t low = 0;
+    size_t high = list->size;
+    while (low < high) {
+        size_t mid = low + ((high - low) / 2);
+        void *element = (uint8_t *)list->array + (mid * list->mem_sz);
+        if (cmp(data, element) > 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Threadpool routine that sorts one chunk of the list.
+ *
+ * @param arg The sort_task_t describing the chunk.
+ * @return int always 0.
+ */
+static int sort_chunk(void *arg) {
+    struct sort_task_t *task = arg;
+    qsort(task->base, task->nmemb, task->mem_sz, task->cmp);
+    return SUCCESS;
+}
+
+/**
+ * @brief Threadpool routine that merges two adjacent sorted runs.
+ *
+ * The merge is stable: on equal elements, the one from the left run is
+ * taken first.
+ *
+ * @param arg The merge_task_t describing the runs.
+ * @return int always 0.
+ */
+static int merge_runs(void *arg) {
+    struct merge_task_t *task = arg;
+    size_t mem_sz = task->mem_sz;
+    size_t a = task->left;
+    size_t b = task->mid;
+    size_t out = task->left;
+    while (a < task->mid && b < task->right) {
+        uint8_t *elem_a = task->src + (a * mem_sz);
+        uint8_t *elem_b = task->src + (b * mem_sz);
+        if (task->cmp(elem_a, elem_b) <= 0) {
+            memcpy(task->dst + (out * mem_sz), elem_a, mem_sz);
+            a++;
+        } else {
+            memcpy(task->dst + (out * mem_sz), elem_b, mem_sz);
+            b++;
+        }
+        out++;
+    }
+    if (a < task->mid) {
+        memcpy(task->dst + (out * mem_sz), task->src + (a * mem_sz),
+               (task->mid - a) * mem_sz);
+        out += task->mid - a;
+    }
+    if (b < task->right) {
+        memcpy(task->dst + (out * mem_sz), task->src + (b * mem_sz),
+               (task->right - b) * mem_sz);
+    }
+    return SUCCESS;
+}
+
 /* PUBLIC FUNCTIONS */
 
 arr_list_t *arr_list_new(FREE_F free_f, CMP_F cmp_f, size_t nmemb, size_t size,
                          int *err) {
-    if (nmemb == 0 || size == 0) {
+    return arr_list_new_alloc(free_f, cmp_f, nmemb, size, NULL, err);
+}
+
+arr_list_t *arr_list_new_alloc(FREE_F free_f, CMP_F cmp_f, size_t nmemb,
+                               size_t size, const allocator_t *allocator,
+                               int *err) {
+    if (nmemb == 0 || size == 0 || nmemb > SIZE_MAX / size) {
         set_err(err, EINVAL);
         return NULL;
     }
-    arr_list_t *list = malloc(sizeof(*list));
+    arr_list_t *list = mem_alloc(allocator, sizeof(*list));
     if (list == NULL) {
         set_err(err, ENOMEM);
         return NULL;
     }
+    list->allocator = allocator != NULL ? *allocator : (allocator_t){0};
     list->wrap = NULL;
-    list->array = calloc(nmemb, size);
+    list->array = mem_zalloc(&list->allocator, nmemb * size);
     if (list->array == NULL) {
-        free(list);
+        mem_free(allocator, list);
         set_err(err, ENOMEM);
         return NULL;
     }
@@ -135,6 +270,7 @@ arr_list_t *arr_list_new(FREE_F free_f, CMP_F cmp_f, size_t nmemb, size_t size,
     list->mem_sz = size;
     list->capacity = nmemb;
     list->iter_pos = 0;
+    list->sorted = true; // an empty list is trivially sorted
     return list;
 }
 
@@ -151,6 +287,7 @@ arr_list_t *arr_list_wrap(FREE_F free_f, CMP_F cmp_f, size_t nmemb, size_t size,
         set_err(err, ENOMEM);
         return NULL;
     }
+    list->allocator = (allocator_t){0};
     list->wrap = arr;
     if (*list->wrap == NULL) {
         *list->wrap = calloc(nmemb, size);
@@ -167,6 +304,7 @@ arr_list_t *arr_list_wrap(FREE_F free_f, CMP_F cmp_f, size_t nmemb, size_t size,
     list->mem_sz = size;
     list->capacity = nmemb;
     list->iter_pos = 0;
+    list->sorted = true; // an empty list is trivially sorted
     return list;
 }
 
@@ -187,6 +325,9 @@ int arr_list_query(const arr_list_t *list, int query, ssize_t *result) {
     case QUERY_IS_FULL:
         *result = list->size == list->capacity;
         break;
+    case QUERY_ELEM_SIZE:
+        *result = list->mem_sz;
+        break;
     default:
         return ENOTSUP;
     }
@@ -223,6 +364,49 @@ int arr_list_insert(arr_list_t *list, void *data, size_t position) {
     void *dest = shift_back(list, position);
     memcpy(dest, data, list->mem_sz);
     list->size++;
+    // a positional insert may break the sorted order
+    list->sorted = false;
+    return SUCCESS;
+}
+
+int arr_list_extend(arr_list_t *list, const void *data, size_t nmemb) {
+    if (list == NULL || (data == NULL && nmemb > 0)) {
+        return EINVAL;
+    } else if (nmemb == 0) {
+        return SUCCESS;
+    }
+    if (list->size + nmemb > list->capacity) {
+        // grow once for the whole batch
+        size_t new_capacity = list->capacity * 2;
+        if (new_capacity < list->size + nmemb) {
+            new_capacity = list->size + nmemb;
+        }
+        if (adjust_size(list, new_capacity) != SUCCESS) {
+            return ENOMEM;
+        }
+    }
+    memcpy((uint8_t *)list->array + (list->size * list->mem_sz), data,
+           nmemb * list->mem_sz);
+    list->size += nmemb;
+    // the appended batch may break the sorted order
+    list->sorted = false;
+    return SUCCESS;
+}
+
+int arr_list_splice(arr_list_t *dst, arr_list_t *src) {
+    if (dst == NULL || src == NULL || dst->mem_sz != src->mem_sz) {
+        return EINVAL;
+    } else if (src->size == 0) {
+        return SUCCESS;
+    }
+    int err = arr_list_extend(dst, src->array, src->size);
+    if (err != SUCCESS) {
+        return err;
+    }
+    // ownership moved to dst, so empty src without freeing the elements
+    memset(src->array, 0, src->size * src->mem_sz);
+    src->size = 0;
+    src->sorted = true;
     return SUCCESS;
 }
 
@@ -235,6 +419,8 @@ int arr_list_set(arr_list_t *list, void *data, size_t position, void *old) {
         memcpy(old, elem, list->mem_sz);
     }
     memcpy(elem, data, list->mem_sz);
+    // an overwrite may break the sorted order
+    list->sorted = false;
     return SUCCESS;
 }
 
@@ -258,6 +444,24 @@ int arr_list_pop(arr_list_t *list, size_t position, void *old) {
     return SUCCESS;
 }
 
+int arr_list_swap_remove(arr_list_t *list, size_t position, void *old) {
+    if (list == NULL || position >= list->size) {
+        return EINVAL;
+    }
+    void *element = (uint8_t *)list->array + (position * list->mem_sz);
+    if (old != NULL) {
+        memmove(old, element, list->mem_sz);
+    }
+    void *last = (uint8_t *)list->array + ((list->size - 1) * list->mem_sz);
+    if (element != last) {
+        memcpy(element, last, list->mem_sz);
+        // moving the last element may break the sorted order
+        list->sorted = false;
+    }
+    list->size--;
+    return SUCCESS;
+}
+
 int arr_list_remove(arr_list_t *list, void *item_to_remove) {
     if (list == NULL) {
         return EINVAL;
@@ -317,6 +521,34 @@ int arr_list_index_of(const arr_list_t *list, const void *data, ssize_t *idx) {
     }
     *idx = INVALID;
 
+    if (list->sorted) {
+        // sorted lists can skip the scan; lower_bound lands on the first
+        // occurrence, preserving the lowest-index contract
+        size_t pos = lower_bound(list, data, list->cmp_f);
+        if (pos < list->size) {
+            void *element = (uint8_t *)list->array + (pos * list->mem_sz);
+            if (list->cmp_f(data, element) == 0) {
+                *idx = pos;
+            }
+        }
+        return SUCCESS;
+    }
+
+    // the built-in integer comparators are recognized here so the scan
+    // runs vectorized over the backing array instead of calling the
+    // comparator once per element
+    if (list->cmp_f == cmp_u32 && list->mem_sz == sizeof(uint32_t)) {
+        uint32_t key;
+        memcpy(&key, data, sizeof(key));
+        *idx = scan_u32(list->array, list->size, key);
+        return SUCCESS;
+    } else if (list->cmp_f == cmp_u64 && list->mem_sz == sizeof(uint64_t)) {
+        uint64_t key;
+        memcpy(&key, data, sizeof(key));
+        *idx = scan_u64(list->array, list->size, key);
+        return SUCCESS;
+    }
+
     for (size_t i = 0; i < list->size; i++) {
         void *element = (uint8_t *)list->array + (i * list->mem_sz);
         if (list->cmp_f(data, element) == 0) {
@@ -327,6 +559,42 @@ int arr_list_index_of(const arr_list_t *list, const void *data, ssize_t *idx) {
     return SUCCESS;
 }
 
+int arr_list_bsearch(const arr_list_t *list, const void *data, ssize_t *idx) {
+    if (list == NULL || idx == NULL) {
+        return EINVAL;
+    } else if (list->cmp_f == NULL || !list->sorted) {
+        return ENOTSUP;
+    }
+    *idx = INVALID;
+
+    size_t pos = lower_bound(list, data, list->cmp_f);
+    if (pos < list->size) {
+        void *element = (uint8_t *)list->array + (pos * list->mem_sz);
+        if (list->cmp_f(data, element) == 0) {
+            *idx = pos;
+        }
+    }
+    return SUCCESS;
+}
+
+int arr_list_insert_sorted(arr_list_t *list, void *data) {
+    if (list == NULL) {
+        return EINVAL;
+    } else if (list->cmp_f == NULL || !list->sorted) {
+        return ENOTSUP;
+    }
+    if (list->size == list->capacity) {
+        if (adjust_size(list, list->capacity * 2) != SUCCESS) {
+            return ENOMEM;
+        }
+    }
+    size_t position = lower_bound(list, data, list->cmp_f);
+    void *dest = shift_back(list, position);
+    memcpy(dest, data, list->mem_sz);
+    list->size++;
+    return SUCCESS;
+}
+
 int arr_list_sort(arr_list_t *list) {
     if (list == NULL) {
         return EINVAL;
@@ -336,6 +604,148 @@ int arr_list_sort(arr_list_t *list) {
         return SUCCESS;
     }
     qsort(list->array, list->size, list->mem_sz, list->cmp_f);
+    list->sorted = true;
+    return SUCCESS;
+}
+
+int arr_list_sort_with(arr_list_t *list, CMP_F cmp, size_t n_threads) {
+    if (list == NULL) {
+        return EINVAL;
+    }
+    if (cmp == NULL) {
+        cmp = list->cmp_f;
+    }
+    if (cmp == NULL) {
+        return ENOTSUP;
+    }
+    if (list->size <= 1) {
+        return SUCCESS;
+    }
+    // an ad-hoc comparator leaves the list unsorted with respect to its own
+    list->sorted = cmp == list->cmp_f;
+    if (n_threads <= 1 || list->size < SORT_PARALLEL_MIN) {
+        qsort(list->array, list->size, list->mem_sz, cmp);
+        return SUCCESS;
+    }
+    if (n_threads > MAX_THREADS) {
+        n_threads = MAX_THREADS;
+    }
+
+    size_t nchunks = n_threads;
+    struct sort_task_t *sorts = malloc(nchunks * sizeof(*sorts));
+    struct merge_task_t *merges = malloc((nchunks / 2) * sizeof(*merges));
+    size_t *bounds = malloc((nchunks + 1) * sizeof(*bounds));
+    uint8_t *scratch = malloc(list->size * list->mem_sz);
+    threadpool_attr_t attr;
+    threadpool_attr_init(&attr);
+    threadpool_attr_set_thread_count(&attr, n_threads);
+    threadpool_attr_set_queue_size(&attr, n_threads);
+    threadpool_attr_set_block_on_add(&attr, BLOCK_ON_ADD_ENABLED);
+    // lazy creation is required for queued tasks to wake worker threads
+    threadpool_attr_set_thread_creation(&attr, THREAD_CREATE_LAZY);
+    threadpool_t *pool = threadpool_create(&attr, NULL);
+    threadpool_attr_destroy(&attr);
+    if (sorts == NULL || merges == NULL || bounds == NULL || scratch == NULL ||
+        pool == NULL) {
+        free(sorts);
+        free(merges);
+        free(bounds);
+        free(scratch);
+        if (pool == NULL) {
+            // no threads available, degrade to a serial sort
+            qsort(list->array, list->size, list->mem_sz, cmp);
+            return SUCCESS;
+        }
+        threadpool_destroy(pool, SHUTDOWN_GRACEFUL);
+        list->sorted = false;
+        return ENOMEM;
+    }
+
+    // sort each chunk concurrently
+    int err = SUCCESS;
+    for (size_t n = 0; n <= nchunks; ++n) {
+        bounds[n] = n * list->size / nchunks;
+    }
+    for (size_t n = 0; n < nchunks; ++n) {
+        sorts[n] = (struct sort_task_t){
+            .base = (uint8_t *)list->array + (bounds[n] * list->mem_sz),
+            .nmemb = bounds[n + 1] - bounds[n],
+            .mem_sz = list->mem_sz,
+            .cmp = cmp,
+        };
+        err = threadpool_add_work(pool, sort_chunk, &sorts[n]);
+        if (err != SUCCESS) {
+            goto cleanup;
+        }
+    }
+    err = threadpool_wait(pool);
+    if (err != SUCCESS) {
+        goto cleanup;
+    }
+
+    // merge pairs of adjacent runs until one run remains, ping-ponging
+    // between the backing array and the scratch buffer
+    uint8_t *cur = list->array;
+    uint8_t *next = scratch;
+    while (nchunks > 1) {
+        size_t new_n = 0;
+        size_t pairs = 0;
+        for (size_t n = 0; n + 1 < nchunks; n += 2) {
+            merges[pairs] = (struct merge_task_t){
+                .src = cur,
+                .dst = next,
+                .left = bounds[n],
+                .mid = bounds[n + 1],
+                .right = bounds[n + 2],
+                .mem_sz = list->mem_sz,
+                .cmp = cmp,
+            };
+            err = threadpool_add_work(pool, merge_runs, &merges[pairs]);
+            if (err != SUCCESS) {
+                goto cleanup;
+            }
+            pairs++;
+        }
+        if (nchunks % 2 != 0) {
+            // odd run out: carry it over to the other buffer untouched
+            size_t last = bounds[nchunks - 1];
+            memcpy(next + (last * list->mem_sz), cur + (last * list->mem_sz),
+                   (bounds[nchunks] - last) * list->mem_sz);
+        }
+        err = threadpool_wait(pool);
+        if (err != SUCCESS) {
+            goto cleanup;
+        }
+        // collapse the merged pair boundaries
+        for (size_t n = 0; n <= nchunks; n += 2) {
+            bounds[new_n++] = bounds[n];
+        }
+        if (nchunks % 2 != 0) {
+            bounds[new_n - 1] = bounds[nchunks - 1];
+            bounds[new_n] = bounds[nchunks];
+        } else {
+            new_n--;
+        }
+        nchunks = new_n;
+        uint8_t *tmp = cur;
+        cur = next;
+        next = tmp;
+    }
+    if (cur != list->array) {
+        memcpy(list->array, cur, list->size * list->mem_sz);
+    }
+
+cleanup:
+    threadpool_destroy(pool, SHUTDOWN_GRACEFUL);
+    free(sorts);
+    free(merges);
+    free(bounds);
+    free(scratch);
+    if (err != SUCCESS) {
+        // leave the caller with a correct result even on pool failure
+        qsort(list->array, list->size, list->mem_sz, cmp);
+        return SUCCESS;
+    }
     return SUCCESS;
 }
 
@@ -350,6 +760,7 @@ int arr_list_clear(arr_list_t *list) {
     }
     memset(list->array, 0, list->size * list->mem_sz);
     list->size = 0;
+    list->sorted = true;
     return SUCCESS;
 }
 
@@ -358,10 +769,12 @@ int arr_list_delete(arr_list_t *list) {
         return EINVAL;
     }
     // only clear list if its not wrapping something else
+    // copied out because the allocator lives inside the block being freed
+    allocator_t allocator = list->allocator;
     if (list->wrap == NULL) {
         arr_list_clear(list);
-        free(list->array);
+        mem_free(&allocator, list->array);
     }
-    free(list);
+    mem_free(&allocator, list);
     return SUCCESS;
 }
@@ -2,41 +2,97 @@
 #include "buildingblocks.h"
 #include "queue.h"
 #include <errno.h>
+#include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* DATA */
 
 #define SUCCESS 0  // no error
 #define INVALID -1 // invalid input
 
+// deepest possible path: an AVL tree holding every representable node is
+// still under 1.44 * 64 levels tall, so a fixed traversal stack is safe
+#define MAX_DEPTH 96
+
 /**
  * @brief structure of a node in the tree
  *
  * @param data void pointer to whatever data that node points to
  * @param left pointer to the node to the left of it
  * @param right pointer to the node to the right of it
+ * @param height height of the subtree rooted at this node, 1 for a leaf
  */
 struct node {
     void *data;
     struct node *left;
     struct node *right;
+    size_t height;
+};
+
+// nodes handed out per arena block; one malloc covers a full block so
+// neighboring nodes share cache lines instead of fragmenting the heap
+#define NODES_PER_BLOCK 256
+
+/**
+ * @brief a block of arena-allocated nodes
+ *
+ * @param next pointer to the previously allocated block
+ * @param nodes storage handed out sequentially until the block is full
+ */
+struct arena_block {
+    struct arena_block *next;
+    struct node nodes[NODES_PER_BLOCK];
+};
+
+// fanout of the high-fanout variant: the keys and child pointers of one
+// node fill a handful of consecutive cache lines, so a lookup costs a
+// few node visits instead of one miss per binary level
+#define BTREE_MAX_KEYS 15
+#define BTREE_MIN_KEYS (BTREE_MAX_KEYS / 2)
+
+/**
+ * @brief structure of a node in the high-fanout tree variant
+ *
+ * @param num_keys number of keys currently stored in the node
+ * @param leaf true if the node has no children
+ * @param keys the stored data, packed in sorted order
+ * @param children subtree pointers; children[i] orders before keys[i]
+ */
+struct bnode {
+    size_t num_keys;
+    bool leaf;
+    void *keys[BTREE_MAX_KEYS];
+    struct bnode *children[BTREE_MAX_KEYS + 1];
 };
 
 /**
  * @brief structure of a tree object
  *
  * @param root pointer to the root node
+ * @param broot pointer to the root node of the high-fanout variant
+ * @param high_fanout true if the tree was created with tree_new_btree()
  * @param iterator in order queue for iterator
  * @param size the number of nodes the tree is currently storing
  * @param customfree pointer to the user defined free function
  * @param compare_function pointer to the user defined compare function
+ * @param arena list of node blocks, newest first
+ * @param arena_used nodes handed out from the newest block
+ * @param free_nodes recycled nodes, linked through their right pointers
+ * @param allocator memory allocator for the tree internals
  */
 struct tree_t {
     struct node *root;
+    struct bnode *broot;
+    bool high_fanout;
     queue_t *iterator;
     size_t size;
     FREE_F free_func;
     CMP_F cmp_func;
+    struct arena_block *arena;
+    size_t arena_used;
+    struct node *free_nodes;
+    allocator_t allocator;
 };
 
 /* PRIVATE FUNCTIONS*/
@@ -57,36 +113,80 @@ struct tree_t {
 static struct node **tree_search(struct node **node, CMP_F cmp, void *needle) {
     if (node == NULL || cmp == NULL) {
         return NULL;
-    } else if (*node == NULL) {
-        return node;
-    }
-    int result = cmp(needle, (*node)->data);
-    if (result == 0) {
-        return node;
-    } else if (result < 0) {
-        return tree_search(&(*node)->left, cmp, needle);
-    } else {
-        return tree_search(&(*node)->right, cmp, needle);
     }
+    while (*node != NULL) {
+        int result = cmp(needle, (*node)->data);
+        if (result == 0) {
+            return node;
+        }
+        node = result < 0 ? &(*node)->left : &(*node)->right;
+    }
+    return node;
 }
 
 /**
- * @brief Create a new node.
+ * @brief Create a new node from the tree's arena.
  *
+ * Recycled nodes are reused first; otherwise the node comes from the
+ * newest block, with a fresh block allocated when that one is full.
+ *
+ * @param tree A pointer to the tree the node belongs to
  * @param data A pointer to the data to be stored in the node
  * @return struct node* A pointer to the new node
  */
-static struct node *create_node(void *data) {
-    struct node *node = malloc(sizeof(*node));
-    if (node == NULL) {
-        return NULL;
+static struct node *create_node(tree_t *tree, void *data) {
+    struct node *node;
+    if (tree->free_nodes != NULL) {
+        node = tree->free_nodes;
+        tree->free_nodes = node->right;
+    } else {
+        if (tree->arena == NULL || tree->arena_used == NODES_PER_BLOCK) {
+            struct arena_block *block =
+                mem_alloc(&tree->allocator, sizeof(*block));
+            if (block == NULL) {
+                return NULL;
+            }
+            block->next = tree->arena;
+            tree->arena = block;
+            tree->arena_used = 0;
+        }
+        node = &tree->arena->nodes[tree->arena_used++];
     }
     node->data = data;
     node->left = NULL;
     node->right = NULL;
+    node->height = 1;
     return node;
 }
 
+/**
+ * @brief Return a node to the tree's recycling list.
+ *
+ * @param tree A pointer to the tree the node belongs to
+ * @param node A pointer to the node to recycle
+ */
+static void recycle_node(tree_t *tree, struct node *node) {
+    node->right = tree->free_nodes;
+    tree->free_nodes = node;
+}
+
+/**
+ * @brief Release every arena block of the tree wholesale.
+ *
+ * @param tree A pointer to the tree to release
+ */
+static void free_arena(tree_t *tree) {
+    struct arena_block *block = tree->arena;
+    while (block != NULL) {
+        struct arena_block *next = block->next;
+        mem_free(&tree->allocator, block);
+        block = next;
+    }
+    tree->arena = NULL;
+    tree->arena_used = 0;
+    tree->free_nodes = NULL;
+}
+
 /**
  * @brief Get the height of the tree.
  *
@@ -94,14 +194,18 @@ static struct node *create_node(void *data) {
  * @return size_t The height of the tree
  */
 static size_t tree_height(const struct node *node) {
-    if (node == NULL) {
-        return 0;
-    }
-
-    size_t left = node->left ? tree_height(node->left) : 0;
-    size_t right = node->right ? tree_height(node->right) : 0;
+    return node == NULL ? 0 : node->height;
+}
 
-    return 1 + (left > right ? left : right);
+/**
+ * @brief Recompute a node's stored height from its children.
+ *
+ * @param node A pointer to the current node
+ */
+static void update_height(struct node *node) {
+    size_t left = tree_height(node->left);
+    size_t right = tree_height(node->right);
+    node->height = 1 + (left > right ? left : right);
 }
 
 /**
@@ -114,7 +218,7 @@ static int balance_factor(struct node *node) {
     if (node == NULL) {
         return -1;
     }
-    return tree_height(node->left) - tree_height(node->right);
+    return (int)tree_height(node->left) - (int)tree_height(node->right);
 }
 
 /**
@@ -145,25 +249,6 @@ static inline int left_heavy(int balance) { return balance > 0; }
  */
 static inline int right_heavy(int balance) { return balance < 0; }
 
-/**
- * @brief Get the maximum value in the tree.
- *
- * If node is NULL, the function returns NULL.
- *
- * @param node A pointer to the current node
- * @return struct node** A pointer to the node containing the maximum
- * value, or NULL.
- */
-static struct node **tree_max(struct node **node) {
-    if (node == NULL) {
-        return NULL;
-    } else if ((*node)->right) {
-        return tree_max(&(*node)->right);
-    } else {
-        return node;
-    }
-}
-
 /**
  * @brief Rotate the tree to the left.
  *
@@ -178,6 +263,8 @@ static void rotate_left(struct node **node) {
     (*node)->right = new_root->left;
     new_root->left = *node;
     *node = new_root;
+    update_height(new_root->left);
+    update_height(new_root);
 }
 
 /**
@@ -194,6 +281,8 @@ static void rotate_right(struct node **node) {
     (*node)->left = new_root->right;
     new_root->right = *node;
     *node = new_root;
+    update_height(new_root->right);
+    update_height(new_root);
 }
 
 /**
@@ -206,6 +295,7 @@ static void balance_tree(struct node **node) {
         return;
     }
 
+    update_height(*node); // children may have changed since the last pass
     int balance = balance_factor(*node);
     if (balanced(balance)) {
         // tree is balanced
@@ -233,6 +323,9 @@ static void balance_tree(struct node **node) {
 /**
  * @brief Insert a new node into the tree.
  *
+ * The insertion point is found iteratively, recording the path so the walk
+ * back up only touches the nodes between the new leaf and the root.
+ *
  * @param node A pointer to the current node
  * @param new A pointer to the new node to be inserted
  * @param cmp A pointer to the user-defined compare function
@@ -240,20 +333,23 @@ static void balance_tree(struct node **node) {
 static void insert_node(struct node **node, struct node *new, CMP_F cmp) {
     if (node == NULL || new == NULL || cmp == NULL) {
         return;
-    } else if (*node == NULL) {
-        *node = new;
-        return;
     }
-
-    int result = cmp(new->data, (*node)->data);
-    if (result < 0) {
-        // new node is less than current node
-        insert_node(&(*node)->left, new, cmp);
-    } else {
-        // new node is greater than or equal to current node
-        insert_node(&(*node)->right, new, cmp);
+    struct node **path[MAX_DEPTH];
+    size_t depth = 0;
+    while (*node != NULL) {
+        path[depth++] = node;
+        if (cmp(new->data, (*node)->data) < 0) {
+            // new node is less than current node
+            node = &(*node)->left;
+        } else {
+            // new node is greater than or equal to current node
+            node = &(*node)->right;
+        }
+    }
+    *node = new;
+    while (depth > 0) {
+        balance_tree(path[--depth]);
     }
-    balance_tree(node);
 }
 
 static int tree_in_order(struct node *node, ACT_F func, void *addl_data) {
@@ -277,6 +373,49 @@ static int tree_in_order(struct node *node, ACT_F func, void *addl_data) {
     return SUCCESS;
 }
 
+/**
+ * @brief Traverse only the nodes whose data falls within [lo, hi].
+ *
+ * Subtrees that cannot contain in-range data are pruned at their root, so
+ * the walk touches the two boundary paths plus the matching nodes only.
+ *
+ * @param node A pointer to the current node
+ * @param cmp A pointer to the user-defined compare function
+ * @param lo A pointer to the lower bound, inclusive
+ * @param hi A pointer to the upper bound, inclusive
+ * @param func A pointer to the action function
+ * @param addl_data A pointer to additional data passed to the action function
+ * @return int The first non-zero action result, or 0
+ */
+static int tree_range_nodes(struct node *node, CMP_F cmp, void *lo, void *hi,
+                            ACT_F func, void *addl_data) {
+    if (node == NULL) {
+        return SUCCESS;
+    }
+
+    int result;
+    int above_lo = cmp(lo, node->data) <= 0;
+    int below_hi = cmp(hi, node->data) >= 0;
+    if (above_lo) {
+        // smaller in-range data may exist on the left
+        result = tree_range_nodes(node->left, cmp, lo, hi, func, addl_data);
+        if (result != SUCCESS) {
+            return result;
+        }
+    }
+    if (above_lo && below_hi) {
+        result = func(node->data, addl_data);
+        if (result != SUCCESS) {
+            return result;
+        }
+    }
+    if (below_hi) {
+        // larger in-range data may exist on the right
+        return tree_range_nodes(node->right, cmp, lo, hi, func, addl_data);
+    }
+    return SUCCESS;
+}
+
 /**
  * @brief Add each node to the tree.
  *
@@ -314,12 +453,13 @@ static int build_iter(void *node_data, void *addl_data) {
 }
 
 /**
- * @brief Traverse the tree in post-order to remove nodes.
+ * @brief Traverse the tree in post-order to release node data.
+ *
+ * The nodes themselves live in the arena and are released wholesale
+ * afterwards; only the stored data needs a per-node visit.
  *
  * @param node A pointer to the current node
  * @param free_func A pointer to the user-defined free function
- * @param addl_data A pointer to additional data to be passed to the action
- * function
  */
 static void clear_nodes(struct node *node, FREE_F free_func) {
     if (node == NULL) {
@@ -331,26 +471,553 @@ static void clear_nodes(struct node *node, FREE_F free_func) {
     if (free_func != NULL) {
         free_func(node->data);
     }
-    free(node);
+}
+
+/* PRIVATE FUNCTIONS - HIGH-FANOUT VARIANT */
+
+/**
+ * @brief Create a new node for the high-fanout tree.
+ *
+ * @param allocator A pointer to the tree's allocator
+ * @param leaf true if the node will have no children
+ * @return struct bnode* A pointer to the new node or NULL on failure
+ */
+static struct bnode *bnode_new(const allocator_t *allocator, bool leaf) {
+    struct bnode *node = mem_alloc(allocator, sizeof(*node));
+    if (node == NULL) {
+        return NULL;
+    }
+    node->num_keys = 0;
+    node->leaf = leaf;
+    return node;
+}
+
+/**
+ * @brief Find the first key in the node that orders at or after the data.
+ *
+ * @param node A pointer to the current node
+ * @param cmp A pointer to the user-defined compare function
+ * @param data A pointer to the data to be compared against
+ * @return size_t The index of the first such key, or num_keys
+ */
+static size_t bnode_lower_bound(const struct bnode *node, CMP_F cmp,
+                                void *data) {
+    size_t i = 0;
+    while (i < node->num_keys && cmp(data, node->keys[i]) > 0) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Find the child slot the data should descend into on insertion.
+ *
+ * Equal data goes right, matching the binary variant.
+ *
+ * @param node A pointer to the current node
+ * @param cmp A pointer to the user-defined compare function
+ * @param data A pointer to the data to be inserted
+ * @return size_t The index of the child to descend into
+ */
+static size_t bnode_upper_bound(const struct bnode *node, CMP_F cmp,
+                                void *data) {
+    size_t i = 0;
+    while (i < node->num_keys && cmp(data, node->keys[i]) >= 0) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Search the high-fanout tree for matching data.
+ *
+ * @param node A pointer to the root of the subtree to search
+ * @param cmp A pointer to the user-defined compare function
+ * @param data A pointer to the data to be searched for
+ * @param found An optional pointer that receives the matched data
+ * @return bool true if a match was found
+ */
+static bool btree_search(struct bnode *node, CMP_F cmp, void *data,
+                         void **found) {
+    while (node != NULL) {
+        size_t i = bnode_lower_bound(node, cmp, data);
+        if (i < node->num_keys && cmp(data, node->keys[i]) == 0) {
+            if (found != NULL) {
+                *found = node->keys[i];
+            }
+            return true;
+        }
+        node = node->leaf ? NULL : node->children[i];
+    }
+    return false;
+}
+
+/**
+ * @brief Split the full child of a non-full parent around its median key.
+ *
+ * @param allocator A pointer to the tree's allocator
+ * @param parent A pointer to the parent node
+ * @param i The index of the full child
+ * @return int 0 on success, non-zero on failure
+ */
+static int btree_split_child(const allocator_t *allocator,
+                             struct bnode *parent, size_t i) {
+    struct bnode *child = parent->children[i];
+    struct bnode *right = bnode_new(allocator, child->leaf);
+    if (right == NULL) {
+        return ENOMEM;
+    }
+    right->num_keys = BTREE_MIN_KEYS;
+    memcpy(&right->keys[0], &child->keys[BTREE_MIN_KEYS + 1],
+           BTREE_MIN_KEYS * sizeof(void *));
+    if (!child->leaf) {
+        memcpy(&right->children[0], &child->children[BTREE_MIN_KEYS + 1],
+               (BTREE_MIN_KEYS + 1) * sizeof(struct bnode *));
+    }
+    child->num_keys = BTREE_MIN_KEYS;
+    memmove(&parent->keys[i + 1], &parent->keys[i],
+            (parent->num_keys - i) * sizeof(void *));
+    memmove(&parent->children[i + 2], &parent->children[i + 1],
+            (parent->num_keys - i) * sizeof(struct bnode *));
+    parent->keys[i] = child->keys[BTREE_MIN_KEYS];
+    parent->children[i + 1] = right;
+    parent->num_keys++;
+    return SUCCESS;
+}
+
+/**
+ * @brief Insert data into the high-fanout tree.
+ *
+ * Full nodes are split on the way down, so the insertion point is always
+ * a non-full leaf and no path has to be walked back up.
+ *
+ * @param tree A pointer to the tree
+ * @param data A pointer to the data to be inserted
+ * @return int 0 on success, non-zero on failure
+ */
+static int btree_insert(tree_t *tree, void *data) {
+    if (tree->broot == NULL) {
+        tree->broot = bnode_new(&tree->allocator, true);
+        if (tree->broot == NULL) {
+            return ENOMEM;
+        }
+        tree->broot->keys[0] = data;
+        tree->broot->num_keys = 1;
+        return SUCCESS;
+    }
+    if (tree->broot->num_keys == BTREE_MAX_KEYS) {
+        struct bnode *root = bnode_new(&tree->allocator, false);
+        if (root == NULL) {
+            return ENOMEM;
+        }
+        root->children[0] = tree->broot;
+        int err = btree_split_child(&tree->allocator, root, 0);
+        if (err != SUCCESS) {
+            mem_free(&tree->allocator, root);
+            return err;
+        }
+        tree->broot = root;
+    }
+    struct bnode *node = tree->broot;
+    while (!node->leaf) {
+        size_t i = bnode_upper_bound(node, tree->cmp_func, data);
+        if (node->children[i]->num_keys == BTREE_MAX_KEYS) {
+            int err = btree_split_child(&tree->allocator, node, i);
+            if (err != SUCCESS) {
+                return err;
+            }
+            if (tree->cmp_func(data, node->keys[i]) >= 0) {
+                i++;
+            }
+        }
+        node = node->children[i];
+    }
+    size_t i = node->num_keys;
+    while (i > 0 && tree->cmp_func(data, node->keys[i - 1]) < 0) {
+        node->keys[i] = node->keys[i - 1];
+        i--;
+    }
+    node->keys[i] = data;
+    node->num_keys++;
+    return SUCCESS;
+}
+
+/**
+ * @brief Merge the key at index i and the child to its right into the
+ * child to its left.
+ *
+ * Both children must hold the minimum number of keys.
+ *
+ * @param allocator A pointer to the tree's allocator
+ * @param node A pointer to the parent node
+ * @param i The index of the key to merge around
+ */
+static void btree_merge(const allocator_t *allocator, struct bnode *node,
+                        size_t i) {
+    struct bnode *child = node->children[i];
+    struct bnode *right = node->children[i + 1];
+    child->keys[child->num_keys] = node->keys[i];
+    memcpy(&child->keys[child->num_keys + 1], &right->keys[0],
+           right->num_keys * sizeof(void *));
+    if (!child->leaf) {
+        memcpy(&child->children[child->num_keys + 1], &right->children[0],
+               (right->num_keys + 1) * sizeof(struct bnode *));
+    }
+    child->num_keys += right->num_keys + 1;
+    memmove(&node->keys[i], &node->keys[i + 1],
+            (node->num_keys - i - 1) * sizeof(void *));
+    memmove(&node->children[i + 1], &node->children[i + 2],
+            (node->num_keys - i - 1) * sizeof(struct bnode *));
+    node->num_keys--;
+    mem_free(allocator, right);
+}
+
+/**
+ * @brief Grow a minimal child before descending into it for a removal.
+ *
+ * A key is rotated in from a sibling through the parent when one has keys
+ * to spare; otherwise the child is merged with a sibling.
+ *
+ * @param allocator A pointer to the tree's allocator
+ * @param node A pointer to the parent node
+ * @param i The index of the minimal child
+ */
+static void btree_fill(const allocator_t *allocator, struct bnode *node,
+                       size_t i) {
+    struct bnode *child = node->children[i];
+    if (i > 0 && node->children[i - 1]->num_keys > BTREE_MIN_KEYS) {
+        // rotate the left sibling's largest key through the parent
+        struct bnode *left = node->children[i - 1];
+        memmove(&child->keys[1], &child->keys[0],
+                child->num_keys * sizeof(void *));
+        child->keys[0] = node->keys[i - 1];
+        if (!child->leaf) {
+            memmove(&child->children[1], &child->children[0],
+                    (child->num_keys + 1) * sizeof(struct bnode *));
+            child->children[0] = left->children[left->num_keys];
+        }
+        node->keys[i - 1] = left->keys[left->num_keys - 1];
+        left->num_keys--;
+        child->num_keys++;
+    } else if (i < node->num_keys &&
+               node->children[i + 1]->num_keys > BTREE_MIN_KEYS) {
+        // rotate the right sibling's smallest key through the parent
+        struct bnode *right = node->children[i + 1];
+        child->keys[child->num_keys] = node->keys[i];
+        if (!child->leaf) {
+            child->children[child->num_keys + 1] = right->children[0];
+            memmove(&right->children[0], &right->children[1],
+                    right->num_keys * sizeof(struct bnode *));
+        }
+        node->keys[i] = right->keys[0];
+        memmove(&right->keys[0], &right->keys[1],
+                (right->num_keys - 1) * sizeof(void *));
+        right->num_keys--;
+        child->num_keys++;
+    } else {
+        btree_merge(allocator, node, i < node->num_keys ? i : i - 1);
+    }
+}
+
+/**
+ * @brief Physically remove and return the largest key in a subtree.
+ *
+ * The subtree root must hold more than the minimum number of keys.
+ *
+ * @param allocator A pointer to the tree's allocator
+ * @param node A pointer to the root of the subtree
+ * @return void* The removed data
+ */
+static void *btree_delete_max(const allocator_t *allocator,
+                              struct bnode *node) {
+    while (!node->leaf) {
+        if (node->children[node->num_keys]->num_keys == BTREE_MIN_KEYS) {
+            btree_fill(allocator, node, node->num_keys);
+        }
+        node = node->children[node->num_keys];
+    }
+    return node->keys[--node->num_keys];
+}
+
+/**
+ * @brief Physically remove and return the smallest key in a subtree.
+ *
+ * The subtree root must hold more than the minimum number of keys.
+ *
+ * @param allocator A pointer to the tree's allocator
+ * @param node A pointer to the root of the subtree
+ * @return void* The removed data
+ */
+static void *btree_delete_min(const allocator_t *allocator,
+                              struct bnode *node) {
+    while (!node->leaf) {
+        if (node->children[0]->num_keys == BTREE_MIN_KEYS) {
+            btree_fill(allocator, node, 0);
+        }
+        node = node->children[0];
+    }
+    void *data = node->keys[0];
+    node->num_keys--;
+    memmove(&node->keys[0], &node->keys[1], node->num_keys * sizeof(void *));
+    return data;
+}
+
+/**
+ * @brief Remove one key matching the data from the high-fanout tree.
+ *
+ * Minimal nodes are grown on the way down, so every node a removal
+ * recurses into can afford to lose a key. The pointer stored in *old is
+ * always the key that was physically unlinked, which matters when
+ * distinct pointers compare equal.
+ *
+ * @param allocator A pointer to the tree's allocator
+ * @param node A pointer to the root of the subtree
+ * @param cmp A pointer to the user-defined compare function
+ * @param data A pointer to the data to be removed
+ * @param old An optional pointer that receives the removed data
+ * @return bool true if a match was removed
+ */
+static bool btree_remove_node(const allocator_t *allocator,
+                              struct bnode *node, CMP_F cmp, void *data,
+                              void **old) {
+    size_t i = bnode_lower_bound(node, cmp, data);
+    if (i < node->num_keys && cmp(data, node->keys[i]) == 0) {
+        if (node->leaf) {
+            if (old != NULL) {
+                *old = node->keys[i];
+            }
+            node->num_keys--;
+            memmove(&node->keys[i], &node->keys[i + 1],
+                    (node->num_keys - i) * sizeof(void *));
+        } else if (node->children[i]->num_keys > BTREE_MIN_KEYS) {
+            // replace the match with its in-order predecessor
+            if (old != NULL) {
+                *old = node->keys[i];
+            }
+            node->keys[i] = btree_delete_max(allocator, node->children[i]);
+        } else if (node->children[i + 1]->num_keys > BTREE_MIN_KEYS) {
+            // replace the match with its in-order successor
+            if (old != NULL) {
+                *old = node->keys[i];
+            }
+            node->keys[i] = btree_delete_min(allocator, node->children[i + 1]);
+        } else {
+            // both neighbors are minimal: push the match down into the
+            // merged child and let the recursion report what it unlinks
+            btree_merge(allocator, node, i);
+            return btree_remove_node(allocator, node->children[i], cmp, data,
+                                     old);
+        }
+        return true;
+    }
+    if (node->leaf) {
+        return false;
+    }
+    if (node->children[i]->num_keys == BTREE_MIN_KEYS) {
+        btree_fill(allocator, node, i);
+        if (i > node->num_keys) {
+            i--; // the child was merged into its left sibling
+        }
+    }
+    return btree_remove_node(allocator, node->children[i], cmp, data, old);
+}
+
+/**
+ * @brief Traverse the high-fanout tree in order.
+ *
+ * Mirrors tree_in_order(): the traversal stops and returns the first
+ * non-zero action result.
+ *
+ * @param node A pointer to the current node
+ * @param func A pointer to the action function
+ * @param addl_data A pointer to additional data passed to the action function
+ * @return int The first non-zero action result, or 0
+ */
+static int btree_in_order(struct bnode *node, ACT_F func, void *addl_data) {
+    if (node == NULL) {
+        return SUCCESS;
+    }
+    int result;
+    for (size_t i = 0; i < node->num_keys; i++) {
+        if (!node->leaf) {
+            result = btree_in_order(node->children[i], func, addl_data);
+            if (result != SUCCESS) {
+                return result;
+            }
+        }
+        result = func(node->keys[i], addl_data);
+        if (result != SUCCESS) {
+            return result;
+        }
+    }
+    return node->leaf ? SUCCESS
+                      : btree_in_order(node->children[node->num_keys], func,
+                                       addl_data);
+}
+
+/**
+ * @brief Traverse only the keys of the high-fanout tree within [lo, hi].
+ *
+ * Mirrors tree_range_nodes(): subtrees that cannot contain in-range data
+ * are pruned at their root.
+ *
+ * @param node A pointer to the current node
+ * @param cmp A pointer to the user-defined compare function
+ * @param lo A pointer to the lower bound, inclusive
+ * @param hi A pointer to the upper bound, inclusive
+ * @param func A pointer to the action function
+ * @param addl_data A pointer to additional data passed to the action function
+ * @return int The first non-zero action result, or 0
+ */
+static int btree_range_nodes(struct bnode *node, CMP_F cmp, void *lo, void *hi,
+                             ACT_F func, void *addl_data) {
+    if (node == NULL) {
+        return SUCCESS;
+    }
+    size_t i = bnode_lower_bound(node, cmp, lo);
+    int result;
+    if (!node->leaf) {
+        // children[i] is the leftmost subtree that can hold in-range data
+        result =
+            btree_range_nodes(node->children[i], cmp, lo, hi, func, addl_data);
+        if (result != SUCCESS) {
+            return result;
+        }
+    }
+    while (i < node->num_keys && cmp(hi, node->keys[i]) >= 0) {
+        result = func(node->keys[i], addl_data);
+        if (result != SUCCESS) {
+            return result;
+        }
+        i++;
+        if (!node->leaf) {
+            result = btree_range_nodes(node->children[i], cmp, lo, hi, func,
+                                       addl_data);
+            if (result != SUCCESS) {
+                return result;
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Find the smallest key at or above the data in the high-fanout tree.
+ *
+ * @param node A pointer to the root of the subtree
+ * @param cmp A pointer to the user-defined compare function
+ * @param data A pointer to the data to be compared against
+ * @return void* A pointer to the data found or NULL
+ */
+static void *btree_ceiling_search(struct bnode *node, CMP_F cmp, void *data) {
+    void *best = NULL;
+    while (node != NULL) {
+        size_t i = bnode_lower_bound(node, cmp, data);
+        if (i < node->num_keys) {
+            if (cmp(data, node->keys[i]) == 0) {
+                return node->keys[i];
+            }
+            // in bound; remember it and look for something smaller
+            best = node->keys[i];
+        }
+        node = node->leaf ? NULL : node->children[i];
+    }
+    return best;
+}
+
+/**
+ * @brief Find the largest key at or below the data in the high-fanout tree.
+ *
+ * @param node A pointer to the root of the subtree
+ * @param cmp A pointer to the user-defined compare function
+ * @param data A pointer to the data to be compared against
+ * @return void* A pointer to the data found or NULL
+ */
+static void *btree_floor_search(struct bnode *node, CMP_F cmp, void *data) {
+    void *best = NULL;
+    while (node != NULL) {
+        size_t i = bnode_lower_bound(node, cmp, data);
+        if (i < node->num_keys && cmp(data, node->keys[i]) == 0) {
+            return node->keys[i];
+        }
+        if (i > 0) {
+            // in bound; remember it and look for something larger
+            best = node->keys[i - 1];
+        }
+        node = node->leaf ? NULL : node->children[i];
+    }
+    return best;
+}
+
+/**
+ * @brief Traverse the high-fanout tree in post-order to release it.
+ *
+ * @param allocator A pointer to the tree's allocator
+ * @param node A pointer to the current node
+ * @param free_func A pointer to the user-defined free function
+ */
+static void btree_clear_nodes(const allocator_t *allocator,
+                              struct bnode *node, FREE_F free_func) {
+    if (node == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < node->num_keys; i++) {
+        if (!node->leaf) {
+            btree_clear_nodes(allocator, node->children[i], free_func);
+        }
+        if (free_func != NULL) {
+            free_func(node->keys[i]);
+        }
+    }
+    if (!node->leaf) {
+        btree_clear_nodes(allocator, node->children[node->num_keys],
+                          free_func);
+    }
+    mem_free(allocator, node);
 }
 
 /* PUBLIC FUNCTIONS */
 
 tree_t *tree_new(FREE_F free_func, CMP_F cmp_func, int *err) {
+    return tree_new_alloc(free_func, cmp_func, NULL, err);
+}
+
+tree_t *tree_new_alloc(FREE_F free_func, CMP_F cmp_func,
+                       const allocator_t *allocator, int *err) {
     if (cmp_func == NULL) {
         set_err(err, EINVAL);
         return NULL;
     }
-    tree_t *tree = calloc(1, sizeof(*tree));
+    tree_t *tree = mem_zalloc(allocator, sizeof(*tree));
     if (tree == NULL) {
         set_err(err, ENOMEM);
         return NULL;
     }
+    if (allocator != NULL) {
+        tree->allocator = *allocator;
+    }
     tree->free_func = free_func;
     tree->cmp_func = cmp_func;
     return tree;
 }
 
+tree_t *tree_new_btree(FREE_F free_func, CMP_F cmp_func, int *err) {
+    tree_t *tree = tree_new(free_func, cmp_func, err);
+    if (tree != NULL) {
+        tree->high_fanout = true;
+    }
+    return tree;
+}
+
+tree_t *tree_new_btree_alloc(FREE_F free_func, CMP_F cmp_func,
+                             const allocator_t *allocator, int *err) {
+    tree_t *tree = tree_new_alloc(free_func, cmp_func, allocator, err);
+    if (tree != NULL) {
+        tree->high_fanout = true;
+    }
+    return tree;
+}
+
 int tree_query(tree_t *tree, int query, ssize_t *result) {
     if (tree == NULL || result == NULL) {
         return EINVAL;
@@ -372,7 +1039,15 @@ int tree_add(tree_t *tree, void *data) {
     if (tree == NULL) {
         return EINVAL;
     }
-    struct node *node = create_node(data);
+    if (tree->high_fanout) {
+        int err = btree_insert(tree, data);
+        if (err != SUCCESS) {
+            return err;
+        }
+        tree->size++;
+        return SUCCESS;
+    }
+    struct node *node = create_node(tree, data);
     if (node == NULL) {
         return ENOMEM;
     }
@@ -387,37 +1062,60 @@ int tree_remove(tree_t *tree, void *data, void **old) {
     } else if (tree->size == 0) {
         return SUCCESS;
     }
-    struct node **to_remove = tree_search(&tree->root, tree->cmp_func, data);
-    if (*to_remove == NULL) {
+    if (tree->high_fanout) {
+        if (btree_remove_node(&tree->allocator, tree->broot, tree->cmp_func,
+                              data, old)) {
+            if (tree->broot->num_keys == 0) {
+                // the root drained: the tree shrinks by one level
+                struct bnode *broot = tree->broot;
+                tree->broot = broot->leaf ? NULL : broot->children[0];
+                mem_free(&tree->allocator, broot);
+            }
+            tree->size--;
+        }
+        return SUCCESS;
+    }
+    // find the node iteratively, recording the path for the rebalance pass
+    struct node **path[MAX_DEPTH];
+    size_t depth = 0;
+    struct node **slot = &tree->root;
+    while (*slot != NULL) {
+        int result = tree->cmp_func(data, (*slot)->data);
+        if (result == 0) {
+            break;
+        }
+        path[depth++] = slot;
+        slot = result < 0 ? &(*slot)->left : &(*slot)->right;
+    }
+    if (*slot == NULL) {
         return SUCCESS;
     }
 
-    struct node *to_promote = NULL;
-
-    if (!((*to_remove)->left && (*to_remove)->right)) {
-        // node has 0 or 1 children
-        if ((*to_remove)->left) {
-            to_promote = (*to_remove)->left;
-        } else {
-            to_promote = (*to_remove)->right;
+    struct node *target = *slot;
+    void *removed = target->data;
+    if (target->left && target->right) {
+        // node has 2 children: move the in-order predecessor's data up and
+        // unlink that node instead, so only recorded slots are touched
+        path[depth++] = slot;
+        struct node **max_left = &target->left;
+        while ((*max_left)->right) {
+            path[depth++] = max_left;
+            max_left = &(*max_left)->right;
         }
-    } else {
-        // node has 2 children
-        struct node **max_left = tree_max(&(*to_remove)->left);
-        to_promote = *max_left;
-        *max_left = (*max_left)->left;
-        to_promote->left = (*to_remove)->left;
-        to_promote->right = (*to_remove)->right;
+        target->data = (*max_left)->data;
+        target = *max_left;
+        slot = max_left;
     }
+    // node has 0 or 1 children
+    *slot = target->left ? target->left : target->right;
+    recycle_node(tree, target);
 
-    void *removed = (*to_remove)->data;
+    while (depth > 0) {
+        balance_tree(path[--depth]);
+    }
     if (old != NULL) {
         *old = removed;
     }
-    free(*to_remove);
-
-    *to_remove = to_promote;
-    balance_tree(to_remove);
     tree->size--;
     return SUCCESS;
 }
@@ -429,6 +1127,17 @@ ssize_t tree_remove_all(tree_t *tree, void *data) {
         return 0;
     }
     size_t count = 0;
+    if (tree->high_fanout) {
+        while (btree_search(tree->broot, tree->cmp_func, data, NULL)) {
+            void *to_remove = NULL;
+            tree_remove(tree, data, &to_remove);
+            if (tree->free_func != NULL) {
+                tree->free_func(to_remove);
+            }
+            count++;
+        }
+        return count;
+    }
     // must use tree_search() instead of tree_remove() in case NULL data is
     // allowed
     struct node **node = tree_search(&tree->root, tree->cmp_func, data);
@@ -441,8 +1150,6 @@ ssize_t tree_remove_all(tree_t *tree, void *data) {
         count++;
         node = tree_search(&tree->root, tree->cmp_func, data);
     }
-    // TODO: How to full rebalance the tree?
-    balance_tree(&tree->root);
     return count;
 }
 
@@ -450,6 +1157,9 @@ int tree_contains(tree_t *tree, void *data) {
     if (tree == NULL) {
         return INVALID;
     }
+    if (tree->high_fanout) {
+        return btree_search(tree->broot, tree->cmp_func, data, NULL);
+    }
     return *tree_search(&tree->root, tree->cmp_func, data) != NULL;
 }
 
@@ -457,6 +1167,11 @@ void *tree_find_first(tree_t *tree, void *data) {
     if (tree == NULL) {
         return NULL;
     }
+    if (tree->high_fanout) {
+        void *found = NULL;
+        btree_search(tree->broot, tree->cmp_func, data, &found);
+        return found;
+    }
     struct node **node = tree_search(&tree->root, tree->cmp_func, data);
     return *node == NULL ? NULL : (*node)->data;
 }
@@ -467,26 +1182,38 @@ tree_t *tree_find_all(tree_t *tree, void *data, int *err) {
         return NULL;
     }
 
-    tree_t *found = tree_new(NULL, tree->cmp_func, NULL);
+    tree_t *found = tree_new_alloc(NULL, tree->cmp_func, &tree->allocator,
+                                   NULL);
     if (found == NULL) {
         set_err(err, ENOMEM);
         return NULL;
     }
 
-    struct node **node = tree_search(&tree->root, tree->cmp_func, data);
-    if (*node == NULL) {
-        // tree is empty, or node not found
-        return found;
+    void *first = NULL;
+    if (tree->high_fanout) {
+        if (!btree_search(tree->broot, tree->cmp_func, data, &first)) {
+            // tree is empty, or node not found
+            return found;
+        }
+    } else {
+        struct node **node = tree_search(&tree->root, tree->cmp_func, data);
+        if (*node == NULL) {
+            // tree is empty, or node not found
+            return found;
+        }
+        first = (*node)->data;
     }
 
     // add the first node to the new tree
-    int loc_err = tree_add(found, (*node)->data);
+    int loc_err = tree_add(found, first);
     if (loc_err != SUCCESS) {
         tree_delete(&found);
         set_err(err, loc_err);
         return NULL;
     }
-    loc_err = tree_in_order(tree->root, find_each, found);
+    loc_err = tree->high_fanout
+                  ? btree_in_order(tree->broot, find_each, found)
+                  : tree_in_order(tree->root, find_each, found);
     if (loc_err != SUCCESS) {
         tree_delete(&found);
         set_err(err, loc_err);
@@ -501,9 +1228,77 @@ int tree_foreach(tree_t *tree, ACT_F act_func, void *addl_data) {
         // tree_foreach() failing and act_func() failing
         return INVALID;
     }
+    if (tree->high_fanout) {
+        return btree_in_order(tree->broot, act_func, addl_data);
+    }
     return tree_in_order(tree->root, act_func, addl_data);
 }
 
+int tree_range(tree_t *tree, void *lo, void *hi, ACT_F act_func,
+               void *addl_data) {
+    if (tree == NULL || act_func == NULL) {
+        // return -1 instead of returning EINVAL to differentiate between
+        // tree_range() failing and act_func() failing
+        return INVALID;
+    } else if (tree->cmp_func(lo, hi) > 0) {
+        return SUCCESS; // empty range
+    }
+    if (tree->high_fanout) {
+        return btree_range_nodes(tree->broot, tree->cmp_func, lo, hi, act_func,
+                                 addl_data);
+    }
+    return tree_range_nodes(tree->root, tree->cmp_func, lo, hi, act_func,
+                            addl_data);
+}
+
+void *tree_ceiling(tree_t *tree, void *data) {
+    if (tree == NULL) {
+        return NULL;
+    }
+    if (tree->high_fanout) {
+        return btree_ceiling_search(tree->broot, tree->cmp_func, data);
+    }
+    struct node *node = tree->root;
+    void *best = NULL;
+    while (node != NULL) {
+        int result = tree->cmp_func(data, node->data);
+        if (result == 0) {
+            return node->data;
+        } else if (result < 0) {
+            // in bound; remember it and look for something smaller
+            best = node->data;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return best;
+}
+
+void *tree_floor(tree_t *tree, void *data) {
+    if (tree == NULL) {
+        return NULL;
+    }
+    if (tree->high_fanout) {
+        return btree_floor_search(tree->broot, tree->cmp_func, data);
+    }
+    struct node *node = tree->root;
+    void *best = NULL;
+    while (node != NULL) {
+        int result = tree->cmp_func(data, node->data);
+        if (result == 0) {
+            return node->data;
+        } else if (result > 0) {
+            // in bound; remember it and look for something larger
+            best = node->data;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+    return best;
+}
+
 int tree_iterator_reset(tree_t *tree) {
     if (tree == NULL) {
         return EINVAL;
@@ -511,11 +1306,15 @@ int tree_iterator_reset(tree_t *tree) {
         // build a new iterator
         queue_destroy(&tree->iterator);
         int err = SUCCESS;
-        tree->iterator = queue_init(tree->size, NULL, tree->cmp_func, &err);
+        tree->iterator = queue_init_alloc(tree->size, NULL, tree->cmp_func,
+                                          &tree->allocator, &err);
         if (tree->iterator == NULL) {
             return err;
         }
-        int results = tree_in_order(tree->root, build_iter, tree->iterator);
+        int results =
+            tree->high_fanout
+                ? btree_in_order(tree->broot, build_iter, tree->iterator)
+                : tree_in_order(tree->root, build_iter, tree->iterator);
         if (results != SUCCESS) {
             queue_destroy(&tree->iterator);
         }
@@ -534,11 +1333,17 @@ void *tree_iterator_next(tree_t *tree) {
 int tree_clear(tree_t *tree) {
     if (tree == NULL) {
         return EINVAL;
-    } else if (tree->size == 0) {
-        return SUCCESS;
     }
-    clear_nodes(tree->root, tree->free_func);
-    tree->root = NULL;
+    // no size shortcut: removals recycle nodes instead of returning their
+    // blocks, so an empty tree can still hold arena blocks to release
+    if (tree->high_fanout) {
+        btree_clear_nodes(&tree->allocator, tree->broot, tree->free_func);
+        tree->broot = NULL;
+    } else {
+        clear_nodes(tree->root, tree->free_func);
+        free_arena(tree);
+        tree->root = NULL;
+    }
     tree->size = 0;
     queue_destroy(&tree->iterator);
     return SUCCESS;
@@ -550,7 +1355,9 @@ int tree_delete(tree_t **tree) {
     }
     tree_clear(*tree);
     queue_destroy(&(*tree)->iterator);
-    free(*tree);
+    // copied out because the allocator lives inside the block being freed
+    allocator_t allocator = (*tree)->allocator;
+    mem_free(&allocator, *tree);
     *tree = NULL;
     return SUCCESS;
 }
@@ -0,0 +1,151 @@
+#include "bb_stats.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+/* DATA */
+
+#define SUCCESS 0
+
+// per-thread slots; more threads than this share slots through atomic
+// updates, which stays correct but may contend
+#define BB_STATS_SLOTS 64
+
+// pad each slot to its own cache lines so recording threads never
+// false-share
+#define BB_STATS_SLOT_PAD 128
+
+#ifndef __STDC_NO_ATOMICS__
+
+atomic_bool bb_stats_on = false;
+
+/**
+ * @brief One thread's counters, padded to avoid false sharing.
+ *
+ * @param counts number of events recorded per counter
+ * @param sums total of the values recorded per counter
+ */
+struct stat_slot {
+    _Atomic uint64_t counts[BB_STAT_ID_COUNT];
+    _Atomic uint64_t sums[BB_STAT_ID_COUNT];
+    char pad[BB_STATS_SLOT_PAD];
+};
+
+static struct stat_slot slots[BB_STATS_SLOTS];
+static atomic_size_t next_slot = 0;
+static _Thread_local int my_slot = -1;
+
+/* PUBLIC FUNCTIONS */
+
+void bb_stats_enable(void) { atomic_store(&bb_stats_on, true); }
+
+void bb_stats_disable(void) { atomic_store(&bb_stats_on, false); }
+
+void bb_stats_reset(void) {
+    for (size_t s = 0; s < BB_STATS_SLOTS; s++) {
+        for (int i = 0; i < BB_STAT_ID_COUNT; i++) {
+            atomic_store_explicit(&slots[s].counts[i], 0,
+                                  memory_order_relaxed);
+            atomic_store_explicit(&slots[s].sums[i], 0, memory_order_relaxed);
+        }
+    }
+}
+
+void bb_stats_add(int stat, uint64_t value) {
+    if (stat < 0 || stat >= BB_STAT_ID_COUNT) {
+        return;
+    }
+    if (my_slot < 0) {
+        my_slot = atomic_fetch_add(&next_slot, 1) % BB_STATS_SLOTS;
+    }
+    atomic_fetch_add_explicit(&slots[my_slot].counts[stat], 1,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&slots[my_slot].sums[stat], value,
+                              memory_order_relaxed);
+}
+
+int bb_stats_snapshot(bb_stat_t snapshot[BB_STAT_ID_COUNT]) {
+    if (snapshot == NULL) {
+        return EINVAL;
+    }
+    memset(snapshot, 0, BB_STAT_ID_COUNT * sizeof(*snapshot));
+    for (size_t s = 0; s < BB_STATS_SLOTS; s++) {
+        for (int i = 0; i < BB_STAT_ID_COUNT; i++) {
+            snapshot[i].count += atomic_load_explicit(&slots[s].counts[i],
+                                                      memory_order_relaxed);
+            snapshot[i].sum +=
+                atomic_load_explicit(&slots[s].sums[i], memory_order_relaxed);
+        }
+    }
+    return SUCCESS;
+}
+
+#else /* __STDC_NO_ATOMICS__ */
+
+#include <pthread.h>
+
+volatile int bb_stats_on = 0;
+
+// without atomics a single locked slot set replaces the per-thread ones
+static bb_stat_t stats[BB_STAT_ID_COUNT];
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* PUBLIC FUNCTIONS */
+
+void bb_stats_enable(void) { bb_stats_on = 1; }
+
+void bb_stats_disable(void) { bb_stats_on = 0; }
+
+void bb_stats_reset(void) {
+    pthread_mutex_lock(&stats_lock);
+    memset(stats, 0, sizeof(stats));
+    pthread_mutex_unlock(&stats_lock);
+}
+
+void bb_stats_add(int stat, uint64_t value) {
+    if (stat < 0 || stat >= BB_STAT_ID_COUNT) {
+        return;
+    }
+    pthread_mutex_lock(&stats_lock);
+    stats[stat].count++;
+    stats[stat].sum += value;
+    pthread_mutex_unlock(&stats_lock);
+}
+
+int bb_stats_snapshot(bb_stat_t snapshot[BB_STAT_ID_COUNT]) {
+    if (snapshot == NULL) {
+        return EINVAL;
+    }
+    pthread_mutex_lock(&stats_lock);
+    memcpy(snapshot, stats, sizeof(stats));
+    pthread_mutex_unlock(&stats_lock);
+    return SUCCESS;
+}
+
+#endif /* __STDC_NO_ATOMICS__ */
+
+const char *bb_stats_name(int stat) {
+    switch (stat) {
+    case BB_STAT_HASH_PROBE_LEN:
+        return "hash_probe_len";
+    case BB_STAT_HASH_RESIZES:
+        return "hash_resizes";
+    case BB_STAT_QUEUE_C_WAIT_NS:
+        return "queue_c_wait_ns";
+    case BB_STAT_QUEUE_C_DEPTH:
+        return "queue_c_depth";
+    case BB_STAT_THREADPOOL_QUEUE_NS:
+        return "threadpool_queue_ns";
+    case BB_STAT_THREADPOOL_TASK_NS:
+        return "threadpool_task_ns";
+    default:
+        return NULL;
+    }
+}
+
+uint64_t bb_stats_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
@@ -1,5 +1,24 @@
 #include "buildingblocks.h"
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* DATA */
+
+#define INVALID -1
+
+// elements compared per vectorizable scan block; the inner block is
+// branch-free so the compiler turns it into packed compares
+#define SCAN_BLOCK_U32 16
+#define SCAN_BLOCK_U64 8
+
+// clone the scan kernels per vector width where the loader can pick the
+// widest supported one; needs GNU ifunc support, so glibc targets only
+#if defined(__x86_64__) && defined(__gnu_linux__) && defined(__GNUC__)
+#define SCAN_TARGETS __attribute__((target_clones("avx2", "default")))
+#else
+#define SCAN_TARGETS
+#endif
 
 /* PUBLIC FUNCTIONS */
 
@@ -12,3 +31,131 @@ void set_err(int *err, int value) {
 int check_flag(int bit_flags, int position) {
     return (bit_flags & position) == position;
 }
+
+int cmp_u32(const void *a, const void *b) {
+    uint32_t x;
+    uint32_t y;
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+    return (x > y) - (x < y);
+}
+
+int cmp_u64(const void *a, const void *b) {
+    uint64_t x;
+    uint64_t y;
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+    return (x > y) - (x < y);
+}
+
+SCAN_TARGETS
+ssize_t scan_u32(const uint32_t *arr, size_t nmemb, uint32_t key) {
+    if (arr == NULL) {
+        return INVALID;
+    }
+    size_t i = 0;
+    for (; i + SCAN_BLOCK_U32 <= nmemb; i += SCAN_BLOCK_U32) {
+        unsigned hit = 0;
+        for (size_t j = 0; j < SCAN_BLOCK_U32; j++) {
+            hit |= arr[i + j] == key;
+        }
+        if (hit) {
+            // the match is somewhere in this block; the tail loop finds it
+            break;
+        }
+    }
+    for (; i < nmemb; i++) {
+        if (arr[i] == key) {
+            return (ssize_t)i;
+        }
+    }
+    return INVALID;
+}
+
+SCAN_TARGETS
+ssize_t scan_u64(const uint64_t *arr, size_t nmemb, uint64_t key) {
+    if (arr == NULL) {
+        return INVALID;
+    }
+    size_t i = 0;
+    for (; i + SCAN_BLOCK_U64 <= nmemb; i += SCAN_BLOCK_U64) {
+        unsigned hit = 0;
+        for (size_t j = 0; j < SCAN_BLOCK_U64; j++) {
+            hit |= arr[i + j] == key;
+        }
+        if (hit) {
+            // the match is somewhere in this block; the tail loop finds it
+            break;
+        }
+    }
+    for (; i < nmemb; i++) {
+        if (arr[i] == key) {
+            return (ssize_t)i;
+        }
+    }
+    return INVALID;
+}
+
+ssize_t scan_mem(const void *arr, size_t nmemb, size_t elem_size,
+                 const void *key) {
+    if (arr == NULL || key == NULL || elem_size == 0) {
+        return INVALID;
+    }
+    const uint8_t *at = arr;
+    for (size_t i = 0; i < nmemb; i++, at += elem_size) {
+        // memcmp already runs vectorized inside libc
+        if (memcmp(at, key, elem_size) == 0) {
+            return (ssize_t)i;
+        }
+    }
+    return INVALID;
+}
+
+void *mem_alloc(const allocator_t *allocator, size_t size) {
+    if (allocator == NULL || allocator->alloc == NULL) {
+        return malloc(size);
+    }
+    return allocator->alloc(size, allocator->ctx);
+}
+
+void *mem_zalloc(const allocator_t *allocator, size_t size) {
+    if (allocator == NULL || allocator->alloc == NULL) {
+        return calloc(1, size);
+    }
+    void *ptr = allocator->alloc(size, allocator->ctx);
+    if (ptr != NULL) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+void *mem_resize(const allocator_t *allocator, void *ptr, size_t old_size,
+                 size_t new_size) {
+    if (allocator == NULL || allocator->alloc == NULL) {
+        return realloc(ptr, new_size);
+    }
+    void *new_ptr = allocator->alloc(new_size, allocator->ctx);
+    if (new_ptr == NULL) {
+        return NULL;
+    }
+    if (ptr != NULL) {
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+        if (allocator->free != NULL) {
+            allocator->free(ptr, allocator->ctx);
+        }
+    }
+    return new_ptr;
+}
+
+void mem_free(const allocator_t *allocator, void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    if (allocator == NULL || allocator->alloc == NULL) {
+        free(ptr);
+        return;
+    }
+    if (allocator->free != NULL) {
+        allocator->free(ptr, allocator->ctx);
+    }
+}
@@ -0,0 +1,687 @@
+#include "container_serialize.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* DATA */
+
+#define SUCCESS 0
+
+// payload bytes per data packet; entries are batched up to this size so a
+// large container becomes a small number of large writes
+#define BATCH_CAP 32768
+
+// container kinds stored in the stream header
+#define KIND_HASH_TABLE 1
+#define KIND_TREE 2
+#define KIND_ARR_LIST 3
+
+/**
+ * @brief The payload of a stream header packet, all fields network order.
+ *
+ * @param kind which container the stream carries
+ * @param elem_size element size in bytes for by-value containers, 0 otherwise
+ * @param count_hi upper half of the element count
+ * @param count_lo lower half of the element count
+ */
+struct wire_hdr {
+    uint32_t kind;
+    uint32_t elem_size;
+    uint32_t count_hi;
+    uint32_t count_lo;
+};
+
+/**
+ * @brief Accumulates entries into data packets of at most BATCH_CAP bytes.
+ *
+ * @param io_info the i/o object packets are written to
+ * @param buf the pending packet payload
+ * @param used bytes of buf filled so far
+ */
+struct batch {
+    io_info_t *io_info;
+    uint8_t *buf;
+    size_t used;
+};
+
+/**
+ * @brief Context for the per-entry hash table serialize callback.
+ *
+ * @param batch the batch writer
+ * @param key_ser encoder for keys
+ * @param val_ser encoder for values
+ */
+struct hash_ser_ctx {
+    struct batch *batch;
+    SERIALIZE_F key_ser;
+    SERIALIZE_F val_ser;
+};
+
+/**
+ * @brief Context for the per-element tree serialize callback.
+ *
+ * @param batch the batch writer
+ * @param ser encoder for elements
+ */
+struct tree_ser_ctx {
+    struct batch *batch;
+    SERIALIZE_F ser;
+};
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * @brief Write the stream header packet.
+ *
+ * @param io_info the i/o object to write to
+ * @param kind which container the stream carries
+ * @param elem_size element size for by-value containers, 0 otherwise
+ * @param count the number of elements that will follow
+ * @return int 0 on success, non-zero on failure
+ */
+static int write_stream_hdr(io_info_t *io_info, uint32_t kind,
+                            uint32_t elem_size, uint64_t count) {
+    struct wire_hdr hdr = {
+        .kind = htonl(kind),
+        .elem_size = htonl(elem_size),
+        .count_hi = htonl((uint32_t)(count >> 32)),
+        .count_lo = htonl((uint32_t)count),
+    };
+    return write_pkt_data(io_info, &hdr, sizeof(hdr), CONTAINER_PKT_HEADER);
+}
+
+/**
+ * @brief Read and validate the stream header packet.
+ *
+ * @param io_info the i/o object to read from
+ * @param pkt the caller's reusable packet
+ * @param kind the container kind the stream must carry
+ * @param elem_size where to store the element size from the header
+ * @param count where to store the element count from the header
+ * @return int 0 on success, non-zero on failure
+ */
+static int read_stream_hdr(io_info_t *io_info, struct packet *pkt,
+                           uint32_t kind, uint32_t *elem_size,
+                           uint64_t *count) {
+    int err = read_pkt_into(io_info, pkt);
+    if (err != SUCCESS) {
+        return err;
+    }
+    if (pkt->hdr->data_type != CONTAINER_PKT_HEADER ||
+        pkt->hdr->data_len != sizeof(struct wire_hdr)) {
+        return EPROTO;
+    }
+    struct wire_hdr hdr;
+    memcpy(&hdr, pkt->data, sizeof(hdr));
+    if (ntohl(hdr.kind) != kind) {
+        return EPROTO;
+    }
+    *elem_size = ntohl(hdr.elem_size);
+    *count = ((uint64_t)ntohl(hdr.count_hi) << 32) | ntohl(hdr.count_lo);
+    return SUCCESS;
+}
+
+/**
+ * @brief Write the pending payload as one data packet.
+ *
+ * @param batch the batch writer
+ * @return int 0 on success, non-zero on failure
+ */
+static int batch_flush(struct batch *batch) {
+    if (batch->used == 0) {
+        return SUCCESS;
+    }
+    int err = write_pkt_data(batch->io_info, batch->buf, batch->used,
+                             CONTAINER_PKT_DATA);
+    batch->used = 0;
+    return err;
+}
+
+/**
+ * @brief Make room for an entry, flushing the pending payload if needed.
+ *
+ * @param batch the batch writer
+ * @param room bytes the entry needs
+ * @return int 0 on success, non-zero on failure
+ */
+static int batch_reserve(struct batch *batch, size_t room) {
+    if (batch->used + room > BATCH_CAP) {
+        return batch_flush(batch);
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Append raw bytes to the pending payload.
+ *
+ * @param batch the batch writer
+ * @param bytes the bytes to append
+ * @param len the number of bytes
+ */
+static void batch_append(struct batch *batch, const void *bytes, size_t len) {
+    memcpy(batch->buf + batch->used, bytes, len);
+    batch->used += len;
+}
+
+/**
+ * @brief Append a length prefix in network order to the pending payload.
+ *
+ * @param batch the batch writer
+ * @param value the length to append
+ */
+static void batch_append_u32(struct batch *batch, uint32_t value) {
+    value = htonl(value);
+    batch_append(batch, &value, sizeof(value));
+}
+
+/**
+ * @brief Add one length-prefixed entry, keeping it whole within a packet.
+ *
+ * Entries larger than the batch buffer are shipped as their own packet,
+ * gathered with write_pkt_datav so the bytes are not copied first.
+ *
+ * @param batch the batch writer
+ * @param bytes the entry's wire bytes
+ * @param len the number of wire bytes
+ * @return int 0 on success, non-zero on failure
+ */
+static int batch_put_entry(struct batch *batch, const void *bytes,
+                           size_t len) {
+    if (len > UINT32_MAX) {
+        return EOVERFLOW;
+    }
+    size_t room = sizeof(uint32_t) + len;
+    if (room > BATCH_CAP) {
+        int err = batch_flush(batch);
+        if (err != SUCCESS) {
+            return err;
+        }
+        uint32_t prefix = htonl((uint32_t)len);
+        struct iovec iov[] = {
+            {.iov_base = &prefix, .iov_len = sizeof(prefix)},
+            {.iov_base = (void *)bytes, .iov_len = len},
+        };
+        return write_pkt_datav(batch->io_info, iov, 2, CONTAINER_PKT_DATA);
+    }
+    int err = batch_reserve(batch, room);
+    if (err != SUCCESS) {
+        return err;
+    }
+    batch_append_u32(batch, (uint32_t)len);
+    batch_append(batch, bytes, len);
+    return SUCCESS;
+}
+
+/**
+ * @brief Add one key/value pair, keeping the pair whole within a packet.
+ *
+ * @param batch the batch writer
+ * @param key the key's wire bytes
+ * @param key_len the number of key bytes
+ * @param val the value's wire bytes
+ * @param val_len the number of value bytes
+ * @return int 0 on success, non-zero on failure
+ */
+static int batch_put_pair(struct batch *batch, const void *key, size_t key_len,
+                          const void *val, size_t val_len) {
+    if (key_len > UINT32_MAX || val_len > UINT32_MAX) {
+        return EOVERFLOW;
+    }
+    size_t room = (2 * sizeof(uint32_t)) + key_len + val_len;
+    if (room > BATCH_CAP) {
+        int err = batch_flush(batch);
+        if (err != SUCCESS) {
+            return err;
+        }
+        uint32_t prefixes[] = {htonl((uint32_t)key_len),
+                               htonl((uint32_t)val_len)};
+        struct iovec iov[] = {
+            {.iov_base = &prefixes[0], .iov_len = sizeof(prefixes[0])},
+            {.iov_base = (void *)key, .iov_len = key_len},
+            {.iov_base = &prefixes[1], .iov_len = sizeof(prefixes[1])},
+            {.iov_base = (void *)val, .iov_len = val_len},
+        };
+        return write_pkt_datav(batch->io_info, iov, 4, CONTAINER_PKT_DATA);
+    }
+    int err = batch_reserve(batch, room);
+    if (err != SUCCESS) {
+        return err;
+    }
+    batch_append_u32(batch, (uint32_t)key_len);
+    batch_append(batch, key, key_len);
+    batch_append_u32(batch, (uint32_t)val_len);
+    batch_append(batch, val, val_len);
+    return SUCCESS;
+}
+
+/**
+ * @brief Per-entry callback for hash_table_serialize.
+ *
+ * @param key the entry's key
+ * @param data pointer to the entry's value
+ * @param addl_data the struct hash_ser_ctx for this stream
+ * @return int 0 to keep iterating, non-zero to stop
+ */
+static int hash_ser_entry(const void *key, void **data, void *addl_data) {
+    struct hash_ser_ctx *ctx = addl_data;
+    const void *key_bytes;
+    size_t key_len;
+    int err = ctx->key_ser(key, &key_bytes, &key_len);
+    if (err != SUCCESS) {
+        return err;
+    }
+    const void *val_bytes;
+    size_t val_len;
+    err = ctx->val_ser(*data, &val_bytes, &val_len);
+    if (err != SUCCESS) {
+        return err;
+    }
+    return batch_put_pair(ctx->batch, key_bytes, key_len, val_bytes, val_len);
+}
+
+/**
+ * @brief Per-element callback for tree_serialize.
+ *
+ * @param node_data the element
+ * @param addl_data the struct tree_ser_ctx for this stream
+ * @return int 0 to keep iterating, non-zero to stop
+ */
+static int tree_ser_elem(void *node_data, void *addl_data) {
+    struct tree_ser_ctx *ctx = addl_data;
+    const void *bytes;
+    size_t len;
+    int err = ctx->ser(node_data, &bytes, &len);
+    if (err != SUCCESS) {
+        return err;
+    }
+    return batch_put_entry(ctx->batch, bytes, len);
+}
+
+/**
+ * @brief Pull one length-prefixed field out of a packet payload.
+ *
+ * @param at cursor into the payload, advanced past the field
+ * @param left payload bytes remaining, reduced by the field
+ * @param bytes where to store the pointer to the field's bytes
+ * @param len where to store the field's length
+ * @return int 0 on success, EPROTO if the payload is truncated
+ */
+static int next_field(const uint8_t **at, size_t *left, const void **bytes,
+                      size_t *len) {
+    uint32_t prefix;
+    if (*left < sizeof(prefix)) {
+        return EPROTO;
+    }
+    memcpy(&prefix, *at, sizeof(prefix));
+    prefix = ntohl(prefix);
+    *at += sizeof(prefix);
+    *left -= sizeof(prefix);
+    if (*left < prefix) {
+        return EPROTO;
+    }
+    *bytes = *at;
+    *at += prefix;
+    *left -= prefix;
+    *len = prefix;
+    return SUCCESS;
+}
+
+/**
+ * @brief Decode one data packet of key/value pairs into the table.
+ *
+ * The packet's pairs are decoded into a scratch array and inserted with a
+ * single hash_table_set_bulk call. On failure the values decoded from this
+ * packet that never reached the table are released through free_f.
+ *
+ * @param pkt the data packet
+ * @param key_des decoder for keys
+ * @param val_des decoder for values
+ * @param free_f the table's free function
+ * @param table the table being loaded
+ * @param remaining elements still expected, reduced by the packet
+ * @return int 0 on success, non-zero on failure
+ */
+static int hash_decode_packet(struct packet *pkt, DESERIALIZE_F key_des,
+                              DESERIALIZE_F val_des, FREE_F free_f,
+                              hash_table_t *table, uint64_t *remaining) {
+    const uint8_t *at = pkt->data;
+    size_t left = pkt->hdr->data_len;
+    // every pair carries at least its two length prefixes
+    hash_table_kv_t *pairs =
+        malloc(((left / (2 * sizeof(uint32_t))) + 1) * sizeof(*pairs));
+    if (pairs == NULL) {
+        return ENOMEM;
+    }
+    int err = SUCCESS;
+    size_t n = 0;
+    while (left > 0 && *remaining > 0) {
+        const void *key_bytes;
+        size_t key_len;
+        err = next_field(&at, &left, &key_bytes, &key_len);
+        if (err != SUCCESS) {
+            break;
+        }
+        const void *val_bytes;
+        size_t val_len;
+        err = next_field(&at, &left, &val_bytes, &val_len);
+        if (err != SUCCESS) {
+            break;
+        }
+        void *key = key_des(key_bytes, key_len, &err);
+        if (key == NULL) {
+            if (err == SUCCESS) {
+                err = EINVAL;
+            }
+            break;
+        }
+        void *val = val_des(val_bytes, val_len, &err);
+        if (val == NULL && err != SUCCESS) {
+            break;
+        }
+        pairs[n++] = (hash_table_kv_t){.key = key, .data = val};
+        (*remaining)--;
+    }
+    if (err == SUCCESS && left > 0) {
+        // more pairs than the stream header advertised
+        err = EPROTO;
+    }
+    if (err == SUCCESS) {
+        err = hash_table_set_bulk(table, pairs, n);
+    } else if (free_f != NULL) {
+        for (size_t i = 0; i < n; i++) {
+            free_f(pairs[i].data);
+        }
+    }
+    free(pairs);
+    return err;
+}
+
+/**
+ * @brief Decode one data packet of elements into the tree.
+ *
+ * @param pkt the data packet
+ * @param des decoder for elements
+ * @param free_f the tree's free function
+ * @param tree the tree being loaded
+ * @param remaining elements still expected, reduced by the packet
+ * @return int 0 on success, non-zero on failure
+ */
+static int tree_decode_packet(struct packet *pkt, DESERIALIZE_F des,
+                              FREE_F free_f, tree_t *tree,
+                              uint64_t *remaining) {
+    const uint8_t *at = pkt->data;
+    size_t left = pkt->hdr->data_len;
+    int err = SUCCESS;
+    while (left > 0 && *remaining > 0) {
+        const void *bytes;
+        size_t len;
+        err = next_field(&at, &left, &bytes, &len);
+        if (err != SUCCESS) {
+            return err;
+        }
+        void *elem = des(bytes, len, &err);
+        if (elem == NULL) {
+            return err != SUCCESS ? err : EINVAL;
+        }
+        err = tree_add(tree, elem);
+        if (err != SUCCESS) {
+            if (free_f != NULL) {
+                free_f(elem);
+            }
+            return err;
+        }
+        (*remaining)--;
+    }
+    if (left > 0) {
+        // more elements than the stream header advertised
+        return EPROTO;
+    }
+    return SUCCESS;
+}
+
+/* PUBLIC FUNCTIONS */
+
+int hash_table_serialize(hash_table_t *table, io_info_t *io_info,
+                         SERIALIZE_F key_ser, SERIALIZE_F val_ser) {
+    if (table == NULL || io_info == NULL || key_ser == NULL ||
+        val_ser == NULL) {
+        return EINVAL;
+    }
+    ssize_t size;
+    int err = hash_table_query(table, QUERY_SIZE, &size);
+    if (err != SUCCESS) {
+        return err;
+    }
+    struct batch batch = {.io_info = io_info, .buf = malloc(BATCH_CAP)};
+    if (batch.buf == NULL) {
+        return ENOMEM;
+    }
+    err = write_stream_hdr(io_info, KIND_HASH_TABLE, 0, (uint64_t)size);
+    if (err == SUCCESS) {
+        struct hash_ser_ctx ctx = {
+            .batch = &batch, .key_ser = key_ser, .val_ser = val_ser};
+        err = hash_table_iterate(table, hash_ser_entry, &ctx);
+        if (err == SUCCESS) {
+            err = batch_flush(&batch);
+        }
+    }
+    free(batch.buf);
+    return err;
+}
+
+hash_table_t *hash_table_deserialize(io_info_t *io_info, DESERIALIZE_F key_des,
+                                     DESERIALIZE_F val_des, FREE_F free_f,
+                                     CMP_F cmp_f, HASH_F hash_f,
+                                     size_t key_len, int mode, int *err) {
+    if (io_info == NULL || key_des == NULL || val_des == NULL ||
+        cmp_f == NULL) {
+        set_err(err, EINVAL);
+        return NULL;
+    }
+    struct packet pkt = {0};
+    uint32_t elem_size;
+    uint64_t count;
+    int loc_err =
+        read_stream_hdr(io_info, &pkt, KIND_HASH_TABLE, &elem_size, &count);
+    if (loc_err != SUCCESS) {
+        free_packet_buffers(&pkt);
+        set_err(err, loc_err);
+        return NULL;
+    }
+    hash_table_t *table = hash_table_init_hash(count > 0 ? count : 1, free_f,
+                                               cmp_f, hash_f, key_len, mode,
+                                               &loc_err);
+    if (table == NULL) {
+        free_packet_buffers(&pkt);
+        set_err(err, loc_err);
+        return NULL;
+    }
+    // size for the whole stream up front so loading never resizes
+    loc_err = hash_table_reserve(table, count);
+    uint64_t remaining = count;
+    while (loc_err == SUCCESS && remaining > 0) {
+        loc_err = read_pkt_into(io_info, &pkt);
+        if (loc_err != SUCCESS) {
+            break;
+        }
+        if (pkt.hdr->data_type != CONTAINER_PKT_DATA) {
+            loc_err = EPROTO;
+            break;
+        }
+        loc_err = hash_decode_packet(&pkt, key_des, val_des, free_f, table,
+                                     &remaining);
+    }
+    free_packet_buffers(&pkt);
+    if (loc_err != SUCCESS) {
+        hash_table_destroy(&table);
+        set_err(err, loc_err);
+        return NULL;
+    }
+    return table;
+}
+
+int tree_serialize(tree_t *tree, io_info_t *io_info, SERIALIZE_F ser) {
+    if (tree == NULL || io_info == NULL || ser == NULL) {
+        return EINVAL;
+    }
+    ssize_t size;
+    int err = tree_query(tree, QUERY_SIZE, &size);
+    if (err != SUCCESS) {
+        return err;
+    }
+    struct batch batch = {.io_info = io_info, .buf = malloc(BATCH_CAP)};
+    if (batch.buf == NULL) {
+        return ENOMEM;
+    }
+    err = write_stream_hdr(io_info, KIND_TREE, 0, (uint64_t)size);
+    if (err == SUCCESS) {
+        struct tree_ser_ctx ctx = {.batch = &batch, .ser = ser};
+        err = tree_foreach(tree, tree_ser_elem, &ctx);
+        if (err == SUCCESS) {
+            err = batch_flush(&batch);
+        }
+    }
+    free(batch.buf);
+    return err;
+}
+
+tree_t *tree_deserialize(io_info_t *io_info, DESERIALIZE_F des, FREE_F free_f,
+                         CMP_F cmp_f, bool high_fanout, int *err) {
+    if (io_info == NULL || des == NULL || cmp_f == NULL) {
+        set_err(err, EINVAL);
+        return NULL;
+    }
+    struct packet pkt = {0};
+    uint32_t elem_size;
+    uint64_t count;
+    int loc_err = read_stream_hdr(io_info, &pkt, KIND_TREE, &elem_size, &count);
+    if (loc_err != SUCCESS) {
+        free_packet_buffers(&pkt);
+        set_err(err, loc_err);
+        return NULL;
+    }
+    tree_t *tree = high_fanout ? tree_new_btree(free_f, cmp_f, &loc_err)
+                               : tree_new(free_f, cmp_f, &loc_err);
+    if (tree == NULL) {
+        free_packet_buffers(&pkt);
+        set_err(err, loc_err);
+        return NULL;
+    }
+    uint64_t remaining = count;
+    while (loc_err == SUCCESS && remaining > 0) {
+        loc_err = read_pkt_into(io_info, &pkt);
+        if (loc_err != SUCCESS) {
+            break;
+        }
+        if (pkt.hdr->data_type != CONTAINER_PKT_DATA) {
+            loc_err = EPROTO;
+            break;
+        }
+        loc_err = tree_decode_packet(&pkt, des, free_f, tree, &remaining);
+    }
+    free_packet_buffers(&pkt);
+    if (loc_err != SUCCESS) {
+        tree_delete(&tree);
+        set_err(err, loc_err);
+        return NULL;
+    }
+    return tree;
+}
+
+int arr_list_serialize(arr_list_t *list, io_info_t *io_info) {
+    if (list == NULL || io_info == NULL) {
+        return EINVAL;
+    }
+    ssize_t size;
+    int err = arr_list_query(list, QUERY_SIZE, &size);
+    if (err != SUCCESS) {
+        return err;
+    }
+    ssize_t elem_size;
+    err = arr_list_query(list, QUERY_ELEM_SIZE, &elem_size);
+    if (err != SUCCESS) {
+        return err;
+    }
+    err = write_stream_hdr(io_info, KIND_ARR_LIST, (uint32_t)elem_size,
+                           (uint64_t)size);
+    if (err != SUCCESS) {
+        return err;
+    }
+    // the backing array is contiguous, so chunks stream straight out of it
+    size_t per_pkt = BATCH_CAP / (size_t)elem_size;
+    if (per_pkt == 0) {
+        per_pkt = 1;
+    }
+    for (size_t at = 0; at < (size_t)size; at += per_pkt) {
+        size_t n = (size_t)size - at;
+        if (n > per_pkt) {
+            n = per_pkt;
+        }
+        err = write_pkt_data(io_info, arr_list_get(list, at),
+                             n * (size_t)elem_size, CONTAINER_PKT_DATA);
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+    return SUCCESS;
+}
+
+arr_list_t *arr_list_deserialize(io_info_t *io_info, FREE_F free_f,
+                                 CMP_F cmp_f, int *err) {
+    if (io_info == NULL) {
+        set_err(err, EINVAL);
+        return NULL;
+    }
+    struct packet pkt = {0};
+    uint32_t elem_size;
+    uint64_t count;
+    int loc_err =
+        read_stream_hdr(io_info, &pkt, KIND_ARR_LIST, &elem_size, &count);
+    if (loc_err == SUCCESS && elem_size == 0) {
+        loc_err = EPROTO;
+    }
+    if (loc_err != SUCCESS) {
+        free_packet_buffers(&pkt);
+        set_err(err, loc_err);
+        return NULL;
+    }
+    // sized for the whole stream up front so loading never reallocates
+    arr_list_t *list = arr_list_new(free_f, cmp_f, count > 0 ? count : 1,
+                                    elem_size, &loc_err);
+    if (list == NULL) {
+        free_packet_buffers(&pkt);
+        set_err(err, loc_err);
+        return NULL;
+    }
+    uint64_t remaining = count;
+    while (remaining > 0) {
+        loc_err = read_pkt_into(io_info, &pkt);
+        if (loc_err != SUCCESS) {
+            break;
+        }
+        if (pkt.hdr->data_type != CONTAINER_PKT_DATA ||
+            pkt.hdr->data_len % elem_size != 0) {
+            loc_err = EPROTO;
+            break;
+        }
+        size_t n = pkt.hdr->data_len / elem_size;
+        if (n > remaining) {
+            // more elements than the stream header advertised
+            loc_err = EPROTO;
+            break;
+        }
+        loc_err = arr_list_extend(list, pkt.data, n);
+        if (loc_err != SUCCESS) {
+            break;
+        }
+        remaining -= n;
+    }
+    free_packet_buffers(&pkt);
+    if (loc_err != SUCCESS) {
+        arr_list_delete(list);
+        set_err(err, loc_err);
+        return NULL;
+    }
+    return list;
+}
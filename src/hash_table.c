@@ -1,64 +1,151 @@
 #include "hash_table.h"
+#include "bb_stats.h"
 #include "buildingblocks.h"
 #include "linked_list.h"
 #include <errno.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* DATA */
 
 #define GROWTH_FACTOR 2 // amount to grow table by when resizing
 #define MAX_LOAD 75     // max load factor before resizing
+#define MIGRATE_BATCH 4 // old buckets migrated per table operation
 #define PRIME 6967      // prime number for hash algo
 #define CONTINUE 0      // return value keep iterating
 #define STOP 1          // return value to stop iterating
 #define SUCCESS 0       // return value for success
 #define INVALID -1      // return value for invalid arguments
 
+// open-addressing slot states
+#define SLOT_EMPTY 0    // slot has never held an entry
+#define SLOT_OCCUPIED 1 // slot currently holds an entry
+#define SLOT_DELETED 2  // slot held an entry that was removed
+
+// recognized built-in comparators, so scans can compare keys inline
+// instead of through the comparator pointer
+#define FAST_CMP_NONE 0 // user comparator, called indirectly
+#define FAST_CMP_U32 1  // cmp_u32: keys are uint32_t
+#define FAST_CMP_U64 2  // cmp_u64: keys are uint64_t
+
 /**
  * @brief structure of a table_node_t object
  *
  * @param key       pointer to the saved keyvalue string
  * @param data      saved data pointer
+ * @param hash      cached full hash of the key
  * @param compare   pointer to the user defined key compare function
  */
 typedef struct table_node_t {
     const void *key;
     void *data;
+    size_t hash;
     CMP_F compare;
 } table_node_t;
 
+/**
+ * @brief search target used when probing a bucket for a key
+ *
+ * Bundles the key with its pre-computed hash so bucket compares can reject
+ * mismatched nodes without calling the user compare function.
+ *
+ * @param key       the key being searched for
+ * @param hash      full hash of the key
+ * @param fast_cmp  the table's recognized-comparator kind
+ */
+struct key_query_t {
+    const void *key;
+    size_t hash;
+    int fast_cmp;
+};
+
+/**
+ * @brief structure of a table_slot_t object
+ *
+ * One slot of an open-addressing table. The full hash of the key is cached
+ * so probing can reject mismatched slots without calling the user compare
+ * function, and so resizing never re-hashes keys.
+ *
+ * @param key       pointer to the saved keyvalue string
+ * @param data      saved data pointer
+ * @param hash      cached full hash of the key
+ * @param state     SLOT_EMPTY, SLOT_OCCUPIED, or SLOT_DELETED
+ */
+typedef struct table_slot_t {
+    const void *key;
+    void *data;
+    size_t hash;
+    uint8_t state;
+} table_slot_t;
+
 /**
  * @brief structure of a hash_table_t object
  *
- * Table will have N slots, with each slot holding a table_node_t
- * Upon table insertion, hash algo will determine which slot to store data
- * If that slot is null, insert new table_node_t there
- * If not null (collision), traverse to end of list and append new table_node_t
+ * In chained mode, the table has N slots, with each slot holding a list of
+ * table_node_t. Upon table insertion, hash algo will determine which slot
+ * to store data. If that slot is null, insert new table_node_t there. If
+ * not null (collision), traverse to end of list and append new
+ * table_node_t.
+ *
+ * In open-addressing mode, all entries live in one contiguous array of
+ * table_slot_t. Collisions are resolved by linear probing from the hashed
+ * position, and removals leave tombstones so later probes are not cut
+ * short.
+ *
+ * Chained growth is incremental: when the load threshold is crossed, a new
+ * bucket array is allocated and the old one is kept around. Each insert
+ * migrates a few old buckets (plus the bucket its own key hashes to) into
+ * the new array, so growth cost is amortized over subsequent operations
+ * instead of being paid as one stop-the-world rebuild.
  *
  * @param capacity      number of positions supported by table
  * @param size          number of elements in table
- * @param buckets       the buckets of table_node_t
+ * @param used          occupied plus tombstoned slots (open mode only)
+ * @param mode          storage mode of the table
+ * @param buckets       the buckets of table_node_t (chained mode)
+ * @param old_buckets   bucket array still being migrated from, or NULL
+ * @param old_capacity  number of positions in old_buckets
+ * @param migrate_idx   next old bucket to migrate
+ * @param slots         the contiguous slot array (open mode)
  * @param customfree    pointer to the user defined free function
  * @param compare       pointer to the user defined key compare function
+ * @param hash_f        pointer to the user defined hash function, or NULL
+ * @param key_len       length of every key, or 0 for string keys
+ * @param fast_cmp      recognized-comparator kind, FAST_CMP_NONE otherwise
+ * @param allocator     memory allocator for the table internals
  */
 struct hash_table_t {
     size_t capacity;
     size_t size;
+    size_t used;
+    int mode;
     list_t **buckets;
+    list_t **old_buckets;
+    size_t old_capacity;
+    size_t migrate_idx;
+    table_slot_t *slots;
     FREE_F customfree;
     CMP_F compare;
+    HASH_F hash_f;
+    size_t key_len;
+    int fast_cmp;
+    allocator_t allocator;
 };
 
 /**
  * @brief structure used to pass data to list_foreach_call
  *
  * @param cmp_key       key to compare against
+ * @param cmp_hash      full hash of cmp_key
+ * @param fast_cmp      the table's recognized-comparator kind
  * @param data          data to be stored at that key value
  * @param customfree    pointer to the user defined free function
  */
 struct lookup_data_t {
     const void *cmp_key;
+    size_t cmp_hash;
+    int fast_cmp;
     void *data;
     FREE_F customfree;
 };
@@ -76,6 +163,55 @@ struct action_data_t {
 
 /* PRIVATE FUNCTIONS */
 
+/**
+ * @brief Classify a comparator as one of the recognized built-ins.
+ *
+ * @param cmp_f the comparator to classify
+ * @return int the FAST_CMP_* kind, FAST_CMP_NONE for user comparators
+ */
+static int fast_cmp_kind(CMP_F cmp_f) {
+    if (cmp_f == cmp_u32) {
+        return FAST_CMP_U32;
+    } else if (cmp_f == cmp_u64) {
+        return FAST_CMP_U64;
+    }
+    return FAST_CMP_NONE;
+}
+
+/**
+ * @brief Check two keys for equality, inlining recognized comparators.
+ *
+ * For the built-in integer comparators the compare is a direct load and
+ * compare; everything else goes through the comparator pointer.
+ *
+ * @param fast_cmp the FAST_CMP_* kind of the comparator
+ * @param compare the comparator to fall back to
+ * @param a the key being searched for
+ * @param b the stored key to compare against
+ * @return int non-zero if the keys are equal, 0 otherwise
+ */
+static inline int keys_match(int fast_cmp, CMP_F compare, const void *a,
+                             const void *b) {
+    switch (fast_cmp) {
+    case FAST_CMP_U32: {
+        uint32_t x;
+        uint32_t y;
+        memcpy(&x, a, sizeof(x));
+        memcpy(&y, b, sizeof(y));
+        return x == y;
+    }
+    case FAST_CMP_U64: {
+        uint64_t x;
+        uint64_t y;
+        memcpy(&x, a, sizeof(x));
+        memcpy(&y, b, sizeof(y));
+        return x == y;
+    }
+    default:
+        return compare(a, b) == 0;
+    }
+}
+
 /**
  * @brief Comparison function to pass to list_new.
  *
@@ -88,24 +224,172 @@ static int map_node_cmp(const void *to_find, const void *node_data) {
         // if somehow node_data is NULL, return 0 so order is not changed
         return 0;
     }
+    const struct key_query_t *query = to_find;
     const struct table_node_t *table_node = node_data;
-    return table_node->compare(to_find, table_node->key);
+    if (query->hash != table_node->hash) {
+        // hashes differ, keys cannot match
+        return 1;
+    }
+    if (query->fast_cmp != FAST_CMP_NONE) {
+        return !keys_match(query->fast_cmp, table_node->compare, query->key,
+                           table_node->key);
+    }
+    return table_node->compare(query->key, table_node->key);
 }
 
 /**
- * @brief Hash function to determine which slot to store data.
+ * @brief Built-in byte-wise hash.
+ *
+ * A non-zero key_len bounds the bytes read so binary keys need no
+ * terminator; a key_len of 0 treats the key as a NUL-terminated string.
  *
- * @param data the key to hash
- * @param capacity the capacity of the table
- * @return size_t the index of the slot to store data
+ * @param key the key to hash
+ * @param key_len length of the key, or 0 for string keys
+ * @return size_t the hash of the key
  */
-static size_t hash(const void *data, size_t capacity) {
+static size_t hash_bytes(const void *key, size_t key_len) {
     size_t hash = PRIME;
-    const uint8_t *bytes = data;
+    const uint8_t *bytes = key;
+    if (key_len != 0) {
+        for (size_t n = 0; n < key_len; ++n) {
+            hash += bytes[n];
+        }
+        return hash;
+    }
     while (*(bytes++)) {
         hash += *bytes;
     }
-    return hash % capacity;
+    return hash;
+}
+
+/**
+ * @brief Compute the full hash of a key.
+ *
+ * Uses the table's custom hash function when one was supplied, otherwise
+ * the built-in byte-wise hash.
+ *
+ * @param table the table the key belongs to
+ * @param key the key to hash
+ * @return size_t the hash of the key
+ */
+static size_t hash_key(const hash_table_t *table, const void *key) {
+    if (table->hash_f != NULL) {
+        return table->hash_f(key, table->key_len);
+    }
+    return hash_bytes(key, table->key_len);
+}
+
+/**
+ * @brief Find the slot for a key in an open-addressing table.
+ *
+ * Probes linearly from the hashed position. If the key is found, the
+ * occupied slot holding it is returned. Otherwise the first reusable slot
+ * (tombstone or empty) seen along the probe path is returned, so the
+ * caller can insert there without lengthening the probe sequence.
+ *
+ * @param table the table to probe
+ * @param key the key to find
+ * @param key_hash full hash of the key
+ * @return table_slot_t * the matching or insertable slot
+ */
+static table_slot_t *probe_slots(const hash_table_t *table, const void *key,
+                                 size_t key_hash) {
+    table_slot_t *insert_at = NULL;
+    size_t idx = key_hash % table->capacity;
+    for (size_t n = 0; n < table->capacity; ++n) {
+        table_slot_t *slot = &table->slots[idx];
+        if (slot->state == SLOT_EMPTY) {
+            bb_stats_record(BB_STAT_HASH_PROBE_LEN, n + 1);
+            return insert_at != NULL ? insert_at : slot;
+        } else if (slot->state == SLOT_DELETED) {
+            if (insert_at == NULL) {
+                insert_at = slot;
+            }
+        } else if (slot->hash == key_hash &&
+                   keys_match(table->fast_cmp, table->compare, key,
+                              slot->key)) {
+            bb_stats_record(BB_STAT_HASH_PROBE_LEN, n + 1);
+            return slot;
+        }
+        idx = (idx + 1) % table->capacity;
+    }
+    bb_stats_record(BB_STAT_HASH_PROBE_LEN, table->capacity);
+    return insert_at;
+}
+
+/**
+ * @brief Resize an open-addressing table.
+ *
+ * Occupied slots are re-inserted into a fresh array using their cached
+ * hashes; tombstones are dropped in the process.
+ *
+ * @param table the table to resize
+ * @param new_capacity number of slots in the new array
+ * @return int 0 on success, non-zero on failure
+ */
+static int resize_slots(hash_table_t *table, size_t new_capacity) {
+    table_slot_t *new_slots =
+        mem_zalloc(&table->allocator, new_capacity * sizeof(*new_slots));
+    if (new_slots == NULL) {
+        return ENOMEM;
+    }
+
+    for (size_t n = 0; n < table->capacity; ++n) {
+        table_slot_t *old = &table->slots[n];
+        if (old->state != SLOT_OCCUPIED) {
+            continue;
+        }
+        size_t idx = old->hash % new_capacity;
+        while (new_slots[idx].state == SLOT_OCCUPIED) {
+            idx = (idx + 1) % new_capacity;
+        }
+        new_slots[idx] = *old;
+    }
+
+    mem_free(&table->allocator, table->slots);
+    table->slots = new_slots;
+    table->capacity = new_capacity;
+    table->used = table->size;
+    bb_stats_record(BB_STAT_HASH_RESIZES, new_capacity);
+    return SUCCESS;
+}
+
+/**
+ * @brief Add or update an item in an open-addressing table.
+ *
+ * @param table the table to add to
+ * @param data data to be stored at that key value
+ * @param key key for data to be stored at
+ * @return int 0 on success, non-zero on failure
+ */
+static int slot_set(hash_table_t *table, void *data, const void *key) {
+    // Resize if used slots exceed MAX_LOAD percent of capacity, counting
+    // tombstones so probe chains stay short
+    if (100 * table->used / table->capacity > MAX_LOAD) {
+        int err = resize_slots(table, GROWTH_FACTOR * table->capacity);
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+
+    size_t key_hash = hash_key(table, key);
+    table_slot_t *slot = probe_slots(table, key, key_hash);
+    if (slot->state == SLOT_OCCUPIED) {
+        if (table->customfree) {
+            table->customfree(slot->data);
+        }
+        slot->data = data;
+        return SUCCESS;
+    }
+    if (slot->state == SLOT_EMPTY) {
+        table->used++;
+    }
+    slot->key = key;
+    slot->data = data;
+    slot->hash = key_hash;
+    slot->state = SLOT_OCCUPIED;
+    table->size++;
+    return SUCCESS;
 }
 
 /**
@@ -126,73 +410,117 @@ static int action_wrapper(void **node, void *addl_data) {
 }
 
 /**
- * @brief Copy the node into a new position into the table.
+ * @brief Get the bucket object
  *
- * @param node_data the node to be copied
- * @param addl_data the table to copy to
- * @return int 0 on success, non-zero on failure
+ * @param table the table to get the bucket from
+ * @param idx index of the bucket in the current bucket array
+ * @return list_t* the bucket
  */
-static int copy_node(void **node_data, void *addl_data) {
-    if (node_data == NULL || *node_data == NULL || addl_data == NULL) {
-        return EINVAL;
+static list_t *get_bucket(hash_table_t *table, size_t idx) {
+    if (table == NULL) {
+        return NULL;
     }
-    table_node_t *table_node = *node_data;
-    hash_table_t *table = addl_data;
-
-    size_t idx = hash(table_node->key, table->capacity);
-    if (table->buckets[idx] == NULL) {
+    list_t *bucket = table->buckets[idx];
+    // if hash does not exist, create new list
+    if (bucket == NULL) {
         // list will not manage memory of table_node
-        table->buckets[idx] = list_new(NULL, map_node_cmp, NULL);
-        if (table->buckets[idx] == NULL) {
-            return ENOMEM;
+        bucket = list_new_alloc(NULL, map_node_cmp, &table->allocator, NULL);
+        if (bucket == NULL) {
+            return NULL;
         }
+        table->buckets[idx] = bucket;
     }
-    return list_push_head(table->buckets[idx], table_node);
+    return bucket;
 }
 
 /**
- * @brief Resize the table.
+ * @brief Begin an incremental resize of a chained table.
+ *
+ * The current bucket array is set aside as old_buckets and a fresh,
+ * larger array takes its place. No entries are moved here; migration
+ * happens a few buckets at a time in later table operations. If a
+ * migration is already in progress, nothing is done.
  *
  * @param table the table to resize
+ * @param new_capacity number of buckets in the new array
  * @return int 0 on success, non-zero on failure
  */
-static int resize_table(hash_table_t *table) {
-    if (table == NULL) {
-        return EINVAL;
+static int start_resize(hash_table_t *table, size_t new_capacity) {
+    if (table->old_buckets != NULL) {
+        // previous growth is still migrating
+        return SUCCESS;
     }
-    list_t **copy_arr =
-        calloc(GROWTH_FACTOR * table->capacity, sizeof(*copy_arr));
-    if (copy_arr == NULL) {
+    list_t **new_buckets =
+        mem_zalloc(&table->allocator, new_capacity * sizeof(*new_buckets));
+    if (new_buckets == NULL) {
         return ENOMEM;
     }
-    // Adjust to new capacity
-    hash_table_t copy_table = {
-        .capacity = GROWTH_FACTOR * table->capacity,
-        .buckets = copy_arr,
-    };
+    table->old_buckets = table->buckets;
+    table->old_capacity = table->capacity;
+    table->migrate_idx = 0;
+    table->buckets = new_buckets;
+    table->capacity = new_capacity;
+    bb_stats_record(BB_STAT_HASH_RESIZES, new_capacity);
+    return SUCCESS;
+}
 
-    for (size_t n = 0; n < table->capacity; ++n) {
-        if (table->buckets[n] == NULL) {
-            continue;
+/**
+ * @brief Move one old bucket's entries into the new bucket array.
+ *
+ * Nodes are popped one at a time so a mid-bucket allocation failure never
+ * leaves an entry reachable from both arrays.
+ *
+ * @param table the table being migrated
+ * @param idx index of the bucket in old_buckets
+ * @return int 0 on success, non-zero on failure
+ */
+static int migrate_bucket(hash_table_t *table, size_t idx) {
+    list_t *old_bucket = table->old_buckets[idx];
+    if (old_bucket == NULL) {
+        return SUCCESS;
+    }
+    table_node_t *node = list_pop_head(old_bucket);
+    while (node != NULL) {
+        // cached hash means migration never re-hashes the key
+        list_t *new_bucket = get_bucket(table, node->hash % table->capacity);
+        if (new_bucket == NULL || list_push_head(new_bucket, node) != SUCCESS) {
+            // put the node back so it is not lost; retry on a later call
+            list_push_head(old_bucket, node);
+            return ENOMEM;
         }
-        int err = list_foreach_call(table->buckets[n], copy_node, &copy_table);
+        node = list_pop_head(old_bucket);
+    }
+    return list_delete(&table->old_buckets[idx]);
+}
+
+/**
+ * @brief Advance the in-progress migration by a bounded amount.
+ *
+ * Migrates up to MIGRATE_BATCH old buckets, then releases the old array
+ * once every bucket has been moved. Does nothing when no migration is in
+ * progress.
+ *
+ * @param table the table being migrated
+ * @return int 0 on success, non-zero on failure
+ */
+static int migrate_step(hash_table_t *table) {
+    if (table->old_buckets == NULL) {
+        return SUCCESS;
+    }
+    for (int n = 0;
+         n < MIGRATE_BATCH && table->migrate_idx < table->old_capacity; ++n) {
+        int err = migrate_bucket(table, table->migrate_idx);
         if (err != SUCCESS) {
-            for (size_t i = 0; i < n; i++) {
-                list_delete(&copy_arr[i]);
-            }
-            free(copy_arr);
             return err;
         }
+        table->migrate_idx++;
     }
-
-    // replace table with copy
-    for (size_t i = 0; i < table->capacity; i++) {
-        list_delete(&table->buckets[i]);
+    if (table->migrate_idx >= table->old_capacity) {
+        mem_free(&table->allocator, table->old_buckets);
+        table->old_buckets = NULL;
+        table->old_capacity = 0;
+        table->migrate_idx = 0;
     }
-    free(table->buckets);
-    table->buckets = copy_arr;
-    table->capacity *= GROWTH_FACTOR;
-
     return SUCCESS;
 }
 
@@ -210,7 +538,9 @@ static int replace_existing(void **node_data, void *addl_data) {
     table_node_t *table_node = *node_data;
     struct lookup_data_t *lookup_data = addl_data;
 
-    if (table_node->compare(table_node->key, lookup_data->cmp_key) == 0) {
+    if (table_node->hash == lookup_data->cmp_hash &&
+        keys_match(lookup_data->fast_cmp, table_node->compare,
+                   table_node->key, lookup_data->cmp_key)) {
         if (lookup_data->customfree) {
             lookup_data->customfree(table_node->data);
         }
@@ -220,85 +550,295 @@ static int replace_existing(void **node_data, void *addl_data) {
     return CONTINUE;
 }
 
-/**
- * @brief Get the bucket object
- *
- * @param table the table to get the bucket from
- * @param key the key to get the bucket for
- * @return list_t* the bucket
- */
-static list_t *get_bucket(hash_table_t *table, const void *key) {
-    if (table == NULL) {
-        return NULL;
-    }
-    size_t idx = hash(key, table->capacity);
-    list_t *bucket = table->buckets[idx];
-    // if hash does not exist, create new list
-    if (bucket == NULL) {
-        // list will not manage memory of table_node
-        bucket = list_new(NULL, map_node_cmp, NULL);
-        if (bucket == NULL) {
-            return NULL;
-        }
-        table->buckets[idx] = bucket;
-    }
-    return bucket;
-}
-
 /**
  * @brief Insert a new node into the bucket.
  *
+ * @param table the table the bucket belongs to
  * @param key the key to insert
+ * @param key_hash full hash of the key
  * @param data the data to insert
  * @param bucket the bucket to insert into
- * @param compare the key compare function to use
  * @return int 0 on success, non-zero on failure
  */
-static int insert_into_bucket(const void *key, void *data, list_t *bucket,
-                              CMP_F compare) {
-    if (compare == NULL || bucket == NULL) {
+static int insert_into_bucket(hash_table_t *table, const void *key,
+                              size_t key_hash, void *data, list_t *bucket) {
+    if (table->compare == NULL || bucket == NULL) {
         return EINVAL;
     }
-    table_node_t *new = malloc(sizeof(*new));
+    table_node_t *new = mem_alloc(&table->allocator, sizeof(*new));
     if (new == NULL) {
         return ENOMEM;
     }
 
     new->key = key;
     new->data = data;
-    new->compare = compare;
+    new->hash = key_hash;
+    new->compare = table->compare;
     int err = list_push_head(bucket, new);
     if (err != SUCCESS) {
-        free(new);
+        mem_free(&table->allocator, new);
         return err;
     }
     return SUCCESS;
 }
 
+/**
+ * @brief Callback invoked for every entry by for_each_entry.
+ *
+ * @param key key of the entry
+ * @param data data stored at that key
+ * @param hash cached full hash of the key
+ * @param ctx caller context
+ * @return int 0 to continue, non-zero to stop
+ */
+typedef int (*ENTRY_CB)(const void *key, void *data, size_t hash, void *ctx);
+
+/**
+ * @brief Visit every entry of the table, regardless of storage mode.
+ *
+ * Covers open-addressing slots, chained buckets, and any chained buckets
+ * still waiting to be migrated.
+ *
+ * @param table the table to walk
+ * @param cb callback invoked per entry
+ * @param ctx context passed through to the callback
+ * @return int 0 on success, or the callback's non-zero return value
+ */
+static int for_each_entry(hash_table_t *table, ENTRY_CB cb, void *ctx) {
+    if (table->mode == HASH_TABLE_MODE_OPEN) {
+        for (size_t n = 0; n < table->capacity; ++n) {
+            table_slot_t *slot = &table->slots[n];
+            if (slot->state != SLOT_OCCUPIED) {
+                continue;
+            }
+            int err = cb(slot->key, slot->data, slot->hash, ctx);
+            if (err != SUCCESS) {
+                return err;
+            }
+        }
+        return SUCCESS;
+    }
+    for (int pass = 0; pass < 2; ++pass) {
+        list_t **buckets = pass == 0 ? table->buckets : table->old_buckets;
+        size_t capacity = pass == 0 ? table->capacity : table->old_capacity;
+        if (buckets == NULL) {
+            continue;
+        }
+        for (size_t n = 0; n < capacity; ++n) {
+            if (buckets[n] == NULL) {
+                continue;
+            }
+            list_iterator_reset(buckets[n]);
+            table_node_t *node = list_iterator_next(buckets[n], NULL);
+            while (node != NULL) {
+                int err = cb(node->key, node->data, node->hash, ctx);
+                if (err != SUCCESS) {
+                    return err;
+                }
+                node = list_iterator_next(buckets[n], NULL);
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+#define FROZEN_MAGIC 0x465442484F52465AULL // identifies a frozen snapshot
+
+/**
+ * @brief Header at the start of a frozen snapshot buffer.
+ *
+ * All offsets in the snapshot are relative to the start of the buffer, so
+ * the buffer can be written to disk and mapped at any address.
+ *
+ * @param magic identifies the buffer as a frozen snapshot
+ * @param slot_count number of slots in the probe array
+ * @param size number of entries stored
+ * @param key_len fixed key length, or 0 for string keys
+ * @param value_len bytes stored per value, or 0 for raw pointers
+ */
+struct frozen_header_t {
+    uint64_t magic;
+    uint64_t slot_count;
+    uint64_t size;
+    uint64_t key_len;
+    uint64_t value_len;
+};
+
+/**
+ * @brief One slot of a frozen snapshot's probe array.
+ *
+ * @param hash cached full hash of the key
+ * @param key_off offset of the key bytes, or 0 if the slot is empty
+ * @param key_size number of key bytes stored
+ * @param value_off offset of the value bytes
+ */
+struct frozen_slot_t {
+    uint64_t hash;
+    uint64_t key_off;
+    uint64_t key_size;
+    uint64_t value_off;
+};
+
+/**
+ * @brief Context threaded through the freeze passes.
+ *
+ * @param table the table being frozen
+ * @param buf the snapshot buffer being filled
+ * @param header header at the start of buf
+ * @param slots probe array inside buf
+ * @param key_bytes total key bytes (sizing pass)
+ * @param data_off next free offset in the data region (fill pass)
+ */
+struct freeze_ctx_t {
+    hash_table_t *table;
+    uint8_t *buf;
+    struct frozen_header_t *header;
+    struct frozen_slot_t *slots;
+    size_t key_bytes;
+    size_t data_off;
+};
+
+/**
+ * @brief Number of bytes a key occupies in a snapshot.
+ *
+ * @param table the table the key belongs to
+ * @param key the key to measure
+ * @return size_t the key size in bytes
+ */
+static size_t frozen_key_size(const hash_table_t *table, const void *key) {
+    // string keys keep their terminator so compare functions still work
+    return table->key_len != 0 ? table->key_len : strlen(key) + 1;
+}
+
+/**
+ * @brief Sizing pass callback: accumulate total key bytes.
+ *
+ * @param key key of the entry
+ * @param data Not used
+ * @param hash Not used
+ * @param ctx the freeze_ctx_t being filled
+ * @return int always 0
+ */
+static int freeze_measure(const void *key, void *data, size_t hash,
+                          void *ctx) {
+    (void)data;
+    (void)hash;
+    struct freeze_ctx_t *freeze = ctx;
+    freeze->key_bytes += frozen_key_size(freeze->table, key);
+    return SUCCESS;
+}
+
+/**
+ * @brief Fill pass callback: place one entry into the snapshot.
+ *
+ * @param key key of the entry
+ * @param data data stored at that key
+ * @param hash cached full hash of the key
+ * @param ctx the freeze_ctx_t being filled
+ * @return int always 0
+ */
+static int freeze_fill(const void *key, void *data, size_t hash, void *ctx) {
+    struct freeze_ctx_t *freeze = ctx;
+    struct frozen_header_t *header = freeze->header;
+
+    // linear probe for the first empty slot; no removals ever happen in a
+    // snapshot so there are no tombstones to account for
+    size_t idx = hash % header->slot_count;
+    while (freeze->slots[idx].key_off != 0) {
+        idx = (idx + 1) % header->slot_count;
+    }
+    struct frozen_slot_t *slot = &freeze->slots[idx];
+
+    size_t key_size = frozen_key_size(freeze->table, key);
+    slot->hash = hash;
+    slot->key_off = freeze->data_off;
+    slot->key_size = key_size;
+    memcpy(freeze->buf + freeze->data_off, key, key_size);
+    freeze->data_off += key_size;
+
+    slot->value_off = freeze->data_off;
+    if (header->value_len != 0) {
+        memcpy(freeze->buf + freeze->data_off, data, header->value_len);
+        freeze->data_off += header->value_len;
+    } else {
+        // store the pointer value itself for in-process snapshots
+        memcpy(freeze->buf + freeze->data_off, &data, sizeof(data));
+        freeze->data_off += sizeof(data);
+    }
+    return SUCCESS;
+}
+
 /* PUBLIC FUNCTIONS */
 
 hash_table_t *hash_table_init(size_t capacity, FREE_F free_f, CMP_F cmp_f,
                               int *err) {
+    return hash_table_init_mode(capacity, free_f, cmp_f,
+                                HASH_TABLE_MODE_CHAINED, err);
+}
+
+hash_table_t *hash_table_init_mode(size_t capacity, FREE_F free_f, CMP_F cmp_f,
+                                   int mode, int *err) {
+    return hash_table_init_hash(capacity, free_f, cmp_f, NULL, 0, mode, err);
+}
+
+hash_table_t *hash_table_init_hash(size_t capacity, FREE_F free_f, CMP_F cmp_f,
+                                   HASH_F hash_f, size_t key_len, int mode,
+                                   int *err) {
+    return hash_table_init_alloc(capacity, free_f, cmp_f, hash_f, key_len,
+                                 mode, NULL, err);
+}
+
+hash_table_t *hash_table_init_alloc(size_t capacity, FREE_F free_f,
+                                    CMP_F cmp_f, HASH_F hash_f, size_t key_len,
+                                    int mode, const allocator_t *allocator,
+                                    int *err) {
     if (cmp_f == NULL) {
         set_err(err, EINVAL);
         return NULL;
     }
-    hash_table_t *table = malloc(sizeof(*table));
+    if (mode != HASH_TABLE_MODE_CHAINED && mode != HASH_TABLE_MODE_OPEN) {
+        set_err(err, ENOTSUP);
+        return NULL;
+    }
+    hash_table_t *table = mem_alloc(allocator, sizeof(*table));
     if (table == NULL) {
         set_err(err, ENOMEM);
         return NULL;
     }
+    table->allocator =
+        allocator != NULL ? *allocator : (allocator_t){0};
 
     table->capacity = capacity == 0 ? HASH_TABLE_DEFAULT_CAPACITY : capacity;
-    table->buckets = calloc(table->capacity, sizeof(*(table->buckets)));
-    if (table->buckets == NULL) {
-        free(table);
-        set_err(err, ENOMEM);
-        return NULL;
+    table->buckets = NULL;
+    table->slots = NULL;
+    if (mode == HASH_TABLE_MODE_OPEN) {
+        table->slots = mem_zalloc(&table->allocator,
+                                  table->capacity * sizeof(*(table->slots)));
+        if (table->slots == NULL) {
+            mem_free(allocator, table);
+            set_err(err, ENOMEM);
+            return NULL;
+        }
+    } else {
+        table->buckets = mem_zalloc(&table->allocator,
+                                    table->capacity * sizeof(*(table->buckets)));
+        if (table->buckets == NULL) {
+            mem_free(allocator, table);
+            set_err(err, ENOMEM);
+            return NULL;
+        }
     }
     table->size = 0;
+    table->used = 0;
+    table->old_buckets = NULL;
+    table->old_capacity = 0;
+    table->migrate_idx = 0;
+    table->mode = mode;
     table->customfree = free_f;
     table->compare = cmp_f;
+    table->fast_cmp = fast_cmp_kind(cmp_f);
+    table->hash_f = hash_f;
+    table->key_len = key_len;
     return table;
 }
 
@@ -322,23 +862,43 @@ int hash_table_set(hash_table_t *table, void *data, const void *key) {
     if (table == NULL || key == NULL) {
         return EINVAL;
     }
+    if (table->mode == HASH_TABLE_MODE_OPEN) {
+        return slot_set(table, data, key);
+    }
 
     int err;
     // Resize if size is greater than MAX_LOAD percent of capacity
-    if (100 * (table->size / table->capacity) > MAX_LOAD) {
-        err = resize_table(table);
+    if (table->old_buckets == NULL &&
+        100 * (table->size / table->capacity) > MAX_LOAD) {
+        err = start_resize(table, GROWTH_FACTOR * table->capacity);
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+    size_t key_hash = hash_key(table, key);
+    if (table->old_buckets != NULL) {
+        // migrate the bucket this key hashes to first, so the key can
+        // never end up reachable from both arrays, then advance the
+        // background migration
+        err = migrate_bucket(table, key_hash % table->old_capacity);
+        if (err != SUCCESS) {
+            return err;
+        }
+        err = migrate_step(table);
         if (err != SUCCESS) {
             return err;
         }
     }
 
-    list_t *curr_list = get_bucket(table, key);
+    list_t *curr_list = get_bucket(table, key_hash % table->capacity);
     if (curr_list == NULL) {
         return ENOMEM;
     }
     // check if key exists
     struct lookup_data_t lookup_data = {
         .cmp_key = key,
+        .cmp_hash = key_hash,
+        .fast_cmp = table->fast_cmp,
         .data = data,
         .customfree = table->customfree,
     };
@@ -347,7 +907,7 @@ int hash_table_set(hash_table_t *table, void *data, const void *key) {
         return SUCCESS;
     } else {
         // Key does not exist, add it
-        err = insert_into_bucket(key, data, curr_list, table->compare);
+        err = insert_into_bucket(table, key, key_hash, data, curr_list);
         if (err == SUCCESS) {
             table->size++;
         }
@@ -355,17 +915,162 @@ int hash_table_set(hash_table_t *table, void *data, const void *key) {
     }
 }
 
+int hash_table_reserve(hash_table_t *table, size_t total) {
+    if (table == NULL) {
+        return EINVAL;
+    }
+    // capacity that keeps total entries under the load threshold
+    size_t needed = total * 100 / MAX_LOAD + 1;
+    if (table->mode == HASH_TABLE_MODE_OPEN) {
+        if (needed <= table->capacity) {
+            return SUCCESS;
+        }
+        return resize_slots(table, needed);
+    }
+    // finish any in-progress migration so only one array is grown
+    int err;
+    while (table->old_buckets != NULL) {
+        err = migrate_step(table);
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+    if (needed <= table->capacity) {
+        return SUCCESS;
+    }
+    err = start_resize(table, needed);
+    if (err != SUCCESS) {
+        return err;
+    }
+    while (table->old_buckets != NULL) {
+        err = migrate_step(table);
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+    return SUCCESS;
+}
+
+int hash_table_set_bulk(hash_table_t *table, const hash_table_kv_t *pairs,
+                        size_t count) {
+    if (table == NULL || pairs == NULL) {
+        return EINVAL;
+    }
+    // one capacity check for the whole batch
+    int err = hash_table_reserve(table, table->size + count);
+    if (err != SUCCESS) {
+        return err;
+    }
+    for (size_t n = 0; n < count; ++n) {
+        err = hash_table_set(table, pairs[n].data, pairs[n].key);
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+    return SUCCESS;
+}
+
 void *hash_table_lookup(const hash_table_t *table, const void *key) {
     if (table == NULL || key == NULL) {
         return NULL;
     } else if (table->size == 0) {
         return NULL;
     }
-    size_t idx = hash(key, table->capacity);
-    table_node_t *node = list_find_first(table->buckets[idx], key, NULL);
+    size_t key_hash = hash_key(table, key);
+    if (table->mode == HASH_TABLE_MODE_OPEN) {
+        table_slot_t *slot = probe_slots(table, key, key_hash);
+        return slot != NULL && slot->state == SLOT_OCCUPIED ? slot->data
+                                                            : NULL;
+    }
+    struct key_query_t query = {
+        .key = key,
+        .hash = key_hash,
+        .fast_cmp = table->fast_cmp,
+    };
+    size_t idx = key_hash % table->capacity;
+    table_node_t *node = list_find_first(table->buckets[idx], &query, NULL);
+    if (node == NULL && table->old_buckets != NULL) {
+        // entry may not have been migrated yet
+        idx = key_hash % table->old_capacity;
+        node = list_find_first(table->old_buckets[idx], &query, NULL);
+    }
     return node != NULL ? node->data : NULL;
 }
 
+int hash_table_freeze(hash_table_t *table, size_t value_len, uint8_t **buf,
+                      size_t *buf_size) {
+    if (table == NULL || buf == NULL || buf_size == NULL) {
+        return EINVAL;
+    }
+
+    struct freeze_ctx_t freeze = {
+        .table = table,
+    };
+    for_each_entry(table, freeze_measure, &freeze);
+
+    // size the probe array so lookups stay under the load threshold
+    size_t slot_count = table->size * 100 / MAX_LOAD + 1;
+    size_t value_size = value_len != 0 ? value_len : sizeof(void *);
+    size_t total = sizeof(struct frozen_header_t) +
+                   slot_count * sizeof(struct frozen_slot_t) +
+                   freeze.key_bytes + table->size * value_size;
+    uint8_t *snapshot = calloc(1, total);
+    if (snapshot == NULL) {
+        return ENOMEM;
+    }
+
+    freeze.buf = snapshot;
+    freeze.header = (struct frozen_header_t *)snapshot;
+    freeze.slots =
+        (struct frozen_slot_t *)(snapshot + sizeof(struct frozen_header_t));
+    freeze.data_off = sizeof(struct frozen_header_t) +
+                      slot_count * sizeof(struct frozen_slot_t);
+    freeze.header->magic = FROZEN_MAGIC;
+    freeze.header->slot_count = slot_count;
+    freeze.header->size = table->size;
+    freeze.header->key_len = table->key_len;
+    freeze.header->value_len = value_len;
+    for_each_entry(table, freeze_fill, &freeze);
+
+    *buf = snapshot;
+    *buf_size = total;
+    return SUCCESS;
+}
+
+void *hash_table_frozen_lookup(const void *frozen, const void *key,
+                               CMP_F cmp_f, HASH_F hash_f) {
+    if (frozen == NULL || key == NULL || cmp_f == NULL) {
+        return NULL;
+    }
+    const struct frozen_header_t *header = frozen;
+    if (header->magic != FROZEN_MAGIC || header->slot_count == 0) {
+        return NULL;
+    }
+    const uint8_t *buf = frozen;
+    const struct frozen_slot_t *slots =
+        (const struct frozen_slot_t *)(buf + sizeof(*header));
+
+    size_t key_hash = hash_f != NULL ? hash_f(key, header->key_len)
+                                     : hash_bytes(key, header->key_len);
+    int fast_cmp = fast_cmp_kind(cmp_f);
+    size_t idx = key_hash % header->slot_count;
+    while (slots[idx].key_off != 0) {
+        const struct frozen_slot_t *slot = &slots[idx];
+        if (slot->hash == key_hash &&
+            keys_match(fast_cmp, cmp_f, key, buf + slot->key_off)) {
+            if (header->value_len != 0) {
+                return (void *)(buf + slot->value_off);
+            }
+            // in-process snapshot: the stored bytes are the pointer itself
+            void *data;
+            memcpy(&data, buf + slot->value_off, sizeof(data));
+            return data;
+        }
+        idx = (idx + 1) % header->slot_count;
+    }
+    return NULL;
+}
+
 int hash_table_iterate(hash_table_t *table, ACT_TABLE_F action,
                        void *addl_data) {
     if (table == NULL || action == NULL) {
@@ -374,6 +1079,20 @@ int hash_table_iterate(hash_table_t *table, ACT_TABLE_F action,
         return SUCCESS;
     }
     int err = SUCCESS;
+    if (table->mode == HASH_TABLE_MODE_OPEN) {
+        for (size_t i = 0; i < table->capacity; i++) {
+            table_slot_t *slot = &table->slots[i];
+            if (slot->state != SLOT_OCCUPIED) {
+                // skip empty and tombstoned slots
+                continue;
+            }
+            err = action(slot->key, &slot->data, addl_data);
+            if (err != CONTINUE) {
+                return err;
+            }
+        }
+        return err;
+    }
     struct action_data_t action_data = {
         .action = action,
         .addl_data = addl_data,
@@ -389,6 +1108,18 @@ int hash_table_iterate(hash_table_t *table, ACT_TABLE_F action,
             return err;
         }
     }
+    // entries still waiting to be migrated live only in the old array
+    for (size_t i = 0; table->old_buckets != NULL && i < table->old_capacity;
+         i++) {
+        if (table->old_buckets[i] == NULL) {
+            continue;
+        }
+        err = list_foreach_call(table->old_buckets[i], action_wrapper,
+                                &action_data);
+        if (err != CONTINUE) {
+            return err;
+        }
+    }
     return err;
 }
 
@@ -398,23 +1129,63 @@ void *hash_table_remove(hash_table_t *table, const void *key) {
     } else if (table->size == 0) {
         return NULL;
     }
-    size_t idx = hash(key, table->capacity);
-    if (table->buckets[idx] == NULL) {
-        return NULL;
+    size_t key_hash = hash_key(table, key);
+    if (table->mode == HASH_TABLE_MODE_OPEN) {
+        table_slot_t *slot = probe_slots(table, key, key_hash);
+        if (slot == NULL || slot->state != SLOT_OCCUPIED) {
+            return NULL;
+        }
+        void *data = slot->data;
+        slot->key = NULL;
+        slot->data = NULL;
+        slot->state = SLOT_DELETED;
+        table->size--;
+        return data;
+    }
+    struct key_query_t query = {
+        .key = key,
+        .hash = key_hash,
+        .fast_cmp = table->fast_cmp,
+    };
+    size_t idx = key_hash % table->capacity;
+    table_node_t *node = NULL;
+    if (table->buckets[idx] != NULL) {
+        node = list_remove(table->buckets[idx], &query, NULL);
+    }
+    if (node == NULL && table->old_buckets != NULL) {
+        // entry may not have been migrated yet
+        idx = key_hash % table->old_capacity;
+        if (table->old_buckets[idx] != NULL) {
+            node = list_remove(table->old_buckets[idx], &query, NULL);
+        }
     }
-    table_node_t *node = list_remove(table->buckets[idx], (void *)key, NULL);
     if (node == NULL) {
         return NULL;
     }
     void *data = node->data;
-    free(node);
+    mem_free(&table->allocator, node);
+    table->size--;
     return data;
 }
 
 int hash_table_clear(hash_table_t *table) {
     if (table == NULL) {
         return EINVAL;
-    } else if (table->size == 0) {
+    }
+    // no size shortcut: a table emptied by removals still owns its
+    // lazily created bucket lists, which must be released here
+    if (table->mode == HASH_TABLE_MODE_OPEN) {
+        for (size_t i = 0; i < table->capacity; i++) {
+            table_slot_t *slot = &table->slots[i];
+            if (slot->state == SLOT_OCCUPIED && table->customfree) {
+                table->customfree(slot->data);
+            }
+            slot->key = NULL;
+            slot->data = NULL;
+            slot->state = SLOT_EMPTY;
+        }
+        table->size = 0;
+        table->used = 0;
         return SUCCESS;
     }
     for (size_t i = 0; i < table->capacity; i++) {
@@ -423,11 +1194,28 @@ int hash_table_clear(hash_table_t *table) {
             if (table->customfree) {
                 table->customfree(curr->data);
             }
-            free(curr);
+            mem_free(&table->allocator, curr);
             curr = list_pop_tail(table->buckets[i]);
         }
         list_delete(&table->buckets[i]);
     }
+    if (table->old_buckets != NULL) {
+        for (size_t i = 0; i < table->old_capacity; i++) {
+            table_node_t *curr = list_pop_tail(table->old_buckets[i]);
+            while (curr != NULL) {
+                if (table->customfree) {
+                    table->customfree(curr->data);
+                }
+                mem_free(&table->allocator, curr);
+                curr = list_pop_tail(table->old_buckets[i]);
+            }
+            list_delete(&table->old_buckets[i]);
+        }
+        mem_free(&table->allocator, table->old_buckets);
+        table->old_buckets = NULL;
+        table->old_capacity = 0;
+        table->migrate_idx = 0;
+    }
     table->size = 0;
     return SUCCESS;
 }
@@ -437,8 +1225,11 @@ int hash_table_destroy(hash_table_t **table_addr) {
         return EINVAL;
     }
     hash_table_clear(*table_addr);
-    free((*table_addr)->buckets);
-    free(*table_addr);
+    // copied out because the allocator lives inside the block being freed
+    allocator_t allocator = (*table_addr)->allocator;
+    mem_free(&allocator, (*table_addr)->buckets);
+    mem_free(&allocator, (*table_addr)->slots);
+    mem_free(&allocator, *table_addr);
     *table_addr = NULL;
     return SUCCESS;
 }
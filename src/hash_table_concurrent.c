@@ -0,0 +1,238 @@
+#include "hash_table_concurrent.h"
+#include "buildingblocks.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* DATA */
+
+#define PRIME 6967 // prime number for stripe hash, matches hash_table.c
+#define SUCCESS 0  // return value for success
+
+/**
+ * @brief One stripe of the concurrent table.
+ *
+ * Each stripe owns an independent hash_table_t and the read/write lock that
+ * guards it. A key always maps to the same stripe, so operations on keys in
+ * different stripes never contend.
+ *
+ * @param table the stripe's private table
+ * @param lock read/write lock guarding the stripe
+ */
+struct table_stripe_t {
+    hash_table_t *table;
+    pthread_rwlock_t lock;
+};
+
+/**
+ * @brief The concurrent hash table object.
+ *
+ * @param stripes array of independent lock-striped tables
+ * @param num_stripes number of stripes in the array
+ * @param hash_f pointer to the user defined hash function, or NULL
+ * @param key_len length of every key, or 0 for string keys
+ */
+struct hash_table_c_t {
+    struct table_stripe_t *stripes;
+    size_t num_stripes;
+    HASH_F hash_f;
+    size_t key_len;
+};
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * @brief Select the stripe a key belongs to.
+ *
+ * Uses the user hash function when one was supplied, otherwise the same
+ * byte-wise hash the core table defaults to, so stripe selection and
+ * in-stripe placement agree on key identity.
+ *
+ * @param table the table the key belongs to
+ * @param key the key to place
+ * @return struct table_stripe_t * the stripe for the key
+ */
+static struct table_stripe_t *get_stripe(hash_table_c_t *table,
+                                         const void *key) {
+    size_t hash;
+    if (table->hash_f != NULL) {
+        hash = table->hash_f(key, table->key_len);
+    } else {
+        hash = PRIME;
+        const uint8_t *bytes = key;
+        if (table->key_len != 0) {
+            for (size_t n = 0; n < table->key_len; ++n) {
+                hash += bytes[n];
+            }
+        } else {
+            while (*(bytes++)) {
+                hash += *bytes;
+            }
+        }
+    }
+    return &table->stripes[hash % table->num_stripes];
+}
+
+/* PUBLIC FUNCTIONS */
+
+hash_table_c_t *hash_table_c_init(size_t capacity, size_t stripes,
+                                  FREE_F free_f, CMP_F cmp_f, int *err) {
+    return hash_table_c_init_hash(capacity, stripes, free_f, cmp_f, NULL, 0,
+                                  err);
+}
+
+hash_table_c_t *hash_table_c_init_hash(size_t capacity, size_t stripes,
+                                       FREE_F free_f, CMP_F cmp_f,
+                                       HASH_F hash_f, size_t key_len,
+                                       int *err) {
+    if (cmp_f == NULL) {
+        set_err(err, EINVAL);
+        return NULL;
+    }
+    hash_table_c_t *table = malloc(sizeof(*table));
+    if (table == NULL) {
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+    table->num_stripes =
+        stripes == 0 ? HASH_TABLE_C_DEFAULT_STRIPES : stripes;
+    table->hash_f = hash_f;
+    table->key_len = key_len;
+    table->stripes = calloc(table->num_stripes, sizeof(*(table->stripes)));
+    if (table->stripes == NULL) {
+        free(table);
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+
+    // spread the requested capacity across the stripes
+    size_t stripe_capacity = capacity / table->num_stripes;
+    for (size_t n = 0; n < table->num_stripes; ++n) {
+        struct table_stripe_t *stripe = &table->stripes[n];
+        stripe->table = hash_table_init_hash(stripe_capacity, free_f, cmp_f,
+                                             hash_f, key_len,
+                                             HASH_TABLE_MODE_CHAINED, err);
+        if (stripe->table == NULL ||
+            pthread_rwlock_init(&stripe->lock, NULL) != SUCCESS) {
+            for (size_t i = 0; i <= n; ++i) {
+                if (table->stripes[i].table != NULL) {
+                    hash_table_destroy(&table->stripes[i].table);
+                }
+                if (i < n) {
+                    pthread_rwlock_destroy(&table->stripes[i].lock);
+                }
+            }
+            free(table->stripes);
+            free(table);
+            set_err(err, ENOMEM);
+            return NULL;
+        }
+    }
+    return table;
+}
+
+int hash_table_c_query(hash_table_c_t *table, int query, ssize_t *result) {
+    if (table == NULL || result == NULL) {
+        return EINVAL;
+    }
+    if (query != QUERY_SIZE && query != QUERY_IS_EMPTY) {
+        return ENOTSUP;
+    }
+    ssize_t total = 0;
+    for (size_t n = 0; n < table->num_stripes; ++n) {
+        struct table_stripe_t *stripe = &table->stripes[n];
+        ssize_t stripe_size = 0;
+        pthread_rwlock_rdlock(&stripe->lock);
+        int err = hash_table_query(stripe->table, QUERY_SIZE, &stripe_size);
+        pthread_rwlock_unlock(&stripe->lock);
+        if (err != SUCCESS) {
+            return err;
+        }
+        total += stripe_size;
+    }
+    *result = query == QUERY_SIZE ? total : total == 0;
+    return SUCCESS;
+}
+
+int hash_table_c_set(hash_table_c_t *table, void *data, const void *key) {
+    if (table == NULL || key == NULL) {
+        return EINVAL;
+    }
+    struct table_stripe_t *stripe = get_stripe(table, key);
+    pthread_rwlock_wrlock(&stripe->lock);
+    int err = hash_table_set(stripe->table, data, key);
+    pthread_rwlock_unlock(&stripe->lock);
+    return err;
+}
+
+void *hash_table_c_lookup(hash_table_c_t *table, const void *key) {
+    if (table == NULL || key == NULL) {
+        return NULL;
+    }
+    struct table_stripe_t *stripe = get_stripe(table, key);
+    pthread_rwlock_rdlock(&stripe->lock);
+    void *data = hash_table_lookup(stripe->table, key);
+    pthread_rwlock_unlock(&stripe->lock);
+    return data;
+}
+
+int hash_table_c_iterate(hash_table_c_t *table, ACT_TABLE_F action,
+                         void *addl_data) {
+    if (table == NULL || action == NULL) {
+        return EINVAL;
+    }
+    int err = SUCCESS;
+    for (size_t n = 0; n < table->num_stripes; ++n) {
+        struct table_stripe_t *stripe = &table->stripes[n];
+        pthread_rwlock_wrlock(&stripe->lock);
+        err = hash_table_iterate(stripe->table, action, addl_data);
+        pthread_rwlock_unlock(&stripe->lock);
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+    return err;
+}
+
+void *hash_table_c_remove(hash_table_c_t *table, const void *key) {
+    if (table == NULL || key == NULL) {
+        return NULL;
+    }
+    struct table_stripe_t *stripe = get_stripe(table, key);
+    pthread_rwlock_wrlock(&stripe->lock);
+    void *data = hash_table_remove(stripe->table, key);
+    pthread_rwlock_unlock(&stripe->lock);
+    return data;
+}
+
+int hash_table_c_clear(hash_table_c_t *table) {
+    if (table == NULL) {
+        return EINVAL;
+    }
+    for (size_t n = 0; n < table->num_stripes; ++n) {
+        struct table_stripe_t *stripe = &table->stripes[n];
+        pthread_rwlock_wrlock(&stripe->lock);
+        int err = hash_table_clear(stripe->table);
+        pthread_rwlock_unlock(&stripe->lock);
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+    return SUCCESS;
+}
+
+int hash_table_c_destroy(hash_table_c_t **table_addr) {
+    if (table_addr == NULL || *table_addr == NULL) {
+        return EINVAL;
+    }
+    hash_table_c_t *table = *table_addr;
+    for (size_t n = 0; n < table->num_stripes; ++n) {
+        hash_table_destroy(&table->stripes[n].table);
+        pthread_rwlock_destroy(&table->stripes[n].lock);
+    }
+    free(table->stripes);
+    free(table);
+    *table_addr = NULL;
+    return SUCCESS;
+}
@@ -10,20 +10,33 @@
 #define SUCCESS 0
 #define INVALID -1
 
+#define DEFAULT_NODES_PER_BLOCK 32 // nodes allocated per pool block
+
 /**
  * @brief structure of a list node
  *
- * @param position is the position in the list relevant to the head (1)
  * @param data void pointer to whatever data that list points to
- * @param prev pointer to the node before it
  * @param next pointer to the node after it
  */
 typedef struct list_node_t {
-    size_t position;
     void *data;
     struct list_node_t *next;
 } list_node_t;
 
+/**
+ * @brief One slab of nodes in the list's pool.
+ *
+ * Blocks are chained so they can all be released at once; the nodes they
+ * hold are handed out sequentially and recycled through the free list.
+ *
+ * @param next pointer to the previously allocated block
+ * @param nodes the nodes carved out of this block
+ */
+struct node_block_t {
+    struct node_block_t *next;
+    list_node_t nodes[];
+};
+
 /**
  * @brief Structure of a list object
  *
@@ -33,6 +46,11 @@ typedef struct list_node_t {
  * @param current pointer to the current node for iteration
  * @param customfree pointer to the user defined free function
  * @param compare_function pointer to the user defined compare function
+ * @param indexed whether the list maintains a positional index
+ * @param index position -> node cache for indexed lists
+ * @param index_size number of valid index entries, 0 when the index is stale
+ * @param index_cap allocated capacity of the index
+ * @param allocator memory allocator for the list and its pool
  */
 struct list_t {
     size_t size;
@@ -41,64 +59,161 @@ struct list_t {
     list_node_t *current;
     FREE_F customfree;
     CMP_F compare_function;
+    struct node_block_t *blocks;
+    list_node_t *free_nodes;
+    size_t block_size;
+    size_t block_used;
+    bool indexed;
+    list_node_t **index;
+    size_t index_size;
+    size_t index_cap;
+    allocator_t allocator;
 };
 
-typedef int (*LOCAL_ACT_F)(list_node_t *node_data, void *addl_data);
+/**
+ * @brief An independent position handle into a list.
+ *
+ * A cursor remembers both the node it is on and the node before it, so
+ * splicing at the cursor is O(1) with no walk from the head. Any number
+ * of cursors may traverse one list at the same time; modifying the list
+ * through one cursor, or through the list functions directly, invalidates
+ * the others.
+ *
+ * @param list the list the cursor traverses
+ * @param prev the node before the current one, NULL at the head
+ * @param current the node the cursor is on, NULL past the end
+ */
+struct list_cursor_t {
+    list_t *list;
+    list_node_t *prev;
+    list_node_t *current;
+};
 
 /* PRIVATE FUNCTIONS*/
 
+/**
+ * @brief Take a node from the list's pool.
+ *
+ * Recycled nodes are served from the free list first; otherwise the node
+ * is a pointer bump out of the newest block, allocating a new block when
+ * the current one is exhausted. Nodes from one block sit contiguously in
+ * memory, which keeps iteration over the list cache friendly.
+ *
+ * @param list list whose pool to allocate from
+ * @return list_node_t* pointer to the node, or NULL on allocation failure
+ */
+static list_node_t *alloc_node(list_t *list) {
+    if (list->free_nodes != NULL) {
+        list_node_t *node = list->free_nodes;
+        list->free_nodes = node->next;
+        return node;
+    }
+    if (list->blocks == NULL || list->block_used == list->block_size) {
+        struct node_block_t *block =
+            mem_alloc(&list->allocator,
+                      sizeof(*block) + (list->block_size * sizeof(*block->nodes)));
+        if (block == NULL) {
+            return NULL;
+        }
+        block->next = list->blocks;
+        list->blocks = block;
+        list->block_used = 0;
+    }
+    return &list->blocks->nodes[list->block_used++];
+}
+
+/**
+ * @brief Return a node to the list's pool.
+ *
+ * The node is pushed onto the free list for reuse; its memory is only
+ * released when the whole list is cleared or deleted.
+ *
+ * @param list list whose pool the node belongs to
+ * @param node node to recycle
+ */
+static void release_node(list_t *list, list_node_t *node) {
+    node->next = list->free_nodes;
+    list->free_nodes = node;
+}
+
 /**
  * @brief Create a new list node.
  *
+ * @param list list whose pool to allocate the node from
  * @param data data to be stored in the node
  * @param next pointer to the next node in the list
- * @param position position of the node in the list
  * @return list_node_t* pointer to the new node
  */
-static list_node_t *create_node(void *data, list_node_t *next,
-                                size_t position) {
-    list_node_t *new_node = malloc(sizeof(*new_node));
+static list_node_t *create_node(list_t *list, void *data, list_node_t *next) {
+    list_node_t *new_node = alloc_node(list);
     if (new_node == NULL) {
         return NULL;
     }
-    new_node->position = position;
     new_node->data = data;
     new_node->next = next;
     return new_node;
 }
 
 /**
- * @brief Increment the position of the node
+ * @brief Rebuild the positional index from the current node order.
+ *
+ * One O(n) walk records every node's address; until the next structural
+ * change, any position can then be resolved with a single array load.
  *
- * @param node The node to be incremented
- * @param data unused
- * @return int 0 on success, EINVAL if node is NULL
+ * @param list indexed list whose index is stale
+ * @return int 0 on success, ENOMEM if the index could not grow
  */
-static int inc_pos(list_node_t *node, void *data) {
-    (void)(data);
-    if (node == NULL) {
-        return EINVAL;
+static int build_index(list_t *list) {
+    if (list->index_cap < list->size) {
+        size_t new_cap = list->index_cap == 0 ? list->block_size
+                                              : list->index_cap;
+        while (new_cap < list->size) {
+            new_cap *= 2;
+        }
+        list_node_t **new_index =
+            mem_resize(&list->allocator, list->index,
+                       list->index_cap * sizeof(*new_index),
+                       new_cap * sizeof(*new_index));
+        if (new_index == NULL) {
+            return ENOMEM;
+        }
+        list->index = new_index;
+        list->index_cap = new_cap;
+    }
+    list_node_t *current_node = list->head;
+    for (size_t i = 0; i < list->size; i++) {
+        list->index[i] = current_node;
+        current_node = current_node->next;
     }
-    node->position++;
+    list->index_size = list->size;
     return SUCCESS;
 }
 
 /**
- * @brief Decrement the position of the node
+ * @brief Find the node at a given position.
  *
- * @param node The node to be decremented
- * @param data unused
- * @return int 0 on success, EINVAL if node is NULL
+ * On an indexed list this is an array load, rebuilding the index first if
+ * a structural change invalidated it. Other lists, or an indexed list
+ * whose index cannot grow, fall back on the forward walk.
+ *
+ * @param list list to look in
+ * @param position position of the node, must be less than the list size
+ * @return list_node_t* the node at that position
  */
-static int dec_pos(list_node_t *node, void *data) {
-    (void)(data);
-    if (node == NULL) {
-        return EINVAL;
+static list_node_t *node_at(const list_t *list, size_t position) {
+    if (list->indexed) {
+        // the index is a cache, so positional reads stay logically const
+        list_t *cache = (list_t *)list;
+        if (cache->index_size == list->size ||
+            build_index(cache) == SUCCESS) {
+            return cache->index[position];
+        }
     }
-    if (node->position > 0) {
-        node->position--;
+    list_node_t *current_node = list->head;
+    for (size_t i = 0; i < position; i++) {
+        current_node = current_node->next;
     }
-    return SUCCESS;
+    return current_node;
 }
 
 /**
@@ -205,34 +320,36 @@ static list_node_t *merge_sort(list_node_t *head, CMP_F cmp_f) {
     return final_head;
 }
 
-/**
- * @brief Perform an action on each node in the list
- *
- * @param head The head of the list
- * @param size The size of the list
- * @param action The action to be performed
- * @param addl_data Additional data to be passed to the action function
- * @return int SUCCESS, or the error code returned by the action function
- */
-static int local_foreach(list_node_t *head, size_t size, LOCAL_ACT_F action,
-                         void *addl_data) {
-    if (head == NULL || action == NULL) {
-        return EINVAL;
+/* PUBLIC FUNCTIONS*/
+
+list_t *list_new(FREE_F free_f, CMP_F cmp_f, int *err) {
+    return list_new_alloc(free_f, cmp_f, NULL, err);
+}
+
+list_t *list_new_alloc(FREE_F free_f, CMP_F cmp_f,
+                       const allocator_t *allocator, int *err) {
+    // the list struct itself comes from the allocator, so the whole
+    // structure lives (and dies) with it
+    list_t *list = mem_zalloc(allocator, sizeof(*list));
+    if (list == NULL) {
+        set_err(err, ENOMEM);
+        return NULL;
     }
-    list_node_t *current_node = head;
-    for (size_t i = 0; i < size; i++) {
-        int err = action(current_node, addl_data);
-        if (err != SUCCESS) {
-            return err;
-        }
-        current_node = current_node->next;
+    list->customfree = free_f;
+    list->compare_function = cmp_f;
+    list->block_size = DEFAULT_NODES_PER_BLOCK;
+    if (allocator != NULL) {
+        list->allocator = *allocator;
     }
-    return SUCCESS;
+    return list;
 }
 
-/* PUBLIC FUNCTIONS*/
-
-list_t *list_new(FREE_F free_f, CMP_F cmp_f, int *err) {
+list_t *list_new_pooled(FREE_F free_f, CMP_F cmp_f, size_t nodes_per_block,
+                        int *err) {
+    if (nodes_per_block == 0) {
+        set_err(err, EINVAL);
+        return NULL;
+    }
     list_t *list = calloc(1, sizeof(*list));
     if (list == NULL) {
         set_err(err, ENOMEM);
@@ -240,6 +357,15 @@ list_t *list_new(FREE_F free_f, CMP_F cmp_f, int *err) {
     }
     list->customfree = free_f;
     list->compare_function = cmp_f;
+    list->block_size = nodes_per_block;
+    return list;
+}
+
+list_t *list_new_indexed(FREE_F free_f, CMP_F cmp_f, int *err) {
+    list_t *list = list_new_pooled(free_f, cmp_f, DEFAULT_NODES_PER_BLOCK, err);
+    if (list != NULL) {
+        list->indexed = true;
+    }
     return list;
 }
 
@@ -263,12 +389,10 @@ int list_push_head(list_t *list, void *data) {
     if (list == NULL) {
         return EINVAL;
     }
-    list_node_t *new_node = create_node(data, list->head, 0);
+    list_node_t *new_node = create_node(list, data, list->head);
     if (new_node == NULL) {
         return ENOMEM;
     }
-    // adjust positions before adding new node
-    local_foreach(list->head, list->size, inc_pos, NULL);
     list->head = new_node;
     list->size++;
     if (list->tail == NULL) {
@@ -276,6 +400,8 @@ int list_push_head(list_t *list, void *data) {
     }
     // maintain circular list
     list->tail->next = list->head;
+    // every position shifted, so the index is stale
+    list->index_size = 0;
     return SUCCESS;
 }
 
@@ -284,7 +410,7 @@ int list_push_tail(list_t *list, void *data) {
         return EINVAL;
     }
     // maintain circular list
-    list_node_t *new_node = create_node(data, list->head, list->size);
+    list_node_t *new_node = create_node(list, data, list->head);
     if (new_node == NULL) {
         return ENOMEM;
     }
@@ -296,6 +422,15 @@ int list_push_tail(list_t *list, void *data) {
     if (list->head == NULL) {
         list->head = new_node;
     }
+    if (list->indexed) {
+        // appends keep the index fresh: no position before the tail moved
+        if (list->index_size == list->size - 1 &&
+            list->index_size < list->index_cap) {
+            list->index[list->index_size++] = new_node;
+        } else {
+            list->index_size = 0;
+        }
+    }
     return SUCCESS;
 }
 
@@ -308,17 +443,14 @@ int list_insert(list_t *list, void *data, size_t position) {
         return list_push_tail(list, data);
     }
 
-    list_node_t *current_node = list->head;
-    for (size_t i = 0; i < position - 1; i++) {
-        current_node = current_node->next;
-    }
-    list_node_t *temp = create_node(data, current_node->next, position);
+    list_node_t *current_node = node_at(list, position - 1);
+    list_node_t *temp = create_node(list, data, current_node->next);
     if (temp == NULL) {
         return ENOMEM;
     }
-    local_foreach(current_node->next, list->size - position, inc_pos, NULL);
     current_node->next = temp;
     list->size++;
+    list->index_size = 0;
     return SUCCESS;
 }
 
@@ -326,11 +458,7 @@ void *list_get(const list_t *list, size_t position) {
     if (list == NULL || position >= list->size) {
         return NULL;
     }
-    list_node_t *current_node = list->head;
-    for (size_t i = 0; i < position; i++) {
-        current_node = current_node->next;
-    }
-    return current_node->data;
+    return node_at(list, position)->data;
 }
 
 ssize_t list_size(const list_t *list) {
@@ -350,17 +478,17 @@ void *list_pop_head(list_t *list) {
 
     list_node_t *to_pop = list->head;
     list->size--;
+    list->index_size = 0;
     if (list->size == 0) {
         list->head = NULL;
         list->tail = NULL;
     } else {
         list->head = list->head->next;
-        local_foreach(list->head, list->size, dec_pos, NULL);
         // maintain circular list
         list->tail->next = list->head;
     }
     void *value = to_pop->data;
-    free(to_pop);
+    release_node(list, to_pop);
     return value;
 }
 
@@ -373,23 +501,31 @@ void *list_pop_tail(list_t *list) {
 
     // find the node before the tail
     list_node_t *current_node;
+    bool index_fresh = list->indexed && list->index_size == list->size;
     list->size--;
     if (list->size == 0) {
         current_node = NULL;
         list->head = NULL;
     } else {
-        current_node = list->head;
-        while (current_node->next != list->tail) {
-            current_node = current_node->next;
+        if (index_fresh) {
+            // a fresh index makes the tail's predecessor an array load
+            current_node = list->index[list->size - 1];
+        } else {
+            current_node = list->head;
+            while (current_node->next != list->tail) {
+                current_node = current_node->next;
+            }
         }
         // maintain circular list
         current_node->next = list->head;
     }
+    // positions before the tail are unchanged, so a fresh index just shrinks
+    list->index_size = index_fresh ? list->size : 0;
 
     list_node_t *to_pop = list->tail;
     list->tail = current_node;
     void *value = to_pop->data;
-    free(to_pop);
+    release_node(list, to_pop);
     return value;
 }
 
@@ -433,8 +569,6 @@ void *list_remove(list_t *list, void *item_to_remove, int *err) {
                 list->tail = NULL;
             } else if (current_node == list->head) {
                 list->head = current_node->next;
-                // adjust positions after removal
-                local_foreach(list->head, list->size - 1, dec_pos, NULL);
                 // maintain circular list
                 list->tail->next = list->head;
             } else if (current_node == list->tail) {
@@ -443,13 +577,11 @@ void *list_remove(list_t *list, void *item_to_remove, int *err) {
                 prev_node->next = list->head;
             } else {
                 prev_node->next = current_node->next;
-                // adjust positions after removal
-                size_t size = list->size - current_node->position - 1;
-                local_foreach(current_node->next, size, dec_pos, NULL);
             }
             list->size--;
+            list->index_size = 0;
             void *data = current_node->data;
-            free(current_node);
+            release_node(list, current_node);
             return data;
         }
         prev_node = current_node;
@@ -500,6 +632,140 @@ void *list_iterator_next(list_t *list, int *err) {
     return data;
 }
 
+list_cursor_t *list_cursor_new(list_t *list, int *err) {
+    if (list == NULL) {
+        set_err(err, EINVAL);
+        return NULL;
+    }
+    list_cursor_t *cursor = mem_alloc(&list->allocator, sizeof(*cursor));
+    if (cursor == NULL) {
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+    cursor->list = list;
+    cursor->prev = NULL;
+    cursor->current = list->head;
+    return cursor;
+}
+
+int list_cursor_reset(list_cursor_t *cursor) {
+    if (cursor == NULL) {
+        return EINVAL;
+    }
+    cursor->prev = NULL;
+    cursor->current = cursor->list->head;
+    return SUCCESS;
+}
+
+void *list_cursor_get(const list_cursor_t *cursor) {
+    if (cursor == NULL || cursor->current == NULL) {
+        return NULL;
+    }
+    return cursor->current->data;
+}
+
+void *list_cursor_next(list_cursor_t *cursor, int *err) {
+    if (cursor == NULL) {
+        set_err(err, EINVAL);
+        return NULL;
+    } else if (cursor->current == NULL) {
+        set_err(err, ENOTSUP);
+        return NULL;
+    }
+    if (cursor->current == cursor->list->tail) {
+        // end of list. need to check because list is circular
+        cursor->prev = cursor->current;
+        cursor->current = NULL;
+        set_err(err, ENOTSUP);
+        return NULL;
+    }
+    cursor->prev = cursor->current;
+    cursor->current = cursor->current->next;
+    return cursor->current->data;
+}
+
+int list_cursor_insert_after(list_cursor_t *cursor, void *data) {
+    if (cursor == NULL) {
+        return EINVAL;
+    }
+    list_t *list = cursor->list;
+    if (cursor->current == NULL) {
+        if (list->size != 0) {
+            // cursor has run past the end of a non-empty list
+            return EINVAL;
+        }
+        list_node_t *new_node = create_node(list, data, NULL);
+        if (new_node == NULL) {
+            return ENOMEM;
+        }
+        // maintain circular list
+        new_node->next = new_node;
+        list->head = new_node;
+        list->tail = new_node;
+        list->size++;
+        list->index_size = 0;
+        cursor->current = new_node;
+        return SUCCESS;
+    }
+    list_node_t *new_node =
+        create_node(list, data, cursor->current->next);
+    if (new_node == NULL) {
+        return ENOMEM;
+    }
+    cursor->current->next = new_node;
+    if (cursor->current == list->tail) {
+        list->tail = new_node;
+    }
+    list->size++;
+    list->index_size = 0;
+    return SUCCESS;
+}
+
+void *list_cursor_remove(list_cursor_t *cursor, int *err) {
+    if (cursor == NULL) {
+        set_err(err, EINVAL);
+        return NULL;
+    } else if (cursor->current == NULL) {
+        set_err(err, ENOTSUP);
+        return NULL;
+    }
+    list_t *list = cursor->list;
+    list_node_t *to_remove = cursor->current;
+    if (list->size == 1) {
+        // list will be empty after removal
+        list->head = NULL;
+        list->tail = NULL;
+        cursor->current = NULL;
+    } else if (to_remove == list->head) {
+        list->head = to_remove->next;
+        // maintain circular list
+        list->tail->next = list->head;
+        cursor->current = list->head;
+    } else if (to_remove == list->tail) {
+        list->tail = cursor->prev;
+        // maintain circular list
+        cursor->prev->next = list->head;
+        cursor->current = NULL;
+    } else {
+        cursor->prev->next = to_remove->next;
+        cursor->current = to_remove->next;
+    }
+    list->size--;
+    list->index_size = 0;
+    void *data = to_remove->data;
+    release_node(list, to_remove);
+    return data;
+}
+
+int list_cursor_delete(list_cursor_t **cursor_address) {
+    if (cursor_address == NULL || *cursor_address == NULL) {
+        return EINVAL;
+    }
+    mem_free(&(*cursor_address)->list->allocator, *cursor_address);
+    *cursor_address = NULL;
+    return SUCCESS;
+}
+
 void *list_find_first(const list_t *list, const void *search_data, int *err) {
     if (list == NULL) {
         set_err(err, EINVAL);
@@ -532,7 +798,9 @@ list_t *list_find_all(const list_t *list, const void *search_data, int *err) {
         return NULL;
     }
 
-    list_t *found_list = list_new(NULL, list->compare_function, NULL);
+    // results share the source list's allocator
+    list_t *found_list =
+        list_new_alloc(NULL, list->compare_function, &list->allocator, NULL);
     if (found_list == NULL) {
         set_err(err, ENOMEM);
         return NULL;
@@ -566,35 +834,43 @@ int list_sort(list_t *list) {
     list->tail->next = NULL;
     list->head = merge_sort(list->head, list->compare_function);
     list->tail = list->head;
-    size_t position = 0;
     while (list->tail->next != NULL) {
-        // adjust positions after removal
-        list->tail->position = position++;
         list->tail = list->tail->next;
     }
-    list->tail->position = position;
     // make list circular again after sorting
     list->tail->next = list->head;
+    list->index_size = 0;
     return SUCCESS;
 }
 
 int list_clear(list_t *list) {
     if (list == NULL) {
         return EINVAL;
-    } else if (list->size == 0) {
+    } else if (list->size == 0 && list->blocks == NULL) {
         return SUCCESS;
     }
 
     list_node_t *current_node = list->head;
-    list_node_t *next_node = NULL;
     for (size_t i = 0; i < list->size; i++) {
-        next_node = current_node->next;
         if (list->customfree != NULL) {
             list->customfree(current_node->data);
         }
-        free(current_node);
-        current_node = next_node;
+        current_node = current_node->next;
     }
+    // the nodes all live in the pool blocks, so release them wholesale
+    struct node_block_t *block = list->blocks;
+    while (block != NULL) {
+        struct node_block_t *next_block = block->next;
+        mem_free(&list->allocator, block);
+        block = next_block;
+    }
+    list->blocks = NULL;
+    list->free_nodes = NULL;
+    list->block_used = 0;
+    mem_free(&list->allocator, list->index);
+    list->index = NULL;
+    list->index_size = 0;
+    list->index_cap = 0;
     list->head = NULL;
     list->tail = NULL;
     list->size = 0;
@@ -605,8 +881,10 @@ int list_delete(list_t **list_address) {
     if (list_address == NULL || *list_address == NULL) {
         return EINVAL;
     }
+    // copied out because the allocator lives inside the block being freed
+    allocator_t allocator = (*list_address)->allocator;
     list_clear(*list_address);
-    free(*list_address);
+    mem_free(&allocator, *list_address);
     *list_address = NULL;
     return SUCCESS;
 }
@@ -0,0 +1,322 @@
+#include "linked_list_intrusive.h"
+#include "buildingblocks.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* DATA */
+
+#define SUCCESS 0
+#define INVALID -1
+
+/**
+ * @brief Structure of an intrusive list object
+ *
+ * The list is circular like list_t, but it stores no data pointers of its
+ * own: head, tail, and current all point at link fields embedded in the
+ * user's items at link_offset bytes from the item start.
+ *
+ * @param size is the number of items the list is currently storing
+ * @param link_offset offset of the embedded link within each item
+ * @param head pointer to the head link
+ * @param tail pointer to the tail link
+ * @param current pointer to the current link for iteration
+ * @param compare_function pointer to the user defined compare function
+ */
+struct ilist_t {
+    size_t size;
+    size_t link_offset;
+    ilist_link_t *head;
+    ilist_link_t *tail;
+    ilist_link_t *current;
+    ICMP_F compare_function;
+};
+
+/* PRIVATE FUNCTIONS*/
+
+/**
+ * @brief Get the link embedded in an item.
+ *
+ * @param list list the item belongs to
+ * @param item the user's item
+ * @return ilist_link_t* pointer to the item's link fields
+ */
+static ilist_link_t *item_link(const ilist_t *list, void *item) {
+    return (ilist_link_t *)((uint8_t *)item + list->link_offset);
+}
+
+/**
+ * @brief Get the item a link is embedded in.
+ *
+ * @param list list the item belongs to
+ * @param link the link fields
+ * @return void* pointer to the user's item
+ */
+static void *link_item(const ilist_t *list, ilist_link_t *link) {
+    return (uint8_t *)link - list->link_offset;
+}
+
+/**
+ * @brief Unlink a link from the list, given the link before it.
+ *
+ * @param list list to unlink from
+ * @param link the link to unlink
+ * @param prev the link before it, NULL if link is the head
+ */
+static void unlink_node(ilist_t *list, ilist_link_t *link, ilist_link_t *prev) {
+    if (list->size == 1) {
+        // list will be empty after removal
+        list->head = NULL;
+        list->tail = NULL;
+    } else if (link == list->head) {
+        list->head = link->next;
+        // maintain circular list
+        list->tail->next = list->head;
+    } else if (link == list->tail) {
+        list->tail = prev;
+        // maintain circular list
+        prev->next = list->head;
+    } else {
+        prev->next = link->next;
+    }
+    link->next = NULL;
+    list->size--;
+}
+
+/* PUBLIC FUNCTIONS*/
+
+ilist_t *ilist_new(size_t link_offset, ICMP_F cmp_f, int *err) {
+    ilist_t *list = calloc(1, sizeof(*list));
+    if (list == NULL) {
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+    list->link_offset = link_offset;
+    list->compare_function = cmp_f;
+    return list;
+}
+
+int ilist_query(const ilist_t *list, int query, ssize_t *result) {
+    if (list == NULL || result == NULL) {
+        return EINVAL;
+    }
+    switch (query) {
+    case QUERY_SIZE:
+        *result = list->size;
+        return SUCCESS;
+    case QUERY_IS_EMPTY:
+        *result = list->size == 0;
+        return SUCCESS;
+    default:
+        return ENOTSUP;
+    }
+}
+
+int ilist_push_head(ilist_t *list, void *item) {
+    if (list == NULL || item == NULL) {
+        return EINVAL;
+    }
+    ilist_link_t *link = item_link(list, item);
+    link->next = list->head;
+    list->head = link;
+    list->size++;
+    if (list->tail == NULL) {
+        list->tail = link;
+    }
+    // maintain circular list
+    list->tail->next = list->head;
+    return SUCCESS;
+}
+
+int ilist_push_tail(ilist_t *list, void *item) {
+    if (list == NULL || item == NULL) {
+        return EINVAL;
+    }
+    ilist_link_t *link = item_link(list, item);
+    // maintain circular list
+    link->next = list->head;
+    if (list->tail != NULL) {
+        list->tail->next = link;
+    }
+    list->tail = link;
+    list->size++;
+    if (list->head == NULL) {
+        list->head = link;
+        // the sole link points at itself
+        link->next = link;
+    }
+    return SUCCESS;
+}
+
+ssize_t ilist_size(const ilist_t *list) {
+    return list == NULL ? INVALID : (ssize_t)list->size;
+}
+
+int ilist_is_empty(const ilist_t *list) {
+    return list == NULL ? INVALID : list->size == 0;
+}
+
+void *ilist_pop_head(ilist_t *list) {
+    if (list == NULL) {
+        return NULL;
+    } else if (list->head == NULL) {
+        return NULL;
+    }
+    ilist_link_t *to_pop = list->head;
+    unlink_node(list, to_pop, NULL);
+    return link_item(list, to_pop);
+}
+
+void *ilist_pop_tail(ilist_t *list) {
+    if (list == NULL) {
+        return NULL;
+    } else if (list->tail == NULL) {
+        return NULL;
+    }
+
+    // find the link before the tail
+    ilist_link_t *prev = NULL;
+    if (list->size > 1) {
+        prev = list->head;
+        while (prev->next != list->tail) {
+            prev = prev->next;
+        }
+    }
+    ilist_link_t *to_pop = list->tail;
+    unlink_node(list, to_pop, prev);
+    return link_item(list, to_pop);
+}
+
+void *ilist_peek_head(const ilist_t *list) {
+    if (list == NULL) {
+        return NULL;
+    } else if (list->head == NULL) {
+        return NULL;
+    }
+    return link_item(list, list->head);
+}
+
+void *ilist_peek_tail(const ilist_t *list) {
+    if (list == NULL) {
+        return NULL;
+    } else if (list->tail == NULL) {
+        return NULL;
+    }
+    return link_item(list, list->tail);
+}
+
+void *ilist_unlink(ilist_t *list, void *item, int *err) {
+    if (list == NULL || item == NULL) {
+        set_err(err, EINVAL);
+        return NULL;
+    } else if (list->size == 0) {
+        return NULL;
+    }
+
+    ilist_link_t *target = item_link(list, item);
+    ilist_link_t *current = list->head;
+    ilist_link_t *prev = NULL;
+    for (size_t i = 0; i < list->size; i++) {
+        if (current == target) {
+            unlink_node(list, current, prev);
+            return item;
+        }
+        prev = current;
+        current = current->next;
+    }
+    return NULL;
+}
+
+void *ilist_remove(ilist_t *list, void *item_to_remove, int *err) {
+    if (list == NULL) {
+        set_err(err, EINVAL);
+        return NULL;
+    } else if (list->compare_function == NULL) {
+        set_err(err, ENOTSUP);
+        return NULL;
+    } else if (list->size == 0) {
+        return NULL;
+    }
+
+    ilist_link_t *current = list->head;
+    ilist_link_t *prev = NULL;
+    for (size_t i = 0; i < list->size; i++) {
+        void *item = link_item(list, current);
+        if (list->compare_function(item_to_remove, item) == 0) {
+            unlink_node(list, current, prev);
+            return item;
+        }
+        prev = current;
+        current = current->next;
+    }
+    return NULL;
+}
+
+int ilist_foreach_call(ilist_t *list, IACT_F action_function, void *addl_data) {
+    if (list == NULL || action_function == NULL) {
+        return EINVAL;
+    }
+    int err = SUCCESS;
+    ilist_link_t *current = list->head;
+    for (size_t i = 0; i < list->size; i++) {
+        err = action_function(link_item(list, current), addl_data);
+        if (err != SUCCESS) {
+            return err;
+        }
+        current = current->next;
+    }
+    return err;
+}
+
+int ilist_iterator_reset(ilist_t *list) {
+    if (list == NULL) {
+        return EINVAL;
+    }
+    list->current = list->head;
+    return SUCCESS;
+}
+
+void *ilist_iterator_next(ilist_t *list, int *err) {
+    if (list == NULL) {
+        set_err(err, EINVAL);
+        return NULL;
+    } else if (list->current == NULL) {
+        set_err(err, ENOTSUP);
+        return NULL;
+    }
+    void *item = link_item(list, list->current);
+    if (list->current == list->tail) {
+        // end of list. need to check because list is circular
+        list->current = NULL;
+    } else {
+        list->current = list->current->next;
+    }
+    return item;
+}
+
+int ilist_clear(ilist_t *list) {
+    if (list == NULL) {
+        return EINVAL;
+    }
+    ilist_link_t *current = list->head;
+    for (size_t i = 0; i < list->size; i++) {
+        ilist_link_t *next = current->next;
+        current->next = NULL;
+        current = next;
+    }
+    list->head = NULL;
+    list->tail = NULL;
+    list->current = NULL;
+    list->size = 0;
+    return SUCCESS;
+}
+
+int ilist_delete(ilist_t **list_address) {
+    if (list_address == NULL || *list_address == NULL) {
+        return EINVAL;
+    }
+    ilist_clear(*list_address);
+    free(*list_address);
+    *list_address = NULL;
+    return SUCCESS;
+}
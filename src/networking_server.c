@@ -8,12 +8,17 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <poll.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 #include <pthread.h>
 #include <signal.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/un.h>
+#include <time.h>
 #include <unistd.h>
 
 /* DATA */
@@ -21,21 +26,44 @@
 #define SUCCESS 0
 #define FAILURE -1
 #define INFINITE_POLL -1
+#ifdef __linux__
+#define EPOLL_MAX_EVENTS 32 // readiness events handled per wakeup
+#endif
 
 struct lists {
     arr_list_t *poll_list;
     arr_list_t *srvs_list;
 };
 
+// tags for the common initial member of the structs attached to epoll
+// events, so a wakeup can tell a listening socket from a client session
+enum event_kind {
+    LISTENER_EVENT, // the fd is a listening socket of a service
+    SESSION_EVENT,  // the fd is a persistent client session
+};
+
+// always-on instrumentation, updated with atomics so the hot path never
+// takes a lock for bookkeeping. Held on the heap because run_server
+// works on copies of the service objects; all copies share one block.
+struct service_counters {
+    _Atomic size_t calls;
+    _Atomic size_t latency[SERVICE_LATENCY_BUCKETS];
+};
+
 struct service_info {
+    int kind; // always LISTENER_EVENT
     char *name;
     int flags;
     service_f service;
     io_info_t *accept_io;
+    io_info_t **extra_ios; // additional reuseport listeners, may be NULL
+    size_t num_extra;
     server_t *server;
+    struct service_counters *counters;
 };
 
 struct session {
+    int kind; // always SESSION_EVENT
     io_info_t *client;
     struct service_info *srv;
 };
@@ -47,6 +75,10 @@ struct server {
     size_t monitor;
     sigset_t oldset;
     ssl_loader_t *ssl_loader;
+    int epfd; // epoll instance while run_server is live, -1 otherwise
+    _Atomic size_t accepts;         // connections accepted since startup
+    _Atomic size_t active_sessions; // sessions currently open
+    _Atomic size_t queued_work;     // sessions waiting for a pool thread
 };
 
 /* PRIVATE FUNCTIONS */
@@ -59,6 +91,11 @@ struct server {
 static void free_service(struct service_info *srv) {
     free(srv->name);
     free_io_info(srv->accept_io);
+    for (size_t i = 0; i < srv->num_extra; i++) {
+        free_io_info(srv->extra_ios[i]);
+    }
+    free(srv->extra_ios);
+    free(srv->counters);
     free(srv);
 }
 
@@ -104,6 +141,10 @@ static server_t *init_resources(size_t max_services, int *err) {
         return NULL;
     }
     server->ssl_loader = NULL;
+    server->epfd = FAILURE;
+    atomic_init(&server->accepts, 0);
+    atomic_init(&server->active_sessions, 0);
+    atomic_init(&server->queued_work, 0);
     return server;
 }
 
@@ -133,6 +174,13 @@ static int new_service(server_t *server, const char *name,
         DEBUG_PRINT("new_service: strdup failed\n");
         return ENOMEM;
     }
+    (*srv)->counters = calloc(1, sizeof(*(*srv)->counters));
+    if ((*srv)->counters == NULL) {
+        free((*srv)->name);
+        free(*srv);
+        DEBUG_PRINT("new_service: calloc failed\n");
+        return ENOMEM;
+    }
     int err = hash_table_set(server->services, *srv, (*srv)->name);
     if (err != SUCCESS) {
         free_service(*srv);
@@ -143,6 +191,30 @@ static int new_service(server_t *server, const char *name,
     return SUCCESS;
 }
 
+/**
+ * @brief Record the duration of one service invocation.
+ *
+ * The histogram buckets are powers of two in milliseconds: bucket 0
+ * counts calls under 1 ms, bucket i calls under 2^i ms, and the last
+ * bucket everything slower.
+ *
+ * @param srv - The service that was invoked.
+ * @param start - When the invocation began.
+ */
+static void record_latency(struct service_info *srv,
+                           const struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long long ms = (end.tv_sec - start->tv_sec) * 1000 +
+                   (end.tv_nsec - start->tv_nsec) / 1000000;
+    size_t bucket = 0;
+    while (bucket < SERVICE_LATENCY_BUCKETS - 1 && ms >= (1LL << bucket)) {
+        bucket++;
+    }
+    atomic_fetch_add(&srv->counters->latency[bucket], 1);
+    atomic_fetch_add(&srv->counters->calls, 1);
+}
+
 /**
  * @brief Handle a request from the client.
  *
@@ -155,14 +227,129 @@ static int handle_request(struct session *session) {
     }
 
     DEBUG_PRINT("\ton thread %lX: begin client session\n\n", pthread_self());
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
     session->srv->service(session->client);
+    record_latency(session->srv, &start);
     DEBUG_PRINT("\ton thread %lX: session complete\n\n", pthread_self());
 
+    atomic_fetch_sub(&session->srv->server->active_sessions, 1);
     free_io_info(session->client);
     free(session);
     return SUCCESS;
 }
 
+/**
+ * @brief Run a queued client session on a pool thread.
+ *
+ * Thin wrapper so the queue depth counter covers exactly the time a
+ * session spends waiting for a thread.
+ *
+ * @param session - The session object.
+ * @return int - 0 on success, non-zero on failure.
+ */
+static int pooled_request(struct session *session) {
+    atomic_fetch_sub(&session->srv->server->queued_work, 1);
+    return handle_request(session);
+}
+
+#ifdef __linux__
+/**
+ * @brief Close a persistent client session.
+ *
+ * @param sess - The session object.
+ */
+static void close_session(struct session *sess) {
+    DEBUG_PRINT("\tclosing event session\n");
+    int fd = io_info_fd(sess->client, NULL);
+    epoll_ctl(sess->srv->server->epfd, EPOLL_CTL_DEL, fd, NULL);
+    atomic_fetch_sub(&sess->srv->server->active_sessions, 1);
+    free_io_info(sess->client);
+    free(sess);
+}
+
+/**
+ * @brief Handle one readable event on a persistent session.
+ *
+ * The service handles a single request; a non-zero return closes the
+ * session. Otherwise the one-shot registration is re-armed so the next
+ * request wakes the event loop again. A session whose registration can
+ * no longer be re-armed (e.g. the event loop has ended) is closed.
+ *
+ * @param sess - The session object.
+ * @return int - 0 on success, non-zero on failure.
+ */
+static int handle_event(struct session *sess) {
+    DEBUG_PRINT("\ton thread %lX: begin session event\n\n", pthread_self());
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int err = sess->srv->service(sess->client);
+    record_latency(sess->srv, &start);
+    DEBUG_PRINT("\ton thread %lX: session event complete\n\n",
+                pthread_self());
+    if (err != SUCCESS) {
+        close_session(sess);
+        return SUCCESS;
+    }
+    struct epoll_event event = {
+        .events = EPOLLIN | EPOLLONESHOT,
+        .data.ptr = sess,
+    };
+    int fd = io_info_fd(sess->client, NULL);
+    if (epoll_ctl(sess->srv->server->epfd, EPOLL_CTL_MOD, fd, &event) ==
+        FAILURE) {
+        err = errno;
+        DEBUG_PRINT("\tfailed to re-arm session: %s\n", strerror(err));
+        close_session(sess);
+        return err;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Run a queued session event on a pool thread.
+ *
+ * Thin wrapper so the queue depth counter covers exactly the time an
+ * event spends waiting for a thread.
+ *
+ * @param sess - The session object.
+ * @return int - 0 on success, non-zero on failure.
+ */
+static int pooled_event(struct session *sess) {
+    atomic_fetch_sub(&sess->srv->server->queued_work, 1);
+    return handle_event(sess);
+}
+
+/**
+ * @brief Register an accepted client as a persistent session.
+ *
+ * The client is registered one-shot so at most one service invocation
+ * is in flight per session; handle_event re-arms it after each request.
+ *
+ * @param sess - The session object.
+ * @return int - 0 on success, non-zero on failure.
+ */
+static int watch_session(struct session *sess) {
+    sess->kind = SESSION_EVENT;
+    struct epoll_event event = {
+        .events = EPOLLIN | EPOLLONESHOT,
+        .data.ptr = sess,
+    };
+    int fd = io_info_fd(sess->client, NULL);
+    if (epoll_ctl(sess->srv->server->epfd, EPOLL_CTL_ADD, fd, &event) ==
+        FAILURE) {
+        int err = errno;
+        DEBUG_PRINT("\tfailed to watch session: %s\n", strerror(err));
+        atomic_fetch_sub(&sess->srv->server->active_sessions, 1);
+        free_io_info(sess->client);
+        free(sess);
+        return err;
+    }
+    DEBUG_PRINT("\tclient registered as event session\n");
+    return SUCCESS;
+}
+#endif
+
 /**
  * @brief Accept a new request from the client.
  *
@@ -187,10 +374,25 @@ static int accept_request(threadpool_t *pool, struct service_info *srv) {
         return err;
     }
     DEBUG_PRINT("\tclient accepted\n");
+    atomic_fetch_add(&srv->server->accepts, 1);
+    atomic_fetch_add(&srv->server->active_sessions, 1);
+
+#ifdef __linux__
+    // persistent sessions are watched by the event loop instead of
+    // being owned by a thread for their whole lifetime
+    if (srv->flags & EVENT_SESSIONS && srv->server->epfd != FAILURE) {
+        return watch_session(sess);
+    }
+#endif
 
     // run the service in a separate thread if the flag is set
     if (srv->flags & THREADED_SESSIONS) {
-        return threadpool_add_work(pool, (ROUTINE)handle_request, sess);
+        atomic_fetch_add(&srv->server->queued_work, 1);
+        err = threadpool_add_work(pool, (ROUTINE)pooled_request, sess);
+        if (err != SUCCESS) {
+            atomic_fetch_sub(&srv->server->queued_work, 1);
+        }
+        return err;
     } else {
         return handle_request(sess);
     }
@@ -219,7 +421,27 @@ static int add_polls(const char *unused, struct service_info **srv,
     if (err) {
         return err;
     }
-    return arr_list_insert(lists->srvs_list, *srv, size);
+    err = arr_list_insert(lists->srvs_list, *srv, size);
+    if (err) {
+        return err;
+    }
+    // each extra reuseport listener gets its own entry pair, sharing the
+    // service but accepting on its own socket
+    for (size_t i = 0; i < (*srv)->num_extra; i++) {
+        struct service_info extra = **srv;
+        extra.accept_io = (*srv)->extra_ios[i];
+        pio.io_info = extra.accept_io;
+        size++;
+        err = arr_list_insert(lists->poll_list, &pio, size);
+        if (err) {
+            return err;
+        }
+        err = arr_list_insert(lists->srvs_list, &extra, size);
+        if (err) {
+            return err;
+        }
+    }
+    return SUCCESS;
 }
 
 /**
@@ -232,21 +454,22 @@ static int add_polls(const char *unused, struct service_info **srv,
  * @param services - The services to build the poll list from.
  * @param pios - The poll list to be created.
  * @param services_cpy - The services list to be created.
- * @param size - The size of the poll list.
+ * @param size - In: the number of services. Out: the number of entries
+ * built, which is larger when services carry extra reuseport listeners.
  * @return int - 0 on success, non-zero on failure.
  */
 static int build_pios(hash_table_t *services, struct pollio **pios,
-                      struct service_info **services_cpy, size_t size) {
+                      struct service_info **services_cpy, ssize_t *size) {
     struct lists lists;
     int err;
     // wrapped array lists are just to easily append to the end of the array
     lists.poll_list =
-        arr_list_wrap(NULL, NULL, size, sizeof(**pios), (void **)pios, &err);
+        arr_list_wrap(NULL, NULL, *size, sizeof(**pios), (void **)pios, &err);
     if (lists.poll_list == NULL) {
         // err != SUCCESS
         return err;
     }
-    lists.srvs_list = arr_list_wrap(NULL, NULL, size, sizeof(**services_cpy),
+    lists.srvs_list = arr_list_wrap(NULL, NULL, *size, sizeof(**services_cpy),
                                     (void **)services_cpy, &err);
     if (lists.srvs_list == NULL) {
         arr_list_delete(lists.poll_list);
@@ -254,6 +477,7 @@ static int build_pios(hash_table_t *services, struct pollio **pios,
     }
 
     err = hash_table_iterate(services, (ACT_TABLE_F)add_polls, &lists);
+    arr_list_query(lists.poll_list, QUERY_SIZE, size);
     // always delete the wrappers; they are no longer needed
     arr_list_delete(lists.srvs_list);
     arr_list_delete(lists.poll_list);
@@ -426,6 +650,53 @@ int open_inet_socket(server_t *server, const char *name, const char *port,
     return err;
 }
 
+int open_inet_socket_n(server_t *server, const char *name, const char *port,
+                       size_t nsockets, int *err_type) {
+    if (server == NULL || port == NULL || name == NULL || nsockets == 0) {
+        set_err(err_type, SYS);
+        DEBUG_PRINT("server, name, or port is NULL or nsockets is 0\n");
+        return EINVAL;
+    }
+    DEBUG_PRINT("opening inet socket group %s with %zu listeners\n", name,
+                nsockets);
+    struct service_info *srv = NULL;
+    int err = new_service(server, name, &srv);
+    if (err != SUCCESS) {
+        set_err(err_type, SYS);
+        return err;
+    }
+
+    srv->accept_io = new_accept_io_info_reuseport(port, &err, err_type);
+    if (srv->accept_io == NULL) {
+        goto error;
+    }
+    if (nsockets > 1) {
+        srv->extra_ios = calloc(nsockets - 1, sizeof(*srv->extra_ios));
+        if (srv->extra_ios == NULL) {
+            err = ENOMEM;
+            set_err(err_type, SYS);
+            goto error;
+        }
+        for (size_t i = 0; i < nsockets - 1; i++) {
+            srv->extra_ios[i] = new_accept_io_info_reuseport(port, &err,
+                                                             err_type);
+            if (srv->extra_ios[i] == NULL) {
+                goto error;
+            }
+            srv->num_extra = i + 1;
+        }
+    }
+    DEBUG_PRINT("inet socket group created\n");
+    return SUCCESS;
+
+error:
+    // free_service releases whatever listeners were opened so far
+    DEBUG_PRINT("inet socket group creation failed\n");
+    hash_table_remove(server->services, srv->name);
+    free_service(srv);
+    return err;
+}
+
 int open_unix_socket(server_t *server, const char *name, const char *path) {
     // TODO:convert raw unix socket to OpenSSL BIO object
     if (server == NULL || name == NULL || path == NULL) {
@@ -512,6 +783,35 @@ int register_service(server_t *server, const char *name, service_f service,
     return SUCCESS;
 }
 
+int server_stats(server_t *server, struct server_stats *stats) {
+    if (server == NULL || stats == NULL) {
+        DEBUG_PRINT("server or stats is NULL\n");
+        return EINVAL;
+    }
+    stats->accepts = atomic_load(&server->accepts);
+    stats->active_sessions = atomic_load(&server->active_sessions);
+    stats->queue_depth = atomic_load(&server->queued_work);
+    return SUCCESS;
+}
+
+int service_stats(server_t *server, const char *name,
+                  struct service_stats *stats) {
+    if (server == NULL || name == NULL || stats == NULL) {
+        DEBUG_PRINT("server, name, or stats is NULL\n");
+        return EINVAL;
+    }
+    struct service_info *srv = hash_table_lookup(server->services, name);
+    if (srv == NULL) {
+        DEBUG_PRINT("service %s not found\n", name);
+        return ENOENT;
+    }
+    stats->calls = atomic_load(&srv->counters->calls);
+    for (size_t i = 0; i < SERVICE_LATENCY_BUCKETS; i++) {
+        stats->latency[i] = atomic_load(&srv->counters->latency[i]);
+    }
+    return SUCCESS;
+}
+
 int run_service(server_t *server, const char *name) {
     if (server == NULL || name == NULL) {
         DEBUG_PRINT("server or name is NULL\n");
@@ -536,23 +836,21 @@ int run_service(server_t *server, const char *name) {
     }
 }
 
-int run_server(server_t *server) {
-    if (server == NULL) {
-        DEBUG_PRINT("server is NULL\n");
-        return EINVAL;
-    }
-
-    DEBUG_PRINT("running all services\n");
-    ssize_t size;
-    hash_table_query(server->services, QUERY_SIZE, &size);
-    struct pollio *pios = NULL;
-    struct service_info *services_cpy = NULL;
-    int err = build_pios(server->services, &pios, &services_cpy, size);
-    if (pios == NULL || services_cpy == NULL) {
-        DEBUG_PRINT("error building poll list: %s\n", strerror(err));
-        return err;
-    }
-
+/**
+ * @brief Run all services with the poll(2) engine.
+ *
+ * Portability fallback: the whole pollio array is scanned after every
+ * wakeup, so the cost per wakeup is O(services).
+ *
+ * @param server - The server object.
+ * @param pios - The poll list, one entry per service.
+ * @param services_cpy - The services, indices matching pios.
+ * @param size - The number of services.
+ * @return int - The error that stopped the loop.
+ */
+static int run_server_poll(server_t *server, struct pollio *pios,
+                           struct service_info *services_cpy, ssize_t size) {
+    int err = SUCCESS;
     bool keep_running = true;
     while (keep_running) {
         int ready = poll_io_info(pios, size, INFINITE_POLL);
@@ -585,6 +883,152 @@ int run_server(server_t *server) {
             }
         }
     }
+    return err;
+}
+
+#ifdef __linux__
+/**
+ * @brief Run all services with the epoll(7) engine.
+ *
+ * The listening sockets are registered edge-triggered, so each wakeup
+ * only touches the sockets that actually became ready instead of
+ * rescanning every service. Edge triggering requires draining: the
+ * listeners are switched to non-blocking and every readiness event
+ * accepts until the socket reports EAGAIN. The original file status
+ * flags are restored when the loop ends.
+ *
+ * If no epoll instance can be created, ENOTSUP is returned so the
+ * caller can fall back to the poll engine.
+ *
+ * @param server - The server object.
+ * @param services_cpy - The services to run.
+ * @param size - The number of services.
+ * @return int - The error that stopped the loop.
+ */
+static int run_server_epoll(server_t *server,
+                            struct service_info *services_cpy, ssize_t size) {
+    int epfd = epoll_create1(0);
+    if (epfd == FAILURE) {
+        DEBUG_PRINT("epoll_create1 failed: %s\n", strerror(errno));
+        return ENOTSUP;
+    }
+    server->epfd = epfd;
+    int *old_flags = malloc(sizeof(*old_flags) * size);
+    if (old_flags == NULL) {
+        close(epfd);
+        return ENOMEM;
+    }
+    int err = SUCCESS;
+    ssize_t registered = 0;
+    for (; registered < size; registered++) {
+        struct service_info *srv = &services_cpy[registered];
+        int fd = io_info_fd(srv->accept_io, NULL);
+        old_flags[registered] = fcntl(fd, F_GETFL);
+        if (old_flags[registered] == FAILURE ||
+            fcntl(fd, F_SETFL, old_flags[registered] | O_NONBLOCK) ==
+                FAILURE) {
+            err = errno;
+            break;
+        }
+        struct epoll_event event = {
+            .events = EPOLLIN | EPOLLET,
+            .data.ptr = srv,
+        };
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event) == FAILURE) {
+            err = errno;
+            fcntl(fd, F_SETFL, old_flags[registered]);
+            break;
+        }
+    }
+
+    bool keep_running = err == SUCCESS;
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    while (keep_running) {
+        int ready = epoll_wait(epfd, events, EPOLL_MAX_EVENTS, INFINITE_POLL);
+        if (ready == FAILURE) {
+            err = errno;
+            DEBUG_PRINT("\tepoll error: %s\n", strerror(err));
+            break;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            int *kind = events[i].data.ptr;
+            if (*kind == SESSION_EVENT) {
+                struct session *sess = events[i].data.ptr;
+                if (events[i].events & EPOLLIN) {
+                    // multiplex session events over the pool, falling
+                    // back to this thread if the work cannot be queued
+                    atomic_fetch_add(&server->queued_work, 1);
+                    if (threadpool_add_work(server->pool,
+                                            (ROUTINE)pooled_event,
+                                            sess) != SUCCESS) {
+                        atomic_fetch_sub(&server->queued_work, 1);
+                        handle_event(sess);
+                    }
+                } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    close_session(sess);
+                }
+                continue;
+            }
+            struct service_info *srv = events[i].data.ptr;
+            if (events[i].events & EPOLLIN) {
+                // edge triggered: accept until the listener is drained
+                do {
+                    err = accept_request(server->pool, srv);
+                } while (err == SUCCESS);
+                if (err == EAGAIN || err == EWOULDBLOCK) {
+                    err = SUCCESS;
+                } else {
+                    keep_running = false;
+                    break;
+                }
+            } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                // error specific to this service socket.
+                // unsure of which error code to return, may change later
+                err = EAGAIN;
+                keep_running = false;
+                DEBUG_PRINT("\tserver socket error\n");
+                break;
+            }
+        }
+    }
+
+    for (ssize_t i = 0; i < registered; i++) {
+        int fd = io_info_fd(services_cpy[i].accept_io, NULL);
+        fcntl(fd, F_SETFL, old_flags[i]);
+    }
+    free(old_flags);
+    server->epfd = FAILURE;
+    close(epfd);
+    return err;
+}
+#endif
+
+int run_server(server_t *server) {
+    if (server == NULL) {
+        DEBUG_PRINT("server is NULL\n");
+        return EINVAL;
+    }
+
+    DEBUG_PRINT("running all services\n");
+    ssize_t size;
+    hash_table_query(server->services, QUERY_SIZE, &size);
+    struct pollio *pios = NULL;
+    struct service_info *services_cpy = NULL;
+    int err = build_pios(server->services, &pios, &services_cpy, &size);
+    if (pios == NULL || services_cpy == NULL) {
+        DEBUG_PRINT("error building poll list: %s\n", strerror(err));
+        return err;
+    }
+
+#ifdef __linux__
+    err = run_server_epoll(server, services_cpy, size);
+    if (err == ENOTSUP) {
+        err = run_server_poll(server, pios, services_cpy, size);
+    }
+#else
+    err = run_server_poll(server, pios, services_cpy, size);
+#endif
 
     free(pios);
     free(services_cpy);
@@ -4,6 +4,7 @@
 #include <errno.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 /*DATA */
 
@@ -13,35 +14,132 @@
 /**
  * @brief structure of a queue object
  *
- * @param q_data is the list containing the queue node pointers
+ * A queue created with a fixed capacity stores its elements in a
+ * contiguous ring buffer: enqueue and dequeue are an index update and a
+ * store, with no allocation on the hot path. An unlimited queue cannot
+ * pre-size a buffer and keeps the linked list backend instead. Exactly
+ * one of q_data and ring is in use.
+ *
+ * A sized queue (mem_sz != 0) owns its element storage: each ring slot
+ * holds mem_sz bytes and enqueue copies the element in. In the default
+ * pointer mode each slot holds the caller's pointer.
+ *
+ * @param q_data is the list containing the queue node pointers (unlimited)
+ * @param ring is the circular element buffer (fixed capacity)
+ * @param head is the ring index of the front element
+ * @param size is the number of elements in the ring
  * @param capacity is the number of nodes the queue can hold
+ * @param mem_sz size of each element, 0 for pointer mode
  * @param support_lookup is a boolean indicating whether the queue supports
  *        lookup
+ * @param customfree pointer to the user defined free function
+ * @param compare pointer to the user defined compare function
+ * @param allocator memory allocator for the queue internals
  */
 struct queue_t {
     list_t *q_data;
+    void *ring;
+    size_t head;
+    size_t size;
     size_t capacity;
+    size_t mem_sz;
     bool support_lookup;
+    FREE_F customfree;
+    CMP_F compare;
+    allocator_t allocator;
 };
 
 /* PRIVATE FUNCTIONS*/
 
+/**
+ * @brief Get the ring buffer slot holding a queue position.
+ *
+ * @param queue queue to index into
+ * @param position position in the queue, 0 being the front
+ * @return void* address of the slot holding that position
+ */
+static void *ring_slot(const queue_t *queue, size_t position) {
+    size_t slot_size = queue->mem_sz != 0 ? queue->mem_sz : sizeof(void *);
+    size_t idx = (queue->head + position) % queue->capacity;
+    return (char *)queue->ring + (idx * slot_size);
+}
+
+/**
+ * @brief Get the element stored at a queue position.
+ *
+ * In pointer mode this is the caller's pointer; in sized mode it is the
+ * address of the queue-owned copy.
+ *
+ * @param queue queue to read from
+ * @param position position in the queue, 0 being the front
+ * @return void* the element at that position
+ */
+static void *ring_get(const queue_t *queue, size_t position) {
+    void *slot = ring_slot(queue, position);
+    return queue->mem_sz != 0 ? slot : *(void **)slot;
+}
+
 /* PUBLIC FUNCTIONS*/
 
 queue_t *queue_init(size_t capacity, FREE_F customfree, CMP_F compare,
                     int *err) {
-    queue_t *queue = malloc(sizeof(*queue));
+    return queue_init_alloc(capacity, customfree, compare, NULL, err);
+}
+
+queue_t *queue_init_alloc(size_t capacity, FREE_F customfree, CMP_F compare,
+                          const allocator_t *allocator, int *err) {
+    queue_t *queue = mem_zalloc(allocator, sizeof(*queue));
     if (queue == NULL) {
         set_err(err, ENOMEM);
         return NULL;
     }
-    queue->q_data = list_new(customfree, compare, err);
-    if (queue->q_data == NULL) {
+    if (allocator != NULL) {
+        queue->allocator = *allocator;
+    }
+    if (capacity == QUEUE_UNLIMITED) {
+        queue->q_data =
+            list_new_alloc(customfree, compare, &queue->allocator, err);
+        if (queue->q_data == NULL) {
+            mem_free(allocator, queue);
+            return NULL;
+        }
+    } else {
+        queue->ring =
+            mem_alloc(&queue->allocator, capacity * sizeof(void *));
+        if (queue->ring == NULL) {
+            set_err(err, ENOMEM);
+            mem_free(allocator, queue);
+            return NULL;
+        }
+    }
+    queue->capacity = capacity;
+    queue->support_lookup = compare != NULL;
+    queue->customfree = customfree;
+    queue->compare = compare;
+    return queue;
+}
+
+queue_t *queue_init_sized(size_t capacity, size_t mem_sz, CMP_F compare,
+                          int *err) {
+    if (capacity == QUEUE_UNLIMITED || mem_sz == 0) {
+        set_err(err, EINVAL);
+        return NULL;
+    }
+    queue_t *queue = calloc(1, sizeof(*queue));
+    if (queue == NULL) {
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+    queue->ring = malloc(capacity * mem_sz);
+    if (queue->ring == NULL) {
+        set_err(err, ENOMEM);
         free(queue);
         return NULL;
     }
     queue->capacity = capacity;
+    queue->mem_sz = mem_sz;
     queue->support_lookup = compare != NULL;
+    queue->compare = compare;
     return queue;
 }
 
@@ -51,11 +149,15 @@ int queue_is_full(const queue_t *queue) {
     } else if (queue->capacity == QUEUE_UNLIMITED) {
         return false;
     }
-    return (size_t)list_size(queue->q_data) == queue->capacity;
+    return queue->size == queue->capacity;
 }
 
 int queue_is_empty(const queue_t *queue) {
-    return queue == NULL ? INVALID : list_size(queue->q_data) == 0;
+    if (queue == NULL) {
+        return INVALID;
+    }
+    return queue->ring != NULL ? queue->size == 0
+                               : list_size(queue->q_data) == 0;
 }
 
 ssize_t queue_capacity(const queue_t *queue) {
@@ -63,7 +165,11 @@ ssize_t queue_capacity(const queue_t *queue) {
 }
 
 ssize_t queue_size(const queue_t *queue) {
-    return queue == NULL ? INVALID : list_size(queue->q_data);
+    if (queue == NULL) {
+        return INVALID;
+    }
+    return queue->ring != NULL ? (ssize_t)queue->size
+                               : list_size(queue->q_data);
 }
 
 int queue_enqueue(queue_t *queue, void *data) {
@@ -72,28 +178,56 @@ int queue_enqueue(queue_t *queue, void *data) {
     } else if (queue_is_full(queue)) {
         return EOVERFLOW;
     }
-    return list_push_tail(queue->q_data, data);
+    if (queue->ring == NULL) {
+        return list_push_tail(queue->q_data, data);
+    }
+    void *slot = ring_slot(queue, queue->size);
+    if (queue->mem_sz != 0) {
+        if (data == NULL) {
+            return EINVAL;
+        }
+        memcpy(slot, data, queue->mem_sz);
+    } else {
+        *(void **)slot = data;
+    }
+    queue->size++;
+    return SUCCESS;
 }
 
 void *queue_dequeue(queue_t *queue) {
     if (queue == NULL) {
         return NULL;
     }
-    return list_pop_head(queue->q_data);
+    if (queue->ring == NULL) {
+        return list_pop_head(queue->q_data);
+    }
+    if (queue->size == 0) {
+        return NULL;
+    }
+    void *data = ring_get(queue, 0);
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->size--;
+    return data;
 }
 
 void *queue_get(const queue_t *queue, size_t position) {
-    if (queue == NULL || position >= (size_t)list_size(queue->q_data)) {
+    if (queue == NULL || position >= (size_t)queue_size(queue)) {
         return NULL;
     }
-    return list_get(queue->q_data, position);
+    if (queue->ring == NULL) {
+        return list_get(queue->q_data, position);
+    }
+    return ring_get(queue, position);
 }
 
 void *queue_peek(const queue_t *queue) {
     if (queue == NULL) {
         return NULL;
     }
-    return list_peek_head(queue->q_data);
+    if (queue->ring == NULL) {
+        return list_peek_head(queue->q_data);
+    }
+    return queue->size == 0 ? NULL : ring_get(queue, 0);
 }
 
 void *queue_remove(queue_t *queue, void *item_to_remove, int *err) {
@@ -104,7 +238,36 @@ void *queue_remove(queue_t *queue, void *item_to_remove, int *err) {
         set_err(err, ENOTSUP);
         return NULL;
     }
-    return list_remove(queue->q_data, item_to_remove, err);
+    if (queue->ring == NULL) {
+        return list_remove(queue->q_data, item_to_remove, err);
+    }
+    for (size_t i = 0; i < queue->size; i++) {
+        void *data = ring_get(queue, i);
+        if (queue->compare(item_to_remove, data) == 0) {
+            if (queue->mem_sz == 0) {
+                // close the hole by shifting the pointers behind it forward
+                for (size_t j = i; j + 1 < queue->size; j++) {
+                    *(void **)ring_slot(queue, j) =
+                        *(void **)ring_slot(queue, j + 1);
+                }
+                queue->size--;
+                return data;
+            }
+            // rotate the removed element into the freed tail slot so the
+            // caller can still read it until the next enqueue
+            unsigned char tmp[queue->mem_sz];
+            memcpy(tmp, data, queue->mem_sz);
+            for (size_t j = i; j + 1 < queue->size; j++) {
+                memcpy(ring_slot(queue, j), ring_slot(queue, j + 1),
+                       queue->mem_sz);
+            }
+            queue->size--;
+            void *freed = ring_slot(queue, queue->size);
+            memcpy(freed, tmp, queue->mem_sz);
+            return freed;
+        }
+    }
+    return NULL;
 }
 
 void *queue_find_first(const queue_t *queue, const void *value_to_find,
@@ -116,14 +279,33 @@ void *queue_find_first(const queue_t *queue, const void *value_to_find,
         set_err(err, ENOTSUP);
         return NULL;
     }
-    return list_find_first(queue->q_data, value_to_find, err);
+    if (queue->ring == NULL) {
+        return list_find_first(queue->q_data, value_to_find, err);
+    }
+    for (size_t i = 0; i < queue->size; i++) {
+        void *data = ring_get(queue, i);
+        if (queue->compare(value_to_find, data) == 0) {
+            return data;
+        }
+    }
+    return NULL;
 }
 
 int queue_clear(queue_t *queue) {
     if (queue == NULL) {
         return EINVAL;
     }
-    list_clear(queue->q_data);
+    if (queue->ring == NULL) {
+        list_clear(queue->q_data);
+        return SUCCESS;
+    }
+    if (queue->customfree != NULL) {
+        for (size_t i = 0; i < queue->size; i++) {
+            queue->customfree(ring_get(queue, i));
+        }
+    }
+    queue->head = 0;
+    queue->size = 0;
     return SUCCESS;
 }
 
@@ -131,8 +313,16 @@ int queue_destroy(queue_t **queue_addr) {
     if (queue_addr == NULL || *queue_addr == NULL) {
         return EINVAL;
     }
-    list_delete(&(*queue_addr)->q_data);
-    free(*queue_addr);
+    queue_t *queue = *queue_addr;
+    // copied out because the allocator lives inside the block being freed
+    allocator_t allocator = queue->allocator;
+    if (queue->ring == NULL) {
+        list_delete(&queue->q_data);
+    } else {
+        queue_clear(queue);
+        mem_free(&allocator, queue->ring);
+    }
+    mem_free(&allocator, queue);
     *queue_addr = NULL;
     return SUCCESS;
 }
@@ -1,10 +1,13 @@
 #define _DEFAULT_SOURCE
 #include "queue_concurrent.h"
+#include "bb_stats.h"
 #include "buildingblocks.h"
 #include "queue.h"
+#include "queue_p.h"
 #include <errno.h>
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #ifdef DEBUG
@@ -37,36 +40,106 @@
 
 typedef int (*PREDICATE)(queue_c_t *queue);
 
+#ifndef __STDC_NO_ATOMICS__
+/**
+ * @brief One slot of the lock-free ring.
+ *
+ * The sequence number encodes the slot's state: equal to the enqueue
+ * position when the slot is free, position + 1 when it holds data. It is
+ * the only synchronization between a producer writing data and the
+ * consumer that claims it.
+ *
+ * @param seq slot state sequence number
+ * @param data the stored element
+ */
+struct lf_cell_t {
+    _Atomic size_t seq;
+    void *data;
+};
+
+/**
+ * @brief Bounded lock-free multi-producer/multi-consumer ring.
+ *
+ * Producers and consumers claim slots by compare-and-swap on their
+ * respective positions, so enqueue and dequeue never take the queue
+ * mutex. The ring size is a power of two so slot lookup is a mask.
+ *
+ * @param cells the slot array
+ * @param mask ring size - 1
+ * @param enq_pos next position a producer will claim
+ * @param deq_pos next position a consumer will claim
+ */
+struct lf_ring_t {
+    struct lf_cell_t *cells;
+    size_t mask;
+    _Atomic size_t enq_pos;
+    _Atomic size_t deq_pos;
+};
+#endif
+
+/**
+ * @brief One thread parked on a queue condition.
+ *
+ * Each waiting thread carries its own condition variable on its stack
+ * frame, so a state change can wake exactly one waiter instead of
+ * broadcasting to every parked thread. Waiters are linked most recently
+ * parked first, which keeps the woken thread the one with the warmest
+ * cache.
+ *
+ * @param cond condition variable private to this waiter
+ * @param next next waiter on the stack
+ * @param woken true once this waiter has been popped and signalled
+ */
+struct waiter_t {
+    pthread_cond_t cond;
+    struct waiter_t *next;
+    bool woken;
+};
+
 /**
  * @brief The deferred signals object.
  *
  * When the queue is manually locked by the user, any signals will be deferred
  * until the user unlocks the queue. This object holds the signals that need to
- * be sent.
+ * be sent, along with the stacks of threads parked on each condition.
  *
- * @param cond_is_empty condition variable to signal the queue is empty
- * @param cond_is_full condition variable to signal the queue is full
- * @param cond_not_empty condition variable to signal the queue is not empty
- * @param cond_not_full condition variable to signal the queue is not full
+ * The is_empty and is_full events wake every waiter on their stack; the
+ * not_empty and not_full events are counted and wake one waiter per
+ * enqueued or dequeued item, so a single item does not stampede a whole
+ * pool of parked consumers.
+ *
+ * @param is_empty_waiters threads waiting for the queue to be empty
+ * @param is_full_waiters threads waiting for the queue to be full
+ * @param not_empty_waiters threads waiting for the queue to not be empty
+ * @param not_full_waiters threads waiting for the queue to not be full
  * @param is_empty true if the queue is empty
  * @param is_full true if the queue is full
- * @param not_empty true if the queue is not empty
- * @param not_full true if the queue is not full
+ * @param not_empty number of pending single wakeups for not empty
+ * @param not_full number of pending single wakeups for not full
  */
 struct deferred_signals_t {
-    pthread_cond_t cond_is_empty;
-    pthread_cond_t cond_is_full;
-    pthread_cond_t cond_not_empty;
-    pthread_cond_t cond_not_full;
+    struct waiter_t *is_empty_waiters;
+    struct waiter_t *is_full_waiters;
+    struct waiter_t *not_empty_waiters;
+    struct waiter_t *not_full_waiters;
     bool is_empty;
     bool is_full;
-    bool not_empty;
-    bool not_full;
+    size_t not_empty;
+    size_t not_full;
 };
 /**
  * @brief The concurrent queue object.
  *
+ * Exactly one of queue, ring and pqueue is in use: queue_c_init creates
+ * the mutex-protected list/ring backend, queue_c_init_lockfree the
+ * bounded lock-free ring, and queue_c_init_priority the priority-ordered
+ * backend. In lock-free mode the mutex only serializes the blocking-wait
+ * slow path and manual locking; enqueue and dequeue never touch it.
+ *
  * @param queue pointer to queue object
+ * @param ring pointer to the lock-free ring, NULL in locking mode
+ * @param pqueue pointer to the priority queue, NULL unless priority mode
+ * @param customfree pointer to the user defined free function (ring mode)
  * @param lock mutex lock
  * @param counter_lock mutex lock for counters
  * @param signals deferred signals object
@@ -77,10 +150,16 @@ struct deferred_signals_t {
  * @param locked_by thread that manually locked the queue
  * @param manually_locked true if the queue was locked manually by the user
  * @param is_destroying true if the queue is being destroyed
+ * @param closed true if the queue has been closed to new data
  * @param cancel_wait true if the queue should stop waiting for a condition
  */
 struct queue_c_t {
     queue_t *queue;
+#ifndef __STDC_NO_ATOMICS__
+    struct lf_ring_t *ring;
+#endif
+    queue_p_t *pqueue;
+    FREE_F customfree;
     pthread_mutex_t lock;
     pthread_mutex_t counter_lock;
     struct deferred_signals_t signals;
@@ -95,11 +174,46 @@ struct queue_c_t {
     pthread_t locked_by;
     bool manually_locked;
     bool is_destroying;
+    bool closed;
     bool cancel_wait;
 };
 
 /* PRIVATE FUNCTIONS */
 
+/**
+ * @brief Compare two stored items by address.
+ *
+ * The priority backend requires a compare function, but the concurrent
+ * queue exposes no search API, so identity comparison is sufficient.
+ *
+ * @param value_to_find first item
+ * @param node_data second item
+ * @return int comparison of the two addresses
+ */
+static int ptr_cmp(const void *value_to_find, const void *node_data) {
+    if (value_to_find == node_data) {
+        return 0;
+    }
+    return value_to_find > node_data ? 1 : -1;
+}
+
+/**
+ * @brief Check if the backing queue has unlimited capacity.
+ *
+ * The lock-free ring is always bounded by construction.
+ *
+ * @param queue pointer to queue object
+ * @return true if the backing queue is unlimited
+ */
+static bool unlimited_capacity(queue_c_t *queue) {
+    if (queue->pqueue != NULL) {
+        return queue_p_capacity(queue->pqueue) == QUEUE_P_UNLIMITED;
+    } else if (queue->queue == NULL) {
+        return false;
+    }
+    return queue_capacity(queue->queue) == QUEUE_UNLIMITED;
+}
+
 /**
  * @brief Initialize thread constructs.
  *
@@ -117,20 +231,21 @@ static void init_thread_constructs(queue_c_t *queue) {
     pthread_mutexattr_destroy(&attr);
 
     pthread_mutex_init(&queue->counter_lock, NULL);
-    pthread_cond_init(&queue->signals.cond_is_empty, NULL);
-    pthread_cond_init(&queue->signals.cond_is_full, NULL);
-    pthread_cond_init(&queue->signals.cond_not_empty, NULL);
-    pthread_cond_init(&queue->signals.cond_not_full, NULL);
     pthread_cond_init(&queue->lock_free, NULL);
 
     queue->waiting_for_lock = 0;
     queue->waiting_for_cond = 0;
+    queue->signals.is_empty_waiters = NULL;
+    queue->signals.is_full_waiters = NULL;
+    queue->signals.not_empty_waiters = NULL;
+    queue->signals.not_full_waiters = NULL;
     queue->signals.is_empty = false;
     queue->signals.is_full = false;
-    queue->signals.not_empty = false;
-    queue->signals.not_full = false;
+    queue->signals.not_empty = 0;
+    queue->signals.not_full = 0;
     queue->manually_locked = false;
     queue->is_destroying = false;
+    queue->closed = false;
     queue->cancel_wait = false;
 }
 
@@ -151,27 +266,62 @@ static void destroy_thread_constructs(queue_c_t *queue) {
 
     pthread_mutex_destroy(&queue->lock);
     pthread_mutex_destroy(&queue->counter_lock);
-    pthread_cond_destroy(&queue->signals.cond_is_empty);
-    pthread_cond_destroy(&queue->signals.cond_is_full);
-    pthread_cond_destroy(&queue->signals.cond_not_empty);
-    pthread_cond_destroy(&queue->signals.cond_not_full);
     pthread_cond_destroy(&queue->lock_free);
 }
 
+/**
+ * @brief Pop and wake up to count waiters off a waiter stack.
+ *
+ * The queue lock must be held by the caller.
+ *
+ * @param stack pointer to the head of the waiter stack
+ * @param count max number of waiters to wake
+ */
+static void wake_waiters(struct waiter_t **stack, size_t count) {
+    while (count > 0 && *stack != NULL) {
+        struct waiter_t *waiter = *stack;
+        *stack = waiter->next;
+        waiter->woken = true;
+        pthread_cond_signal(&waiter->cond);
+        count--;
+    }
+}
+
+/**
+ * @brief Remove a waiter from a waiter stack without waking it.
+ *
+ * Used when a timed wait expires before the waiter is popped. The queue
+ * lock must be held by the caller.
+ *
+ * @param stack pointer to the head of the waiter stack
+ * @param waiter the waiter to remove
+ */
+static void unlink_waiter(struct waiter_t **stack, struct waiter_t *waiter) {
+    while (*stack != NULL) {
+        if (*stack == waiter) {
+            *stack = waiter->next;
+            return;
+        }
+        stack = &(*stack)->next;
+    }
+}
+
 /**
  * @brief Wake all threads waiting on queue.
  *
- * @param queue pointer to queue object
+ * The queue lock must be held by the caller.
+ *
+ * @param signals pointer to the deferred signals object
  */
 static void wake_all_threads(struct deferred_signals_t *signals) {
     if (signals == NULL) {
         return;
     }
     DEBUG_PRINT("\ton thread %lX: waking all threads\n", pthread_self());
-    pthread_cond_broadcast(&signals->cond_is_empty);
-    pthread_cond_broadcast(&signals->cond_is_full);
-    pthread_cond_broadcast(&signals->cond_not_empty);
-    pthread_cond_broadcast(&signals->cond_not_full);
+    wake_waiters(&signals->is_empty_waiters, SIZE_MAX);
+    wake_waiters(&signals->is_full_waiters, SIZE_MAX);
+    wake_waiters(&signals->not_empty_waiters, SIZE_MAX);
+    wake_waiters(&signals->not_full_waiters, SIZE_MAX);
 }
 
 /**
@@ -255,20 +405,24 @@ static void send_signals(queue_c_t *queue) {
           pthread_equal(queue->locked_by, pthread_self()))) {
         DEBUG_PRINT("on thread %lX: sending signals\n", pthread_self());
         if (queue->signals.is_empty) {
-            pthread_cond_broadcast(&queue->signals.cond_is_empty);
+            wake_waiters(&queue->signals.is_empty_waiters, SIZE_MAX);
             queue->signals.is_empty = false;
         }
         if (queue->signals.is_full) {
-            pthread_cond_broadcast(&queue->signals.cond_is_full);
+            wake_waiters(&queue->signals.is_full_waiters, SIZE_MAX);
             queue->signals.is_full = false;
         }
-        if (queue->signals.not_empty) {
-            pthread_cond_broadcast(&queue->signals.cond_not_empty);
-            queue->signals.not_empty = false;
+        // one waiter per item; threads that stay parked never wake just
+        // to find another consumer got there first
+        if (queue->signals.not_empty > 0) {
+            wake_waiters(&queue->signals.not_empty_waiters,
+                         queue->signals.not_empty);
+            queue->signals.not_empty = 0;
         }
-        if (queue->signals.not_full) {
-            pthread_cond_broadcast(&queue->signals.cond_not_full);
-            queue->signals.not_full = false;
+        if (queue->signals.not_full > 0) {
+            wake_waiters(&queue->signals.not_full_waiters,
+                         queue->signals.not_full);
+            queue->signals.not_full = 0;
         }
     }
 }
@@ -286,6 +440,151 @@ static void mark_manually_locked(queue_c_t *queue) {
     queue->locked_by = pthread_self();
 }
 
+#ifndef __STDC_NO_ATOMICS__
+
+/**
+ * @brief Create a lock-free ring.
+ *
+ * @param capacity requested capacity, rounded up to a power of two
+ * @return struct lf_ring_t* the ring, NULL on allocation failure
+ */
+static struct lf_ring_t *ring_create(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+        size *= 2;
+    }
+    struct lf_ring_t *ring = calloc(1, sizeof(*ring));
+    if (ring == NULL) {
+        return NULL;
+    }
+    ring->cells = malloc(size * sizeof(*ring->cells));
+    if (ring->cells == NULL) {
+        free(ring);
+        return NULL;
+    }
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&ring->cells[i].seq, i);
+        ring->cells[i].data = NULL;
+    }
+    ring->mask = size - 1;
+    atomic_init(&ring->enq_pos, 0);
+    atomic_init(&ring->deq_pos, 0);
+    return ring;
+}
+
+/**
+ * @brief Push an element onto the ring.
+ *
+ * @param ring ring to push onto
+ * @param data element to store
+ * @return int 0 on success, EOVERFLOW if the ring is full
+ */
+static int ring_enqueue(struct lf_ring_t *ring, void *data) {
+    size_t pos = atomic_load_explicit(&ring->enq_pos, memory_order_relaxed);
+    struct lf_cell_t *cell;
+    for (;;) {
+        cell = &ring->cells[pos & ring->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            // slot is free; claim it
+            if (atomic_compare_exchange_weak_explicit(
+                    &ring->enq_pos, &pos, pos + 1, memory_order_relaxed,
+                    memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return EOVERFLOW;
+        } else {
+            pos = atomic_load_explicit(&ring->enq_pos, memory_order_relaxed);
+        }
+    }
+    cell->data = data;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return SUCCESS;
+}
+
+/**
+ * @brief Pop an element off the ring.
+ *
+ * @param ring ring to pop from
+ * @param data where to store the popped element
+ * @return int 0 on success, ENODATA if the ring is empty
+ */
+static int ring_dequeue(struct lf_ring_t *ring, void **data) {
+    size_t pos = atomic_load_explicit(&ring->deq_pos, memory_order_relaxed);
+    struct lf_cell_t *cell;
+    for (;;) {
+        cell = &ring->cells[pos & ring->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (dif == 0) {
+            // slot holds data; claim it
+            if (atomic_compare_exchange_weak_explicit(
+                    &ring->deq_pos, &pos, pos + 1, memory_order_relaxed,
+                    memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return ENODATA;
+        } else {
+            pos = atomic_load_explicit(&ring->deq_pos, memory_order_relaxed);
+        }
+    }
+    *data = cell->data;
+    atomic_store_explicit(&cell->seq, pos + ring->mask + 1,
+                          memory_order_release);
+    return SUCCESS;
+}
+
+/**
+ * @brief Approximate number of elements in the ring.
+ *
+ * @param ring ring to measure
+ * @return size_t element count at some recent instant
+ */
+static size_t ring_size(struct lf_ring_t *ring) {
+    size_t enq = atomic_load_explicit(&ring->enq_pos, memory_order_relaxed);
+    size_t deq = atomic_load_explicit(&ring->deq_pos, memory_order_relaxed);
+    return enq >= deq ? enq - deq : 0;
+}
+
+/**
+ * @brief Wake waiters after a lock-free operation.
+ *
+ * The hot path never touches the mutex; only when a thread is parked in
+ * one of the wait functions does the producer or consumer take the lock
+ * to hand over the signals. If the calling thread manually locked the
+ * queue, the signals are deferred to queue_c_unlock as in locking mode.
+ *
+ * @param queue queue whose waiters to wake
+ * @param enqueued true after an enqueue, false after a dequeue
+ * @param count number of items moved, one waiter is woken per item
+ */
+static void ring_notify(queue_c_t *queue, bool enqueued, size_t count) {
+    if (queue->waiting_for_cond == 0) {
+        return;
+    }
+    int lock_err = pthread_mutex_lock(&queue->lock);
+    if (enqueued) {
+        queue->signals.not_empty += count;
+        if (queue_c_is_full(queue)) {
+            queue->signals.is_full = true;
+        }
+    } else {
+        queue->signals.not_full += count;
+        if (queue_c_is_empty(queue)) {
+            queue->signals.is_empty = true;
+        }
+    }
+    send_signals(queue);
+    if (lock_err == SUCCESS) {
+        pthread_mutex_unlock(&queue->lock);
+    }
+}
+
+#endif /* __STDC_NO_ATOMICS__ */
+
 static int not_full(queue_c_t *queue) { return !queue_c_is_full(queue); }
 
 static int not_empty(queue_c_t *queue) { return !queue_c_is_empty(queue); }
@@ -306,15 +605,21 @@ static int keep_waiting(queue_c_t *queue) {
 }
 
 /**
- * @brief Wait for condition variable.
+ * @brief Wait for a queue condition.
+ *
+ * The calling thread parks itself on the condition's waiter stack with
+ * its own condition variable, so it wakes only when a state change is
+ * handed to it specifically (or on a wake-all event such as cancel,
+ * close or destroy).
  *
  * @param queue pointer to queue object
- * @param condition condition variable to wait for
+ * @param stack waiter stack of the condition to wait for
  * @param pred predicate function
  * @return int 0 if success, error code otherwise
  */
-static int wait_for(queue_c_t *queue, pthread_cond_t *cond, PREDICATE pred) {
-    if (queue == NULL || queue->is_destroying || cond == NULL || pred == NULL) {
+static int wait_for(queue_c_t *queue, struct waiter_t **stack, PREDICATE pred) {
+    if (queue == NULL || queue->is_destroying || stack == NULL ||
+        pred == NULL) {
         return EINVAL;
     }
     DEBUG_PRINT("on thread %lX: getting condition lock\n", pthread_self());
@@ -327,11 +632,31 @@ static int wait_for(queue_c_t *queue, pthread_cond_t *cond, PREDICATE pred) {
         return err;
     }
     DEBUG_PRINT("on thread %lX: condition lock acquired\n", pthread_self());
-    while ((!pred(queue)) && keep_waiting(queue)) {
+    uint64_t wait_start = bb_stats_active() ? bb_stats_now_ns() : 0;
+    struct waiter_t self = {.next = NULL, .woken = false};
+    pthread_cond_init(&self.cond, NULL);
+    while ((!pred(queue)) && keep_waiting(queue) && !queue->closed) {
         DEBUG_PRINT("on thread %lX: waiting for condition\n", pthread_self());
-        pthread_cond_wait(cond, &queue->lock);
+        // park most-recently-first so wakeups hit the warmest cache
+        self.woken = false;
+        self.next = *stack;
+        *stack = &self;
+        while (!self.woken) {
+            pthread_cond_wait(&self.cond, &queue->lock);
+        }
+    }
+    pthread_cond_destroy(&self.cond);
+    if (wait_start != 0) {
+        bb_stats_add(BB_STAT_QUEUE_C_WAIT_NS, bb_stats_now_ns() - wait_start);
     }
     ATOMIC_DEC(queue->waiting_for_cond, queue->counter_lock);
+    // a closed queue can still satisfy the condition (e.g. draining a
+    // non-empty queue); only fail the waiters it can never satisfy
+    if (queue->closed && !pred(queue)) {
+        DEBUG_PRINT("on thread %lX: the queue is closed\n", pthread_self());
+        auto_unlock_queue(queue);
+        return EPIPE;
+    }
     if (!keep_waiting(queue)) {
         DEBUG_PRINT("on thread %lX: should stop waiting\n", pthread_self());
         // stop canceling wait if no other thread is waiting for a condition
@@ -348,19 +673,19 @@ static int wait_for(queue_c_t *queue, pthread_cond_t *cond, PREDICATE pred) {
 }
 
 /**
- * @brief Wait for condition variable with timeout.
+ * @brief Wait for a queue condition with timeout.
  *
  * @param queue pointer to queue object
- * @param condition condition variable to wait for
+ * @param stack waiter stack of the condition to wait for
  * @param pred predicate function
  * @param timeout timeout in seconds
  * @return int 0 if success, error code otherwise
  */
-static int timed_wait_for(queue_c_t *queue, pthread_cond_t *cond,
+static int timed_wait_for(queue_c_t *queue, struct waiter_t **stack,
                           PREDICATE pred, time_t timeout) {
     if (timeout == 0) {
-        return wait_for(queue, cond, pred);
-    } else if (queue == NULL || queue->is_destroying || cond == NULL ||
+        return wait_for(queue, stack, pred);
+    } else if (queue == NULL || queue->is_destroying || stack == NULL ||
                pred == NULL || timeout < 0) {
         return EINVAL;
     }
@@ -373,16 +698,42 @@ static int timed_wait_for(queue_c_t *queue, pthread_cond_t *cond,
         return err;
     }
     DEBUG_PRINT("on thread %lX: condition lock acquired\n", pthread_self());
-    if ((!pred(queue)) && keep_waiting(queue)) {
+    if ((!pred(queue)) && keep_waiting(queue) && !queue->closed) {
         DEBUG_PRINT("on thread %lX: waiting for condition\n", pthread_self());
-        int err = pthread_cond_timedwait(cond, &queue->lock, &abs_timeout);
-        if (err == ETIMEDOUT) {
+        uint64_t wait_start = bb_stats_active() ? bb_stats_now_ns() : 0;
+        struct waiter_t self = {.next = *stack, .woken = false};
+        pthread_cond_init(&self.cond, NULL);
+        *stack = &self;
+        err = SUCCESS;
+        while (!self.woken && err != ETIMEDOUT) {
+            err = pthread_cond_timedwait(&self.cond, &queue->lock,
+                                         &abs_timeout);
+        }
+        if (!self.woken) {
+            unlink_waiter(stack, &self);
+        }
+        pthread_cond_destroy(&self.cond);
+        if (wait_start != 0) {
+            bb_stats_add(BB_STAT_QUEUE_C_WAIT_NS,
+                         bb_stats_now_ns() - wait_start);
+        }
+        // a waker may spend a wakeup credit on this thread in the same
+        // instant the wait times out; honoring the wakeup keeps the
+        // credit from being lost
+        if (err == ETIMEDOUT && !self.woken) {
             queue->waiting_for_cond--;
             auto_unlock_queue(queue);
             return ETIMEDOUT;
         }
     }
     ATOMIC_DEC(queue->waiting_for_cond, queue->counter_lock);
+    // a closed queue can still satisfy the condition (e.g. draining a
+    // non-empty queue); only fail the waiters it can never satisfy
+    if (queue->closed && !pred(queue)) {
+        DEBUG_PRINT("on thread %lX: the queue is closed\n", pthread_self());
+        auto_unlock_queue(queue);
+        return EPIPE;
+    }
     if (!keep_waiting(queue)) {
         DEBUG_PRINT("on thread %lX: should stop waiting\n", pthread_self());
         // stop canceling wait if no other thread is waiting for a condition
@@ -411,6 +762,66 @@ queue_c_t *queue_c_init(size_t capacity, FREE_F customfree, int *err) {
         free(queue_c);
         return NULL;
     }
+#ifndef __STDC_NO_ATOMICS__
+    queue_c->ring = NULL;
+#endif
+    queue_c->pqueue = NULL;
+    queue_c->customfree = customfree;
+
+    init_thread_constructs(queue_c);
+    return queue_c;
+}
+
+queue_c_t *queue_c_init_lockfree(size_t capacity, FREE_F customfree, int *err) {
+#ifdef __STDC_NO_ATOMICS__
+    (void)capacity;
+    (void)customfree;
+    set_err(err, ENOTSUP);
+    return NULL;
+#else
+    if (capacity == QUEUE_C_UNLIMITED) {
+        // the ring is bounded by construction
+        set_err(err, EINVAL);
+        return NULL;
+    }
+    queue_c_t *queue_c = malloc(sizeof(*queue_c));
+    if (queue_c == NULL) {
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+
+    queue_c->queue = NULL;
+    queue_c->ring = ring_create(capacity);
+    if (queue_c->ring == NULL) {
+        free(queue_c);
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+    queue_c->pqueue = NULL;
+    queue_c->customfree = customfree;
+
+    init_thread_constructs(queue_c);
+    return queue_c;
+#endif
+}
+
+queue_c_t *queue_c_init_priority(size_t capacity, FREE_F customfree, int *err) {
+    queue_c_t *queue_c = malloc(sizeof(*queue_c));
+    if (queue_c == NULL) {
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+
+    queue_c->queue = NULL;
+#ifndef __STDC_NO_ATOMICS__
+    queue_c->ring = NULL;
+#endif
+    queue_c->pqueue = queue_p_init(capacity, customfree, ptr_cmp, err);
+    if (queue_c->pqueue == NULL) {
+        free(queue_c);
+        return NULL;
+    }
+    queue_c->customfree = customfree;
 
     init_thread_constructs(queue_c);
     return queue_c;
@@ -419,6 +830,14 @@ queue_c_t *queue_c_init(size_t capacity, FREE_F customfree, int *err) {
 int queue_c_is_full(queue_c_t *queue) {
     if (queue == NULL || queue->is_destroying) {
         return INVALID;
+    }
+#ifndef __STDC_NO_ATOMICS__
+    if (queue->ring != NULL) {
+        return ring_size(queue->ring) > queue->ring->mask;
+    }
+#endif
+    if (queue->pqueue != NULL) {
+        return queue_p_is_full(queue->pqueue);
     } else if (queue_capacity(queue->queue) == QUEUE_UNLIMITED) {
         return 0;
     }
@@ -432,38 +851,38 @@ int queue_c_is_full(queue_c_t *queue) {
 int queue_c_wait_for_full(queue_c_t *queue) {
     if (queue == NULL || queue->is_destroying) {
         return EINVAL;
-    } else if (queue_capacity(queue->queue) == QUEUE_UNLIMITED) {
+    } else if (unlimited_capacity(queue)) {
         return ENOTSUP;
     }
-    return wait_for(queue, &queue->signals.cond_is_full, queue_c_is_full);
+    return wait_for(queue, &queue->signals.is_full_waiters, queue_c_is_full);
 }
 
 int queue_c_timed_wait_for_full(queue_c_t *queue, time_t timeout) {
     if (queue == NULL || queue->is_destroying) {
         return EINVAL;
-    } else if (queue_capacity(queue->queue) == QUEUE_UNLIMITED) {
+    } else if (unlimited_capacity(queue)) {
         return ENOTSUP;
     }
-    return timed_wait_for(queue, &queue->signals.cond_is_full, queue_c_is_full,
-                          timeout);
+    return timed_wait_for(queue, &queue->signals.is_full_waiters,
+                          queue_c_is_full, timeout);
 }
 
 int queue_c_wait_for_not_full(queue_c_t *queue) {
     if (queue == NULL || queue->is_destroying) {
         return EINVAL;
-    } else if (queue_capacity(queue->queue) == QUEUE_UNLIMITED) {
+    } else if (unlimited_capacity(queue)) {
         return ENOTSUP;
     }
-    return wait_for(queue, &queue->signals.cond_not_full, not_full);
+    return wait_for(queue, &queue->signals.not_full_waiters, not_full);
 }
 
 int queue_c_timed_wait_for_not_full(queue_c_t *queue, time_t timeout) {
     if (queue == NULL || queue->is_destroying) {
         return EINVAL;
-    } else if (queue_capacity(queue->queue) == QUEUE_UNLIMITED) {
+    } else if (unlimited_capacity(queue)) {
         return ENOTSUP;
     }
-    return timed_wait_for(queue, &queue->signals.cond_not_full, not_full,
+    return timed_wait_for(queue, &queue->signals.not_full_waiters, not_full,
                           timeout);
 }
 
@@ -472,6 +891,14 @@ int queue_c_is_empty(queue_c_t *queue) {
         return INVALID;
     }
     DEBUG_PRINT("on thread %lX: checking if queue is empty\n", pthread_self());
+#ifndef __STDC_NO_ATOMICS__
+    if (queue->ring != NULL) {
+        return ring_size(queue->ring) == 0;
+    }
+#endif
+    if (queue->pqueue != NULL) {
+        return queue_p_is_empty(queue->pqueue);
+    }
     int response = queue_is_empty(queue->queue);
     DEBUG_PRINT("on thread %lX: queue is%s empty\n", pthread_self(),
                 response ? "" : " NOT");
@@ -482,7 +909,7 @@ int queue_c_wait_for_empty(queue_c_t *queue) {
     if (queue == NULL || queue->is_destroying) {
         return EINVAL;
     } else {
-        return wait_for(queue, &queue->signals.cond_is_empty, queue_c_is_empty);
+        return wait_for(queue, &queue->signals.is_empty_waiters, queue_c_is_empty);
     }
 }
 
@@ -490,7 +917,7 @@ int queue_c_timed_wait_for_empty(queue_c_t *queue, time_t timeout) {
     if (queue == NULL || queue->is_destroying) {
         return EINVAL;
     } else {
-        return timed_wait_for(queue, &queue->signals.cond_is_empty,
+        return timed_wait_for(queue, &queue->signals.is_empty_waiters,
                               queue_c_is_empty, timeout);
     }
 }
@@ -499,7 +926,7 @@ int queue_c_wait_for_not_empty(queue_c_t *queue) {
     if (queue == NULL || queue->is_destroying) {
         return EINVAL;
     } else {
-        return wait_for(queue, &queue->signals.cond_not_empty, not_empty);
+        return wait_for(queue, &queue->signals.not_empty_waiters, not_empty);
     }
 }
 
@@ -507,8 +934,8 @@ int queue_c_timed_wait_for_not_empty(queue_c_t *queue, time_t timeout) {
     if (queue == NULL || queue->is_destroying) {
         return EINVAL;
     } else {
-        return timed_wait_for(queue, &queue->signals.cond_not_empty, not_empty,
-                              timeout);
+        return timed_wait_for(queue, &queue->signals.not_empty_waiters,
+                              not_empty, timeout);
     }
 }
 
@@ -516,8 +943,34 @@ int queue_c_cancel_wait(queue_c_t *queue) {
     if (queue == NULL || queue->is_destroying) {
         return EINVAL;
     }
+    // the waiter stacks are protected by the queue lock; tolerate
+    // EDEADLK so a thread holding the manual lock can still cancel
+    int lock_err = pthread_mutex_lock(&queue->lock);
     queue->cancel_wait = true;
     wake_all_threads(&queue->signals);
+    if (lock_err == SUCCESS) {
+        pthread_mutex_unlock(&queue->lock);
+    }
+    return SUCCESS;
+}
+
+int queue_c_close(queue_c_t *queue) {
+    if (queue == NULL || queue->is_destroying) {
+        return EINVAL;
+    }
+    if (queue->closed) {
+        // closing twice is harmless
+        return SUCCESS;
+    }
+    // the flag is raised under the lock so waiters can't park between the
+    // flag check and the broadcast
+    DEBUG_PRINT("on thread %lX: closing the queue\n", pthread_self());
+    if (lock_queue(queue) == EINTR) {
+        return EINTR;
+    }
+    queue->closed = true;
+    wake_all_threads(&queue->signals);
+    auto_unlock_queue(queue);
     return SUCCESS;
 }
 
@@ -561,6 +1014,14 @@ ssize_t queue_c_capacity(queue_c_t *queue) {
     if (queue == NULL || queue->is_destroying) {
         return INVALID;
     }
+#ifndef __STDC_NO_ATOMICS__
+    if (queue->ring != NULL) {
+        return (ssize_t)(queue->ring->mask + 1);
+    }
+#endif
+    if (queue->pqueue != NULL) {
+        return queue_p_capacity(queue->pqueue);
+    }
     return queue_capacity(queue->queue);
 }
 
@@ -568,6 +1029,14 @@ ssize_t queue_c_size(queue_c_t *queue) {
     if (queue == NULL || queue->is_destroying) {
         return INVALID;
     }
+#ifndef __STDC_NO_ATOMICS__
+    if (queue->ring != NULL) {
+        return (ssize_t)ring_size(queue->ring);
+    }
+#endif
+    if (queue->pqueue != NULL) {
+        return queue_p_size(queue->pqueue);
+    }
     return queue_size(queue->queue);
 }
 
@@ -576,11 +1045,30 @@ int queue_c_enqueue(queue_c_t *queue, void *data) {
         return EINVAL;
     }
 
+#ifndef __STDC_NO_ATOMICS__
+    if (queue->ring != NULL) {
+        if (queue->closed) {
+            return EPIPE;
+        }
+        int res = ring_enqueue(queue->ring, data);
+        if (res != SUCCESS) {
+            return res;
+        }
+        bb_stats_record(BB_STAT_QUEUE_C_DEPTH, ring_size(queue->ring));
+        ring_notify(queue, true, 1);
+        return SUCCESS;
+    }
+#endif
+
     // deadlock error can be ignored, it was caused by one of the lock functions
     // check if destruction was called while waiting for lock
     DEBUG_PRINT("on thread %lX: getting auto lock\n", pthread_self());
     if (lock_queue(queue) == EINTR) {
         return EINTR;
+    } else if (queue->closed) {
+        DEBUG_PRINT("on thread %lX: the queue is closed\n", pthread_self());
+        auto_unlock_queue(queue);
+        return EPIPE;
     } else if (queue_c_is_full(queue)) {
         DEBUG_PRINT("on thread %lX: the queue is full\n", pthread_self());
         auto_unlock_queue(queue);
@@ -588,7 +1076,10 @@ int queue_c_enqueue(queue_c_t *queue, void *data) {
     }
 
     DEBUG_PRINT("\ton thread %lX: \tEnqueueing...\n", pthread_self());
-    int res = queue_enqueue(queue->queue, data);
+    // priority mode: plain enqueues get the default priority
+    int res = queue->pqueue != NULL
+                  ? queue_p_enqueue(queue->pqueue, data, QUEUE_C_DEFAULT_PRI)
+                  : queue_enqueue(queue->queue, data);
     if (res != SUCCESS) {
         DEBUG_PRINT("on thread %lX: enqueue failed: %s\n", pthread_self(),
                     strerror(res));
@@ -596,9 +1087,12 @@ int queue_c_enqueue(queue_c_t *queue, void *data) {
         return res;
     }
     DEBUG_PRINT("on thread %lX: enqueue successful\n", pthread_self());
+    bb_stats_record(BB_STAT_QUEUE_C_DEPTH,
+                    queue->pqueue != NULL ? queue_p_size(queue->pqueue)
+                                          : queue_size(queue->queue));
 
     // set up signals
-    queue->signals.not_empty = true;
+    queue->signals.not_empty++;
     if (queue_c_is_full(queue)) {
         queue->signals.is_full = true;
     }
@@ -607,12 +1101,125 @@ int queue_c_enqueue(queue_c_t *queue, void *data) {
     return SUCCESS;
 }
 
+int queue_c_enqueue_pri(queue_c_t *queue, void *data, double priority) {
+    if (queue == NULL || queue->is_destroying) {
+        return EINVAL;
+    } else if (queue->pqueue == NULL) {
+        return ENOTSUP;
+    }
+
+    // deadlock error can be ignored, it was caused by one of the lock functions
+    // check if destruction was called while waiting for lock
+    DEBUG_PRINT("on thread %lX: getting auto lock\n", pthread_self());
+    if (lock_queue(queue) == EINTR) {
+        return EINTR;
+    } else if (queue->closed) {
+        DEBUG_PRINT("on thread %lX: the queue is closed\n", pthread_self());
+        auto_unlock_queue(queue);
+        return EPIPE;
+    } else if (queue_c_is_full(queue)) {
+        DEBUG_PRINT("on thread %lX: the queue is full\n", pthread_self());
+        auto_unlock_queue(queue);
+        return EOVERFLOW;
+    }
+
+    DEBUG_PRINT("\ton thread %lX: \tEnqueueing at priority %f...\n",
+                pthread_self(), priority);
+    int res = queue_p_enqueue(queue->pqueue, data, priority);
+    if (res != SUCCESS) {
+        DEBUG_PRINT("on thread %lX: enqueue failed: %s\n", pthread_self(),
+                    strerror(res));
+        auto_unlock_queue(queue);
+        return res;
+    }
+    DEBUG_PRINT("on thread %lX: enqueue successful\n", pthread_self());
+
+    // set up signals
+    queue->signals.not_empty++;
+    if (queue_c_is_full(queue)) {
+        queue->signals.is_full = true;
+    }
+    send_signals(queue);
+    auto_unlock_queue(queue);
+    return SUCCESS;
+}
+
+ssize_t queue_c_enqueue_n(queue_c_t *queue, void **items, size_t n) {
+    if (queue == NULL || queue->is_destroying || items == NULL) {
+        return INVALID;
+    }
+
+#ifndef __STDC_NO_ATOMICS__
+    if (queue->ring != NULL) {
+        if (queue->closed) {
+            return INVALID;
+        }
+        size_t count = 0;
+        while (count < n && ring_enqueue(queue->ring, items[count]) == SUCCESS) {
+            count++;
+        }
+        if (count > 0) {
+            ring_notify(queue, true, count);
+        }
+        return count;
+    }
+#endif
+
+    // deadlock error can be ignored, it was caused by one of the lock functions
+    // check if destruction was called while waiting for lock
+    DEBUG_PRINT("on thread %lX: getting auto lock\n", pthread_self());
+    if (lock_queue(queue) == EINTR) {
+        return INVALID;
+    }
+    if (queue->closed) {
+        DEBUG_PRINT("on thread %lX: the queue is closed\n", pthread_self());
+        auto_unlock_queue(queue);
+        return INVALID;
+    }
+
+    size_t count = 0;
+    while (count < n && !queue_c_is_full(queue) &&
+           (queue->pqueue != NULL
+                ? queue_p_enqueue(queue->pqueue, items[count],
+                                  QUEUE_C_DEFAULT_PRI)
+                : queue_enqueue(queue->queue, items[count])) == SUCCESS) {
+        count++;
+    }
+    DEBUG_PRINT("on thread %lX: enqueued %zu items\n", pthread_self(), count);
+
+    // one signalling round for the whole batch
+    if (count > 0) {
+        queue->signals.not_empty += count;
+        if (queue_c_is_full(queue)) {
+            queue->signals.is_full = true;
+        }
+        send_signals(queue);
+    }
+    auto_unlock_queue(queue);
+    return count;
+}
+
 void *queue_c_dequeue(queue_c_t *queue, int *err) {
     if (queue == NULL || queue->is_destroying) {
         set_err(err, EINVAL);
         return NULL;
     }
 
+#ifndef __STDC_NO_ATOMICS__
+    if (queue->ring != NULL) {
+        void *data = NULL;
+        if (ring_dequeue(queue->ring, &data) != SUCCESS) {
+            // a closed queue drains the items left, then fails
+            if (queue->closed) {
+                set_err(err, EPIPE);
+            }
+            return NULL;
+        }
+        ring_notify(queue, false, 1);
+        return data;
+    }
+#endif
+
     // deadlock error can be ignored, it was caused by one of the lock functions
     // check if destruction was called while waiting for lock
     DEBUG_PRINT("on thread %lX: getting auto lock\n", pthread_self());
@@ -621,15 +1228,26 @@ void *queue_c_dequeue(queue_c_t *queue, int *err) {
         return NULL;
     } else if (queue_c_is_empty(queue)) {
         DEBUG_PRINT("on thread %lX: the queue is empty\n", pthread_self());
+        // a closed queue drains the items left, then fails
+        if (queue->closed) {
+            set_err(err, EPIPE);
+        }
         auto_unlock_queue(queue);
         return NULL;
     }
 
     DEBUG_PRINT("dequeueing...\n");
-    void *data = queue_dequeue(queue->queue);
+    void *data;
+    if (queue->pqueue != NULL) {
+        queue_p_node_t *node = queue_p_dequeue(queue->pqueue);
+        data = node->data;
+        free(node);
+    } else {
+        data = queue_dequeue(queue->queue);
+    }
 
     // set up signals
-    queue->signals.not_full = true;
+    queue->signals.not_full++;
     if (queue_c_is_empty(queue)) {
         queue->signals.is_empty = true;
     }
@@ -638,10 +1256,82 @@ void *queue_c_dequeue(queue_c_t *queue, int *err) {
     return data;
 }
 
+ssize_t queue_c_dequeue_n(queue_c_t *queue, void **items, size_t max_n) {
+    if (queue == NULL || queue->is_destroying || items == NULL) {
+        return INVALID;
+    }
+
+#ifndef __STDC_NO_ATOMICS__
+    if (queue->ring != NULL) {
+        size_t count = 0;
+        while (count < max_n &&
+               ring_dequeue(queue->ring, &items[count]) == SUCCESS) {
+            count++;
+        }
+        if (count > 0) {
+            ring_notify(queue, false, count);
+        } else if (queue->closed) {
+            // a closed queue drains the items left, then fails
+            return INVALID;
+        }
+        return count;
+    }
+#endif
+
+    // deadlock error can be ignored, it was caused by one of the lock functions
+    // check if destruction was called while waiting for lock
+    DEBUG_PRINT("on thread %lX: getting auto lock\n", pthread_self());
+    if (lock_queue(queue) == EINTR) {
+        return INVALID;
+    }
+
+    size_t count = 0;
+    while (count < max_n && !queue_c_is_empty(queue)) {
+        if (queue->pqueue != NULL) {
+            queue_p_node_t *node = queue_p_dequeue(queue->pqueue);
+            items[count++] = node->data;
+            free(node);
+        } else {
+            items[count++] = queue_dequeue(queue->queue);
+        }
+    }
+    DEBUG_PRINT("on thread %lX: dequeued %zu items\n", pthread_self(), count);
+
+    // one signalling round for the whole batch
+    if (count > 0) {
+        queue->signals.not_full += count;
+        if (queue_c_is_empty(queue)) {
+            queue->signals.is_empty = true;
+        }
+        send_signals(queue);
+    } else if (queue->closed) {
+        // a closed queue drains the items left, then fails
+        auto_unlock_queue(queue);
+        return INVALID;
+    }
+    auto_unlock_queue(queue);
+    return count;
+}
+
 void *queue_c_peek(queue_c_t *queue) {
     if (queue == NULL || queue->is_destroying) {
         return NULL;
     }
+#ifndef __STDC_NO_ATOMICS__
+    if (queue->ring != NULL) {
+        // best effort: the element may be claimed by a consumer on another
+        // thread before the caller looks at it
+        struct lf_ring_t *ring = queue->ring;
+        size_t pos = atomic_load_explicit(&ring->deq_pos, memory_order_relaxed);
+        struct lf_cell_t *cell = &ring->cells[pos & ring->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        return seq == pos + 1 ? cell->data : NULL;
+    }
+#endif
+    if (queue->pqueue != NULL) {
+        queue_p_node_t *node = queue_p_peek(queue->pqueue);
+        return node != NULL ? node->data : NULL;
+    }
     return queue_peek(queue->queue);
 }
 
@@ -655,10 +1345,30 @@ int queue_c_clear(queue_c_t *queue) {
     if (lock_queue(queue) == EINTR) {
         return EINTR;
     }
-    queue_clear(queue->queue);
+#ifndef __STDC_NO_ATOMICS__
+    if (queue->ring != NULL) {
+        void *data = NULL;
+        while (ring_dequeue(queue->ring, &data) == SUCCESS) {
+            if (queue->customfree != NULL) {
+                queue->customfree(data);
+            }
+        }
+    } else if (queue->pqueue != NULL) {
+        queue_p_clear(queue->pqueue);
+    } else {
+        queue_clear(queue->queue);
+    }
+#else
+    if (queue->pqueue != NULL) {
+        queue_p_clear(queue->pqueue);
+    } else {
+        queue_clear(queue->queue);
+    }
+#endif
 
-    // set up signals
-    queue->signals.not_full = true;
+    // set up signals; every parked producer can make progress against an
+    // emptied queue, so broadcast rather than credit single wakeups
+    queue->signals.not_full = SIZE_MAX;
     queue->signals.is_empty = true;
     send_signals(queue);
     auto_unlock_queue(queue);
@@ -681,7 +1391,23 @@ int queue_c_destroy(queue_c_t **queue_addr) {
     (*queue_addr)->is_destroying = true;
     wake_all_threads(&(*queue_addr)->signals);
 
-    queue_destroy(&(*queue_addr)->queue);
+#ifndef __STDC_NO_ATOMICS__
+    if ((*queue_addr)->ring != NULL) {
+        void *data = NULL;
+        while (ring_dequeue((*queue_addr)->ring, &data) == SUCCESS) {
+            if ((*queue_addr)->customfree != NULL) {
+                (*queue_addr)->customfree(data);
+            }
+        }
+        free((*queue_addr)->ring->cells);
+        free((*queue_addr)->ring);
+    }
+#endif
+    if ((*queue_addr)->pqueue != NULL) {
+        queue_p_destroy(&(*queue_addr)->pqueue);
+    } else {
+        queue_destroy(&(*queue_addr)->queue);
+    }
     destroy_thread_constructs(*queue_addr);
     free(*queue_addr);
     *queue_addr = NULL;
@@ -1,7 +1,5 @@
 #include "queue_p.h"
 #include "buildingblocks.h"
-#include "linked_list.h"
-#include "queue.h"
 #include <errno.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -11,19 +9,44 @@
 #define SUCCESS 0
 #define INVALID -1
 
+#define HEAP_INITIAL_CAP 16 // slots allocated when the first node arrives
+
+/**
+ * @brief One slot of the priority heap.
+ *
+ * The sequence number records enqueue order and breaks priority ties, so
+ * nodes with equal priority still dequeue first-in first-out even though
+ * the heap itself is not order preserving.
+ *
+ * @param node the caller-visible node
+ * @param seq enqueue sequence number for FIFO tie breaking
+ */
+struct heap_entry_t {
+    queue_p_node_t *node;
+    size_t seq;
+};
+
 /**
  * @brief structure of a queue object
  *
- * @param list is the list containing the queue node pointers
+ * Nodes live in an array-backed binary max-heap ordered by priority:
+ * enqueue and dequeue are O(log n) sift operations over contiguous
+ * memory, with no per-priority sub-queue objects.
+ *
+ * @param heap array holding the binary heap
+ * @param heap_cap allocated capacity of the heap array
  * @param capacity is the number of nodes the queue can hold
  * @param size is the number of nodes the queue is currently storing
+ * @param next_seq sequence number handed to the next enqueued node
  * @param customfree pointer to the user defined free function
- * @compare pointer to the user defined compare function
+ * @param compare pointer to the user defined compare function
  */
 struct queue_p_t {
-    list_t *list;
+    struct heap_entry_t *heap;
+    size_t heap_cap;
     size_t capacity;
     size_t size;
+    size_t next_seq;
     FREE_F customfree;
     CMP_F compare;
 };
@@ -31,79 +54,156 @@ struct queue_p_t {
 /* PRIVATE FUNCTIONS */
 
 /**
- * @brief Compare priorities to find the correct queue.
+ * @brief Check whether one entry dequeues before another.
  *
- * Compares a given priority to the priority of a list of queues. Returns 0 if
- * the priority is found, -1 if the priority is greater than the priority of the
- * current queue, and 1 if the priority is less than the priority of the current
- * queue.
+ * Higher priority wins; equal priorities fall back on enqueue order.
  *
- * @param value_to_find pointer to the priority to find
- * @param node_data pointer to the queue to compare
- * @return int the result of the comparison
+ * @param first entry to test
+ * @param second entry to test against
+ * @return bool true if first dequeues before second
  */
-int q_cmp(const void *value_to_find, const void *node_data) {
-    if (value_to_find == NULL || node_data == NULL) {
-        return 0; // stable sort on error
+static bool entry_before(const struct heap_entry_t *first,
+                         const struct heap_entry_t *second) {
+    if (first->node->priority != second->node->priority) {
+        return first->node->priority > second->node->priority;
     }
-    int priority = *(double *)value_to_find;
-    queue_p_node_t *node = queue_peek((queue_t *)node_data);
-    if (node == NULL) {
-        return 0; // stable sort on error
+    return first->seq < second->seq;
+}
+
+/**
+ * @brief Swap two heap entries.
+ *
+ * @param heap the heap array
+ * @param first index of the first entry
+ * @param second index of the second entry
+ */
+static void entry_swap(struct heap_entry_t *heap, size_t first, size_t second) {
+    struct heap_entry_t tmp = heap[first];
+    heap[first] = heap[second];
+    heap[second] = tmp;
+}
+
+/**
+ * @brief Restore the heap property upward from an index.
+ *
+ * @param queue queue whose heap to fix
+ * @param idx index of the possibly misplaced entry
+ */
+static void sift_up(queue_p_t *queue, size_t idx) {
+    while (idx > 0) {
+        size_t parent = (idx - 1) / 2;
+        if (!entry_before(&queue->heap[idx], &queue->heap[parent])) {
+            break;
+        }
+        entry_swap(queue->heap, idx, parent);
+        idx = parent;
     }
-    if (node->priority > priority) {
-        return -1;
-    } else if (node->priority < priority) {
-        return 1;
-    } else {
-        return 0;
+}
+
+/**
+ * @brief Restore the heap property downward from an index.
+ *
+ * @param queue queue whose heap to fix
+ * @param idx index of the possibly misplaced entry
+ */
+static void sift_down(queue_p_t *queue, size_t idx) {
+    for (;;) {
+        size_t best = idx;
+        size_t left = (2 * idx) + 1;
+        size_t right = left + 1;
+        if (left < queue->size &&
+            entry_before(&queue->heap[left], &queue->heap[best])) {
+            best = left;
+        }
+        if (right < queue->size &&
+            entry_before(&queue->heap[right], &queue->heap[best])) {
+            best = right;
+        }
+        if (best == idx) {
+            return;
+        }
+        entry_swap(queue->heap, idx, best);
+        idx = best;
     }
 }
 
 /**
- * @brief Free a queue.
+ * @brief Remove the entry at a heap index and return its node.
  *
- * This function is passed to the list_new function to free the queue when the
- * list is destroyed. It is a wrapper for queue_destroy.
+ * The last entry takes the removed slot and is sifted to its place.
  *
- * @param data pointer to the queue to free
+ * @param queue queue to remove from
+ * @param idx heap index of the entry to remove
+ * @return queue_p_node_t* the removed node
  */
-void q_dst(void *data) {
-    queue_t *queue = data;
-    queue_destroy(&queue);
+static queue_p_node_t *heap_delete(queue_p_t *queue, size_t idx) {
+    queue_p_node_t *node = queue->heap[idx].node;
+    queue->size--;
+    if (idx != queue->size) {
+        queue->heap[idx] = queue->heap[queue->size];
+        sift_down(queue, idx);
+        sift_up(queue, idx);
+    }
+    if (queue->size == 0) {
+        // no pending ties left, so the tie breaker can restart
+        queue->next_seq = 0;
+    }
+    return node;
 }
 
 /**
- * @brief Create a new queue and insert it into the list.
+ * @brief Find the heap index of the entry at a dequeue-order position.
+ *
+ * The heap array is not sorted, so the position is resolved by ranking:
+ * the wanted entry is the one preceded by exactly position others. This
+ * is O(n^2) and meant for the positional inspection API, not the hot
+ * enqueue/dequeue path.
  *
- * @param queue pointer to the queue_p_t object
- * @param node pointer to the queue_p_node_t object
- * @param list_idx index to insert the new queue into the list
- * @return int 0 on success, non-zero on failure
+ * @param queue queue to search
+ * @param position position in dequeue order, 0 being the front
+ * @return ssize_t heap index of the entry, -1 if out of range
  */
-int push_new_node(queue_p_t *queue, queue_p_node_t *node, size_t list_idx) {
-    if (queue == NULL) {
-        return EINVAL;
-    }
-    int err = SUCCESS;
-    queue_t *new_queue =
-        queue_init(queue->capacity, free, queue->compare, &err);
-    if (new_queue == NULL) {
-        free(node);
-        return err;
+static ssize_t index_of_position(const queue_p_t *queue, size_t position) {
+    if (position >= queue->size) {
+        return INVALID;
     }
-    err = queue_enqueue(new_queue, node);
-    if (err != SUCCESS) {
-        queue_destroy(&new_queue);
-        return err;
+    for (size_t i = 0; i < queue->size; i++) {
+        size_t rank = 0;
+        for (size_t j = 0; j < queue->size; j++) {
+            if (j != i && entry_before(&queue->heap[j], &queue->heap[i])) {
+                rank++;
+            }
+        }
+        if (rank == position) {
+            return i;
+        }
     }
-    err = list_insert(queue->list, new_queue, list_idx);
-    if (err == SUCCESS) {
-        queue->size++;
-    } else {
-        queue_destroy(&new_queue);
+    return INVALID;
+}
+
+/**
+ * @brief Find the heap index of the first entry matching a value.
+ *
+ * "First" means earliest in dequeue order, matching the behavior of the
+ * old per-priority sub-queue scan.
+ *
+ * @param queue queue to search
+ * @param value_to_find value to pass to the compare function
+ * @return ssize_t heap index of the match, -1 if not found
+ */
+static ssize_t index_of_value(const queue_p_t *queue,
+                              const void *value_to_find) {
+    ssize_t found = INVALID;
+    for (size_t i = 0; i < queue->size; i++) {
+        if (queue->compare(value_to_find, queue->heap[i].node) != 0) {
+            continue;
+        }
+        if (found == INVALID ||
+            entry_before(&queue->heap[i], &queue->heap[found])) {
+            found = i;
+        }
     }
-    return err;
+    return found;
 }
 
 /* PUBLIC FUNCTIONS */
@@ -114,18 +214,12 @@ queue_p_t *queue_p_init(size_t capacity, FREE_F customfree, CMP_F compare,
         set_err(err, EINVAL);
         return NULL;
     }
-    queue_p_t *queue = malloc(sizeof(*queue));
+    queue_p_t *queue = calloc(1, sizeof(*queue));
     if (queue == NULL) {
         set_err(err, ENOMEM);
         return NULL;
     }
-    queue->list = list_new(q_dst, q_cmp, err);
-    if (queue->list == NULL) {
-        free(queue);
-        return NULL;
-    }
     queue->capacity = capacity;
-    queue->size = 0;
     queue->customfree = customfree;
     queue->compare = compare;
     return queue;
@@ -159,6 +253,22 @@ int queue_p_enqueue(queue_p_t *queue, void *data, double priority) {
         return EOVERFLOW;
     }
 
+    if (queue->size == queue->heap_cap) {
+        size_t new_cap =
+            queue->heap_cap == 0 ? HEAP_INITIAL_CAP : queue->heap_cap * 2;
+        if (queue->capacity != QUEUE_P_UNLIMITED &&
+            new_cap > queue->capacity) {
+            new_cap = queue->capacity;
+        }
+        struct heap_entry_t *new_heap =
+            realloc(queue->heap, new_cap * sizeof(*new_heap));
+        if (new_heap == NULL) {
+            return ENOMEM;
+        }
+        queue->heap = new_heap;
+        queue->heap_cap = new_cap;
+    }
+
     queue_p_node_t *node = malloc(sizeof(*node));
     if (node == NULL) {
         return ENOMEM;
@@ -166,70 +276,39 @@ int queue_p_enqueue(queue_p_t *queue, void *data, double priority) {
     node->data = data;
     node->priority = priority;
 
-    size_t list_idx = 0;
-    list_iterator_reset(queue->list);
-    queue_t *inner_q = list_iterator_next(queue->list, NULL);
-    if (inner_q == NULL) {
-        // priority queue is empty, create new queue and insert it into the list
-        return push_new_node(queue, node, list_idx);
-    }
-
-    do {
-        double q_priority = ((queue_p_node_t *)queue_peek(inner_q))->priority;
-        if (node->priority < q_priority) {
-            // keep looking for the correct queue
-            list_idx++;
-            continue;
-        } else if (node->priority > q_priority) {
-            // node priority is greater than current queue priority
-            // create new queue and insert it into the list
-            return push_new_node(queue, node, list_idx);
-        } else {
-            // node inserted, stop iterating
-            int err = queue_enqueue(inner_q, node);
-            if (err == SUCCESS) {
-                queue->size++;
-            } else {
-                free(node);
-            }
-            return err;
-        }
-    } while ((inner_q = list_iterator_next(queue->list, NULL)) != NULL);
-    // node priority is less than all other queue priorities
-    // create new queue and append it to the list
-    return push_new_node(queue, node, list_idx);
+    queue->heap[queue->size].node = node;
+    queue->heap[queue->size].seq = queue->next_seq++;
+    queue->size++;
+    sift_up(queue, queue->size - 1);
+    return SUCCESS;
 }
 
 queue_p_node_t *queue_p_dequeue(queue_p_t *queue) {
-    if (queue == NULL || queue_p_is_empty(queue)) {
+    if (queue == NULL || queue->size == 0) {
         return NULL;
     }
-    queue_t *current_queue = list_peek_head(queue->list);
-    queue_p_node_t *node = queue_dequeue(current_queue);
-    queue->size--;
-    if (queue_is_empty(current_queue)) {
-        list_pop_head(queue->list);
-        queue_destroy(&current_queue);
+    return heap_delete(queue, 0);
+}
+
+ssize_t queue_p_drain_until(queue_p_t *queue, double min_priority,
+                            queue_p_node_t **nodes, size_t max_n) {
+    if (queue == NULL || nodes == NULL) {
+        return INVALID;
     }
-    return node;
+    size_t count = 0;
+    while (count < max_n && queue->size > 0 &&
+           queue->heap[0].node->priority >= min_priority) {
+        nodes[count++] = heap_delete(queue, 0);
+    }
+    return count;
 }
 
 queue_p_node_t *queue_p_get(const queue_p_t *queue, size_t position) {
     if (queue == NULL || position >= queue->size) {
         return NULL;
     }
-
-    list_iterator_reset(queue->list);
-    queue_t *inner_q = list_iterator_next(queue->list, NULL);
-    do {
-        if ((size_t)queue_size(inner_q) > position) {
-            return queue_get(inner_q, position);
-        } else {
-            position -= queue_size(inner_q);
-        }
-    } while ((inner_q = list_iterator_next(queue->list, NULL)) != NULL);
-    // should never reach this point
-    return NULL;
+    ssize_t idx = index_of_position(queue, position);
+    return idx == INVALID ? NULL : queue->heap[idx].node;
 }
 
 queue_p_node_t *queue_p_get_priority(const queue_p_t *queue, size_t position,
@@ -237,80 +316,71 @@ queue_p_node_t *queue_p_get_priority(const queue_p_t *queue, size_t position,
     if (queue == NULL) {
         return NULL;
     }
-
-    queue_t *current_queue = list_find_first(queue->list, &priority, NULL);
-    if (current_queue == NULL) {
-        return NULL;
-    }
-    queue_p_node_t *node = queue_get(current_queue, position);
-    if (node == NULL) {
-        return NULL;
+    // the entry wanted is the one with position entries of the same
+    // priority enqueued before it
+    ssize_t found = INVALID;
+    size_t skipped = 0;
+    while (skipped <= position) {
+        ssize_t next = INVALID;
+        for (size_t i = 0; i < queue->size; i++) {
+            if (queue->heap[i].node->priority != priority) {
+                continue;
+            }
+            if ((found == INVALID ||
+                 queue->heap[i].seq > queue->heap[found].seq) &&
+                (next == INVALID ||
+                 queue->heap[i].seq < queue->heap[next].seq)) {
+                next = i;
+            }
+        }
+        if (next == INVALID) {
+            return NULL;
+        }
+        found = next;
+        skipped++;
     }
-    return node;
+    return queue->heap[found].node;
 }
 
 queue_p_node_t *queue_p_peek(const queue_p_t *queue) {
-    if (queue == NULL || queue_p_is_empty(queue)) {
+    if (queue == NULL || queue->size == 0) {
         return NULL;
     }
-    queue_t *current_queue = list_peek_head(queue->list);
-    return queue_peek(current_queue);
+    return queue->heap[0].node;
 }
 
 queue_p_node_t *queue_p_remove(queue_p_t *queue, void *item_to_remove) {
-    if (queue == NULL || queue_p_is_empty(queue)) {
+    if (queue == NULL || queue->size == 0) {
         return NULL;
     }
-    list_iterator_reset(queue->list);
-    queue_t *inner_q;
-    while ((inner_q = list_iterator_next(queue->list, NULL)) != NULL) {
-        queue_p_node_t *node = queue_remove(inner_q, item_to_remove, NULL);
-        if (node != NULL) {
-            queue->size--;
-            if (queue_is_empty(inner_q)) {
-                list_remove(queue->list, inner_q, NULL);
-                queue_destroy(&inner_q);
-            }
-            return node;
-        }
+    ssize_t idx = index_of_value(queue, item_to_remove);
+    if (idx == INVALID) {
+        return NULL;
     }
-    return NULL;
+    return heap_delete(queue, idx);
 }
 
 queue_p_node_t *queue_p_find_first(const queue_p_t *queue,
                                    const void *value_to_find) {
-    if (queue == NULL || queue_p_is_empty(queue)) {
+    if (queue == NULL || queue->size == 0) {
         return NULL;
     }
-    list_iterator_reset(queue->list);
-    queue_t *inner_q;
-    while ((inner_q = list_iterator_next(queue->list, NULL)) != NULL) {
-        queue_p_node_t *node = queue_find_first(inner_q, value_to_find, NULL);
-        if (node != NULL) {
-            return node;
-        }
-    }
-    return NULL;
+    ssize_t idx = index_of_value(queue, value_to_find);
+    return idx == INVALID ? NULL : queue->heap[idx].node;
 }
 
 int queue_p_clear(queue_p_t *queue) {
     if (queue == NULL) {
         return EINVAL;
-    } else if (queue_p_is_empty(queue)) {
-        return SUCCESS;
     }
-    do {
-        queue_t *inner_q = list_pop_head(queue->list);
-        do {
-            queue_p_node_t *node = queue_dequeue(inner_q);
-            if (queue->customfree != NULL) {
-                queue->customfree(node->data);
-            }
-            free(node);
-        } while (!queue_is_empty(inner_q));
-        queue_destroy(&inner_q);
-    } while (!list_is_empty(queue->list));
+    for (size_t i = 0; i < queue->size; i++) {
+        if (queue->customfree != NULL) {
+            queue->customfree(queue->heap[i].node->data);
+        }
+        free(queue->heap[i].node);
+    }
     queue->size = 0;
+    queue->next_seq = 0;
     return SUCCESS;
 }
 
@@ -319,7 +389,7 @@ int queue_p_destroy(queue_p_t **queue) {
         return EINVAL;
     }
     queue_p_clear(*queue);
-    list_delete(&(*queue)->list);
+    free((*queue)->heap);
     free(*queue);
     *queue = NULL;
     return SUCCESS;
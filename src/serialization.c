@@ -1,4 +1,4 @@
-#define _DEFAULT_SOURCE
+#define _GNU_SOURCE // accept4
 #include "serialization.h"
 #include "buildingblocks.h"
 #include <errno.h>
@@ -7,12 +7,24 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 /* DATA */
 
 #define SUCCESS 0
 #define FAILURE -1
+#define COPY_CHUNK 16384 // buffer size for the non-zero-copy io_copy path
+#define PKT_BUF_MIN 256  // starting capacity of a reusable packet buffer
+#define WRITE_BUF_SIZE 16384 // capacity/auto-flush threshold of write buffer
 
 struct io_info {
     int type;
@@ -22,6 +34,12 @@ struct io_info {
     socklen_t addr_len;
     char host[NI_MAXHOST];
     char serv[NI_MAXSERV];
+    uint8_t *wbuf; // userspace write buffer, NULL when unbuffered
+    size_t wbuf_len;
+    bool mapped; // io is backed by a read-only file mapping
+    uint8_t *map; // the mapping itself, NULL for an empty file
+    size_t map_len;
+    size_t map_off; // read cursor into the mapping
 };
 
 /* PRIVATE FUNCTIONS*/
@@ -31,11 +49,12 @@ struct io_info {
  *
  * @param result - the result of getaddrinfo.
  * @param info - the io_info object to populate.
+ * @param reuse_port - whether to set SO_REUSEPORT before binding.
  * @param err_type - the type of error that occurred.
  * @return int - 0 on success, non-zero on failure.
  */
 static int create_socket(struct addrinfo *result, io_info_t *info,
-                         int *err_type) {
+                         bool reuse_port, int *err_type) {
     int err = FAILURE;
     for (struct addrinfo *res_ptr = result; res_ptr != NULL;
          res_ptr = res_ptr->ai_next) {
@@ -50,6 +69,14 @@ static int create_socket(struct addrinfo *result, io_info_t *info,
 
         int optval = 1;
         setsockopt(info->fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+#ifdef SO_REUSEPORT
+        if (reuse_port) {
+            setsockopt(info->fd, SOL_SOCKET, SO_REUSEPORT, &optval,
+                       sizeof(optval));
+        }
+#else
+        (void)reuse_port;
+#endif
         if (bind(info->fd, res_ptr->ai_addr, res_ptr->ai_addrlen) == SUCCESS) {
             if (listen(info->fd, MAX_CONNECTIONS) == SUCCESS) {
                 err = SUCCESS; // success, exit loop
@@ -165,8 +192,61 @@ io_info_t *new_file_io_info(const char *filename, int flags, mode_t mode,
     return io_info;
 }
 
-io_info_t *new_accept_io_info(const char *port, int *err, int *err_type) {
-    io_info_t *io_info = malloc(sizeof(*io_info));
+io_info_t *new_file_mmap_io_info(const char *filename, int *err) {
+    io_info_t *io_info = calloc(1, sizeof(*io_info));
+    if (io_info == NULL) {
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+    io_info->fd = open(filename, O_RDONLY);
+    if (io_info->fd == FAILURE) {
+        set_err(err, errno);
+        free(io_info);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(io_info->fd, &st) == FAILURE) {
+        set_err(err, errno);
+        close(io_info->fd);
+        free(io_info);
+        return NULL;
+    }
+    if (st.st_size > 0) {
+        io_info->map =
+            mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, io_info->fd, 0);
+        if (io_info->map == MAP_FAILED) {
+            set_err(err, errno);
+            close(io_info->fd);
+            free(io_info);
+            return NULL;
+        }
+        io_info->map_len = st.st_size;
+#ifdef MADV_SEQUENTIAL
+        // reads walk the file front to back; let readahead run wide
+        madvise(io_info->map, io_info->map_len, MADV_SEQUENTIAL);
+#endif
+    }
+    io_info->mapped = true; // an empty file keeps map NULL
+    io_info->type = FILE_IO;
+    io_info->close_on_free = true;
+    return io_info;
+}
+
+/**
+ * @brief Create a new accepting io_info object.
+ *
+ * Shared body of the public accept constructors; reuse_port selects
+ * whether the listening socket is bound with SO_REUSEPORT.
+ *
+ * @param port - the port to listen on.
+ * @param reuse_port - whether to set SO_REUSEPORT before binding.
+ * @param err - where to store the error code.
+ * @param err_type - where to store the error type.
+ * @return io_info_t* - the io_info object.
+ */
+static io_info_t *accept_io_create(const char *port, bool reuse_port, int *err,
+                                   int *err_type) {
+    io_info_t *io_info = calloc(1, sizeof(*io_info));
     if (io_info == NULL) {
         set_err(err_type, SYS);
         set_err(err, ENOMEM);
@@ -193,7 +273,7 @@ io_info_t *new_accept_io_info(const char *port, int *err, int *err_type) {
         goto error;
     }
 
-    loc_err = create_socket(result, io_info, err_type);
+    loc_err = create_socket(result, io_info, reuse_port, err_type);
     if (loc_err == SUCCESS) {
         getnameinfo((struct sockaddr *)&io_info->addr, io_info->addr_len,
                     io_info->host, NI_MAXHOST, io_info->serv, NI_MAXSERV,
@@ -213,9 +293,24 @@ cleanup:
     return io_info;
 }
 
+io_info_t *new_accept_io_info(const char *port, int *err, int *err_type) {
+    return accept_io_create(port, false, err, err_type);
+}
+
+io_info_t *new_accept_io_info_reuseport(const char *port, int *err,
+                                        int *err_type) {
+#ifndef SO_REUSEPORT
+    set_err(err_type, SYS);
+    set_err(err, ENOTSUP);
+    return NULL;
+#else
+    return accept_io_create(port, true, err, err_type);
+#endif
+}
+
 io_info_t *new_connect_io_info(const char *host, const char *port, int *err,
                                int *err_type) {
-    io_info_t *io_info = malloc(sizeof(*io_info));
+    io_info_t *io_info = calloc(1, sizeof(*io_info));
     if (io_info == NULL) {
         set_err(err_type, SYS);
         set_err(err, ENOMEM);
@@ -269,6 +364,99 @@ cleanup: // if jumped directly here, function succeeded
     return io_info;
 }
 
+io_info_t *new_connect_io_info_async(const char *host, const char *port,
+                                     int *err, int *err_type) {
+    io_info_t *io_info = calloc(1, sizeof(*io_info));
+    if (io_info == NULL) {
+        set_err(err_type, SYS);
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+    struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+        .ai_flags = AI_V4MAPPED,
+        .ai_protocol = 0,
+    };
+
+    struct addrinfo *result = NULL;
+    int loc_err = getaddrinfo(host, port, &hints, &result);
+    if (loc_err != SUCCESS) {
+        if (loc_err == EAI_SYSTEM) {
+            set_err(err, errno);
+            set_err(err_type, SYS);
+        } else {
+            set_err(err, loc_err);
+            set_err(err_type, GAI);
+        }
+        free(io_info);
+        return NULL;
+    }
+
+    // name resolution above is still synchronous; only the handshake
+    // itself is started in the background
+    for (struct addrinfo *res_ptr = result; res_ptr != NULL;
+         res_ptr = res_ptr->ai_next) {
+        int sock = socket(res_ptr->ai_family, res_ptr->ai_socktype,
+                          res_ptr->ai_protocol);
+        if (sock == FAILURE) {
+            set_err(err, errno);
+            set_err(err_type, SOCK);
+            continue;
+        }
+        int flags = fcntl(sock, F_GETFL);
+        if (flags == FAILURE ||
+            fcntl(sock, F_SETFL, flags | O_NONBLOCK) == FAILURE) {
+            set_err(err, errno);
+            set_err(err_type, SYS);
+            close(sock);
+            continue;
+        }
+        if (connect(sock, res_ptr->ai_addr, res_ptr->ai_addrlen) == SUCCESS ||
+            errno == EINPROGRESS) {
+            memcpy(&io_info->addr, res_ptr->ai_addr, res_ptr->ai_addrlen);
+            io_info->addr_len = res_ptr->ai_addrlen;
+            io_info->fd = sock;
+            io_info->type = CONNECTED_IO;
+            io_info->close_on_free = true;
+            freeaddrinfo(result);
+            return io_info;
+        }
+        set_err(err, errno);
+        set_err(err_type, CONN);
+        close(sock);
+    }
+    // only get here if no address worked
+    freeaddrinfo(result);
+    free(io_info);
+    return NULL;
+}
+
+int io_connect_status(io_info_t *io_info) {
+    if (io_info == NULL || io_info->type != CONNECTED_IO) {
+        return EINVAL;
+    }
+    if (connect(io_info->fd, (struct sockaddr *)&io_info->addr,
+                io_info->addr_len) == SUCCESS ||
+        errno == EISCONN) {
+        // established: restore blocking mode and name the peer, so the
+        // object behaves like one from new_connect_io_info from here on
+        int flags = fcntl(io_info->fd, F_GETFL);
+        if (flags != FAILURE) {
+            fcntl(io_info->fd, F_SETFL, flags & ~O_NONBLOCK);
+        }
+        getnameinfo((struct sockaddr *)&io_info->addr, io_info->addr_len,
+                    io_info->host, NI_MAXHOST, io_info->serv, NI_MAXSERV,
+                    NI_NUMERICHOST | NI_NUMERICSERV);
+        return SUCCESS;
+    }
+    if (errno == EALREADY || errno == EINPROGRESS || errno == EAGAIN) {
+        return EINPROGRESS;
+    }
+    DEBUG_PRINT("from call to connect(2): %s\n", strerror(errno));
+    return errno;
+}
+
 ssl_loader_t *new_ssl_loader(int *err) {
     set_err(err, ENOTSUP);
     return NULL;
@@ -276,6 +464,11 @@ ssl_loader_t *new_ssl_loader(int *err) {
 
 void free_io_info(io_info_t *io_info) {
     if (io_info != NULL) {
+        io_flush(io_info); // best effort for any buffered bytes
+        free(io_info->wbuf);
+        if (io_info->map != NULL) {
+            munmap(io_info->map, io_info->map_len);
+        }
         if (io_info->close_on_free) {
             close(io_info->fd);
         }
@@ -285,6 +478,11 @@ void free_io_info(io_info_t *io_info) {
 
 void free_ssl_loader(ssl_loader_t *loader) { (void)loader; }
 
+int ssl_loader_enable_ktls(ssl_loader_t *loader) {
+    (void)loader;
+    return ENOTSUP;
+}
+
 int io_info_fd(io_info_t *io_info, int *type) {
     set_err(type, io_info->type);
     return io_info->fd;
@@ -339,7 +537,75 @@ io_info_t *io_accept(io_info_t *io_info, int *err) {
     return new_info;
 }
 
+int io_accept_batch(io_info_t *io_info, io_info_t **clients, size_t *count) {
+    if (io_info == NULL || clients == NULL || count == NULL || *count == 0) {
+        if (count != NULL) {
+            *count = 0;
+        }
+        return EINVAL;
+    }
+    size_t capacity = *count;
+    *count = 0;
+
+    // the drain must not block on an empty queue, so the listener is
+    // switched to non-blocking for the duration of the batch
+    int old_flags = fcntl(io_info->fd, F_GETFL);
+    if (old_flags == FAILURE) {
+        return errno;
+    }
+    bool restore = (old_flags & O_NONBLOCK) == 0;
+    if (restore &&
+        fcntl(io_info->fd, F_SETFL, old_flags | O_NONBLOCK) == FAILURE) {
+        return errno;
+    }
+
+    int err = SUCCESS;
+    while (*count < capacity) {
+        io_info_t *new_info = calloc(1, sizeof(*new_info));
+        if (new_info == NULL) {
+            err = ENOMEM;
+            break;
+        }
+        new_info->addr_len = sizeof(new_info->addr);
+#ifdef __linux__
+        // accept4 delivers the connection in a single syscall
+        new_info->fd = accept4(io_info->fd, (struct sockaddr *)&new_info->addr,
+                               &new_info->addr_len, 0);
+#else
+        new_info->fd = accept(io_info->fd, (struct sockaddr *)&new_info->addr,
+                              &new_info->addr_len);
+#endif
+        if (new_info->fd == FAILURE) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                err = errno;
+            }
+            free(new_info);
+            break; // queue drained, or a real error
+        }
+        getnameinfo((struct sockaddr *)&new_info->addr, new_info->addr_len,
+                    new_info->host, NI_MAXHOST, new_info->serv, NI_MAXSERV,
+                    NI_NUMERICHOST | NI_NUMERICSERV);
+        new_info->type = CONNECTED_IO;
+        new_info->close_on_free = true;
+        clients[(*count)++] = new_info;
+    }
+
+    if (restore) {
+        fcntl(io_info->fd, F_SETFL, old_flags);
+    }
+    return err;
+}
+
 int read_exact(io_info_t *io_info, void *buff, size_t read_sz) {
+    if (io_info->mapped) {
+        if (read_sz > io_info->map_len - io_info->map_off) {
+            DEBUG_PRINT("mapping exhausted: %s\n", strerror(ENODATA));
+            return ENODATA;
+        }
+        memcpy(buff, io_info->map + io_info->map_off, read_sz);
+        io_info->map_off += read_sz;
+        return SUCCESS;
+    }
     uint8_t *buf_ptr = (uint8_t *)buff;
     size_t total_len = 0;
     ssize_t bytes_read;
@@ -360,11 +626,19 @@ int read_exact(io_info_t *io_info, void *buff, size_t read_sz) {
         total_len += bytes_read;
         buf_ptr += bytes_read;
         read_sz -= bytes_read;
-    } while (total_len < read_sz);
+    } while (read_sz > 0);
     return SUCCESS;
 }
 
-int write_all(io_info_t *io_info, const void *buf, size_t len) {
+/**
+ * @brief Write a buffer to an io_info object, bypassing the write buffer.
+ *
+ * @param io_info - the io_info object to write to
+ * @param buf - the buffer to write
+ * @param len - the length of the buffer
+ * @return int - 0 on success, non-zero on failure
+ */
+static int write_direct(io_info_t *io_info, const void *buf, size_t len) {
     ssize_t bytes_written;
     uint8_t *buf_ptr = (uint8_t *)buf;
     DEBUG_PRINT("writing %zu bytes total\n", len);
@@ -380,72 +654,323 @@ int write_all(io_info_t *io_info, const void *buf, size_t len) {
     return SUCCESS;
 }
 
-void free_packet(struct packet *pkt) {
+int io_flush(io_info_t *io_info) {
+    if (io_info == NULL) {
+        return EINVAL;
+    }
+    if (io_info->wbuf == NULL || io_info->wbuf_len == 0) {
+        return SUCCESS; // nothing pending
+    }
+    DEBUG_PRINT("flushing %zu buffered bytes\n", io_info->wbuf_len);
+    int err = write_direct(io_info, io_info->wbuf, io_info->wbuf_len);
+    // the buffer is reset even on failure: write_direct may have pushed
+    // part of it out, so retrying would duplicate bytes on the wire
+    io_info->wbuf_len = 0;
+    return err;
+}
+
+int io_set_buffered(io_info_t *io_info, bool enabled) {
+    if (io_info == NULL) {
+        return EINVAL;
+    }
+    if (enabled) {
+        if (io_info->wbuf != NULL) {
+            return SUCCESS; // already buffered
+        }
+        io_info->wbuf = malloc(WRITE_BUF_SIZE);
+        if (io_info->wbuf == NULL) {
+            DEBUG_PRINT("failed to allocate write buffer: %s\n",
+                        strerror(errno));
+            return errno;
+        }
+        io_info->wbuf_len = 0;
+        return SUCCESS;
+    }
+    int err = io_flush(io_info);
+    free(io_info->wbuf);
+    io_info->wbuf = NULL;
+    return err;
+}
+
+int write_all(io_info_t *io_info, const void *buf, size_t len) {
+    if (io_info->wbuf == NULL) {
+        return write_direct(io_info, buf, len);
+    }
+    if (len >= WRITE_BUF_SIZE) {
+        // a write this large gains nothing from coalescing; push any
+        // pending bytes first so ordering is preserved
+        int err = io_flush(io_info);
+        if (err != SUCCESS) {
+            return err;
+        }
+        return write_direct(io_info, buf, len);
+    }
+    if (io_info->wbuf_len + len > WRITE_BUF_SIZE) {
+        int err = io_flush(io_info);
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+    DEBUG_PRINT("buffering %zu bytes\n", len);
+    memcpy(io_info->wbuf + io_info->wbuf_len, buf, len);
+    io_info->wbuf_len += len;
+    if (io_info->wbuf_len == WRITE_BUF_SIZE) {
+        return io_flush(io_info); // auto-flush on threshold
+    }
+    return SUCCESS;
+}
+
+int io_copy(io_info_t *dest, io_info_t *src, off_t offset, size_t len) {
+    if (dest == NULL || src == NULL || offset < 0) {
+        return EINVAL;
+    }
+    if (src->type != FILE_IO && offset != 0) {
+        // only file sources are seekable
+        return ESPIPE;
+    }
+#ifdef __linux__
+    if (src->type == FILE_IO) {
+        // zero-copy path: the kernel moves the file pages directly and
+        // the source file position is left untouched
+        int err = io_flush(dest); // sendfile bypasses the write buffer
+        if (err != SUCCESS) {
+            return err;
+        }
+        off_t off = offset;
+        while (len > 0) {
+            ssize_t sent = sendfile(dest->fd, src->fd, &off, len);
+            if (sent > 0) {
+                len -= sent;
+                continue;
+            }
+            if (sent == 0) {
+                DEBUG_PRINT("file ended before copy completed\n");
+                return ENODATA;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                continue;
+            }
+            if (errno == EINVAL || errno == ENOSYS) {
+                // destination cannot take sendfile; fall back to the
+                // buffered loop, keeping any progress already made
+                break;
+            }
+            DEBUG_PRINT("from call to sendfile(2): %s\n", strerror(errno));
+            return errno;
+        }
+        if (len == 0) {
+            return SUCCESS;
+        }
+        offset = off;
+    }
+#endif
+    uint8_t buf[COPY_CHUNK];
+    while (len > 0) {
+        size_t chunk = len < sizeof(buf) ? len : sizeof(buf);
+        ssize_t bytes_read = src->type == FILE_IO
+                                 ? pread(src->fd, buf, chunk, offset)
+                                 : read(src->fd, buf, chunk);
+        if (bytes_read < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // retry the read if the call would block
+                continue;
+            }
+            DEBUG_PRINT("from call to read(2): %s\n", strerror(errno));
+            return errno;
+        } else if (bytes_read == 0) {
+            DEBUG_PRINT("source ended before copy completed\n");
+            return ENODATA;
+        }
+        int err = write_all(dest, buf, bytes_read);
+        if (err != SUCCESS) {
+            return err;
+        }
+        offset += bytes_read;
+        len -= bytes_read;
+    }
+    return SUCCESS;
+}
+
+void free_packet_buffers(struct packet *pkt) {
     if (pkt != NULL) {
         free(pkt->hdr);
-        free(pkt->data);
+        if (pkt->data_cap > 0) {
+            free(pkt->data); // data with no capacity aliases a mapping
+        }
+        pkt->hdr = NULL;
+        pkt->data = NULL;
+        pkt->data_cap = 0;
+    }
+}
+
+void free_packet(struct packet *pkt) {
+    if (pkt != NULL) {
+        free_packet_buffers(pkt);
         free(pkt);
     }
 }
 
-int write_pkt_data(io_info_t *io_info, void *data, size_t len,
-                   uint32_t data_type) {
-    DEBUG_PRINT("writing packet...\n");
+int write_pkt_datav(io_info_t *io_info, struct iovec *iov, size_t iovcnt,
+                    uint32_t data_type) {
+    if (io_info == NULL || (iov == NULL && iovcnt > 0)) {
+        return EINVAL;
+    }
+    size_t total = 0;
+    for (size_t i = 0; i < iovcnt; i++) {
+        total += iov[i].iov_len;
+    }
+    if (total > UINT32_MAX) {
+        return EOVERFLOW; // the packet header cannot describe the payload
+    }
+
+    DEBUG_PRINT("writing packet of %zu fragments...\n", iovcnt);
     struct pkt_hdr hdr;
     memset(&hdr, 0, sizeof(hdr));
     hdr.header_len = htonl(sizeof(hdr));
-    hdr.data_len = htonl(len);
+    hdr.data_len = htonl(total);
     hdr.data_type = htonl(data_type);
 
-    int err = write_all(io_info, &hdr, sizeof(hdr));
-    if (err != SUCCESS) {
+    if (io_info->wbuf != NULL) {
+        // buffered streams coalesce in userspace; the fragments just
+        // append to the write buffer until it flushes
+        int err = write_all(io_info, &hdr, sizeof(hdr));
+        for (size_t i = 0; err == SUCCESS && i < iovcnt; i++) {
+            err = write_all(io_info, iov[i].iov_base, iov[i].iov_len);
+        }
         return err;
     }
-    DEBUG_PRINT("header successfully written\n");
-    return write_all(io_info, data, len);
+
+    // header and fragments go out through a single writev so small
+    // packets cost one syscall instead of one per fragment
+    struct iovec *vec = malloc((iovcnt + 1) * sizeof(*vec));
+    if (vec == NULL) {
+        return errno;
+    }
+    vec[0].iov_base = &hdr;
+    vec[0].iov_len = sizeof(hdr);
+    memcpy(vec + 1, iov, iovcnt * sizeof(*iov));
+
+    int err = SUCCESS;
+    size_t idx = 0;
+    size_t nvecs = iovcnt + 1;
+    while (idx < nvecs) {
+        size_t batch = nvecs - idx;
+        if (batch > IOV_MAX) {
+            batch = IOV_MAX;
+        }
+        ssize_t written = writev(io_info->fd, vec + idx, batch);
+        if (written < 0) {
+            DEBUG_PRINT("from call to writev(2): %s\n", strerror(errno));
+            err = errno;
+            break;
+        }
+        DEBUG_PRINT("amount written: %zd bytes\n", written);
+        // step past fully sent fragments, trimming a partial one
+        while (written > 0) {
+            if ((size_t)written >= vec[idx].iov_len) {
+                written -= vec[idx].iov_len;
+                idx++;
+            } else {
+                vec[idx].iov_base = (uint8_t *)vec[idx].iov_base + written;
+                vec[idx].iov_len -= written;
+                written = 0;
+            }
+        }
+        // skip any empty fragments so progress is always made
+        while (idx < nvecs && vec[idx].iov_len == 0) {
+            idx++;
+        }
+    }
+    free(vec);
+    return err;
 }
 
-struct packet *read_pkt(io_info_t *io_info, int *err) {
-    struct packet *pkt = calloc(1, sizeof(*pkt));
-    if (pkt == NULL) {
-        set_err(err, errno);
-        DEBUG_PRINT("failed to allocate packet buffer: %s\n", strerror(*err));
-        return NULL;
+int write_pkt_data(io_info_t *io_info, void *data, size_t len,
+                   uint32_t data_type) {
+    struct iovec iov = {
+        .iov_base = data,
+        .iov_len = len,
+    };
+    return write_pkt_datav(io_info, &iov, len > 0 ? 1 : 0, data_type);
+}
+
+int read_pkt_into(io_info_t *io_info, struct packet *pkt) {
+    if (io_info == NULL || pkt == NULL) {
+        return EINVAL;
     }
-    pkt->hdr = malloc(sizeof(*pkt->hdr));
     if (pkt->hdr == NULL) {
-        set_err(err, errno);
-        DEBUG_PRINT("failed to allocate header buffer: %s\n", strerror(*err));
-        free_packet(pkt);
-        return NULL;
+        pkt->hdr = malloc(sizeof(*pkt->hdr));
+        if (pkt->hdr == NULL) {
+            DEBUG_PRINT("failed to allocate header buffer: %s\n",
+                        strerror(errno));
+            return errno;
+        }
     }
 
     int loc_err = read_hdr_data(io_info, pkt->hdr);
     if (loc_err != SUCCESS) {
-        set_err(err, loc_err);
-        free_packet(pkt);
-        return NULL;
+        return loc_err;
     } else if (pkt->hdr->data_len == 0) {
         DEBUG_PRINT("header successfully read: but no data\n");
-        pkt->data = NULL;
-        return pkt; // no data to read
+        return SUCCESS; // no data to read, buffer kept for reuse
     }
 
-    pkt->data = malloc(pkt->hdr->data_len);
-    if (pkt->data == NULL) {
-        set_err(err, errno);
-        DEBUG_PRINT("failed to allocate data buffer: %s\n", strerror(*err));
-        free_packet(pkt);
-        return NULL;
+    if (io_info->mapped) {
+        // zero-copy: the packet data aliases the mapping directly and
+        // stays valid until the io_info is freed
+        if (pkt->hdr->data_len > io_info->map_len - io_info->map_off) {
+            DEBUG_PRINT("mapping exhausted: %s\n", strerror(ENODATA));
+            return ENODATA;
+        }
+        if (pkt->data_cap > 0) {
+            free(pkt->data); // drop any owned buffer from previous reads
+            pkt->data_cap = 0;
+        }
+        pkt->data = io_info->map + io_info->map_off;
+        io_info->map_off += pkt->hdr->data_len;
+        return SUCCESS;
+    }
+    if (pkt->data != NULL && pkt->data_cap == 0) {
+        pkt->data = NULL; // previous read aliased a mapping; do not grow it
+    }
+
+    if (pkt->hdr->data_len > pkt->data_cap) {
+        // grow geometrically so a busy connection stops allocating once
+        // the buffer has seen its largest packet
+        size_t new_cap = pkt->data_cap == 0 ? PKT_BUF_MIN : pkt->data_cap;
+        while (new_cap < pkt->hdr->data_len) {
+            new_cap *= 2;
+        }
+        void *new_data = realloc(pkt->data, new_cap);
+        if (new_data == NULL) {
+            DEBUG_PRINT("failed to grow data buffer: %s\n", strerror(errno));
+            return errno;
+        }
+        pkt->data = new_data;
+        pkt->data_cap = new_cap;
     }
     DEBUG_PRINT("reading data...\n");
     loc_err = read_exact(io_info, pkt->data, pkt->hdr->data_len);
+    if (loc_err != SUCCESS) {
+        return loc_err;
+    }
+    DEBUG_PRINT("data successfully read\n");
+    return SUCCESS;
+}
+
+struct packet *read_pkt(io_info_t *io_info, int *err) {
+    struct packet *pkt = calloc(1, sizeof(*pkt));
+    if (pkt == NULL) {
+        set_err(err, errno);
+        DEBUG_PRINT("failed to allocate packet buffer: %s\n", strerror(*err));
+        return NULL;
+    }
+    int loc_err = read_pkt_into(io_info, pkt);
     if (loc_err != SUCCESS) {
         set_err(err, loc_err);
         free_packet(pkt);
         return NULL;
     }
-    DEBUG_PRINT("data successfully read\n");
     return pkt;
 }
 
@@ -464,3 +989,351 @@ struct packet *recv_pkt_data(io_info_t *io_info, int timeout, int *err) {
         return NULL; // error in revents, usually means other end closed
     }
 }
+
+int recv_pkt_data_into(io_info_t *io_info, int timeout, struct packet *pkt) {
+    struct pollio pio = {.io_info = io_info, .events = POLLIN};
+    int loc_err = poll_io_info(&pio, 1, timeout);
+    if (loc_err <= 0) {
+        // 0 on timeout, negative on poll error
+        loc_err = loc_err == 0 ? ETIMEDOUT : -loc_err;
+        DEBUG_PRINT("poll error: %s\n", strerror(loc_err));
+        return loc_err;
+    } else if (pio.revents & POLLIN) {
+        DEBUG_PRINT("receiving packet...\n");
+        return read_pkt_into(io_info, pkt);
+    }
+    return ENODATA; // error in revents, usually means other end closed
+}
+
+/* IO_URING ENGINE */
+
+#ifdef __linux__
+
+struct io_ring {
+    int ring_fd;
+    unsigned pending; // queued submissions not yet passed to the kernel
+    // submission queue
+    uint8_t *sq_ptr;
+    size_t sq_map_sz;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned sq_tail_local;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    size_t sqes_map_sz;
+    // completion queue
+    uint8_t *cq_ptr;
+    size_t cq_map_sz;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+};
+
+/**
+ * @brief Wrapper for the io_uring_setup(2) syscall.
+ *
+ * @param entries - requested submission queue depth
+ * @param params - setup parameters, filled in by the kernel
+ * @return int - ring file descriptor on success, -1 on failure
+ */
+static int ring_setup(unsigned entries, struct io_uring_params *params) {
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+/**
+ * @brief Wrapper for the io_uring_enter(2) syscall.
+ *
+ * @param fd - the ring file descriptor
+ * @param to_submit - number of queued submissions to hand to the kernel
+ * @param min_complete - minimum completions to wait for
+ * @param flags - IORING_ENTER_* flags
+ * @return int - number of submissions consumed on success, -1 on failure
+ */
+static int ring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                      unsigned flags) {
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                   NULL, 0);
+}
+
+/**
+ * @brief Claim the next free submission queue entry.
+ *
+ * @param ring - the ring to claim from
+ * @return struct io_uring_sqe* - zeroed entry, or NULL if the queue is full
+ */
+static struct io_uring_sqe *ring_next_sqe(io_ring_t *ring) {
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->sq_tail_local - head == ring->sq_entries) {
+        return NULL; // submission queue is full
+    }
+    struct io_uring_sqe *sqe = &ring->sqes[ring->sq_tail_local & ring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+/**
+ * @brief Publish the most recently claimed submission queue entry.
+ *
+ * @param ring - the ring the entry was claimed from
+ */
+static void ring_push_sqe(io_ring_t *ring) {
+    unsigned idx = ring->sq_tail_local & ring->sq_mask;
+    ring->sq_array[idx] = idx;
+    ring->sq_tail_local++;
+    __atomic_store_n(ring->sq_tail, ring->sq_tail_local, __ATOMIC_RELEASE);
+    ring->pending++;
+}
+
+io_ring_t *new_io_ring(unsigned entries, int *err) {
+    if (entries == 0) {
+        set_err(err, EINVAL);
+        return NULL;
+    }
+    io_ring_t *ring = calloc(1, sizeof(*ring));
+    if (ring == NULL) {
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->ring_fd = ring_setup(entries, &params);
+    if (ring->ring_fd == FAILURE) {
+        set_err(err, errno);
+        DEBUG_PRINT("io_uring_setup error: %s\n", strerror(errno));
+        free(ring);
+        return NULL;
+    }
+
+    ring->sq_map_sz = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_map_sz =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        // modern kernels expose both rings through one mapping
+        if (ring->cq_map_sz > ring->sq_map_sz) {
+            ring->sq_map_sz = ring->cq_map_sz;
+        }
+    }
+    ring->sq_ptr = mmap(NULL, ring->sq_map_sz, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->ring_fd,
+                        IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED) {
+        goto mmap_error;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ptr = ring->sq_ptr;
+    } else {
+        ring->cq_ptr = mmap(NULL, ring->cq_map_sz, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring->ring_fd,
+                            IORING_OFF_CQ_RING);
+        if (ring->cq_ptr == MAP_FAILED) {
+            goto mmap_error;
+        }
+    }
+    ring->sqes_map_sz = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_map_sz, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        goto mmap_error;
+    }
+
+    ring->sq_head = (unsigned *)(ring->sq_ptr + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(ring->sq_ptr + params.sq_off.tail);
+    ring->sq_mask = *(unsigned *)(ring->sq_ptr + params.sq_off.ring_mask);
+    ring->sq_entries = params.sq_entries;
+    ring->sq_tail_local = *ring->sq_tail;
+    ring->sq_array = (unsigned *)(ring->sq_ptr + params.sq_off.array);
+    ring->cq_head = (unsigned *)(ring->cq_ptr + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(ring->cq_ptr + params.cq_off.tail);
+    ring->cq_mask = *(unsigned *)(ring->cq_ptr + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(ring->cq_ptr + params.cq_off.cqes);
+    return ring;
+
+mmap_error:
+    set_err(err, errno);
+    DEBUG_PRINT("failed to map ring: %s\n", strerror(errno));
+    if (ring->sq_ptr != NULL && ring->sq_ptr != MAP_FAILED) {
+        munmap(ring->sq_ptr, ring->sq_map_sz);
+    }
+    if (ring->cq_ptr != NULL && ring->cq_ptr != MAP_FAILED &&
+        ring->cq_ptr != ring->sq_ptr) {
+        munmap(ring->cq_ptr, ring->cq_map_sz);
+    }
+    close(ring->ring_fd);
+    free(ring);
+    return NULL;
+}
+
+void free_io_ring(io_ring_t *ring) {
+    if (ring != NULL) {
+        munmap(ring->sqes, ring->sqes_map_sz);
+        if (ring->cq_ptr != ring->sq_ptr) {
+            munmap(ring->cq_ptr, ring->cq_map_sz);
+        }
+        munmap(ring->sq_ptr, ring->sq_map_sz);
+        close(ring->ring_fd);
+        free(ring);
+    }
+}
+
+int io_ring_read(io_ring_t *ring, io_info_t *io_info, void *buf, size_t len,
+                 off_t offset, void *user_data) {
+    if (ring == NULL || io_info == NULL || buf == NULL) {
+        return EINVAL;
+    }
+    struct io_uring_sqe *sqe = ring_next_sqe(ring);
+    if (sqe == NULL) {
+        return EBUSY; // submit the queued batch first
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = io_info->fd;
+    sqe->addr = (uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = io_info->type == FILE_IO ? (uint64_t)offset : 0;
+    sqe->user_data = (uintptr_t)user_data;
+    ring_push_sqe(ring);
+    return SUCCESS;
+}
+
+int io_ring_write(io_ring_t *ring, io_info_t *io_info, const void *buf,
+                  size_t len, off_t offset, void *user_data) {
+    if (ring == NULL || io_info == NULL || buf == NULL) {
+        return EINVAL;
+    }
+    struct io_uring_sqe *sqe = ring_next_sqe(ring);
+    if (sqe == NULL) {
+        return EBUSY; // submit the queued batch first
+    }
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = io_info->fd;
+    sqe->addr = (uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = io_info->type == FILE_IO ? (uint64_t)offset : 0;
+    sqe->user_data = (uintptr_t)user_data;
+    ring_push_sqe(ring);
+    return SUCCESS;
+}
+
+int io_ring_accept(io_ring_t *ring, io_info_t *io_info, void *user_data) {
+    if (ring == NULL || io_info == NULL || io_info->type != ACCEPT_IO) {
+        return EINVAL;
+    }
+    struct io_uring_sqe *sqe = ring_next_sqe(ring);
+    if (sqe == NULL) {
+        return EBUSY; // submit the queued batch first
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = io_info->fd;
+    sqe->user_data = (uintptr_t)user_data;
+    ring_push_sqe(ring);
+    return SUCCESS;
+}
+
+int io_ring_submit(io_ring_t *ring) {
+    if (ring == NULL) {
+        return EINVAL;
+    }
+    while (ring->pending > 0) {
+        int ret = ring_enter(ring->ring_fd, ring->pending, 0, 0);
+        if (ret == FAILURE) {
+            if (errno == EINTR) {
+                continue;
+            }
+            DEBUG_PRINT("io_uring_enter error: %s\n", strerror(errno));
+            return errno;
+        }
+        DEBUG_PRINT("submitted %d operations\n", ret);
+        ring->pending -= ret;
+    }
+    return SUCCESS;
+}
+
+int io_ring_wait(io_ring_t *ring, struct io_completion *comps, size_t *count) {
+    if (ring == NULL || comps == NULL || count == NULL || *count == 0) {
+        if (count != NULL) {
+            *count = 0;
+        }
+        return EINVAL;
+    }
+    size_t capacity = *count;
+    *count = 0;
+    for (;;) {
+        unsigned head = *ring->cq_head;
+        unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail && *count < capacity) {
+            struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+            comps[*count].user_data = (void *)(uintptr_t)cqe->user_data;
+            comps[*count].res = cqe->res;
+            (*count)++;
+            head++;
+        }
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+        if (*count > 0) {
+            DEBUG_PRINT("harvested %zu completions\n", *count);
+            return SUCCESS;
+        }
+        // nothing ready yet: block until at least one completion arrives
+        int ret = ring_enter(ring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+        if (ret == FAILURE && errno != EINTR) {
+            DEBUG_PRINT("io_uring_enter error: %s\n", strerror(errno));
+            return errno;
+        }
+    }
+}
+
+#else // !__linux__
+
+io_ring_t *new_io_ring(unsigned entries, int *err) {
+    (void)entries;
+    set_err(err, ENOTSUP);
+    return NULL;
+}
+
+void free_io_ring(io_ring_t *ring) { (void)ring; }
+
+int io_ring_read(io_ring_t *ring, io_info_t *io_info, void *buf, size_t len,
+                 off_t offset, void *user_data) {
+    (void)ring;
+    (void)io_info;
+    (void)buf;
+    (void)len;
+    (void)offset;
+    (void)user_data;
+    return ENOTSUP;
+}
+
+int io_ring_write(io_ring_t *ring, io_info_t *io_info, const void *buf,
+                  size_t len, off_t offset, void *user_data) {
+    (void)ring;
+    (void)io_info;
+    (void)buf;
+    (void)len;
+    (void)offset;
+    (void)user_data;
+    return ENOTSUP;
+}
+
+int io_ring_accept(io_ring_t *ring, io_info_t *io_info, void *user_data) {
+    (void)ring;
+    (void)io_info;
+    (void)user_data;
+    return ENOTSUP;
+}
+
+int io_ring_submit(io_ring_t *ring) {
+    (void)ring;
+    return ENOTSUP;
+}
+
+int io_ring_wait(io_ring_t *ring, struct io_completion *comps, size_t *count) {
+    (void)ring;
+    (void)comps;
+    if (count != NULL) {
+        *count = 0;
+    }
+    return ENOTSUP;
+}
+
+#endif // __linux__
@@ -6,6 +6,12 @@
 #include <netdb.h>
 #include <openssl/ssl.h>
 #include <stdbool.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #ifdef DEBUG
@@ -18,6 +24,9 @@
 #define SUCCESS 0
 #define FAILURE -1
 #define SSL_SUCCESS 1
+#define COPY_CHUNK 16384 // buffer size for the non-zero-copy io_copy path
+#define PKT_BUF_MIN 256  // starting capacity of a reusable packet buffer
+#define WRITE_BUF_SIZE 16384 // capacity/auto-flush threshold of write buffer
 
 #define SSL_LOCATION "/usr/local/ssl/"
 #define SSL_BUILD_PATH(file_name) SSL_LOCATION file_name
@@ -29,13 +38,24 @@ struct io_info {
     bool ssl_enabled;
     const char *host;
     const char *serv;
+    uint8_t *wbuf; // userspace write buffer, NULL when unbuffered
+    size_t wbuf_len;
+    bool mapped; // io is backed by a read-only file mapping
+    uint8_t *map; // the mapping itself, NULL for an empty file
+    size_t map_len;
+    size_t map_off; // read cursor into the mapping
 };
 
 struct ssl_loader {
     SSL_CTX *client_ctx;
     SSL_CTX *server_ctx;
+    SSL_SESSION *client_session; // most recent resumable client session
+    bool ktls_enabled;
 };
 
+// ex_data slot linking an SSL_CTX back to its loader, for callbacks
+static int loader_ex_idx = -1;
+
 /* PRIVATE FUNCTIONS*/
 
 static void DEBUG_PRINT_SSL(void) {
@@ -44,6 +64,29 @@ static void DEBUG_PRINT_SSL(void) {
 #endif
 }
 
+/**
+ * @brief Capture a resumable session for later client connections.
+ *
+ * Registered on the client SSL_CTX; TLS 1.3 delivers session tickets after
+ * the handshake, so the session only becomes available through this
+ * callback. The newest session replaces any cached one.
+ *
+ * @param ssl - the connection the session belongs to
+ * @param session - the freshly negotiated session
+ * @return int - 1 to take ownership of the session
+ */
+static int client_session_cb(SSL *ssl, SSL_SESSION *session) {
+    ssl_loader_t *loader =
+        SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), loader_ex_idx);
+    if (loader == NULL) {
+        return 0; // not our context; let the library free the session
+    }
+    DEBUG_PRINT("caching resumable client session\n");
+    SSL_SESSION_free(loader->client_session);
+    loader->client_session = session;
+    return 1;
+}
+
 /**
  * @brief Get the SSL_CTX object for a server.
  *
@@ -57,6 +100,15 @@ static SSL_CTX *get_server_ctx(ssl_loader_t *loader) {
         loader->server_ctx = SSL_CTX_new(TLS_server_method());
         SSL_CTX_set_min_proto_version(loader->server_ctx, TLS1_2_VERSION);
         SSL_CTX_set_mode(loader->server_ctx, SSL_MODE_AUTO_RETRY);
+        // all connections accepted through this loader share one session
+        // cache, so returning clients resume instead of re-handshaking
+        SSL_CTX_set_session_cache_mode(loader->server_ctx,
+                                       SSL_SESS_CACHE_SERVER);
+#ifdef SSL_OP_ENABLE_KTLS
+        if (loader->ktls_enabled) {
+            SSL_CTX_set_options(loader->server_ctx, SSL_OP_ENABLE_KTLS);
+        }
+#endif
         if (!SSL_CTX_use_certificate_chain_file(loader->server_ctx,
                                                 SSL_BUILD_PATH("cert.pem")) ||
             !SSL_CTX_use_PrivateKey_file(loader->server_ctx,
@@ -87,6 +139,21 @@ static SSL_CTX *get_client_ctx(ssl_loader_t *loader) {
         SSL_CTX_set_min_proto_version(loader->client_ctx, TLS1_2_VERSION);
         SSL_CTX_set_mode(loader->client_ctx, SSL_MODE_AUTO_RETRY);
         SSL_CTX_set_verify(loader->client_ctx, SSL_VERIFY_PEER, NULL);
+        // capture session tickets so later connections can resume; the
+        // loader keeps the session itself, no internal store needed
+        if (loader_ex_idx == -1) {
+            loader_ex_idx = SSL_CTX_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+        }
+        SSL_CTX_set_ex_data(loader->client_ctx, loader_ex_idx, loader);
+        SSL_CTX_set_session_cache_mode(loader->client_ctx,
+                                       SSL_SESS_CACHE_CLIENT |
+                                           SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(loader->client_ctx, client_session_cb);
+#ifdef SSL_OP_ENABLE_KTLS
+        if (loader->ktls_enabled) {
+            SSL_CTX_set_options(loader->client_ctx, SSL_OP_ENABLE_KTLS);
+        }
+#endif
         if (!SSL_CTX_set_default_verify_paths(loader->client_ctx)) {
             DEBUG_PRINT("Failed to set default trusted certificate store\n");
             DEBUG_PRINT_SSL();
@@ -146,6 +213,11 @@ static int add_client_ssl(io_info_t *io_info, ssl_loader_t *loader) {
     BIO_get_ssl(ssl_bio, &ssl);
     SSL_set_tlsext_host_name(ssl, io_info->host);
     SSL_set1_host(ssl, io_info->host);
+    if (loader->client_session != NULL) {
+        // resume the cached session; the server falls back to a full
+        // handshake if the ticket has expired
+        SSL_set_session(ssl, loader->client_session);
+    }
 
     io_info->bio = BIO_push(ssl_bio, io_info->bio);
     int err;
@@ -272,7 +344,7 @@ cleanup:
 
 io_info_t *new_file_io_info(const char *filename, int flags, mode_t mode,
                             int *err) {
-    io_info_t *io_info = malloc(sizeof(*io_info));
+    io_info_t *io_info = calloc(1, sizeof(*io_info));
     if (io_info == NULL) {
         set_err(err, ENOMEM);
         return NULL;
@@ -294,6 +366,55 @@ io_info_t *new_file_io_info(const char *filename, int flags, mode_t mode,
     return io_info;
 }
 
+io_info_t *new_file_mmap_io_info(const char *filename, int *err) {
+    io_info_t *io_info = calloc(1, sizeof(*io_info));
+    if (io_info == NULL) {
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+    io_info->fd = open(filename, O_RDONLY);
+    if (io_info->fd < 0) {
+        set_err(err, errno);
+        free(io_info);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(io_info->fd, &st) < 0) {
+        set_err(err, errno);
+        close(io_info->fd);
+        free(io_info);
+        return NULL;
+    }
+    if (st.st_size > 0) {
+        io_info->map =
+            mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, io_info->fd, 0);
+        if (io_info->map == MAP_FAILED) {
+            set_err(err, errno);
+            close(io_info->fd);
+            free(io_info);
+            return NULL;
+        }
+        io_info->map_len = st.st_size;
+#ifdef MADV_SEQUENTIAL
+        // reads walk the file front to back; let readahead run wide
+        madvise(io_info->map, io_info->map_len, MADV_SEQUENTIAL);
+#endif
+    }
+    io_info->mapped = true; // an empty file keeps map NULL
+    io_info->bio = BIO_new_fd(io_info->fd, BIO_CLOSE);
+    if (io_info->bio == NULL) {
+        set_err(err, FAILURE); // TODO: don't know what to use for error
+        if (io_info->map != NULL) {
+            munmap(io_info->map, io_info->map_len);
+        }
+        close(io_info->fd);
+        free(io_info);
+        return NULL;
+    }
+    io_info->type = FILE_IO;
+    return io_info;
+}
+
 io_info_t *new_accept_io_info(const char *port, int *err, int *err_type) {
     io_info_t *io_info = calloc(1, sizeof(*io_info));
     if (io_info == NULL) {
@@ -329,6 +450,76 @@ io_info_t *new_accept_io_info(const char *port, int *err, int *err_type) {
     return io_info;
 }
 
+io_info_t *new_accept_io_info_reuseport(const char *port, int *err,
+                                        int *err_type) {
+#ifndef SO_REUSEPORT
+    (void)port;
+    set_err(err_type, SYS);
+    set_err(err, ENOTSUP);
+    return NULL;
+#else
+    // accept BIOs bind their own socket and only expose BIO_BIND_REUSEADDR,
+    // so the listening socket is created by hand and wrapped afterwards
+    struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+        .ai_flags = AI_PASSIVE | AI_V4MAPPED,
+        .ai_protocol = 0,
+    };
+    struct addrinfo *result = NULL;
+    int loc_err = getaddrinfo(NULL, port, &hints, &result);
+    if (loc_err != SUCCESS) {
+        if (loc_err == EAI_SYSTEM) {
+            set_err(err, errno);
+            set_err(err_type, SYS);
+        } else {
+            set_err(err, loc_err);
+            set_err(err_type, GAI);
+        }
+        return NULL;
+    }
+
+    int sock = FAILURE;
+    loc_err = FAILURE;
+    for (struct addrinfo *res_ptr = result; res_ptr != NULL;
+         res_ptr = res_ptr->ai_next) {
+        sock = socket(res_ptr->ai_family, res_ptr->ai_socktype,
+                      res_ptr->ai_protocol);
+        if (sock == FAILURE) {
+            loc_err = errno;
+            set_err(err_type, SOCK);
+            continue;
+        }
+        int optval = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+        setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval));
+        if (bind(sock, res_ptr->ai_addr, res_ptr->ai_addrlen) == SUCCESS &&
+            listen(sock, MAX_CONNECTIONS) == SUCCESS) {
+            loc_err = SUCCESS;
+            break;
+        }
+        loc_err = errno;
+        set_err(err_type, BIND);
+        close(sock);
+        sock = FAILURE;
+    }
+    freeaddrinfo(result);
+    if (loc_err != SUCCESS) {
+        set_err(err, loc_err);
+        return NULL;
+    }
+
+    io_info_t *io_info = new_io_info(sock, ACCEPT_IO, err);
+    if (io_info == NULL) {
+        set_err(err_type, SYS);
+        close(sock);
+        return NULL;
+    }
+    (void)BIO_set_close(io_info->bio, BIO_CLOSE);
+    return io_info;
+#endif
+}
+
 io_info_t *new_connect_io_info(const char *host, const char *port, int *err,
                                int *err_type) {
     io_info_t *io_info = calloc(1, sizeof(*io_info));
@@ -374,6 +565,65 @@ io_info_t *new_connect_io_info(const char *host, const char *port, int *err,
     return io_info;
 }
 
+io_info_t *new_connect_io_info_async(const char *host, const char *port,
+                                     int *err, int *err_type) {
+    io_info_t *io_info = calloc(1, sizeof(*io_info));
+    if (io_info == NULL) {
+        set_err(err_type, SYS);
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+
+    if ((io_info->bio = BIO_new(BIO_s_connect())) == NULL) {
+        set_err(err_type, SYS);
+        set_err(err, FAILURE); // TODO: don't know what to use for error
+        DEBUG_PRINT("BIO_new_connect failed\n");
+        DEBUG_PRINT_SSL();
+        free(io_info);
+        return NULL;
+    }
+    BIO_set_conn_hostname(io_info->bio, host);
+    BIO_set_conn_port(io_info->bio, port);
+    BIO_set_nbio(io_info->bio, true);
+
+    // start the handshake; an attempt that would block is completed
+    // later through io_connect_status
+    if (BIO_do_connect(io_info->bio) <= SUCCESS &&
+        !BIO_should_retry(io_info->bio)) {
+        set_err(err_type, SYS);
+        set_err(err, FAILURE); // TODO: don't know what to use for error
+        DEBUG_PRINT("BIO_do_connect failed\n");
+        DEBUG_PRINT_SSL();
+        free_io_info(io_info);
+        return NULL;
+    }
+
+    io_info->host = BIO_get_conn_hostname(io_info->bio);
+    io_info->serv = BIO_get_conn_port(io_info->bio);
+    (void)BIO_set_close(io_info->bio, BIO_CLOSE);
+    BIO_get_fd(io_info->bio, &io_info->fd);
+    io_info->type = CONNECTED_IO;
+
+    return io_info;
+}
+
+int io_connect_status(io_info_t *io_info) {
+    if (io_info == NULL || io_info->type != CONNECTED_IO) {
+        return EINVAL;
+    }
+    if (BIO_do_connect(io_info->bio) <= SUCCESS) {
+        if (BIO_should_retry(io_info->bio)) {
+            return EINPROGRESS;
+        }
+        DEBUG_PRINT("BIO_do_connect failed\n");
+        DEBUG_PRINT_SSL();
+        return FAILURE; // TODO: don't know what to use for error
+    }
+    // the socket is only final once the connection is established
+    BIO_get_fd(io_info->bio, &io_info->fd);
+    return SUCCESS;
+}
+
 ssl_loader_t *new_ssl_loader(int *err) {
     ssl_loader_t *loader = calloc(1, sizeof(*loader));
     if (loader == NULL) {
@@ -385,6 +635,11 @@ ssl_loader_t *new_ssl_loader(int *err) {
 
 void free_io_info(io_info_t *io_info) {
     if (io_info != NULL) {
+        io_flush(io_info); // best effort for any buffered bytes
+        free(io_info->wbuf);
+        if (io_info->map != NULL) {
+            munmap(io_info->map, io_info->map_len);
+        }
         BIO_free_all(io_info->bio);
         free(io_info);
     }
@@ -392,12 +647,32 @@ void free_io_info(io_info_t *io_info) {
 
 void free_ssl_loader(ssl_loader_t *loader) {
     if (loader != NULL) {
+        SSL_SESSION_free(loader->client_session);
         SSL_CTX_free(loader->client_ctx);
         SSL_CTX_free(loader->server_ctx);
         free(loader);
     }
 }
 
+int ssl_loader_enable_ktls(ssl_loader_t *loader) {
+    if (loader == NULL) {
+        return EINVAL;
+    }
+#ifdef SSL_OP_ENABLE_KTLS
+    loader->ktls_enabled = true;
+    // contexts are created lazily; cover any that already exist
+    if (loader->server_ctx != NULL) {
+        SSL_CTX_set_options(loader->server_ctx, SSL_OP_ENABLE_KTLS);
+    }
+    if (loader->client_ctx != NULL) {
+        SSL_CTX_set_options(loader->client_ctx, SSL_OP_ENABLE_KTLS);
+    }
+    return SUCCESS;
+#else
+    return ENOTSUP; // this OpenSSL build has no kernel TLS support
+#endif
+}
+
 int io_info_fd(io_info_t *io_info, int *type) {
     set_err(type, io_info->type);
     return io_info->fd;
@@ -454,9 +729,14 @@ io_info_t *io_accept(io_info_t *io_info, int *err) {
     }
 
     if (BIO_do_accept(io_info->bio) <= SUCCESS) {
-        set_err(err, FAILURE); // TODO: don't know what to use for error
-        DEBUG_PRINT("Error accepting connection\n");
-        DEBUG_PRINT_SSL();
+        if (BIO_should_retry(io_info->bio)) {
+            // no pending connection; report it like a non-blocking accept
+            set_err(err, EAGAIN);
+        } else {
+            set_err(err, FAILURE); // TODO: don't know what to use for error
+            DEBUG_PRINT("Error accepting connection\n");
+            DEBUG_PRINT_SSL();
+        }
         free(new_info);
         return NULL;
     }
@@ -483,7 +763,43 @@ io_info_t *io_accept(io_info_t *io_info, int *err) {
     return new_info;
 }
 
+int io_accept_batch(io_info_t *io_info, io_info_t **clients, size_t *count) {
+    if (io_info == NULL || clients == NULL || count == NULL || *count == 0) {
+        if (count != NULL) {
+            *count = 0;
+        }
+        return EINVAL;
+    }
+    size_t capacity = *count;
+    *count = 0;
+
+    // the accept BIO is already non-blocking, so each attempt either
+    // delivers a pending connection or reports it would block
+    int err = SUCCESS;
+    while (*count < capacity) {
+        int loc_err = SUCCESS;
+        io_info_t *client = io_accept(io_info, &loc_err);
+        if (client == NULL) {
+            if (!BIO_should_retry(io_info->bio)) {
+                err = loc_err; // a real error, not a drained queue
+            }
+            break;
+        }
+        clients[(*count)++] = client;
+    }
+    return err;
+}
+
 int read_exact(io_info_t *io_info, void *buff, size_t read_sz) {
+    if (io_info->mapped) {
+        if (read_sz > io_info->map_len - io_info->map_off) {
+            DEBUG_PRINT("mapping exhausted: %s\n", strerror(ENODATA));
+            return ENODATA;
+        }
+        memcpy(buff, io_info->map + io_info->map_off, read_sz);
+        io_info->map_off += read_sz;
+        return SUCCESS;
+    }
     uint8_t *buf_ptr = (uint8_t *)buff;
     size_t total_len = 0;
     size_t bytes_read = 0;
@@ -507,11 +823,19 @@ int read_exact(io_info_t *io_info, void *buff, size_t read_sz) {
         total_len += bytes_read;
         buf_ptr += bytes_read;
         read_sz -= bytes_read;
-    } while (total_len < read_sz);
+    } while (read_sz > 0);
     return SUCCESS;
 }
 
-int write_all(io_info_t *io_info, const void *buf, size_t len) {
+/**
+ * @brief Write a buffer to an io_info object, bypassing the write buffer.
+ *
+ * @param io_info - the io_info object to write to
+ * @param buf - the buffer to write
+ * @param len - the length of the buffer
+ * @return int - 0 on success, non-zero on failure
+ */
+static int write_direct(io_info_t *io_info, const void *buf, size_t len) {
     size_t bytes_written;
     uint8_t *buf_ptr = (uint8_t *)buf;
     DEBUG_PRINT("writing %zu bytes total\n", len);
@@ -529,72 +853,297 @@ int write_all(io_info_t *io_info, const void *buf, size_t len) {
     return SUCCESS;
 }
 
-void free_packet(struct packet *pkt) {
+int io_flush(io_info_t *io_info) {
+    if (io_info == NULL) {
+        return EINVAL;
+    }
+    if (io_info->wbuf == NULL || io_info->wbuf_len == 0) {
+        return SUCCESS; // nothing pending
+    }
+    DEBUG_PRINT("flushing %zu buffered bytes\n", io_info->wbuf_len);
+    int err = write_direct(io_info, io_info->wbuf, io_info->wbuf_len);
+    // the buffer is reset even on failure: write_direct may have pushed
+    // part of it out, so retrying would duplicate bytes on the wire
+    io_info->wbuf_len = 0;
+    return err;
+}
+
+int io_set_buffered(io_info_t *io_info, bool enabled) {
+    if (io_info == NULL) {
+        return EINVAL;
+    }
+    if (enabled) {
+        if (io_info->wbuf != NULL) {
+            return SUCCESS; // already buffered
+        }
+        io_info->wbuf = malloc(WRITE_BUF_SIZE);
+        if (io_info->wbuf == NULL) {
+            DEBUG_PRINT("failed to allocate write buffer: %s\n",
+                        strerror(errno));
+            return errno;
+        }
+        io_info->wbuf_len = 0;
+        return SUCCESS;
+    }
+    int err = io_flush(io_info);
+    free(io_info->wbuf);
+    io_info->wbuf = NULL;
+    return err;
+}
+
+int write_all(io_info_t *io_info, const void *buf, size_t len) {
+    if (io_info->wbuf == NULL) {
+        return write_direct(io_info, buf, len);
+    }
+    if (len >= WRITE_BUF_SIZE) {
+        // a write this large fills a record on its own; push any pending
+        // bytes first so ordering is preserved
+        int err = io_flush(io_info);
+        if (err != SUCCESS) {
+            return err;
+        }
+        return write_direct(io_info, buf, len);
+    }
+    if (io_info->wbuf_len + len > WRITE_BUF_SIZE) {
+        int err = io_flush(io_info);
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+    DEBUG_PRINT("buffering %zu bytes\n", len);
+    memcpy(io_info->wbuf + io_info->wbuf_len, buf, len);
+    io_info->wbuf_len += len;
+    if (io_info->wbuf_len == WRITE_BUF_SIZE) {
+        return io_flush(io_info); // auto-flush on threshold
+    }
+    return SUCCESS;
+}
+
+int io_copy(io_info_t *dest, io_info_t *src, off_t offset, size_t len) {
+    if (dest == NULL || src == NULL || offset < 0) {
+        return EINVAL;
+    }
+    if (src->type != FILE_IO && offset != 0) {
+        // only file sources are seekable
+        return ESPIPE;
+    }
+#ifdef __linux__
+    // zero-copy path: only possible when the bytes do not have to pass
+    // through the SSL layer on their way out
+    if (src->type == FILE_IO && !dest->ssl_enabled) {
+        int err = io_flush(dest); // sendfile bypasses the write buffer
+        if (err != SUCCESS) {
+            return err;
+        }
+        off_t off = offset;
+        while (len > 0) {
+            ssize_t sent = sendfile(dest->fd, src->fd, &off, len);
+            if (sent > 0) {
+                len -= sent;
+                continue;
+            }
+            if (sent == 0) {
+                DEBUG_PRINT("file ended before copy completed\n");
+                return ENODATA;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                continue;
+            }
+            if (errno == EINVAL || errno == ENOSYS) {
+                // destination cannot take sendfile; fall back to the
+                // buffered loop, keeping any progress already made
+                break;
+            }
+            DEBUG_PRINT("from call to sendfile(2): %s\n", strerror(errno));
+            return errno;
+        }
+        if (len == 0) {
+            return SUCCESS;
+        }
+        offset = off;
+    }
+#endif
+    uint8_t buf[COPY_CHUNK];
+    while (len > 0) {
+        size_t chunk = len < sizeof(buf) ? len : sizeof(buf);
+        size_t bytes_read;
+        if (src->type == FILE_IO) {
+            // files never carry an SSL layer; pread leaves the file
+            // position untouched
+            ssize_t res = pread(src->fd, buf, chunk, offset);
+            if (res < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    continue;
+                }
+                DEBUG_PRINT("from call to pread(2): %s\n", strerror(errno));
+                return errno;
+            }
+            bytes_read = res;
+        } else if (!BIO_read_ex(src->bio, buf, chunk, &bytes_read)) {
+            if (BIO_should_retry(src->bio)) {
+                // retry the read if the call would block
+                continue;
+            }
+            DEBUG_PRINT("BIO_read_ex failed\n");
+            DEBUG_PRINT_SSL();
+            return FAILURE; // TODO: don't know what to use for error
+        }
+        if (bytes_read == 0) {
+            DEBUG_PRINT("source ended before copy completed\n");
+            return ENODATA;
+        }
+        int err = write_all(dest, buf, bytes_read);
+        if (err != SUCCESS) {
+            return err;
+        }
+        offset += bytes_read;
+        len -= bytes_read;
+    }
+    return SUCCESS;
+}
+
+void free_packet_buffers(struct packet *pkt) {
     if (pkt != NULL) {
         free(pkt->hdr);
-        free(pkt->data);
+        if (pkt->data_cap > 0) {
+            free(pkt->data); // data with no capacity aliases a mapping
+        }
+        pkt->hdr = NULL;
+        pkt->data = NULL;
+        pkt->data_cap = 0;
+    }
+}
+
+void free_packet(struct packet *pkt) {
+    if (pkt != NULL) {
+        free_packet_buffers(pkt);
         free(pkt);
     }
 }
 
-int write_pkt_data(io_info_t *io_info, void *data, size_t len,
-                   uint32_t data_type) {
-    DEBUG_PRINT("writing packet...\n");
+int write_pkt_datav(io_info_t *io_info, struct iovec *iov, size_t iovcnt,
+                    uint32_t data_type) {
+    if (io_info == NULL || (iov == NULL && iovcnt > 0)) {
+        return EINVAL;
+    }
+    size_t total = 0;
+    for (size_t i = 0; i < iovcnt; i++) {
+        total += iov[i].iov_len;
+    }
+    if (total > UINT32_MAX) {
+        return EOVERFLOW; // the packet header cannot describe the payload
+    }
+
+    DEBUG_PRINT("writing packet of %zu fragments...\n", iovcnt);
     struct pkt_hdr hdr;
     memset(&hdr, 0, sizeof(hdr));
     hdr.header_len = htonl(sizeof(hdr));
-    hdr.data_len = htonl(len);
+    hdr.data_len = htonl(total);
     hdr.data_type = htonl(data_type);
 
-    int err = write_all(io_info, &hdr, sizeof(hdr));
-    if (err != SUCCESS) {
-        return err;
+    // BIOs have no scatter-gather interface, so the packet is coalesced
+    // and pushed through the SSL layer as a single record
+    uint8_t *buf = malloc(sizeof(hdr) + total);
+    if (buf == NULL) {
+        return ENOMEM;
+    }
+    memcpy(buf, &hdr, sizeof(hdr));
+    size_t pos = sizeof(hdr);
+    for (size_t i = 0; i < iovcnt; i++) {
+        memcpy(buf + pos, iov[i].iov_base, iov[i].iov_len);
+        pos += iov[i].iov_len;
     }
-    DEBUG_PRINT("header successfully written\n");
-    return write_all(io_info, data, len);
+    int err = write_all(io_info, buf, pos);
+    free(buf);
+    return err;
 }
 
-struct packet *read_pkt(io_info_t *io_info, int *err) {
-    struct packet *pkt = calloc(1, sizeof(*pkt));
-    if (pkt == NULL) {
-        set_err(err, errno);
-        DEBUG_PRINT("failed to allocate packet buffer: %s\n", strerror(*err));
-        return NULL;
+int write_pkt_data(io_info_t *io_info, void *data, size_t len,
+                   uint32_t data_type) {
+    struct iovec iov = {
+        .iov_base = data,
+        .iov_len = len,
+    };
+    return write_pkt_datav(io_info, &iov, len > 0 ? 1 : 0, data_type);
+}
+
+int read_pkt_into(io_info_t *io_info, struct packet *pkt) {
+    if (io_info == NULL || pkt == NULL) {
+        return EINVAL;
     }
-    pkt->hdr = malloc(sizeof(*pkt->hdr));
     if (pkt->hdr == NULL) {
-        set_err(err, errno);
-        DEBUG_PRINT("failed to allocate header buffer: %s\n", strerror(*err));
-        free_packet(pkt);
-        return NULL;
+        pkt->hdr = malloc(sizeof(*pkt->hdr));
+        if (pkt->hdr == NULL) {
+            DEBUG_PRINT("failed to allocate header buffer: %s\n",
+                        strerror(errno));
+            return errno;
+        }
     }
 
     int loc_err = read_hdr_data(io_info, pkt->hdr);
     if (loc_err != SUCCESS) {
-        set_err(err, loc_err);
-        free_packet(pkt);
-        return NULL;
+        return loc_err;
     } else if (pkt->hdr->data_len == 0) {
         DEBUG_PRINT("header successfully read: but no data\n");
-        pkt->data = NULL;
-        return pkt; // no data to read
+        return SUCCESS; // no data to read, buffer kept for reuse
     }
 
-    pkt->data = malloc(pkt->hdr->data_len);
-    if (pkt->data == NULL) {
-        set_err(err, errno);
-        DEBUG_PRINT("failed to allocate data buffer: %s\n", strerror(*err));
-        free_packet(pkt);
-        return NULL;
+    if (io_info->mapped) {
+        // zero-copy: the packet data aliases the mapping directly and
+        // stays valid until the io_info is freed
+        if (pkt->hdr->data_len > io_info->map_len - io_info->map_off) {
+            DEBUG_PRINT("mapping exhausted: %s\n", strerror(ENODATA));
+            return ENODATA;
+        }
+        if (pkt->data_cap > 0) {
+            free(pkt->data); // drop any owned buffer from previous reads
+            pkt->data_cap = 0;
+        }
+        pkt->data = io_info->map + io_info->map_off;
+        io_info->map_off += pkt->hdr->data_len;
+        return SUCCESS;
+    }
+    if (pkt->data != NULL && pkt->data_cap == 0) {
+        pkt->data = NULL; // previous read aliased a mapping; do not grow it
+    }
+
+    if (pkt->hdr->data_len > pkt->data_cap) {
+        // grow geometrically so a busy connection stops allocating once
+        // the buffer has seen its largest packet
+        size_t new_cap = pkt->data_cap == 0 ? PKT_BUF_MIN : pkt->data_cap;
+        while (new_cap < pkt->hdr->data_len) {
+            new_cap *= 2;
+        }
+        void *new_data = realloc(pkt->data, new_cap);
+        if (new_data == NULL) {
+            DEBUG_PRINT("failed to grow data buffer: %s\n", strerror(errno));
+            return errno;
+        }
+        pkt->data = new_data;
+        pkt->data_cap = new_cap;
     }
     DEBUG_PRINT("reading data...\n");
     loc_err = read_exact(io_info, pkt->data, pkt->hdr->data_len);
+    if (loc_err != SUCCESS) {
+        return loc_err;
+    }
+    DEBUG_PRINT("data successfully read\n");
+    return SUCCESS;
+}
+
+struct packet *read_pkt(io_info_t *io_info, int *err) {
+    struct packet *pkt = calloc(1, sizeof(*pkt));
+    if (pkt == NULL) {
+        set_err(err, errno);
+        DEBUG_PRINT("failed to allocate packet buffer: %s\n", strerror(*err));
+        return NULL;
+    }
+    int loc_err = read_pkt_into(io_info, pkt);
     if (loc_err != SUCCESS) {
         set_err(err, loc_err);
         free_packet(pkt);
         return NULL;
     }
-    DEBUG_PRINT("data successfully read\n");
     return pkt;
 }
 
@@ -614,3 +1163,74 @@ struct packet *recv_pkt_data(io_info_t *io_info, int timeout, int *err) {
         return NULL; // error in revents, usually means other end closed
     }
 }
+
+int recv_pkt_data_into(io_info_t *io_info, int timeout, struct packet *pkt) {
+    struct pollio pio = {.io_info = io_info, .events = POLLIN};
+    int loc_err = poll_io_info(&pio, 1, timeout);
+    if (loc_err <= 0) {
+        // 0 on timeout, negative on poll error
+        loc_err = loc_err == 0 ? ETIMEDOUT : -loc_err;
+        DEBUG_PRINT("poll error: %s\n", strerror(loc_err));
+        return loc_err;
+    } else if (pio.revents & POLLIN) {
+        DEBUG_PRINT("receiving packet...\n");
+        return read_pkt_into(io_info, pkt);
+    }
+    return ENODATA; // error in revents, usually means other end closed
+}
+
+/* IO_URING ENGINE */
+
+// the ring engine submits raw descriptor operations, which would bypass
+// the SSL layer entirely; it is only supported by the plain backend
+
+io_ring_t *new_io_ring(unsigned entries, int *err) {
+    (void)entries;
+    set_err(err, ENOTSUP);
+    return NULL;
+}
+
+void free_io_ring(io_ring_t *ring) { (void)ring; }
+
+int io_ring_read(io_ring_t *ring, io_info_t *io_info, void *buf, size_t len,
+                 off_t offset, void *user_data) {
+    (void)ring;
+    (void)io_info;
+    (void)buf;
+    (void)len;
+    (void)offset;
+    (void)user_data;
+    return ENOTSUP;
+}
+
+int io_ring_write(io_ring_t *ring, io_info_t *io_info, const void *buf,
+                  size_t len, off_t offset, void *user_data) {
+    (void)ring;
+    (void)io_info;
+    (void)buf;
+    (void)len;
+    (void)offset;
+    (void)user_data;
+    return ENOTSUP;
+}
+
+int io_ring_accept(io_ring_t *ring, io_info_t *io_info, void *user_data) {
+    (void)ring;
+    (void)io_info;
+    (void)user_data;
+    return ENOTSUP;
+}
+
+int io_ring_submit(io_ring_t *ring) {
+    (void)ring;
+    return ENOTSUP;
+}
+
+int io_ring_wait(io_ring_t *ring, struct io_completion *comps, size_t *count) {
+    (void)ring;
+    (void)comps;
+    if (count != NULL) {
+        *count = 0;
+    }
+    return ENOTSUP;
+}
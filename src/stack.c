@@ -1,49 +1,167 @@
 #include "stack.h"
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* DATA */
 
 #define SUCCESS 0
 #define INVALID -1
 
+#define CHUNK_BYTES 4096 // one page of entries per chunk
+
 /**
  * @brief structure of a stack object
  *
+ * Entries live in fixed-size contiguous chunks that are allocated on
+ * demand, so a push is usually just a store into the current chunk and
+ * creating a deep stack never pays for its full capacity up front. The
+ * chunk directory maps position / chunk_entries to a chunk, keeping
+ * positional reads O(1). Popping keeps one empty chunk in reserve so a
+ * push/pop cycle straddling a chunk boundary does not thrash the
+ * allocator.
+ *
+ * A sized stack (mem_sz != 0) owns its element storage: each slot holds
+ * mem_sz bytes and push copies the element in. In the default pointer
+ * mode each slot holds the caller's pointer.
+ *
  * @param capacity is the number of nodes the stack can hold
  * @param size is the number of nodes the stack is currently storing
- * @param arr is the array containing the stack node pointers
+ * @param mem_sz size of each element, 0 for pointer mode
+ * @param chunk_entries number of elements each chunk holds
+ * @param chunks directory of allocated chunks
+ * @param chunk_count number of allocated chunks
+ * @param chunks_cap allocated capacity of the directory
  * @param customfree pointer to the user defined free function
- * @param compare_function pointer to the user defined compare function
  */
 typedef struct stack_t {
     size_t capacity;
     size_t size;
-    void **arr;
+    size_t mem_sz;
+    size_t chunk_entries;
+    void **chunks;
+    size_t chunk_count;
+    size_t chunks_cap;
     FREE_F customfree;
 } stack_t;
 
-/* PUBLIC FUNCTIONS */
+/* PRIVATE FUNCTIONS */
 
-stack_t *stack_init(size_t capacity, FREE_F customfree) {
+/**
+ * @brief Get the slot holding a stack position.
+ *
+ * @param stack stack to index into
+ * @param position position in the stack, 0 being the bottom
+ * @return void* address of the slot holding that position
+ */
+static void *slot_at(const stack_t *stack, size_t position) {
+    size_t slot_size = stack->mem_sz != 0 ? stack->mem_sz : sizeof(void *);
+    char *chunk = stack->chunks[position / stack->chunk_entries];
+    return chunk + ((position % stack->chunk_entries) * slot_size);
+}
+
+/**
+ * @brief Get the element stored at a stack position.
+ *
+ * In pointer mode this is the caller's pointer; in sized mode it is the
+ * address of the stack-owned copy.
+ *
+ * @param stack stack to read from
+ * @param position position in the stack, 0 being the bottom
+ * @return void* the element at that position
+ */
+static void *entry_at(const stack_t *stack, size_t position) {
+    void *slot = slot_at(stack, position);
+    return stack->mem_sz != 0 ? slot : *(void **)slot;
+}
+
+/**
+ * @brief Make sure the chunk holding the next push exists.
+ *
+ * @param stack stack about to be pushed onto
+ * @return int 0 on success, ENOMEM on allocation failure
+ */
+static int ensure_top_chunk(stack_t *stack) {
+    size_t chunk_idx = stack->size / stack->chunk_entries;
+    if (chunk_idx < stack->chunk_count) {
+        return SUCCESS;
+    }
+    if (stack->chunk_count == stack->chunks_cap) {
+        size_t new_cap = stack->chunks_cap == 0 ? 4 : stack->chunks_cap * 2;
+        void **new_dir = realloc(stack->chunks, new_cap * sizeof(*new_dir));
+        if (new_dir == NULL) {
+            return ENOMEM;
+        }
+        stack->chunks = new_dir;
+        stack->chunks_cap = new_cap;
+    }
+    size_t slot_size = stack->mem_sz != 0 ? stack->mem_sz : sizeof(void *);
+    void *chunk = malloc(stack->chunk_entries * slot_size);
+    if (chunk == NULL) {
+        return ENOMEM;
+    }
+    stack->chunks[stack->chunk_count++] = chunk;
+    return SUCCESS;
+}
+
+/**
+ * @brief Release chunks no longer reachable by the stack top.
+ *
+ * One empty chunk above the top is kept in reserve; anything beyond that
+ * is returned to the allocator.
+ *
+ * @param stack stack to trim
+ */
+static void trim_chunks(stack_t *stack) {
+    size_t used =
+        (stack->size + stack->chunk_entries - 1) / stack->chunk_entries;
+    while (stack->chunk_count > used + 1) {
+        free(stack->chunks[--stack->chunk_count]);
+    }
+}
+
+/**
+ * @brief Shared constructor behind the two stack modes.
+ *
+ * @param capacity max number of nodes the stack will hold
+ * @param mem_sz size of each element, 0 for pointer mode
+ * @param customfree pointer to the user defined free function
+ * @return stack_t* pointer to allocated stack, NULL on failure
+ */
+static stack_t *stack_create(size_t capacity, size_t mem_sz,
+                             FREE_F customfree) {
     if (capacity == 0) {
         return NULL;
     }
-    stack_t *stack = malloc(sizeof(*stack));
+    stack_t *stack = calloc(1, sizeof(*stack));
     if (stack == NULL) {
         return NULL;
     }
-    stack->arr = malloc(sizeof(*(stack->arr)) * capacity);
-    if (stack->arr == NULL) {
-        free(stack);
-        return NULL;
+    size_t slot_size = mem_sz != 0 ? mem_sz : sizeof(void *);
+    stack->chunk_entries = CHUNK_BYTES / slot_size;
+    if (stack->chunk_entries == 0) {
+        // elements bigger than a chunk get one element per chunk
+        stack->chunk_entries = 1;
     }
     stack->capacity = capacity;
-    stack->size = 0;
+    stack->mem_sz = mem_sz;
     stack->customfree = customfree;
     return stack;
 }
 
+/* PUBLIC FUNCTIONS */
+
+stack_t *stack_init(size_t capacity, FREE_F customfree) {
+    return stack_create(capacity, 0, customfree);
+}
+
+stack_t *stack_init_sized(size_t capacity, size_t mem_sz) {
+    if (mem_sz == 0) {
+        return NULL;
+    }
+    return stack_create(capacity, mem_sz, NULL);
+}
+
 ssize_t stack_get_capacity(stack_t *stack) {
     if (stack == NULL) {
         return INVALID;
@@ -77,8 +195,20 @@ int stack_push(stack_t *stack, void *data) {
         return EINVAL;
     } else if (stack->size == stack->capacity) {
         return EOVERFLOW;
+    } else if (stack->mem_sz != 0 && data == NULL) {
+        return EINVAL;
     }
-    stack->arr[stack->size++] = data;
+    int err = ensure_top_chunk(stack);
+    if (err != SUCCESS) {
+        return err;
+    }
+    void *slot = slot_at(stack, stack->size);
+    if (stack->mem_sz != 0) {
+        memcpy(slot, data, stack->mem_sz);
+    } else {
+        *(void **)slot = data;
+    }
+    stack->size++;
     return SUCCESS;
 }
 
@@ -86,22 +216,26 @@ void *stack_pop(stack_t *stack) {
     if (stack == NULL || stack->size == 0) {
         return NULL;
     }
-    // no need to set the popped node to NULL
-    return stack->arr[--stack->size];
+    stack->size--;
+    // in sized mode the returned copy stays readable until the next push:
+    // trimming keeps the popped slot's chunk in reserve
+    void *data = entry_at(stack, stack->size);
+    trim_chunks(stack);
+    return data;
 }
 
 void *stack_peek(stack_t *stack) {
     if (stack == NULL || stack->size == 0) {
         return NULL;
     }
-    return stack->arr[stack->size - 1];
+    return entry_at(stack, stack->size - 1);
 }
 
 void *stack_get(stack_t *stack, size_t position) {
     if (stack == NULL || position >= stack->size) {
         return NULL;
     }
-    return stack->arr[position];
+    return entry_at(stack, position);
 }
 
 int stack_clear(stack_t *stack) {
@@ -110,12 +244,13 @@ int stack_clear(stack_t *stack) {
     } else if (stack->size == 0) {
         return SUCCESS;
     }
-    for (size_t i = 0; i < stack->size; i++) {
-        if (stack->customfree != NULL) {
-            stack->customfree(stack->arr[i]);
+    if (stack->customfree != NULL) {
+        for (size_t i = 0; i < stack->size; i++) {
+            stack->customfree(entry_at(stack, i));
         }
     }
     stack->size = 0;
+    trim_chunks(stack);
     return SUCCESS;
 }
 
@@ -124,7 +259,10 @@ int stack_destroy(stack_t **stack) {
         return EINVAL;
     }
     stack_clear(*stack);
-    free((*stack)->arr);
+    for (size_t i = 0; i < (*stack)->chunk_count; i++) {
+        free((*stack)->chunks[i]);
+    }
+    free((*stack)->chunks);
     free(*stack);
     *stack = NULL;
     return SUCCESS;
@@ -1,18 +1,49 @@
-#define _DEFAULT_SOURCE
+#define _GNU_SOURCE // pthread_setaffinity_np
 #include "threadpool.h"
+#include "bb_stats.h"
 #include "buildingblocks.h"
 #include "queue_concurrent.h"
+#include "queue_p.h"
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+#ifndef __STDC_NO_ATOMICS__
+#include <stdatomic.h>
+#define ATOMIC_INC(counter, lock) counter++
+#define ATOMIC_DEC(counter, lock) counter--
+#else
+#define ATOMIC_INC(counter, lock)                                              \
+    do {                                                                       \
+        pthread_mutex_lock(&lock);                                             \
+        counter++;                                                             \
+        pthread_mutex_unlock(&lock);                                           \
+    } while (0);
+#define ATOMIC_DEC(counter, lock)                                              \
+    do {                                                                       \
+        pthread_mutex_lock(&lock);                                             \
+        counter--;                                                             \
+        pthread_mutex_unlock(&lock);                                           \
+    } while (0);
+#endif
 
 /* DATA */
 
 #define SUCCESS 0
 #define LOCK_WAIT_TIMEOUT 3
+#define DEQUE_INITIAL_CAP 64 // slots allocated on a deque's first push
+// adaptive parallel_for grain: sub-ranges created per worker thread
+#define CHUNKS_PER_THREAD 4
+
+#define MS_PER_SEC 1000
+#define NS_PER_MS 1000000
+#define CPU_MASK_BITS 64 // CPUs covered by the affinity mask
 
 // casting for pthread start routine
 typedef void *(*THRD)(void *);
@@ -20,6 +51,85 @@ typedef void *(*THRD)(void *);
 struct task_t {
     ROUTINE action;
     void *arg;
+    threadpool_future_t *future; // NULL unless added with threadpool_submit
+    uint64_t enqueue_ns; // submission timestamp, 0 when stats are off
+};
+
+/**
+ * @brief A deferred or periodic task.
+ *
+ * Timers live in the pool's deadline heap until they expire, at which
+ * point the timer thread hands the routine to the regular work queue.
+ *
+ * @param action routine to submit when the timer fires
+ * @param arg argument for the routine
+ * @param deadline_ms absolute expiry time in milliseconds
+ * @param interval_ms re-arm period, 0 for one-shot timers
+ */
+struct timer_task {
+    ROUTINE action;
+    void *arg;
+    long long deadline_ms;
+    long long interval_ms;
+};
+
+/**
+ * @brief Completion handle for a submitted task.
+ *
+ * The worker that runs the task marks the future ready and stores the
+ * routine's return value; waiters sleep on the condition variable until
+ * then. If the threadpool is destroyed before the task runs, the future
+ * is marked cancelled instead.
+ *
+ * @param lock protects this future
+ * @param cond signalled when the task completes
+ * @param ready true once the task has completed or been cancelled
+ * @param cancelled true if the task was discarded before running
+ * @param result return value of the routine
+ */
+struct threadpool_future_t {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool ready;
+    bool cancelled;
+    int result;
+};
+
+/**
+ * @brief One sub-range of a parallel_for loop.
+ *
+ * @param body routine to run on the sub-range
+ * @param arg shared context passed through to the body
+ * @param start first index of the sub-range
+ * @param end one past the last index of the sub-range
+ */
+struct range_task {
+    RANGE_ROUTINE body;
+    void *arg;
+    size_t start;
+    size_t end;
+};
+
+/**
+ * @brief Per-worker task deque for work-stealing mode.
+ *
+ * The owning worker pushes and pops at the top (newest first, for cache
+ * warmth); idle workers steal the oldest task from the bottom. Each
+ * deque has its own lock, so submissions and steals on different
+ * workers never contend with each other.
+ *
+ * @param tasks circular array of queued tasks
+ * @param cap allocated capacity of the array
+ * @param bottom index of the oldest task, where thieves steal
+ * @param count number of queued tasks
+ * @param lock protects this deque
+ */
+struct task_deque {
+    struct task_t **tasks;
+    size_t cap;
+    size_t bottom;
+    size_t count;
+    pthread_mutex_t lock;
 };
 
 struct thread {
@@ -27,6 +137,7 @@ struct thread {
     pthread_t id;
     threadpool_t *pool;
     struct task_t *task;
+    struct task_deque deque;
     pthread_mutex_t info_lock;
     thread_status status;
     int error;
@@ -41,8 +152,23 @@ struct threadpool_t {
     pthread_rwlock_t running_lock;
     pthread_mutex_t pool_lock;
     queue_c_t *queue;
+    // work-stealing mode: parked workers and drain waiters sleep here
+    pthread_mutex_t steal_lock;
+    pthread_cond_t steal_cond;
+    pthread_cond_t drain_cond;
+    pthread_mutex_t counter_lock;
+#ifndef __STDC_NO_ATOMICS__
+    _Atomic size_t pending_tasks;
+    _Atomic size_t next_deque;
+    _Atomic size_t steal_sleepers;
+#else
+    size_t pending_tasks;
+    size_t next_deque;
+    size_t steal_sleepers;
+#endif
     size_t num_threads;
     size_t max_threads;
+    size_t min_threads;
     bool lock_requested;
     size_t locked_thread;
     pthread_cond_t lock_cond;
@@ -51,7 +177,18 @@ struct threadpool_t {
     int block_on_add;
     int block_on_err;
     int thread_creation;
+    int work_steal;
+    int task_priority;
     time_t default_wait;
+    time_t idle_timeout;
+    int affinity;
+    uint64_t cpu_mask;
+    // deferred/periodic tasks: a deadline heap serviced by one timer thread
+    queue_p_t *timers;
+    pthread_t timer_id;
+    bool timer_running;
+    pthread_mutex_t timer_lock;
+    pthread_cond_t timer_cond;
 };
 
 /* PRIVATE FUNCTIONS */
@@ -68,6 +205,133 @@ static void set_status(struct thread *self, thread_status status) {
     pthread_mutex_unlock(&self->info_lock);
 }
 
+/**
+ * @brief Mark a task's future as completed.
+ *
+ * Stores the routine's return value and wakes any waiters. Does nothing
+ * if the task has no future attached.
+ *
+ * @param task pointer to the completed task
+ * @param result return value of the task's routine
+ */
+static void complete_future(struct task_t *task, int result) {
+    threadpool_future_t *future = task->future;
+    if (future == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&future->lock);
+    future->result = result;
+    future->ready = true;
+    pthread_cond_broadcast(&future->cond);
+    pthread_mutex_unlock(&future->lock);
+}
+
+/**
+ * @brief Free a task that will never run.
+ *
+ * Used when discarding queued tasks during destruction. If the task has
+ * a future attached, the future is marked cancelled so that waiters are
+ * released instead of blocking forever.
+ *
+ * @param arg pointer to the task
+ */
+static void free_task(void *arg) {
+    struct task_t *task = arg;
+    threadpool_future_t *future = task->future;
+    if (future != NULL) {
+        pthread_mutex_lock(&future->lock);
+        future->cancelled = true;
+        future->ready = true;
+        pthread_cond_broadcast(&future->cond);
+        pthread_mutex_unlock(&future->lock);
+    }
+    free(task);
+}
+
+/**
+ * @brief Run one sub-range of a parallel_for loop.
+ *
+ * ROUTINE adapter so that sub-ranges can be queued as ordinary tasks.
+ *
+ * @param arg pointer to the range task
+ * @return int return value of the body routine
+ */
+static int run_range(void *arg) {
+    struct range_task *chunk = arg;
+    return chunk->body(chunk->start, chunk->end, chunk->arg);
+}
+
+/**
+ * @brief Push a task onto the top of a deque.
+ *
+ * @param deque pointer to the deque
+ * @param task task to push
+ * @return int 0 if successful, ENOMEM if the deque cannot grow
+ */
+static int deque_push(struct task_deque *deque, struct task_t *task) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count == deque->cap) {
+        size_t new_cap = deque->cap == 0 ? DEQUE_INITIAL_CAP : deque->cap * 2;
+        struct task_t **new_tasks = malloc(new_cap * sizeof(*new_tasks));
+        if (new_tasks == NULL) {
+            pthread_mutex_unlock(&deque->lock);
+            return ENOMEM;
+        }
+        // unwrap the ring into the new array
+        for (size_t i = 0; i < deque->count; i++) {
+            new_tasks[i] = deque->tasks[(deque->bottom + i) % deque->cap];
+        }
+        free(deque->tasks);
+        deque->tasks = new_tasks;
+        deque->cap = new_cap;
+        deque->bottom = 0;
+    }
+    deque->tasks[(deque->bottom + deque->count) % deque->cap] = task;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+    return SUCCESS;
+}
+
+/**
+ * @brief Pop the newest task off the top of a deque.
+ *
+ * Used by the owning worker; the newest task is the most likely to
+ * still be warm in its cache.
+ *
+ * @param deque pointer to the deque
+ * @return struct task_t* the task, NULL if the deque is empty
+ */
+static struct task_t *deque_pop(struct task_deque *deque) {
+    pthread_mutex_lock(&deque->lock);
+    struct task_t *task = NULL;
+    if (deque->count > 0) {
+        deque->count--;
+        task = deque->tasks[(deque->bottom + deque->count) % deque->cap];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+/**
+ * @brief Steal the oldest task off the bottom of a deque.
+ *
+ * Used by idle workers raiding another worker's deque.
+ *
+ * @param deque pointer to the deque
+ * @return struct task_t* the task, NULL if the deque is empty
+ */
+static struct task_t *deque_steal(struct task_deque *deque) {
+    pthread_mutex_lock(&deque->lock);
+    struct task_t *task = NULL;
+    if (deque->count > 0) {
+        task = deque->tasks[deque->bottom];
+        deque->bottom = (deque->bottom + 1) % deque->cap;
+        deque->count--;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
 /**
  * @brief Deallocate memory for the threadpool object
  *
@@ -81,14 +345,29 @@ static void free_pool(threadpool_t *pool) {
         pthread_cond_destroy(&thread->type_cond);
         pthread_mutex_destroy(&thread->info_lock);
         if (thread->task != NULL) {
-            free(thread->task);
+            free_task(thread->task);
         }
+        struct task_t *task;
+        while ((task = deque_steal(&thread->deque)) != NULL) {
+            free_task(task);
+        }
+        free(thread->deque.tasks);
+        pthread_mutex_destroy(&thread->deque.lock);
     }
     free(pool->threads);
     free(pool->info);
     pthread_rwlock_destroy(&pool->running_lock);
     pthread_mutex_destroy(&pool->pool_lock);
     pthread_cond_destroy(&pool->lock_cond);
+    pthread_mutex_destroy(&pool->steal_lock);
+    pthread_cond_destroy(&pool->steal_cond);
+    pthread_cond_destroy(&pool->drain_cond);
+    pthread_mutex_destroy(&pool->counter_lock);
+    pthread_mutex_destroy(&pool->timer_lock);
+    pthread_cond_destroy(&pool->timer_cond);
+    if (pool->timers != NULL) {
+        queue_p_destroy(&pool->timers);
+    }
     queue_c_destroy(&pool->queue);
     free(pool);
 }
@@ -120,6 +399,11 @@ static threadpool_t *init_thread_info(threadpool_t *pool, int *err) {
         thread->index = i;
         thread->pool = pool;
         thread->task = NULL;
+        thread->deque.tasks = NULL;
+        thread->deque.cap = 0;
+        thread->deque.bottom = 0;
+        thread->deque.count = 0;
+        pthread_mutex_init(&thread->deque.lock, NULL);
         pthread_mutex_init(&thread->info_lock, NULL);
         thread->status = STOPPED;
         thread->error = SUCCESS;
@@ -162,32 +446,65 @@ static threadpool_t *init_pool(threadpool_attr_t *attr, int *err) {
 
     // use a copy of the supplied attributes so that the user can free them
     // after creating the threadpool
+    threadpool_attr_t temp_attr;
     if (attr == NULL) {
         DEBUG_PRINT("\tUsing default attributes\n");
-        threadpool_attr_t temp_attr;
         threadpool_attr_init(&temp_attr);
         attr = &temp_attr;
     }
     size_t q_size;
     threadpool_attr_get_queue_size(attr, &q_size);
     threadpool_attr_get_thread_count(attr, &pool->max_threads);
+    threadpool_attr_get_min_threads(attr, &pool->min_threads);
+    threadpool_attr_get_idle_timeout(attr, &pool->idle_timeout);
+    if (pool->min_threads > pool->max_threads) {
+        DEBUG_PRINT("\tMinimum thread count exceeds maximum\n");
+        free(pool);
+        set_err(err, EINVAL);
+        return NULL;
+    }
     threadpool_attr_get_block_on_add(attr, &pool->block_on_add);
     threadpool_attr_get_block_on_err(attr, &pool->block_on_err);
     threadpool_attr_get_thread_creation(attr, &pool->thread_creation);
     threadpool_attr_get_timed_wait(attr, &pool->timed_wait);
     threadpool_attr_get_timeout(attr, &pool->default_wait);
+    threadpool_attr_get_work_steal(attr, &pool->work_steal);
+    threadpool_attr_get_task_priority(attr, &pool->task_priority);
+    threadpool_attr_get_affinity(attr, &pool->affinity);
+    threadpool_attr_get_affinity_mask(attr, &pool->cpu_mask);
+    // the per-worker deques are plain FIFOs, they cannot order by priority
+    if (pool->work_steal == WORK_STEAL_ENABLED &&
+        pool->task_priority == TASK_PRIORITY_ENABLED) {
+        DEBUG_PRINT("\tWork stealing and task priorities are exclusive\n");
+        free(pool);
+        set_err(err, EINVAL);
+        return NULL;
+    }
 
     // initialize mutexes and condition variables
     pthread_rwlock_init(&pool->running_lock, NULL);
     pthread_mutex_init(&pool->pool_lock, NULL);
     pthread_cond_init(&pool->lock_cond, NULL);
+    pthread_mutex_init(&pool->steal_lock, NULL);
+    pthread_cond_init(&pool->steal_cond, NULL);
+    pthread_cond_init(&pool->drain_cond, NULL);
+    pthread_mutex_init(&pool->counter_lock, NULL);
+    pthread_mutex_init(&pool->timer_lock, NULL);
+    pthread_cond_init(&pool->timer_cond, NULL);
+    pool->timers = NULL;
+    pool->timer_running = false;
+    pool->pending_tasks = 0;
+    pool->next_deque = 0;
+    pool->steal_sleepers = 0;
     pool->lock_requested = false;
     pool->locked_thread = 0;
     pool->num_threads = 0;
     pool->shutdown = NO_SHUTDOWN;
 
     // initialize queue/threads
-    pool->queue = queue_c_init(q_size, free, err);
+    pool->queue = pool->task_priority == TASK_PRIORITY_ENABLED
+                      ? queue_c_init_priority(q_size, free_task, err)
+                      : queue_c_init(q_size, free_task, err);
     if (pool->queue == NULL) {
         DEBUG_PRINT("\tFailed to initialize queue\n");
         pool->max_threads = 0; // prevent attempted freeing of thread details
@@ -214,6 +531,35 @@ static void wait_on_error(struct thread *self) {
     }
 }
 
+/**
+ * @brief Retire a worker that hit the idle timeout.
+ *
+ * The worker is only allowed to exit while the pool stays above its
+ * minimum thread count and is not shutting down; a shutdown joins the
+ * workers, so a retiring thread must not race it. The slot is marked
+ * STOPPED so lazy creation can restart it on demand, and the thread
+ * detaches itself since nobody joins a STOPPED worker.
+ *
+ * @param self pointer to thread
+ * @return bool true if the worker should exit
+ */
+static bool retire_worker(struct thread *self) {
+    threadpool_t *pool = self->pool;
+    pthread_mutex_lock(&self->info_lock);
+    if (pool->num_threads <= pool->min_threads ||
+        pool->shutdown != NO_SHUTDOWN) {
+        pthread_mutex_unlock(&self->info_lock);
+        return false;
+    }
+    pool->num_threads--;
+    self->status = STOPPED;
+    self->type = UNSPECIFIED;
+    pthread_detach(pthread_self());
+    pthread_mutex_unlock(&self->info_lock);
+    DEBUG_PRINT("Retiring idle thread %lX\n", pthread_self());
+    return true;
+}
+
 /**
  * @brief Perform a task for the threadpool.
  *
@@ -227,7 +573,20 @@ static void thread_task(struct thread *self) {
         DEBUG_PRINT("\ton thread %lX: ..Waiting for work\n", pthread_self());
         // wait for work queue to be not empty
         while (queue_c_is_empty(pool->queue) && pool->shutdown == NO_SHUTDOWN) {
-            int err = queue_c_wait_for_not_empty(pool->queue);
+            int err;
+            if (pool->idle_timeout > 0) {
+                err = queue_c_timed_wait_for_not_empty(pool->queue,
+                                                       pool->idle_timeout);
+                if (err == ETIMEDOUT) {
+                    // sustained idleness; the wait released the queue lock
+                    if (retire_worker(self)) {
+                        pthread_exit(NULL);
+                    }
+                    continue; // at the worker floor, keep waiting
+                }
+            } else {
+                err = queue_c_wait_for_not_empty(pool->queue);
+            }
             if (!(err == SUCCESS || err == EAGAIN)) {
                 // EAGAIN returned if queue wait is manually canceled
                 DEBUG_PRINT("\ton thread %lX: Error waiting for work\n",
@@ -267,19 +626,180 @@ static void thread_task(struct thread *self) {
         DEBUG_PRINT("\ton thread %lX: ..Performing work\n", pthread_self());
         // perform work
         pthread_mutex_lock(&self->info_lock);
+        // no-op (EDEADLK) if the wait above already locked the queue
+        queue_c_lock(pool->queue);
         self->task = queue_c_dequeue(pool->queue, NULL);
-        queue_c_unlock(pool->queue);
         if (self->task == NULL) {
             DEBUG_PRINT("\ton thread %lX: Failed to dequeue task\n",
                         pthread_self());
+            queue_c_unlock(pool->queue);
             pthread_mutex_unlock(&self->info_lock);
             continue;
         }
         self->status = RUNNING;
-        pthread_mutex_unlock(&self->info_lock);
         DEBUG_PRINT("\ton thread %lX: Work dequeued\n", pthread_self());
+        // acquire the running lock before releasing the queue so that
+        // threadpool_wait cannot observe an empty queue while this task
+        // has been dequeued but not yet started
+        pthread_rwlock_rdlock(&pool->running_lock);
+        queue_c_unlock(pool->queue);
+        pthread_mutex_unlock(&self->info_lock);
+        uint64_t run_start = 0;
+        if (bb_stats_active()) {
+            run_start = bb_stats_now_ns();
+            if (self->task->enqueue_ns != 0) {
+                bb_stats_add(BB_STAT_THREADPOOL_QUEUE_NS,
+                             run_start - self->task->enqueue_ns);
+            }
+        }
+        int err = self->task->action(self->task->arg);
+        if (run_start != 0) {
+            bb_stats_add(BB_STAT_THREADPOOL_TASK_NS,
+                         bb_stats_now_ns() - run_start);
+        }
+        complete_future(self->task, err);
+        pthread_rwlock_unlock(&pool->running_lock);
+        pthread_mutex_lock(&self->info_lock);
+        self->error = err;
+        wait_on_error(self);
+        free(self->task);
+        self->task = NULL;
+        self->status = IDLE;
+        pthread_mutex_unlock(&self->info_lock);
+        DEBUG_PRINT("\ton thread %lX: Work complete\n", pthread_self());
+    }
+}
+
+/**
+ * @brief Take the next task in work-stealing mode.
+ *
+ * The worker's own deque is tried first; if it is empty, the oldest
+ * task is stolen from another worker's deque, starting with the next
+ * neighbor so thieves spread out instead of all raiding worker 0.
+ *
+ * @param self pointer to thread
+ * @return struct task_t* the task, NULL if no work is available
+ */
+static struct task_t *take_task(struct thread *self) {
+    struct task_t *task = deque_pop(&self->deque);
+    if (task != NULL) {
+        return task;
+    }
+    threadpool_t *pool = self->pool;
+    for (size_t i = 1; i < pool->max_threads; i++) {
+        size_t victim = (self->index + i) % pool->max_threads;
+        task = deque_steal(&pool->threads[victim].deque);
+        if (task != NULL) {
+            DEBUG_PRINT("\ton thread %lX: Stole task from worker %zu\n",
+                        pthread_self(), victim);
+            return task;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Perform tasks from the per-worker deques.
+ *
+ * Work-stealing counterpart of thread_task: tasks come from the
+ * worker's own deque or are stolen from the others, and the worker only
+ * touches the shared steal lock to park when no work is available
+ * anywhere.
+ *
+ * @param self pointer to thread
+ */
+static void steal_task(struct thread *self) {
+    DEBUG_PRINT("Starting stealing worker %lX\n", pthread_self());
+    threadpool_t *pool = self->pool;
+    set_status(self, IDLE);
+    for (;;) {
+        if (pool->shutdown == SHUTDOWN_FORCEFUL) {
+            DEBUG_PRINT("\ton thread %lX: Thread shutting down\n",
+                        pthread_self());
+            set_status(self, DESTROYING);
+            return;
+        }
+
+        struct task_t *task = take_task(self);
+        if (task == NULL) {
+            if (pool->shutdown != NO_SHUTDOWN) {
+                // graceful shutdown and every deque is drained
+                DEBUG_PRINT("\ton thread %lX: Thread shutting down\n",
+                            pthread_self());
+                set_status(self, DESTROYING);
+                return;
+            }
+            // check if thread lock requested
+            pthread_mutex_lock(&pool->pool_lock);
+            if (pool->lock_requested) {
+                pthread_mutex_lock(&self->info_lock);
+                self->status = LOCKED;
+                self->type = UNSPECIFIED;
+                pthread_mutex_unlock(&self->info_lock);
+                pool->lock_requested = false;
+                pool->locked_thread = self->index;
+                pthread_cond_signal(&pool->lock_cond);
+                pthread_mutex_unlock(&pool->pool_lock);
+                return;
+            }
+            pthread_mutex_unlock(&pool->pool_lock);
+
+            DEBUG_PRINT("\ton thread %lX: ..Waiting for work\n",
+                        pthread_self());
+            pthread_mutex_lock(&pool->steal_lock);
+            ATOMIC_INC(pool->steal_sleepers, pool->counter_lock);
+            // recheck under the lock: a task may have arrived since the
+            // deque scan, and its submitter saw no sleepers to wake
+            int err = SUCCESS;
+            if (pool->pending_tasks == 0 && pool->shutdown == NO_SHUTDOWN &&
+                !pool->lock_requested) {
+                if (pool->idle_timeout > 0) {
+                    struct timespec abstime = {time(NULL) + pool->idle_timeout,
+                                               0};
+                    err = pthread_cond_timedwait(&pool->steal_cond,
+                                                 &pool->steal_lock, &abstime);
+                } else {
+                    pthread_cond_wait(&pool->steal_cond, &pool->steal_lock);
+                }
+            }
+            ATOMIC_DEC(pool->steal_sleepers, pool->counter_lock);
+            pthread_mutex_unlock(&pool->steal_lock);
+            if (err == ETIMEDOUT && retire_worker(self)) {
+                pthread_exit(NULL);
+            }
+            continue;
+        }
+
+        DEBUG_PRINT("\ton thread %lX: ..Performing work\n", pthread_self());
+        // perform work
+        pthread_mutex_lock(&self->info_lock);
+        self->task = task;
+        self->status = RUNNING;
+        // acquire the running lock before dropping the pending count so
+        // that threadpool_wait cannot observe zero pending tasks while
+        // this task has been taken but not yet started
         pthread_rwlock_rdlock(&pool->running_lock);
+        pthread_mutex_unlock(&self->info_lock);
+        ATOMIC_DEC(pool->pending_tasks, pool->counter_lock);
+        if (pool->pending_tasks == 0) {
+            pthread_mutex_lock(&pool->steal_lock);
+            pthread_cond_broadcast(&pool->drain_cond);
+            pthread_mutex_unlock(&pool->steal_lock);
+        }
+        uint64_t run_start = 0;
+        if (bb_stats_active()) {
+            run_start = bb_stats_now_ns();
+            if (self->task->enqueue_ns != 0) {
+                bb_stats_add(BB_STAT_THREADPOOL_QUEUE_NS,
+                             run_start - self->task->enqueue_ns);
+            }
+        }
         int err = self->task->action(self->task->arg);
+        if (run_start != 0) {
+            bb_stats_add(BB_STAT_THREADPOOL_TASK_NS,
+                         bb_stats_now_ns() - run_start);
+        }
+        complete_future(self->task, err);
         pthread_rwlock_unlock(&pool->running_lock);
         pthread_mutex_lock(&self->info_lock);
         self->error = err;
@@ -321,6 +841,65 @@ static void dedicated_task(struct thread *self) {
     pthread_mutex_unlock(&self->info_lock);
 }
 
+/**
+ * @brief Pin a worker to one CPU.
+ *
+ * The worker takes the Nth allowed CPU, round-robin over the pool's CPU
+ * mask (or every online CPU when no mask is set), so the workers spread
+ * one per core instead of migrating. Pinning is best effort: an invalid
+ * mask or a kernel refusal leaves the worker unpinned.
+ *
+ * @param self pointer to thread
+ */
+static void apply_affinity(struct thread *self) {
+    threadpool_t *pool = self->pool;
+    if (pool->affinity != AFFINITY_ENABLED) {
+        return;
+    }
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu <= 0) {
+        return;
+    } else if (ncpu > CPU_MASK_BITS) {
+        ncpu = CPU_MASK_BITS;
+    }
+    uint64_t mask = pool->cpu_mask;
+    if (mask == 0) {
+        mask = ncpu == CPU_MASK_BITS ? UINT64_MAX
+                                     : (UINT64_C(1) << ncpu) - 1;
+    }
+    size_t allowed = 0;
+    for (int cpu = 0; cpu < CPU_MASK_BITS; cpu++) {
+        if (mask & UINT64_C(1) << cpu) {
+            allowed++;
+        }
+    }
+    if (allowed == 0) {
+        return;
+    }
+    // pick the worker's slot among the allowed CPUs
+    size_t slot = self->index % allowed;
+    int target = 0;
+    for (int cpu = 0; cpu < CPU_MASK_BITS; cpu++) {
+        if (mask & UINT64_C(1) << cpu) {
+            if (slot == 0) {
+                target = cpu;
+                break;
+            }
+            slot--;
+        }
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(target, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != SUCCESS) {
+        DEBUG_PRINT("\ton thread %lX: Failed to pin to CPU %d\n",
+                    pthread_self(), target);
+        return;
+    }
+    DEBUG_PRINT("\ton thread %lX: Pinned to CPU %d\n", pthread_self(),
+                target);
+}
+
 /**
  * @brief Task coordinator for the thread.
  *
@@ -332,6 +911,7 @@ static void dedicated_task(struct thread *self) {
  */
 static void *task_coordinator(struct thread *self) {
     DEBUG_PRINT("Starting thread %lX\n", pthread_self());
+    apply_affinity(self);
 
     threadpool_t *pool = self->pool;
     for (;;) {
@@ -351,8 +931,12 @@ static void *task_coordinator(struct thread *self) {
         pthread_mutex_unlock(&self->info_lock);
         switch (type) {
         case WORKER:
-            // perform work from queue
-            thread_task(self);
+            // perform work from queue or the per-worker deques
+            if (pool->work_steal == WORK_STEAL_ENABLED) {
+                steal_task(self);
+            } else {
+                thread_task(self);
+            }
             break;
         case DEDICATED:
             // perform dedicated task
@@ -387,6 +971,11 @@ static int lock_idle(threadpool_t *pool, size_t *thread_idx) {
         pool->lock_requested = true;
         // wake all threads, ask 1 to lock
         queue_c_cancel_wait(pool->queue);
+        if (pool->work_steal == WORK_STEAL_ENABLED) {
+            pthread_mutex_lock(&pool->steal_lock);
+            pthread_cond_broadcast(&pool->steal_cond);
+            pthread_mutex_unlock(&pool->steal_lock);
+        }
         struct timespec abstime = {time(NULL) + LOCK_WAIT_TIMEOUT, 0};
         // locked thread will set lock_requested to false
         while (pool->lock_requested == true) {
@@ -467,6 +1056,7 @@ static int start_new_thread(threadpool_t *pool) {
                 DEBUG_PRINT("\tWake thread %zu with id %lX\n", i, thread->id);
                 thread->type = WORKER;
                 pthread_cond_signal(&thread->type_cond);
+                pthread_mutex_unlock(&thread->info_lock);
                 return SUCCESS;
             }
             // keep looking
@@ -504,9 +1094,12 @@ static int start_new_thread(threadpool_t *pool) {
  * @param pool pointer to threadpool_t
  * @param action pointer to function to be performed
  * @param arg pointer to argument for action
+ * @param future completion handle to attach to the task, may be NULL
+ * @param priority task priority, ignored unless the pool orders by priority
  * @return int 0 if successful, otherwise error code
  */
-static int add_task(threadpool_t *pool, ROUTINE action, void *arg) {
+static int add_task(threadpool_t *pool, ROUTINE action, void *arg,
+                    threadpool_future_t *future, double priority) {
     struct task_t *task = malloc(sizeof(*task));
     if (task == NULL) {
         queue_c_unlock(pool->queue);
@@ -516,7 +1109,11 @@ static int add_task(threadpool_t *pool, ROUTINE action, void *arg) {
     }
     task->action = action;
     task->arg = arg;
-    int res = queue_c_enqueue(pool->queue, task);
+    task->future = future;
+    task->enqueue_ns = bb_stats_active() ? bb_stats_now_ns() : 0;
+    int res = pool->task_priority == TASK_PRIORITY_ENABLED
+                  ? queue_c_enqueue_pri(pool->queue, task, priority)
+                  : queue_c_enqueue(pool->queue, task);
     if (res != SUCCESS) {
         queue_c_unlock(pool->queue);
         free(task);
@@ -539,6 +1136,65 @@ static int add_task(threadpool_t *pool, ROUTINE action, void *arg) {
     return SUCCESS;
 }
 
+/**
+ * @brief Add a task to a per-worker deque.
+ *
+ * The target deque is picked round-robin so submissions spread evenly;
+ * a parked worker is only woken when one is actually asleep, keeping
+ * the submission path free of the shared lock.
+ *
+ * @param pool pointer to threadpool_t
+ * @param action pointer to function to be performed
+ * @param arg pointer to argument for action
+ * @param future completion handle to attach to the task, may be NULL
+ * @return int 0 if successful, otherwise error code
+ */
+static int add_task_steal(threadpool_t *pool, ROUTINE action, void *arg,
+                          threadpool_future_t *future) {
+    struct task_t *task = malloc(sizeof(*task));
+    if (task == NULL) {
+        DEBUG_PRINT("\ton thread %lX: Failed to allocate memory for task\n",
+                    pthread_self());
+        return ENOMEM;
+    }
+    task->action = action;
+    task->arg = arg;
+    task->future = future;
+    task->enqueue_ns = bb_stats_active() ? bb_stats_now_ns() : 0;
+#ifndef __STDC_NO_ATOMICS__
+    size_t slot = pool->next_deque++ % pool->max_threads;
+#else
+    pthread_mutex_lock(&pool->counter_lock);
+    size_t slot = pool->next_deque++ % pool->max_threads;
+    pthread_mutex_unlock(&pool->counter_lock);
+#endif
+    int res = deque_push(&pool->threads[slot].deque, task);
+    if (res != SUCCESS) {
+        free(task);
+        DEBUG_PRINT("\ton thread %lX: Failed to push task\n", pthread_self());
+        return res;
+    }
+    ATOMIC_INC(pool->pending_tasks, pool->counter_lock);
+    if (pool->steal_sleepers > 0) {
+        pthread_mutex_lock(&pool->steal_lock);
+        pthread_cond_signal(&pool->steal_cond);
+        pthread_mutex_unlock(&pool->steal_lock);
+    }
+    DEBUG_PRINT("\ton thread %lX: Task added to deque %zu\n", pthread_self(),
+                slot);
+    // lazy creation allows for threads to be created on demand
+    // even if thread creation fails, the task still stays in the deque
+    if (pool->thread_creation == THREAD_CREATE_LAZY) {
+        res = start_new_thread(pool);
+        if (res != SUCCESS) {
+            DEBUG_PRINT("\ton thread %lX: Failed to start new thread '%s'\n",
+                        pthread_self(), strerror(res));
+            return res;
+        }
+    }
+    return SUCCESS;
+}
+
 /**
  * @brief Restart a thread.
  *
@@ -575,6 +1231,99 @@ static int restart_thread(struct thread *thread) {
     return res;
 }
 
+/**
+ * @brief Get the current wall-clock time in milliseconds.
+ *
+ * @return long long milliseconds since the epoch
+ */
+static long long now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (long long)now.tv_sec * MS_PER_SEC + now.tv_nsec / NS_PER_MS;
+}
+
+/**
+ * @brief Compare two timers by identity.
+ *
+ * The deadline heap orders on priority; the comparator is only used to
+ * look up a specific timer, so compare the pointers themselves.
+ *
+ * @param value_to_find pointer to the timer to find
+ * @param node_data pointer to the timer stored in the heap
+ * @return int 0 if equal, non-zero otherwise
+ */
+static int timer_cmp(const void *value_to_find, const void *node_data) {
+    if (value_to_find == node_data) {
+        return 0;
+    }
+    return value_to_find > node_data ? 1 : -1;
+}
+
+/**
+ * @brief Service the pool's deadline heap.
+ *
+ * The timer thread sleeps until the earliest deadline (or until a new
+ * timer is scheduled), then hands the expired routine to the regular
+ * work queue. Periodic timers are re-armed relative to their previous
+ * deadline; intervals missed while the pool was saturated are skipped
+ * rather than run back to back. The thread exits when the pool shuts
+ * down, dropping any timers that have not expired.
+ *
+ * @param pool pointer to threadpool_t
+ * @return void* NULL
+ */
+static void *timer_loop(threadpool_t *pool) {
+    DEBUG_PRINT("Starting timer thread %lX\n", pthread_self());
+    pthread_mutex_lock(&pool->timer_lock);
+    while (pool->shutdown == NO_SHUTDOWN) {
+        queue_p_node_t *next = queue_p_peek(pool->timers);
+        if (next == NULL) {
+            pthread_cond_wait(&pool->timer_cond, &pool->timer_lock);
+            continue;
+        }
+        struct timer_task *timer = next->data;
+        if (timer->deadline_ms > now_ms()) {
+            struct timespec abstime = {
+                .tv_sec = timer->deadline_ms / MS_PER_SEC,
+                .tv_nsec = timer->deadline_ms % MS_PER_SEC * NS_PER_MS};
+            pthread_cond_timedwait(&pool->timer_cond, &pool->timer_lock,
+                                   &abstime);
+            // re-evaluate: an earlier timer may have been scheduled
+            continue;
+        }
+        queue_p_node_t *node = queue_p_dequeue(pool->timers);
+        free(node);
+        pthread_mutex_unlock(&pool->timer_lock);
+        DEBUG_PRINT("\ton thread %lX: Timer expired, submitting work\n",
+                    pthread_self());
+        int res = threadpool_add_work(pool, timer->action, timer->arg);
+        if (res != SUCCESS) {
+            DEBUG_PRINT("\ton thread %lX: Failed to submit timer work: %s\n",
+                        pthread_self(), strerror(res));
+        }
+        pthread_mutex_lock(&pool->timer_lock);
+        if (timer->interval_ms > 0 && pool->shutdown == NO_SHUTDOWN) {
+            timer->deadline_ms += timer->interval_ms;
+            long long now = now_ms();
+            if (timer->deadline_ms <= now) {
+                timer->deadline_ms = now + timer->interval_ms;
+            }
+            res = queue_p_enqueue(pool->timers, timer,
+                                  -(double)timer->deadline_ms);
+            if (res != SUCCESS) {
+                DEBUG_PRINT("\ton thread %lX: Failed to re-arm timer\n",
+                            pthread_self());
+                free(timer);
+            }
+        } else {
+            free(timer);
+        }
+    }
+    pthread_mutex_unlock(&pool->timer_lock);
+    DEBUG_PRINT("Destroying timer thread %lX\n", pthread_self());
+    return NULL;
+}
+
 /* PUBLIC FUNCTIONS */
 
 threadpool_t *threadpool_create(threadpool_attr_t *attr, int *err) {
@@ -589,6 +1338,7 @@ threadpool_t *threadpool_create(threadpool_attr_t *attr, int *err) {
         for (size_t i = 0; i < pool->max_threads; i++) {
             struct thread *thread = &pool->threads[i];
             thread->status = STARTING;
+            thread->type = WORKER;
             int res = pthread_create(&thread->id, NULL, (THRD)task_coordinator,
                                      thread);
             if (res != SUCCESS) {
@@ -612,6 +1362,11 @@ int threadpool_add_work(threadpool_t *pool, ROUTINE action, void *arg) {
         return EINVAL;
     }
 
+    // the deques are unbounded, so the full-queue handling does not apply
+    if (pool->work_steal == WORK_STEAL_ENABLED) {
+        return add_task_steal(pool, action, arg, NULL);
+    }
+
     // timeout ignored if TIMED_WAIT is not set
     if (pool->block_on_add == BLOCK_ON_ADD_ENABLED &&
         pool->timed_wait == TIMED_WAIT_ENABLED) {
@@ -631,7 +1386,7 @@ int threadpool_add_work(threadpool_t *pool, ROUTINE action, void *arg) {
     }
 
     DEBUG_PRINT("\ton thread %lX: Adding task to queue\n", pthread_self());
-    return add_task(pool, action, arg);
+    return add_task(pool, action, arg, NULL, QUEUE_C_DEFAULT_PRI);
 }
 
 int threadpool_timed_add_work(threadpool_t *pool, ROUTINE action, void *arg,
@@ -643,6 +1398,11 @@ int threadpool_timed_add_work(threadpool_t *pool, ROUTINE action, void *arg,
         return EINVAL;
     }
 
+    // the deques are unbounded, so the add never has to block
+    if (pool->work_steal == WORK_STEAL_ENABLED) {
+        return add_task_steal(pool, action, arg, NULL);
+    }
+
     DEBUG_PRINT("\ton thread %lX: ...Blocking on add with timeout\n",
                 pthread_self());
     while (queue_c_is_full(pool->queue)) {
@@ -654,7 +1414,353 @@ int threadpool_timed_add_work(threadpool_t *pool, ROUTINE action, void *arg,
     }
 
     DEBUG_PRINT("\ton thread %lX: Adding task to queue\n", pthread_self());
-    return add_task(pool, action, arg);
+    return add_task(pool, action, arg, NULL, QUEUE_C_DEFAULT_PRI);
+}
+
+int threadpool_add_work_pri(threadpool_t *pool, ROUTINE action, void *arg,
+                            double priority) {
+    DEBUG_PRINT("\ton thread %lX: Adding work to threadpool at priority %f\n",
+                pthread_self(), priority);
+    if (pool == NULL || action == NULL) {
+        DEBUG_PRINT("\ton thread %lX: Invalid arguments\n", pthread_self());
+        return EINVAL;
+    } else if (pool->task_priority != TASK_PRIORITY_ENABLED) {
+        DEBUG_PRINT("\ton thread %lX: Pool does not order by priority\n",
+                    pthread_self());
+        return ENOTSUP;
+    }
+
+    // same full-queue handling as threadpool_add_work
+    if (pool->block_on_add == BLOCK_ON_ADD_ENABLED &&
+        pool->timed_wait == TIMED_WAIT_ENABLED) {
+        DEBUG_PRINT("\ton thread %lX: ...Blocking on add with timeout\n",
+                    pthread_self());
+        while (queue_c_is_full(pool->queue)) {
+            if (queue_c_timed_wait_for_not_full(pool->queue,
+                                                pool->default_wait) ==
+                ETIMEDOUT) {
+                DEBUG_PRINT("\ton thread %lX: Timed out\n", pthread_self());
+                return ETIMEDOUT;
+            }
+        }
+    } else if (pool->block_on_add) {
+        DEBUG_PRINT("\ton thread %lX: ...Blocking on add\n", pthread_self());
+        while (queue_c_is_full(pool->queue)) {
+            queue_c_wait_for_not_full(pool->queue);
+        }
+    } else {
+        queue_c_lock(pool->queue);
+        if (queue_c_is_full(pool->queue)) {
+            queue_c_unlock(pool->queue);
+            DEBUG_PRINT("\ton thread %lX: Queue is full\n", pthread_self());
+            return EOVERFLOW;
+        }
+    }
+
+    DEBUG_PRINT("\ton thread %lX: Adding task to queue\n", pthread_self());
+    return add_task(pool, action, arg, NULL, priority);
+}
+
+int threadpool_schedule(threadpool_t *pool, ROUTINE action, void *arg,
+                        time_t delay_ms, time_t interval_ms) {
+    DEBUG_PRINT("\ton thread %lX: Scheduling work on threadpool\n",
+                pthread_self());
+    if (pool == NULL || action == NULL || delay_ms < 0 || interval_ms < 0) {
+        DEBUG_PRINT("\ton thread %lX: Invalid arguments\n", pthread_self());
+        return EINVAL;
+    }
+    struct timer_task *timer = malloc(sizeof(*timer));
+    if (timer == NULL) {
+        DEBUG_PRINT("\ton thread %lX: Failed to allocate memory for timer\n",
+                    pthread_self());
+        return ENOMEM;
+    }
+    timer->action = action;
+    timer->arg = arg;
+    timer->deadline_ms = now_ms() + delay_ms;
+    timer->interval_ms = interval_ms;
+
+    pthread_mutex_lock(&pool->timer_lock);
+    // the heap and its service thread are only created once a pool
+    // actually schedules timers
+    if (pool->timers == NULL) {
+        int err = SUCCESS;
+        pool->timers = queue_p_init(QUEUE_P_UNLIMITED, free, timer_cmp, &err);
+        if (pool->timers == NULL) {
+            pthread_mutex_unlock(&pool->timer_lock);
+            free(timer);
+            return err;
+        }
+    }
+    if (!pool->timer_running) {
+        int res =
+            pthread_create(&pool->timer_id, NULL, (THRD)timer_loop, pool);
+        if (res != SUCCESS) {
+            DEBUG_PRINT("\ton thread %lX: Failed to start timer thread\n",
+                        pthread_self());
+            pthread_mutex_unlock(&pool->timer_lock);
+            free(timer);
+            return res;
+        }
+        pool->timer_running = true;
+    }
+    int res = queue_p_enqueue(pool->timers, timer,
+                              -(double)timer->deadline_ms);
+    if (res != SUCCESS) {
+        free(timer);
+    } else {
+        // wake the timer thread in case this deadline is now the earliest
+        pthread_cond_signal(&pool->timer_cond);
+    }
+    pthread_mutex_unlock(&pool->timer_lock);
+    return res;
+}
+
+threadpool_future_t *threadpool_submit(threadpool_t *pool, ROUTINE action,
+                                       void *arg, int *err) {
+    DEBUG_PRINT("\ton thread %lX: Submitting work to threadpool\n",
+                pthread_self());
+    if (pool == NULL || action == NULL) {
+        DEBUG_PRINT("\ton thread %lX: Invalid arguments\n", pthread_self());
+        set_err(err, EINVAL);
+        return NULL;
+    }
+
+    threadpool_future_t *future = malloc(sizeof(*future));
+    if (future == NULL) {
+        DEBUG_PRINT("\ton thread %lX: Failed to allocate memory for future\n",
+                    pthread_self());
+        set_err(err, ENOMEM);
+        return NULL;
+    }
+    pthread_mutex_init(&future->lock, NULL);
+    pthread_cond_init(&future->cond, NULL);
+    future->ready = false;
+    future->cancelled = false;
+    future->result = SUCCESS;
+
+    int res;
+    if (pool->work_steal == WORK_STEAL_ENABLED) {
+        // the deques are unbounded, so the full-queue handling does not apply
+        res = add_task_steal(pool, action, arg, future);
+    } else {
+        // same full-queue gating as threadpool_add_work
+        res = SUCCESS;
+        if (pool->block_on_add == BLOCK_ON_ADD_ENABLED &&
+            pool->timed_wait == TIMED_WAIT_ENABLED) {
+            while (res == SUCCESS && queue_c_is_full(pool->queue)) {
+                if (queue_c_timed_wait_for_not_full(
+                        pool->queue, pool->default_wait) == ETIMEDOUT) {
+                    DEBUG_PRINT("\ton thread %lX: Timed out\n", pthread_self());
+                    res = ETIMEDOUT;
+                }
+            }
+        } else if (pool->block_on_add) {
+            while (queue_c_is_full(pool->queue)) {
+                queue_c_wait_for_not_full(pool->queue);
+            }
+        } else {
+            queue_c_lock(pool->queue);
+            if (queue_c_is_full(pool->queue)) {
+                queue_c_unlock(pool->queue);
+                DEBUG_PRINT("\ton thread %lX: Queue is full\n", pthread_self());
+                res = EOVERFLOW;
+            }
+        }
+        if (res == SUCCESS) {
+            res = add_task(pool, action, arg, future, QUEUE_C_DEFAULT_PRI);
+        }
+    }
+
+    // ENOMEM/EOVERFLOW/ETIMEDOUT mean the task was never queued; any
+    // other failure comes from lazy thread creation, which leaves the
+    // task queued with the future attached
+    if (res == ENOMEM || res == EOVERFLOW || res == ETIMEDOUT) {
+        pthread_mutex_destroy(&future->lock);
+        pthread_cond_destroy(&future->cond);
+        free(future);
+        set_err(err, res);
+        DEBUG_PRINT("\ton thread %lX: Failed to submit work\n", pthread_self());
+        return NULL;
+    } else if (res != SUCCESS) {
+        DEBUG_PRINT("\ton thread %lX: Work submitted, but thread creation "
+                    "failed '%s'\n",
+                    pthread_self(), strerror(res));
+    }
+    return future;
+}
+
+int future_wait(threadpool_future_t *future) {
+    if (future == NULL) {
+        DEBUG_PRINT("\ton thread %lX: Invalid arguments\n", pthread_self());
+        return EINVAL;
+    }
+    DEBUG_PRINT("\ton thread %lX: ...Waiting on future\n", pthread_self());
+    pthread_mutex_lock(&future->lock);
+    while (!future->ready) {
+        pthread_cond_wait(&future->cond, &future->lock);
+    }
+    pthread_mutex_unlock(&future->lock);
+    DEBUG_PRINT("\ton thread %lX: Future is ready\n", pthread_self());
+    return SUCCESS;
+}
+
+int future_timed_wait(threadpool_future_t *future, time_t timeout) {
+    if (future == NULL || timeout <= 0) {
+        DEBUG_PRINT("\ton thread %lX: Invalid arguments\n", pthread_self());
+        return EINVAL;
+    }
+    DEBUG_PRINT("\ton thread %lX: ...Waiting on future with timeout\n",
+                pthread_self());
+    struct timespec abstime = {time(NULL) + timeout, 0};
+    pthread_mutex_lock(&future->lock);
+    while (!future->ready) {
+        int res = pthread_cond_timedwait(&future->cond, &future->lock,
+                                         &abstime);
+        if (res == ETIMEDOUT) {
+            pthread_mutex_unlock(&future->lock);
+            DEBUG_PRINT("\ton thread %lX: Timed out\n", pthread_self());
+            return ETIMEDOUT;
+        }
+    }
+    pthread_mutex_unlock(&future->lock);
+    DEBUG_PRINT("\ton thread %lX: Future is ready\n", pthread_self());
+    return SUCCESS;
+}
+
+bool future_ready(threadpool_future_t *future) {
+    if (future == NULL) {
+        return false;
+    }
+    pthread_mutex_lock(&future->lock);
+    bool ready = future->ready;
+    pthread_mutex_unlock(&future->lock);
+    return ready;
+}
+
+int future_get(threadpool_future_t *future, int *result) {
+    if (future == NULL) {
+        DEBUG_PRINT("\ton thread %lX: Invalid arguments\n", pthread_self());
+        return EINVAL;
+    }
+    pthread_mutex_lock(&future->lock);
+    while (!future->ready) {
+        pthread_cond_wait(&future->cond, &future->lock);
+    }
+    int res = SUCCESS;
+    if (future->cancelled) {
+        DEBUG_PRINT("\ton thread %lX: Task was cancelled\n", pthread_self());
+        res = ECANCELED;
+    } else if (result != NULL) {
+        *result = future->result;
+    }
+    pthread_mutex_unlock(&future->lock);
+    return res;
+}
+
+int future_destroy(threadpool_future_t *future) {
+    if (future == NULL) {
+        DEBUG_PRINT("\ton thread %lX: Invalid arguments\n", pthread_self());
+        return EINVAL;
+    }
+    pthread_mutex_lock(&future->lock);
+    if (!future->ready) {
+        // the threadpool still holds a reference to this future
+        pthread_mutex_unlock(&future->lock);
+        DEBUG_PRINT("\ton thread %lX: Future is still pending\n",
+                    pthread_self());
+        return EBUSY;
+    }
+    pthread_mutex_unlock(&future->lock);
+    pthread_mutex_destroy(&future->lock);
+    pthread_cond_destroy(&future->cond);
+    free(future);
+    DEBUG_PRINT("\ton thread %lX: Future destroyed\n", pthread_self());
+    return SUCCESS;
+}
+
+int threadpool_parallel_for(threadpool_t *pool, size_t start, size_t end,
+                            size_t grain, RANGE_ROUTINE body, void *arg) {
+    DEBUG_PRINT("\ton thread %lX: Parallel for over [%zu, %zu)\n",
+                pthread_self(), start, end);
+    if (pool == NULL || body == NULL) {
+        DEBUG_PRINT("\ton thread %lX: Invalid arguments\n", pthread_self());
+        return EINVAL;
+    }
+    if (start >= end) {
+        // empty range, nothing to do
+        return SUCCESS;
+    }
+
+    size_t total = end - start;
+    if (grain == 0) {
+        // adaptive grain: several sub-ranges per worker, so that idle
+        // workers can pick up the slack when iterations are skewed
+        size_t chunks = pool->max_threads * CHUNKS_PER_THREAD;
+        grain = (total + chunks - 1) / chunks;
+    }
+    size_t num_chunks = (total + grain - 1) / grain;
+
+    struct range_task *tasks = malloc(num_chunks * sizeof(*tasks));
+    threadpool_future_t **futures = malloc(num_chunks * sizeof(*futures));
+    if (tasks == NULL || futures == NULL) {
+        free(tasks);
+        free(futures);
+        DEBUG_PRINT("\ton thread %lX: Failed to allocate memory for chunks\n",
+                    pthread_self());
+        return ENOMEM;
+    }
+
+    int err = SUCCESS;
+    size_t submitted = 0;
+    for (size_t i = 0; i < num_chunks; i++) {
+        struct range_task *chunk = &tasks[i];
+        chunk->body = body;
+        chunk->arg = arg;
+        chunk->start = start + i * grain;
+        chunk->end = chunk->start + grain < end ? chunk->start + grain : end;
+        if (i == num_chunks - 1) {
+            // the calling thread works on the last chunk instead of idling
+            break;
+        }
+        int res;
+        threadpool_future_t *future =
+            threadpool_submit(pool, run_range, chunk, &res);
+        if (future == NULL) {
+            // could not queue the chunk; run it inline so the whole
+            // range is still processed
+            DEBUG_PRINT("\ton thread %lX: Running chunk %zu inline '%s'\n",
+                        pthread_self(), i, strerror(res));
+            res = run_range(chunk);
+            if (res != SUCCESS && err == SUCCESS) {
+                err = res;
+            }
+            continue;
+        }
+        futures[submitted++] = future;
+    }
+
+    int res = run_range(&tasks[num_chunks - 1]);
+    if (res != SUCCESS && err == SUCCESS) {
+        err = res;
+    }
+
+    for (size_t i = 0; i < submitted; i++) {
+        int result = SUCCESS;
+        res = future_get(futures[i], &result);
+        if (res != SUCCESS) {
+            // ECANCELED if the pool was destroyed under the loop
+            result = res;
+        }
+        if (result != SUCCESS && err == SUCCESS) {
+            err = result;
+        }
+        future_destroy(futures[i]);
+    }
+    free(futures);
+    free(tasks);
+    DEBUG_PRINT("\ton thread %lX: Parallel for complete\n", pthread_self());
+    return err;
 }
 
 int threadpool_lock_thread(threadpool_t *pool, size_t *thread_idx) {
@@ -727,6 +1833,8 @@ int threadpool_add_dedicated(threadpool_t *pool, ROUTINE action, void *arg,
         }
         thread->task->action = action;
         thread->task->arg = arg;
+        thread->task->future = NULL;
+        thread->task->enqueue_ns = 0;
         thread->type = DEDICATED;
         pthread_cond_signal(&thread->type_cond);
         res = SUCCESS;
@@ -754,8 +1862,9 @@ int threadpool_thread_status(threadpool_t *pool, size_t thread_idx,
     struct thread *thread = &pool->threads[thread_idx];
     pthread_mutex_lock(&thread->info_lock);
     info->index = thread_idx;
-    info->action = thread->task->action;
-    info->arg = thread->task->arg;
+    // an idle or stopped thread has no task to report
+    info->action = thread->task != NULL ? thread->task->action : NULL;
+    info->arg = thread->task != NULL ? thread->task->arg : NULL;
     info->status = thread->status;
     info->type = thread->type;
     info->error = thread->error;
@@ -833,9 +1942,31 @@ int threadpool_wait(threadpool_t *pool) {
     }
 
     DEBUG_PRINT("\ton thread %lX: ...Waiting for threadpool\n", pthread_self());
-    // this loop is skipped if the queue is empty upon first check,
-    // meaning the queue is never locked. bug?
+    if (pool->work_steal == WORK_STEAL_ENABLED) {
+        // a worker read-locks running_lock before decrementing the pending
+        // counter, so once the counter reaches zero the write lock below
+        // cannot be acquired until every claimed task has finished
+        pthread_mutex_lock(&pool->steal_lock);
+        while (pool->pending_tasks > 0) {
+            pthread_cond_wait(&pool->drain_cond, &pool->steal_lock);
+        }
+        pthread_mutex_unlock(&pool->steal_lock);
+
+        // cant acquire the write lock until all readers are done
+        pthread_rwlock_wrlock(&pool->running_lock);
+
+        // all threads are idle
+        pthread_rwlock_unlock(&pool->running_lock);
+        DEBUG_PRINT("\ton thread %lX: All tasks complete\n", pthread_self());
+        return SUCCESS;
+    }
+
+    // hold the queue lock across the empty check so that no worker can
+    // dequeue the last task between the check and the write lock below
+    queue_c_lock(pool->queue);
     while (!queue_c_is_empty(pool->queue)) {
+        queue_c_unlock(pool->queue);
+        // the queue is re-locked when the wait succeeds
         int res = queue_c_wait_for_empty(pool->queue);
         if (res != SUCCESS) {
             DEBUG_PRINT("\ton thread %lX: stop waiting on queue: %s\n",
@@ -864,10 +1995,45 @@ int threadpool_timed_wait(threadpool_t *pool, time_t timeout) {
 
     struct timespec abstime = {time(NULL) + timeout, 0};
 
+    if (pool->work_steal == WORK_STEAL_ENABLED) {
+        // a worker read-locks running_lock before decrementing the pending
+        // counter, so once the counter reaches zero the write lock below
+        // cannot be acquired until every claimed task has finished
+        pthread_mutex_lock(&pool->steal_lock);
+        while (pool->pending_tasks > 0) {
+            int res =
+                pthread_cond_timedwait(&pool->drain_cond, &pool->steal_lock,
+                                       &abstime);
+            if (res == ETIMEDOUT) {
+                pthread_mutex_unlock(&pool->steal_lock);
+                DEBUG_PRINT("\ton thread %lX: Timed out\n", pthread_self());
+                return ETIMEDOUT;
+            }
+        }
+        pthread_mutex_unlock(&pool->steal_lock);
+
+        // cant acquire the write lock until all readers are done
+        int res = pthread_rwlock_timedwrlock(&pool->running_lock, &abstime);
+        if (res == ETIMEDOUT) {
+            DEBUG_PRINT("\ton thread %lX: Timed out\n", pthread_self());
+            return ETIMEDOUT;
+        }
+
+        // all threads are idle
+        pthread_rwlock_unlock(&pool->running_lock);
+        DEBUG_PRINT("\ton thread %lX: All tasks complete\n", pthread_self());
+        return SUCCESS;
+    }
+
     DEBUG_PRINT(
         "\ton thread %lX: ...Waiting for queue to be empty with timeout\n",
         pthread_self());
+    // hold the queue lock across the empty check so that no worker can
+    // dequeue the last task between the check and the write lock below
+    queue_c_lock(pool->queue);
     while (!queue_c_is_empty(pool->queue)) {
+        queue_c_unlock(pool->queue);
+        // the queue is re-locked when the wait succeeds
         int res = queue_c_timed_wait_for_empty(pool->queue, timeout);
         if (res != SUCCESS) {
             DEBUG_PRINT("\ton thread %lX: stop waiting on queue: %s\n",
@@ -961,6 +2127,20 @@ int threadpool_destroy(threadpool_t *pool, int flag) {
     // wake up all threads, then allow them to end on their own
     pool->shutdown = flag;
     queue_c_cancel_wait(pool->queue);
+    if (pool->timer_running) {
+        // stop the timer thread before the workers so no new work arrives
+        pthread_mutex_lock(&pool->timer_lock);
+        pthread_cond_signal(&pool->timer_cond);
+        pthread_mutex_unlock(&pool->timer_lock);
+        pthread_join(pool->timer_id, NULL);
+        pool->timer_running = false;
+    }
+    if (pool->work_steal == WORK_STEAL_ENABLED) {
+        // wake parked stealers so they observe the shutdown flag
+        pthread_mutex_lock(&pool->steal_lock);
+        pthread_cond_broadcast(&pool->steal_cond);
+        pthread_mutex_unlock(&pool->steal_lock);
+    }
     for (size_t i = 0; i < pool->max_threads; i++) {
         struct thread *thread = &pool->threads[i];
         pthread_mutex_lock(&thread->info_lock);
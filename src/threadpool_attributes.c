@@ -13,14 +13,20 @@ enum attr_flags {
     BLOCK_ON_ADD = 1 << 1,    // true = block on add, false = return EAGAIN
     BLOCK_ON_ERR = 1 << 2,    // true = block on error, false = continue running
     THREAD_CREATION = 1 << 3, // true = lazy creation, false = strict creation
+    WORK_STEAL = 1 << 4,      // true = per-worker deques, false = shared queue
+    TASK_PRIORITY = 1 << 5,   // true = priority-ordered queue, false = FIFO
+    AFFINITY = 1 << 6,        // true = pin workers to CPUs, false = migrate
 };
 
 struct inner_threadpool_attr_t {
     int flags;          // bit flags
     size_t max_threads; // maximum number of threads
+    size_t min_threads; // floor for idle scale-down
     size_t max_q_size;  // maximum queue size
     // default wait time for blocking calls when timeout not given (in seconds)
     time_t default_wait;
+    time_t idle_timeout; // seconds a worker may sit idle before exiting
+    uint64_t cpu_mask;   // allowed CPUs for pinned workers, 0 = all
 };
 
 /* PRIVATE FUNCTIONS */
@@ -33,8 +39,11 @@ int threadpool_attr_init(threadpool_attr_t *attr) {
             (struct inner_threadpool_attr_t *)attr;
         inner->flags = DEFAULT_FLAGS;
         inner->max_threads = DEFAULT_THREADS;
+        inner->min_threads = DEFAULT_MIN_THREADS;
         inner->max_q_size = DEFAULT_QUEUE;
         inner->default_wait = DEFAULT_WAIT;
+        inner->idle_timeout = DEFAULT_IDLE_TIMEOUT;
+        inner->cpu_mask = DEFAULT_CPU_MASK;
     }
     DEBUG_PRINT("\tAttributes initialized\n");
     return SUCCESS;
@@ -221,6 +230,80 @@ int threadpool_attr_get_thread_creation(threadpool_attr_t *attr,
     return SUCCESS;
 }
 
+int threadpool_attr_set_work_steal(threadpool_attr_t *attr, int work_steal) {
+    if (attr == NULL) {
+        DEBUG_PRINT("\tInvalid arguments\n");
+        return EINVAL;
+    }
+    struct inner_threadpool_attr_t *inner =
+        ((struct inner_threadpool_attr_t *)attr);
+    switch (work_steal) {
+    case WORK_STEAL_ENABLED:
+        DEBUG_PRINT("Enabling work stealing\n");
+        inner->flags |= WORK_STEAL;
+        return SUCCESS;
+    case WORK_STEAL_DISABLED:
+        DEBUG_PRINT("Disabling work stealing\n");
+        inner->flags &= ~WORK_STEAL;
+        return SUCCESS;
+    default:
+        DEBUG_PRINT("\tInvalid work steal flag\n");
+        return EINVAL;
+    }
+}
+
+int threadpool_attr_get_work_steal(threadpool_attr_t *attr, int *work_steal) {
+    if (attr == NULL || work_steal == NULL) {
+        DEBUG_PRINT("\tInvalid arguments\n");
+        return EINVAL;
+    }
+    struct inner_threadpool_attr_t *inner =
+        ((struct inner_threadpool_attr_t *)attr);
+    *work_steal = check_flag(inner->flags, WORK_STEAL) ? WORK_STEAL_ENABLED
+                                                       : WORK_STEAL_DISABLED;
+    DEBUG_PRINT("Work stealing %s\n", *work_steal ? "enabled" : "disabled");
+    return SUCCESS;
+}
+
+int threadpool_attr_set_task_priority(threadpool_attr_t *attr,
+                                      int task_priority) {
+    if (attr == NULL) {
+        DEBUG_PRINT("\tInvalid arguments\n");
+        return EINVAL;
+    }
+    struct inner_threadpool_attr_t *inner =
+        ((struct inner_threadpool_attr_t *)attr);
+    switch (task_priority) {
+    case TASK_PRIORITY_ENABLED:
+        DEBUG_PRINT("Enabling task priorities\n");
+        inner->flags |= TASK_PRIORITY;
+        return SUCCESS;
+    case TASK_PRIORITY_DISABLED:
+        DEBUG_PRINT("Disabling task priorities\n");
+        inner->flags &= ~TASK_PRIORITY;
+        return SUCCESS;
+    default:
+        DEBUG_PRINT("\tInvalid task priority flag\n");
+        return EINVAL;
+    }
+}
+
+int threadpool_attr_get_task_priority(threadpool_attr_t *attr,
+                                      int *task_priority) {
+    if (attr == NULL || task_priority == NULL) {
+        DEBUG_PRINT("\tInvalid arguments\n");
+        return EINVAL;
+    }
+    struct inner_threadpool_attr_t *inner =
+        ((struct inner_threadpool_attr_t *)attr);
+    *task_priority = check_flag(inner->flags, TASK_PRIORITY)
+                         ? TASK_PRIORITY_ENABLED
+                         : TASK_PRIORITY_DISABLED;
+    DEBUG_PRINT("Task priorities %s\n",
+                *task_priority ? "enabled" : "disabled");
+    return SUCCESS;
+}
+
 int threadpool_attr_set_thread_count(threadpool_attr_t *attr,
                                      size_t num_threads) {
     if (attr == NULL || num_threads == 0 || num_threads > MAX_THREADS) {
@@ -247,6 +330,117 @@ int threadpool_attr_get_thread_count(threadpool_attr_t *attr,
     return SUCCESS;
 }
 
+int threadpool_attr_set_affinity(threadpool_attr_t *attr, int affinity) {
+    if (attr == NULL) {
+        DEBUG_PRINT("\tInvalid arguments\n");
+        return EINVAL;
+    }
+    struct inner_threadpool_attr_t *inner =
+        ((struct inner_threadpool_attr_t *)attr);
+    switch (affinity) {
+    case AFFINITY_ENABLED:
+        DEBUG_PRINT("Enabling CPU affinity\n");
+        inner->flags |= AFFINITY;
+        return SUCCESS;
+    case AFFINITY_DISABLED:
+        DEBUG_PRINT("Disabling CPU affinity\n");
+        inner->flags &= ~AFFINITY;
+        return SUCCESS;
+    default:
+        DEBUG_PRINT("\tInvalid affinity flag\n");
+        return EINVAL;
+    }
+}
+
+int threadpool_attr_get_affinity(threadpool_attr_t *attr, int *affinity) {
+    if (attr == NULL || affinity == NULL) {
+        DEBUG_PRINT("\tInvalid arguments\n");
+        return EINVAL;
+    }
+    struct inner_threadpool_attr_t *inner =
+        ((struct inner_threadpool_attr_t *)attr);
+    *affinity =
+        check_flag(inner->flags, AFFINITY) ? AFFINITY_ENABLED : AFFINITY_DISABLED;
+    DEBUG_PRINT("CPU affinity %s\n", *affinity ? "enabled" : "disabled");
+    return SUCCESS;
+}
+
+int threadpool_attr_set_affinity_mask(threadpool_attr_t *attr,
+                                      uint64_t cpu_mask) {
+    if (attr == NULL) {
+        DEBUG_PRINT("\tInvalid arguments\n");
+        return EINVAL;
+    }
+    struct inner_threadpool_attr_t *inner =
+        ((struct inner_threadpool_attr_t *)attr);
+    inner->cpu_mask = cpu_mask;
+    DEBUG_PRINT("Setting CPU mask to %llx\n", (unsigned long long)cpu_mask);
+    return SUCCESS;
+}
+
+int threadpool_attr_get_affinity_mask(threadpool_attr_t *attr,
+                                      uint64_t *cpu_mask) {
+    if (attr == NULL || cpu_mask == NULL) {
+        DEBUG_PRINT("\tInvalid arguments\n");
+        return EINVAL;
+    }
+    struct inner_threadpool_attr_t *inner =
+        ((struct inner_threadpool_attr_t *)attr);
+    *cpu_mask = inner->cpu_mask;
+    DEBUG_PRINT("CPU mask: %llx\n", (unsigned long long)*cpu_mask);
+    return SUCCESS;
+}
+
+int threadpool_attr_set_min_threads(threadpool_attr_t *attr,
+                                    size_t min_threads) {
+    if (attr == NULL || min_threads > MAX_THREADS) {
+        DEBUG_PRINT("\tInvalid arguments\n");
+        return EINVAL;
+    }
+    struct inner_threadpool_attr_t *inner =
+        ((struct inner_threadpool_attr_t *)attr);
+    inner->min_threads = min_threads;
+    DEBUG_PRINT("Setting minimum thread count to %zu\n", min_threads);
+    return SUCCESS;
+}
+
+int threadpool_attr_get_min_threads(threadpool_attr_t *attr,
+                                    size_t *min_threads) {
+    if (attr == NULL || min_threads == NULL) {
+        DEBUG_PRINT("\tInvalid arguments\n");
+        return EINVAL;
+    }
+    struct inner_threadpool_attr_t *inner =
+        ((struct inner_threadpool_attr_t *)attr);
+    *min_threads = inner->min_threads;
+    DEBUG_PRINT("Minimum thread count: %zu\n", *min_threads);
+    return SUCCESS;
+}
+
+int threadpool_attr_set_idle_timeout(threadpool_attr_t *attr, time_t timeout) {
+    if (attr == NULL || timeout < 0) {
+        DEBUG_PRINT("\tInvalid arguments\n");
+        return EINVAL;
+    }
+    struct inner_threadpool_attr_t *inner =
+        ((struct inner_threadpool_attr_t *)attr);
+    inner->idle_timeout = timeout;
+    DEBUG_PRINT("Setting idle timeout to %ld\n", timeout);
+    return SUCCESS;
+}
+
+int threadpool_attr_get_idle_timeout(threadpool_attr_t *attr, time_t *timeout) {
+    if (attr == NULL || timeout == NULL) {
+        DEBUG_PRINT("\tInvalid arguments\n");
+        return EINVAL;
+    }
+    struct inner_threadpool_attr_t *inner =
+        ((struct inner_threadpool_attr_t *)attr);
+    *timeout = inner->idle_timeout;
+    DEBUG_PRINT("Idle timeout: %ld\n", *timeout);
+    return SUCCESS;
+}
+
 int threadpool_attr_set_queue_size(threadpool_attr_t *attr, size_t queue_size) {
     if (attr == NULL || queue_size == 0) {
         DEBUG_PRINT("\tInvalid arguments\n");
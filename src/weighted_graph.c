@@ -3,18 +3,16 @@
 #include "queue_p.h"
 #include <errno.h>
 #include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* DATA */
 
 #define SUCCESS 0
 #define FAILURE -1
 
-union double_pointer {
-    double dbl;
-    void *ptr;
-};
-
 struct edge {
     struct node *from;
     struct node *to;
@@ -26,32 +24,46 @@ struct node {
     list_t *edges;
     CMP_F cmp;
     FREE_F destroy;
+    const allocator_t *allocator; // the owning graph's allocator
+    size_t index; // position in the CSR snapshot, valid while frozen
+};
+
+/**
+ * @brief compressed sparse row snapshot of the graph topology
+ *
+ * The outgoing edges of node i are targets[offsets[i]] through
+ * targets[offsets[i + 1] - 1], with their weights at the same positions
+ * in weights. All four arrays are contiguous, so traversals walk flat
+ * memory instead of chasing list nodes across the heap.
+ *
+ * @param num_nodes number of nodes captured by the snapshot
+ * @param num_edges number of edges captured by the snapshot
+ * @param node_data data pointer of each node, by index
+ * @param offsets first edge position of each node, num_nodes + 1 entries
+ * @param targets node index each edge points to
+ * @param weights weight of each edge
+ */
+struct csr_snapshot {
+    size_t num_nodes;
+    size_t num_edges;
+    void **node_data;
+    size_t *offsets;
+    size_t *targets;
+    double *weights;
 };
 
 struct weighted_graph_t {
     list_t *nodes;
+    hash_table_t *node_index; // maps node data to its struct node
+    bool ptr_index;           // node_index keyed by pointer identity
     CMP_F cmp;
     FREE_F destroy;
-    queue_p_t *to_process;
-    hash_table_t *previous;
-    hash_table_t *distance_from_origin;
-    struct queue_p_node_t *curr_item;
+    struct csr_snapshot *csr; // non-NULL while the graph is frozen
+    allocator_t allocator;
 };
 
 /* PRIVATE FUNCTIONS */
 
-/**
- * @brief Sets the error code.
- *
- * @param err The error code.
- * @param value The value to set.
- */
-static void set_err(int *err, int value) {
-    if (err != NULL) {
-        *err = value;
-    }
-}
-
 /**
  * @brief Create a new node
  *
@@ -63,7 +75,7 @@ static struct node *node_new(const weighted_graph_t *graph, void *data) {
     if (graph == NULL) {
         return NULL;
     }
-    struct node *new = malloc(sizeof(*new));
+    struct node *new = mem_alloc(&graph->allocator, sizeof(*new));
     if (new == NULL) {
         return NULL;
     }
@@ -71,23 +83,26 @@ static struct node *node_new(const weighted_graph_t *graph, void *data) {
     new->edges = NULL;
     new->cmp = graph->cmp;
     new->destroy = graph->destroy;
+    new->allocator = &graph->allocator;
     return new;
 }
 
 /**
- * @brief Compare two nodes
+ * @brief Compare search data against a stored node
  *
- * @param value_to_find pointer to the node to be found
+ * The node list hands the raw search data through as the first argument
+ * and the stored node as the second.
+ *
+ * @param value_to_find pointer to the data to be found
  * @param node_data pointer to the node to be compared
- * @return int 0 if the nodes are equal, non-zero if the nodes are not equal
+ * @return int 0 if the node holds the data, non-zero otherwise
  */
 static int node_cmp(const void *value_to_find, const void *node_data) {
     if (value_to_find == NULL || node_data == NULL) {
         return 0;
     }
-    const struct node *node_1 = value_to_find;
-    const struct node *node_2 = node_data;
-    return node_1->cmp(node_1->data, node_2->data);
+    const struct node *node = node_data;
+    return node->cmp(value_to_find, node->data);
 }
 
 /**
@@ -104,7 +119,7 @@ static void node_free(void *data) {
     if (node->destroy != NULL) {
         node->destroy(node->data);
     }
-    free(node);
+    mem_free(node->allocator, node);
 }
 
 /**
@@ -116,7 +131,7 @@ static void node_free(void *data) {
  */
 static struct edge *edge_new(struct node *from, struct node *to,
                              double weight) {
-    struct edge *new = malloc(sizeof(*new));
+    struct edge *new = mem_alloc(from->allocator, sizeof(*new));
     if (new == NULL) {
         return NULL;
     }
@@ -126,110 +141,394 @@ static struct edge *edge_new(struct node *from, struct node *to,
     return new;
 }
 
+/**
+ * @brief Free an edge through the owning graph's allocator
+ *
+ * @param data pointer to the edge to be freed
+ */
+static void edge_free(void *data) {
+    if (data == NULL) {
+        return;
+    }
+    struct edge *edge = data;
+    mem_free(edge->from->allocator, edge);
+}
+
 /**
  * @brief Find an edge
  *
  * Specifically used to find which node an edge is connected to. Cannot be used
  * for ordering/sorting.
  *
- * @param value_to_find pointer to the edge to be found
- * @param to_node pointer to the node to be compared
+ * @param value_to_find pointer to the node the edge should point to
+ * @param edge_data pointer to the edge to be compared
  * @return int 0 if edge points to node, non-zero otherwise
  */
-static int edge_cmp(const void *value_to_find, const void *to_node) {
+static int edge_cmp(const void *value_to_find, const void *edge_data) {
     if (value_to_find == NULL) {
         return 0;
     }
-    const struct edge *edge = value_to_find;
-    const struct node *node = to_node;
+    const struct node *node = value_to_find;
+    const struct edge *edge = edge_data;
     // only care about equality, not ordering
-    return edge->to == node;
+    return edge->to != node;
 }
 
-static int add_to_pqueue_if_faster(void **neighbor, void *addl_data) {
-    if (neighbor == NULL || addl_data == NULL) {
-        return EINVAL;
+/**
+ * @brief Hash a node index key by its pointer value
+ *
+ * Used for graphs created without a caller-supplied hash, where the node
+ * data must stay fully opaque: the pointer itself is hashed and the data
+ * is never dereferenced.
+ *
+ * @param key the pointer to hash
+ * @param key_len unused
+ * @return size_t the hash of the pointer value
+ */
+static size_t ptr_hash(const void *key, size_t key_len) {
+    (void)key_len;
+    uintptr_t value = (uintptr_t)key;
+    // spread the low bits pointers share before the table reduces the hash
+    return (size_t)((value >> 4) * 2654435761u);
+}
+
+/**
+ * @brief Compare two node index keys by pointer identity
+ *
+ * @param a the key being searched for
+ * @param b the stored key to compare against
+ * @return int 0 if the pointers are equal, non-zero otherwise
+ */
+static int ptr_cmp(const void *a, const void *b) { return a != b; }
+
+/**
+ * @brief Resolve user data to its node through the hash index
+ *
+ * For pointer-identity indexes a miss is not authoritative: a caller may
+ * resolve through a different pointer whose data compares equal, so the
+ * lookup falls back to the cmp-based scan of the node list.
+ *
+ * @param graph pointer to the graph
+ * @param data pointer to the data to be resolved
+ * @return pointer to the node holding the data, NULL if not in the graph
+ */
+static struct node *find_node(const weighted_graph_t *graph, const void *data) {
+    struct node *node = hash_table_lookup(graph->node_index, data);
+    if (node == NULL && graph->ptr_index) {
+        node = list_find_first(graph->nodes, data, NULL);
+    }
+    return node;
+}
+
+/**
+ * @brief Free a CSR snapshot
+ *
+ * @param allocator pointer to the graph's allocator
+ * @param csr pointer to the snapshot to be freed
+ */
+static void csr_free(const allocator_t *allocator, struct csr_snapshot *csr) {
+    if (csr == NULL) {
+        return;
     }
-    weighted_graph_t *graph = addl_data;
-    double weight =
-        graph_get_edge_weight(graph, graph->curr_item->data, *neighbor, NULL);
-    double distance = weight + graph->curr_item->priority;
+    mem_free(allocator, csr->node_data);
+    mem_free(allocator, csr->offsets);
+    mem_free(allocator, csr->targets);
+    mem_free(allocator, csr->weights);
+    mem_free(allocator, csr);
+}
 
-    union double_pointer current_best = {
-        .ptr = hash_table_lookup(graph->distance_from_origin, *neighbor)};
+/**
+ * @brief shared state of one parallel BFS frontier expansion
+ *
+ * @param csr the snapshot being traversed
+ * @param frontier node indices discovered in the previous round
+ * @param next node indices claimed during this round
+ * @param next_count nodes appended to next, advanced atomically
+ * @param levels hop count per node, -1 while unreached
+ * @param depth hop count of the nodes in the current frontier
+ */
+struct bfs_ctx {
+    const struct csr_snapshot *csr;
+    const size_t *frontier;
+    size_t *next;
+    size_t next_count;
+    ssize_t *levels;
+    ssize_t depth;
+};
 
-    // if the node has not been visited yet, or if the distance is shorter
-    // than the current best, then update the distance and add to the queue
-    if (hash_table_lookup(graph->previous, *neighbor) == NULL ||
-        distance < current_best.dbl) {
-        int err =
-            hash_table_set(graph->previous, graph->curr_item->data, *neighbor);
-        if (err) {
-            return err;
+/**
+ * @brief Expand one chunk of the BFS frontier.
+ *
+ * Chunks race to claim unreached neighbors; the compare-exchange on the
+ * level entry guarantees each node enters the next frontier exactly once.
+ *
+ * @param start first frontier position of the chunk
+ * @param end one past the last frontier position of the chunk
+ * @param arg pointer to the shared bfs_ctx
+ * @return int always 0
+ */
+static int bfs_expand_chunk(size_t start, size_t end, void *arg) {
+    struct bfs_ctx *ctx = arg;
+    const struct csr_snapshot *csr = ctx->csr;
+    for (size_t i = start; i < end; i++) {
+        size_t node = ctx->frontier[i];
+        for (size_t pos = csr->offsets[node]; pos < csr->offsets[node + 1];
+             pos++) {
+            size_t target = csr->targets[pos];
+            ssize_t expected = -1;
+            if (__atomic_compare_exchange_n(&ctx->levels[target], &expected,
+                                            ctx->depth + 1, false,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                size_t slot =
+                    __atomic_fetch_add(&ctx->next_count, 1, __ATOMIC_RELAXED);
+                ctx->next[slot] = target;
+            }
         }
-        struct node *new = node_new(graph, *neighbor);
-        if (new == NULL) {
-            return ENOMEM;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Atomically lower a distance entry.
+ *
+ * The doubles are exchanged through their bit patterns; every stored
+ * value is either INFINITY or a finite sum of weights, so comparing the
+ * reloaded double is always well defined.
+ *
+ * @param slot pointer to the distance entry
+ * @param alt the candidate distance
+ * @return bool true if the entry was lowered to alt
+ */
+static bool relax_dist(double *slot, double alt) {
+    uint64_t *bits = (uint64_t *)slot;
+    uint64_t old_bits = __atomic_load_n(bits, __ATOMIC_RELAXED);
+    while (true) {
+        double old;
+        memcpy(&old, &old_bits, sizeof(old));
+        if (alt >= old) {
+            return false;
         }
-        err = queue_p_enqueue(graph->to_process, new, distance);
-        if (err) {
-            node_free(new);
-            return err;
+        uint64_t new_bits;
+        memcpy(&new_bits, &alt, sizeof(new_bits));
+        // on failure old_bits is reloaded and the comparison re-run
+        if (__atomic_compare_exchange_n(bits, &old_bits, new_bits, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return true;
         }
+    }
+}
 
-        current_best.dbl = distance;
-        err = hash_table_set(graph->distance_from_origin, current_best.ptr,
-                             *neighbor);
-        if (err) {
-            return err;
+/**
+ * @brief shared state of one parallel SSSP relaxation round
+ *
+ * @param csr the snapshot being traversed
+ * @param frontier node indices whose distance improved last round
+ * @param next node indices whose distance improved this round
+ * @param next_count nodes appended to next, advanced atomically
+ * @param dist tentative distance per node, INFINITY while unreached
+ * @param queued non-zero while a node already waits in next
+ */
+struct sssp_ctx {
+    const struct csr_snapshot *csr;
+    const size_t *frontier;
+    size_t *next;
+    size_t next_count;
+    double *dist;
+    unsigned char *queued;
+};
+
+/**
+ * @brief Relax the outgoing edges of one chunk of the SSSP frontier.
+ *
+ * An improved neighbor is appended to the next frontier once per round;
+ * the queued flag deduplicates nodes improved through several edges.
+ *
+ * @param start first frontier position of the chunk
+ * @param end one past the last frontier position of the chunk
+ * @param arg pointer to the shared sssp_ctx
+ * @return int always 0
+ */
+static int sssp_relax_chunk(size_t start, size_t end, void *arg) {
+    struct sssp_ctx *ctx = arg;
+    const struct csr_snapshot *csr = ctx->csr;
+    for (size_t i = start; i < end; i++) {
+        size_t node = ctx->frontier[i];
+        uint64_t du_bits =
+            __atomic_load_n((uint64_t *)&ctx->dist[node], __ATOMIC_RELAXED);
+        double du;
+        memcpy(&du, &du_bits, sizeof(du));
+        for (size_t pos = csr->offsets[node]; pos < csr->offsets[node + 1];
+             pos++) {
+            size_t target = csr->targets[pos];
+            if (relax_dist(&ctx->dist[target], du + csr->weights[pos]) &&
+                __atomic_exchange_n(&ctx->queued[target], 1,
+                                    __ATOMIC_RELAXED) == 0) {
+                size_t slot =
+                    __atomic_fetch_add(&ctx->next_count, 1, __ATOMIC_RELAXED);
+                ctx->next[slot] = target;
+            }
         }
     }
     return SUCCESS;
 }
 
-/* PUBLIC FUNCTIONS */
-
-weighted_graph_t *graph_create(CMP_F cmp, FREE_F free_f, int *err) {
+/**
+ * @brief Shared constructor behind the graph_create variants
+ *
+ * The node index is built from index_cmp and hash_f, which only match
+ * the caller's cmp when the index hashes the data's content; the
+ * pointer-identity index pairs ptr_hash with ptr_cmp instead.
+ *
+ * @param cmp pointer to user defined compare function
+ * @param free_f pointer to a function to free graph data
+ * @param hash_f hash for the node index
+ * @param key_len bytes of the data to hash, or 0 for string data
+ * @param index_cmp compare function for the node index
+ * @param ptr_index true when the index is keyed by pointer identity
+ * @param allocator memory allocator for the graph internals, or NULL
+ * @param err pointer to an integer to store the error code
+ * @return A pointer to a weighted graph.
+ */
+static weighted_graph_t *create_graph(CMP_F cmp, FREE_F free_f, HASH_F hash_f,
+                                      size_t key_len, CMP_F index_cmp,
+                                      bool ptr_index,
+                                      const allocator_t *allocator, int *err) {
     if (cmp == NULL) {
         set_err(err, EINVAL);
         return NULL;
     }
-    weighted_graph_t *graph = malloc(sizeof(*graph));
+    weighted_graph_t *graph = mem_alloc(allocator, sizeof(*graph));
     if (graph == NULL) {
         set_err(err, ENOMEM);
         return NULL;
     }
-    graph->nodes = list_new(node_free, node_cmp, err);
+    graph->allocator = allocator != NULL ? *allocator : (allocator_t){0};
+    graph->nodes = list_new_alloc(node_free, node_cmp, &graph->allocator, err);
     if (graph->nodes == NULL) {
-        free(graph);
-        return NULL;
-    }
-    graph->to_process = queue_p_init(0, NULL, node_cmp, err);
-    if (graph->to_process == NULL) {
-        list_delete(&graph->nodes);
-        free(graph);
-        return NULL;
-    }
-    graph->previous = hash_table_init(0, NULL, cmp, err);
-    if (graph->previous == NULL) {
-        list_delete(&graph->nodes);
-        queue_p_destroy(&graph->to_process);
-        free(graph);
+        mem_free(allocator, graph);
         return NULL;
     }
-    graph->distance_from_origin = hash_table_init(0, NULL, cmp, err);
-    if (graph->distance_from_origin == NULL) {
+    graph->node_index =
+        hash_table_init_alloc(0, NULL, index_cmp, hash_f, key_len,
+                              HASH_TABLE_MODE_CHAINED, &graph->allocator, err);
+    if (graph->node_index == NULL) {
         list_delete(&graph->nodes);
-        queue_p_destroy(&graph->to_process);
-        hash_table_destroy(&graph->previous);
-        free(graph);
+        mem_free(allocator, graph);
         return NULL;
     }
+    graph->ptr_index = ptr_index;
     graph->cmp = cmp;
     graph->destroy = free_f;
+    graph->csr = NULL;
     return graph;
 }
 
+/* PUBLIC FUNCTIONS */
+
+weighted_graph_t *graph_create(CMP_F cmp, FREE_F free_f, int *err) {
+    // the default index never dereferences node data: pointers are hashed
+    // by identity and cmp-equal aliases resolve through the list fallback
+    return create_graph(cmp, free_f, ptr_hash, 0, ptr_cmp, true, NULL, err);
+}
+
+weighted_graph_t *graph_create_hash(CMP_F cmp, FREE_F free_f, HASH_F hash_f,
+                                    size_t key_len, int *err) {
+    return graph_create_alloc(cmp, free_f, hash_f, key_len, NULL, err);
+}
+
+weighted_graph_t *graph_create_alloc(CMP_F cmp, FREE_F free_f, HASH_F hash_f,
+                                     size_t key_len,
+                                     const allocator_t *allocator, int *err) {
+    return create_graph(cmp, free_f, hash_f, key_len, cmp, false, allocator,
+                        err);
+}
+
+int graph_freeze(weighted_graph_t *graph) {
+    if (graph == NULL) {
+        return EINVAL;
+    }
+    if (graph->csr != NULL) {
+        // already frozen
+        return SUCCESS;
+    }
+
+    struct csr_snapshot *csr = mem_alloc(&graph->allocator, sizeof(*csr));
+    if (csr == NULL) {
+        return ENOMEM;
+    }
+    size_t num_nodes = list_size(graph->nodes);
+    csr->num_nodes = num_nodes;
+    csr->node_data =
+        mem_alloc(&graph->allocator, num_nodes * sizeof(*csr->node_data));
+    csr->offsets =
+        mem_alloc(&graph->allocator, (num_nodes + 1) * sizeof(*csr->offsets));
+    if (csr->node_data == NULL || csr->offsets == NULL) {
+        mem_free(&graph->allocator, csr->node_data);
+        mem_free(&graph->allocator, csr->offsets);
+        mem_free(&graph->allocator, csr);
+        return ENOMEM;
+    }
+
+    // first pass: assign indices and count edges
+    size_t num_edges = 0;
+    size_t index = 0;
+    list_iterator_reset(graph->nodes);
+    struct node *curr_node = list_iterator_next(graph->nodes, NULL);
+    while (curr_node) {
+        curr_node->index = index;
+        csr->node_data[index] = curr_node->data;
+        if (curr_node->edges != NULL) {
+            num_edges += list_size(curr_node->edges);
+        }
+        index++;
+        curr_node = list_iterator_next(graph->nodes, NULL);
+    }
+    csr->num_edges = num_edges;
+    csr->targets =
+        mem_alloc(&graph->allocator, num_edges * sizeof(*csr->targets));
+    csr->weights =
+        mem_alloc(&graph->allocator, num_edges * sizeof(*csr->weights));
+    if (csr->targets == NULL || csr->weights == NULL) {
+        csr_free(&graph->allocator, csr);
+        return ENOMEM;
+    }
+
+    // second pass: pack each node's edges into one contiguous row
+    size_t edge_pos = 0;
+    index = 0;
+    list_iterator_reset(graph->nodes);
+    curr_node = list_iterator_next(graph->nodes, NULL);
+    while (curr_node) {
+        csr->offsets[index] = edge_pos;
+        if (curr_node->edges != NULL) {
+            list_iterator_reset(curr_node->edges);
+            struct edge *curr_edge = list_iterator_next(curr_node->edges, NULL);
+            while (curr_edge) {
+                csr->targets[edge_pos] = curr_edge->to->index;
+                csr->weights[edge_pos] = curr_edge->weight;
+                edge_pos++;
+                curr_edge = list_iterator_next(curr_node->edges, NULL);
+            }
+        }
+        index++;
+        curr_node = list_iterator_next(graph->nodes, NULL);
+    }
+    csr->offsets[num_nodes] = edge_pos;
+
+    graph->csr = csr;
+    return SUCCESS;
+}
+
+int graph_unfreeze(weighted_graph_t *graph) {
+    if (graph == NULL) {
+        return EINVAL;
+    }
+    csr_free(&graph->allocator, graph->csr);
+    graph->csr = NULL;
+    return SUCCESS;
+}
+
 ssize_t graph_size(const weighted_graph_t *graph) {
     return graph == NULL ? FAILURE : list_size(graph->nodes);
 }
@@ -238,6 +537,9 @@ int graph_add_node(weighted_graph_t *graph, void *data) {
     if (graph == NULL || data == NULL) {
         return EINVAL;
     }
+    if (graph->csr != NULL) {
+        return EBUSY;
+    }
 
     // If the data already exist in a node, then bail out
     if (graph_contains(graph, data)) {
@@ -248,8 +550,14 @@ int graph_add_node(weighted_graph_t *graph, void *data) {
     if (new == NULL) {
         return ENOMEM;
     }
+    int loc_err = hash_table_set(graph->node_index, new, data);
+    if (loc_err) {
+        mem_free(&graph->allocator, new);
+        return loc_err;
+    }
     if (list_push_tail(graph->nodes, new) == ENOMEM) {
-        free(new);
+        hash_table_remove(graph->node_index, data);
+        mem_free(&graph->allocator, new);
         return ENOMEM;
     } else {
         return SUCCESS;
@@ -261,19 +569,28 @@ void *graph_remove_node(weighted_graph_t *graph, void *data, int *err) {
         set_err(err, EINVAL);
         return NULL;
     }
+    if (graph->csr != NULL) {
+        set_err(err, EBUSY);
+        return NULL;
+    }
 
     struct node *removed = list_remove(graph->nodes, data, NULL);
     if (removed == NULL) {
         set_err(err, ENOENT); // item not found in graph
         return NULL;
     }
+    // remove by the stored pointer: the caller may have resolved the node
+    // through a cmp-equal alias that the index does not know about
+    hash_table_remove(graph->node_index, removed->data);
 
     list_iterator_reset(graph->nodes);
     struct node *curr_node = list_iterator_next(graph->nodes, NULL);
     while (curr_node) {
         // will skip nodes with no edges
-        while (list_remove(curr_node->edges, removed, NULL)) {
+        struct edge *stale;
+        while ((stale = list_remove(curr_node->edges, removed, NULL)) != NULL) {
             // removes all edges that point to the removed node
+            edge_free(stale);
         }
         if (list_size(curr_node->edges) == 0) {
             list_delete(&curr_node->edges);
@@ -282,13 +599,26 @@ void *graph_remove_node(weighted_graph_t *graph, void *data, int *err) {
     }
 
     list_delete(&removed->edges);
-    return removed->data;
+    void *removed_data = removed->data;
+    // the data is handed back, not destroyed with the node
+    mem_free(&graph->allocator, removed);
+    return removed_data;
 }
 
 int graph_iterate_nodes(weighted_graph_t *graph, ACT_F func, void *obj) {
     if (graph == NULL || func == NULL) {
         return EINVAL;
     }
+    if (graph->csr != NULL) {
+        struct csr_snapshot *csr = graph->csr;
+        for (size_t i = 0; i < csr->num_nodes; i++) {
+            int err = func(&csr->node_data[i], obj);
+            if (err) {
+                return err;
+            }
+        }
+        return SUCCESS;
+    }
 
     list_iterator_reset(graph->nodes);
     struct node *curr = list_iterator_next(graph->nodes, NULL);
@@ -308,11 +638,24 @@ int graph_iterate_neighbors(weighted_graph_t *graph, void *center, ACT_F func,
         return EINVAL;
     }
 
-    struct node *curr_node = list_find_first(graph->nodes, center, NULL);
+    struct node *curr_node = find_node(graph, center);
     if (curr_node == NULL) {
         return ENOENT;
     }
 
+    if (graph->csr != NULL) {
+        // walk the node's packed row instead of its edge list
+        struct csr_snapshot *csr = graph->csr;
+        for (size_t pos = csr->offsets[curr_node->index];
+             pos < csr->offsets[curr_node->index + 1]; pos++) {
+            int err = func(&csr->node_data[csr->targets[pos]], obj);
+            if (err) {
+                return err;
+            }
+        }
+        return SUCCESS;
+    }
+
     if (curr_node->edges == NULL) {
         return SUCCESS;
     }
@@ -328,82 +671,289 @@ int graph_iterate_neighbors(weighted_graph_t *graph, void *center, ACT_F func,
     return SUCCESS;
 }
 
-list_t *graph_find_path(weighted_graph_t *graph, const void *start,
-                        const void *end, int *err) {
+list_t *graph_find_path_cost(weighted_graph_t *graph, const void *start,
+                             const void *end, double *cost, int *err) {
     if (graph == NULL || start == NULL || end == NULL) {
         set_err(err, EINVAL);
         return NULL;
     }
-
-    // Nothing in Dijkstra's changes these items or neighbors; casting is safe
-    struct node *new = node_new(graph, (void *)start);
-    if (new == NULL) {
-        set_err(err, ENOMEM);
+    struct node *start_node = find_node(graph, start);
+    struct node *end_node = find_node(graph, end);
+    if (start_node == NULL || end_node == NULL) {
+        set_err(err, ENOENT);
         return NULL;
     }
-    int loc_err = queue_p_enqueue(graph->to_process, new, 0);
-    if (loc_err) {
-        node_free(new);
-        set_err(err, loc_err);
-        return NULL;
+
+    size_t num_nodes = list_size(graph->nodes);
+    struct node **by_index = NULL;
+    if (graph->csr == NULL) {
+        // the mutable form has no stable indices; assign them for this run
+        by_index = malloc(num_nodes * sizeof(*by_index));
+        if (by_index == NULL) {
+            set_err(err, ENOMEM);
+            return NULL;
+        }
+        size_t index = 0;
+        list_iterator_reset(graph->nodes);
+        struct node *curr_node = list_iterator_next(graph->nodes, NULL);
+        while (curr_node) {
+            curr_node->index = index;
+            by_index[index] = curr_node;
+            index++;
+            curr_node = list_iterator_next(graph->nodes, NULL);
+        }
+    }
+
+    int loc_err = SUCCESS;
+    double *dist = malloc(num_nodes * sizeof(*dist));
+    size_t *prev = malloc(num_nodes * sizeof(*prev));
+    bool *settled = calloc(num_nodes, sizeof(*settled));
+    queue_p_t *frontier = queue_p_init(0, NULL, graph->cmp, &loc_err);
+    list_t *results = NULL;
+    if (dist == NULL || prev == NULL || settled == NULL || frontier == NULL) {
+        loc_err = loc_err != SUCCESS ? loc_err : ENOMEM;
+        goto cleanup;
+    }
+    for (size_t i = 0; i < num_nodes; i++) {
+        dist[i] = INFINITY;
+        prev[i] = SIZE_MAX;
     }
-    loc_err = hash_table_set(graph->previous, NULL, start);
+    dist[start_node->index] = 0.0;
+    // the heap prefers high priorities, so distances are enqueued negated
+    // to pop the closest frontier node first
+    loc_err = queue_p_enqueue(frontier, (void *)(uintptr_t)start_node->index,
+                              0.0);
     if (loc_err) {
-        queue_p_clear(graph->to_process);
-        node_free(new);
-        set_err(err, loc_err);
-        return NULL;
+        goto cleanup;
     }
 
-    while (!queue_p_is_empty(graph->to_process)) {
-        graph->curr_item = queue_p_dequeue(graph->to_process);
-        if (graph->cmp(graph->curr_item->data, end) == 0) {
-            break;
+    while (!queue_p_is_empty(frontier)) {
+        queue_p_node_t *item = queue_p_dequeue(frontier);
+        size_t curr = (uintptr_t)item->data;
+        free(item);
+        if (settled[curr]) {
+            continue; // stale entry for an already settled node
+        }
+        settled[curr] = true;
+        if (curr == end_node->index) {
+            break; // the destination is settled: its distance is final
         }
 
-        loc_err = graph_iterate_neighbors(
-            (weighted_graph_t *)graph, graph->curr_item->data,
-            add_to_pqueue_if_faster, (weighted_graph_t *)graph);
-        node_free(graph->curr_item->data);
-        free(graph->curr_item);
-        if (loc_err) {
-            queue_p_clear(graph->to_process);
-            hash_table_clear(graph->previous);
-            hash_table_clear(graph->distance_from_origin);
-            set_err(err, loc_err);
-            return NULL;
+        if (graph->csr != NULL) {
+            struct csr_snapshot *csr = graph->csr;
+            for (size_t pos = csr->offsets[curr];
+                 pos < csr->offsets[curr + 1]; pos++) {
+                size_t target = csr->targets[pos];
+                double alt = dist[curr] + csr->weights[pos];
+                if (alt < dist[target]) {
+                    dist[target] = alt;
+                    prev[target] = curr;
+                    loc_err = queue_p_enqueue(
+                        frontier, (void *)(uintptr_t)target, -alt);
+                    if (loc_err) {
+                        goto cleanup;
+                    }
+                }
+            }
+        } else if (by_index[curr]->edges != NULL) {
+            list_iterator_reset(by_index[curr]->edges);
+            struct edge *curr_edge =
+                list_iterator_next(by_index[curr]->edges, NULL);
+            while (curr_edge) {
+                size_t target = curr_edge->to->index;
+                double alt = dist[curr] + curr_edge->weight;
+                if (alt < dist[target]) {
+                    dist[target] = alt;
+                    prev[target] = curr;
+                    loc_err = queue_p_enqueue(
+                        frontier, (void *)(uintptr_t)target, -alt);
+                    if (loc_err) {
+                        goto cleanup;
+                    }
+                }
+                curr_edge = list_iterator_next(by_index[curr]->edges, NULL);
+            }
         }
     }
-    queue_p_clear(graph->to_process);
-    hash_table_clear(graph->distance_from_origin);
 
-    list_t *results = list_new(NULL, graph->cmp, err);
+    results = list_new_alloc(NULL, graph->cmp, &graph->allocator, &loc_err);
     if (results == NULL) {
-        hash_table_clear(graph->previous);
+        goto cleanup;
+    }
+    if (settled[end_node->index]) {
+        size_t curr = end_node->index;
+        while (curr != SIZE_MAX) {
+            void *data = graph->csr != NULL ? graph->csr->node_data[curr]
+                                            : by_index[curr]->data;
+            loc_err = list_push_head(results, data);
+            if (loc_err) {
+                list_delete(&results);
+                goto cleanup;
+            }
+            curr = prev[curr];
+        }
+    }
+    // an unreachable destination yields an empty path at infinite cost
+    if (cost != NULL) {
+        *cost = dist[end_node->index];
+    }
+
+cleanup:
+    free(by_index);
+    free(dist);
+    free(prev);
+    free(settled);
+    queue_p_destroy(&frontier);
+    if (loc_err != SUCCESS) {
+        set_err(err, loc_err);
         return NULL;
     }
-    void *curr = (void *)end;
-    while (curr) {
-        loc_err = list_push_head(results, curr);
-        if (loc_err) {
-            hash_table_clear(graph->previous);
-            list_delete(&results);
-            set_err(err, loc_err);
-            return NULL;
+    return results;
+}
+
+list_t *graph_find_path(weighted_graph_t *graph, const void *start,
+                        const void *end, int *err) {
+    return graph_find_path_cost(graph, start, end, NULL, err);
+}
+
+int graph_bfs_parallel(weighted_graph_t *graph, const void *start,
+                       threadpool_t *pool, BFS_F visit, void *obj) {
+    if (graph == NULL || start == NULL || pool == NULL || visit == NULL) {
+        return EINVAL;
+    }
+    if (graph->csr == NULL) {
+        // frontier expansion runs on the packed rows of the snapshot
+        return ENOTSUP;
+    }
+    struct node *start_node = find_node(graph, start);
+    if (start_node == NULL) {
+        return ENOENT;
+    }
+
+    struct csr_snapshot *csr = graph->csr;
+    size_t num_nodes = csr->num_nodes;
+    ssize_t *levels = malloc(num_nodes * sizeof(*levels));
+    size_t *frontier = malloc(num_nodes * sizeof(*frontier));
+    size_t *next = malloc(num_nodes * sizeof(*next));
+    if (levels == NULL || frontier == NULL || next == NULL) {
+        free(levels);
+        free(frontier);
+        free(next);
+        return ENOMEM;
+    }
+    for (size_t i = 0; i < num_nodes; i++) {
+        levels[i] = -1;
+    }
+    levels[start_node->index] = 0;
+    frontier[0] = start_node->index;
+    size_t frontier_count = 1;
+
+    int loc_err = SUCCESS;
+    struct bfs_ctx ctx = {.csr = csr, .levels = levels, .depth = 0};
+    while (frontier_count > 0) {
+        ctx.frontier = frontier;
+        ctx.next = next;
+        ctx.next_count = 0;
+        loc_err = threadpool_parallel_for(pool, 0, frontier_count, 0,
+                                          bfs_expand_chunk, &ctx);
+        if (loc_err != SUCCESS) {
+            break;
         }
+        // the claimed nodes become the frontier of the next round
+        size_t *swap = frontier;
+        frontier = next;
+        next = swap;
+        frontier_count = ctx.next_count;
+        ctx.depth++;
+    }
 
-        curr = hash_table_lookup(graph->previous, curr);
+    if (loc_err == SUCCESS) {
+        for (size_t i = 0; i < num_nodes && loc_err == SUCCESS; i++) {
+            if (levels[i] >= 0) {
+                loc_err = visit(csr->node_data[i], (size_t)levels[i], obj);
+            }
+        }
     }
+    free(levels);
+    free(frontier);
+    free(next);
+    return loc_err;
+}
 
-    hash_table_clear(graph->previous);
-    return results;
+int graph_sssp_parallel(weighted_graph_t *graph, const void *start,
+                        threadpool_t *pool, SSSP_F visit, void *obj) {
+    if (graph == NULL || start == NULL || pool == NULL || visit == NULL) {
+        return EINVAL;
+    }
+    if (graph->csr == NULL) {
+        // edge relaxation runs on the packed rows of the snapshot
+        return ENOTSUP;
+    }
+    struct node *start_node = find_node(graph, start);
+    if (start_node == NULL) {
+        return ENOENT;
+    }
+
+    struct csr_snapshot *csr = graph->csr;
+    size_t num_nodes = csr->num_nodes;
+    double *dist = malloc(num_nodes * sizeof(*dist));
+    size_t *frontier = malloc(num_nodes * sizeof(*frontier));
+    size_t *next = malloc(num_nodes * sizeof(*next));
+    unsigned char *queued = calloc(num_nodes, sizeof(*queued));
+    if (dist == NULL || frontier == NULL || next == NULL || queued == NULL) {
+        free(dist);
+        free(frontier);
+        free(next);
+        free(queued);
+        return ENOMEM;
+    }
+    for (size_t i = 0; i < num_nodes; i++) {
+        dist[i] = INFINITY;
+    }
+    dist[start_node->index] = 0.0;
+    frontier[0] = start_node->index;
+    size_t frontier_count = 1;
+
+    int loc_err = SUCCESS;
+    struct sssp_ctx ctx = {.csr = csr, .dist = dist, .queued = queued};
+    while (frontier_count > 0) {
+        // nodes leaving the frontier may be re-queued if improved again
+        for (size_t i = 0; i < frontier_count; i++) {
+            queued[frontier[i]] = 0;
+        }
+        ctx.frontier = frontier;
+        ctx.next = next;
+        ctx.next_count = 0;
+        loc_err = threadpool_parallel_for(pool, 0, frontier_count, 0,
+                                          sssp_relax_chunk, &ctx);
+        if (loc_err != SUCCESS) {
+            break;
+        }
+        size_t *swap = frontier;
+        frontier = next;
+        next = swap;
+        frontier_count = ctx.next_count;
+    }
+
+    if (loc_err == SUCCESS) {
+        for (size_t i = 0; i < num_nodes && loc_err == SUCCESS; i++) {
+            if (dist[i] < INFINITY) {
+                loc_err = visit(csr->node_data[i], dist[i], obj);
+            }
+        }
+    }
+    free(dist);
+    free(frontier);
+    free(next);
+    free(queued);
+    return loc_err;
 }
 
 int graph_contains(const weighted_graph_t *graph, const void *data) {
     if (graph == NULL || data == NULL) {
         return FAILURE;
     }
-    return list_find_first(graph->nodes, data, NULL) == NULL;
+    return find_node(graph, data) != NULL;
 }
 
 int graph_add_edge(weighted_graph_t *graph, void *src, void *dst,
@@ -412,11 +962,15 @@ int graph_add_edge(weighted_graph_t *graph, void *src, void *dst,
         return EINVAL;
     }
 
-    struct node *from = list_find_first(graph->nodes, src, NULL);
+    if (graph->csr != NULL) {
+        return EBUSY;
+    }
+
+    struct node *from = find_node(graph, src);
     if (from == NULL) {
         return ENOENT;
     }
-    struct node *to = list_find_first(graph->nodes, dst, NULL);
+    struct node *to = find_node(graph, dst);
     if (to == NULL) {
         return ENOENT;
     }
@@ -424,7 +978,8 @@ int graph_add_edge(weighted_graph_t *graph, void *src, void *dst,
     // check if the edge already exists, if so, update the weight
     if (from->edges == NULL) {
         int err;
-        from->edges = list_new(free, edge_cmp, &err);
+        from->edges = list_new_alloc(edge_free, edge_cmp, from->allocator,
+                                     &err);
         if (from->edges == NULL) {
             return err;
         }
@@ -451,17 +1006,30 @@ double graph_get_edge_weight(const weighted_graph_t *graph, const void *src,
         return NAN;
     }
 
-    struct node *from = list_find_first(graph->nodes, src, NULL);
+    struct node *from = find_node(graph, src);
     if (from == NULL) {
         set_err(err, ENOENT);
         return NAN;
     }
-    struct node *to = list_find_first(graph->nodes, dst, NULL);
+    struct node *to = find_node(graph, dst);
     if (to == NULL) {
         set_err(err, ENOENT);
         return NAN;
     }
 
+    if (graph->csr != NULL) {
+        // scan the source node's packed row
+        struct csr_snapshot *csr = graph->csr;
+        for (size_t pos = csr->offsets[from->index];
+             pos < csr->offsets[from->index + 1]; pos++) {
+            if (csr->targets[pos] == to->index) {
+                return csr->weights[pos];
+            }
+        }
+        set_err(err, ENOENT);
+        return NAN;
+    }
+
     struct edge *checker = list_find_first(from->edges, to, NULL);
     if (checker == NULL) {
         set_err(err, ENOENT);
@@ -475,19 +1043,22 @@ int graph_remove_edge(weighted_graph_t *graph, const void *src,
     if (graph == NULL || src == NULL || dst == NULL) {
         return EINVAL;
     }
+    if (graph->csr != NULL) {
+        return EBUSY;
+    }
 
-    struct node *from = list_find_first(graph->nodes, src, NULL);
+    struct node *from = find_node(graph, src);
     if (from == NULL) {
         return ENOENT;
     }
-    struct node *to = list_find_first(graph->nodes, dst, NULL);
+    struct node *to = find_node(graph, dst);
     if (to == NULL) {
         return ENOENT;
     }
 
     struct edge *checker = list_remove(from->edges, to, NULL);
     if (checker) {
-        free(checker);
+        edge_free(checker);
         return SUCCESS;
     }
     return ENOENT;
@@ -500,11 +1071,15 @@ ssize_t graph_out_degree_size(const weighted_graph_t *graph, const void *src,
         return FAILURE;
     }
 
-    struct node *from = list_find_first(graph->nodes, src, NULL);
+    struct node *from = find_node(graph, src);
     if (from == NULL) {
         set_err(err, ENOENT);
         return FAILURE;
     }
+    if (graph->csr != NULL) {
+        return graph->csr->offsets[from->index + 1] -
+               graph->csr->offsets[from->index];
+    }
     // node might not have any edges yet
     return from->edges == NULL ? 0 : list_size(from->edges);
 }
@@ -516,13 +1091,23 @@ ssize_t graph_in_degree_size(const weighted_graph_t *graph, const void *dst,
         return FAILURE;
     }
 
-    struct node *to = list_find_first(graph->nodes, dst, NULL);
+    struct node *to = find_node(graph, dst);
     if (dst == NULL) {
         set_err(err, ENOENT);
         return FAILURE;
     }
 
     size_t count = 0;
+    if (graph->csr != NULL) {
+        // one linear pass over the packed edge array
+        struct csr_snapshot *csr = graph->csr;
+        for (size_t pos = 0; pos < csr->num_edges; pos++) {
+            if (csr->targets[pos] == to->index) {
+                ++count;
+            }
+        }
+        return count;
+    }
     list_iterator_reset(graph->nodes);
     struct node *curr_node = list_iterator_next(graph->nodes, NULL);
     while (curr_node) {
@@ -553,9 +1138,10 @@ int graph_destroy(weighted_graph_t *graph) {
     }
 
     list_delete(&graph->nodes);
-    queue_p_destroy(&graph->to_process);
-    hash_table_destroy(&graph->previous);
-    hash_table_destroy(&graph->distance_from_origin);
-    free(graph);
+    hash_table_destroy(&graph->node_index);
+    // copied out because the allocator lives inside the block being freed
+    allocator_t allocator = graph->allocator;
+    csr_free(&allocator, graph->csr);
+    mem_free(&allocator, graph);
     return SUCCESS;
 }
@@ -116,6 +116,39 @@ void test_arr_list_get() {
     CU_ASSERT_EQUAL(data[position], *node);
 }
 
+void test_arr_list_extend() {
+    // Should catch if called on an invalid list
+    CU_ASSERT_EQUAL(arr_list_extend((arr_list_t *)INVALID_LIST, data, SIZE),
+                    EINVAL);
+
+    // Extend an empty list with the whole batch in one call
+    arr_list_t *batch =
+        arr_list_new(NULL, test_compare_node, 1, sizeof(*data), NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(batch);
+    CU_ASSERT_EQUAL(arr_list_extend(batch, data, SIZE), SUCCESS);
+    ssize_t res = INVALID;
+    arr_list_query(batch, QUERY_SIZE, &res);
+    CU_ASSERT_EQUAL(res, SIZE);
+    for (size_t i = 0; i < SIZE; i++) {
+        CU_ASSERT_EQUAL(*(int *)arr_list_get(batch, i), data[i]);
+    }
+
+    // Splice moves everything over and empties the source
+    arr_list_t *other =
+        arr_list_new(NULL, test_compare_node, 1, sizeof(*data), NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(other);
+    CU_ASSERT_EQUAL(arr_list_splice(other, batch), SUCCESS);
+    arr_list_query(other, QUERY_SIZE, &res);
+    CU_ASSERT_EQUAL(res, SIZE);
+    arr_list_query(batch, QUERY_IS_EMPTY, &res);
+    CU_ASSERT_TRUE(res);
+    for (size_t i = 0; i < SIZE; i++) {
+        CU_ASSERT_EQUAL(*(int *)arr_list_get(other, i), data[i]);
+    }
+    CU_ASSERT_EQUAL(arr_list_delete(batch), SUCCESS);
+    CU_ASSERT_EQUAL(arr_list_delete(other), SUCCESS);
+}
+
 void test_arr_list_sort() {
     // Should catch if sort is called on an invalid list
     CU_ASSERT_NOT_EQUAL(arr_list_sort((arr_list_t *)INVALID_LIST), SUCCESS);
@@ -132,6 +165,69 @@ void test_arr_list_sort() {
     }
 }
 
+int test_compare_reversed(const void *value_to_find, const void *node_data) {
+    return test_compare_node(node_data, value_to_find);
+}
+
+void test_arr_list_sort_with() {
+    // Should catch if sort is called on an invalid list
+    CU_ASSERT_NOT_EQUAL(
+        arr_list_sort_with((arr_list_t *)INVALID_LIST, NULL, 4), SUCCESS);
+
+    CU_ASSERT_PTR_NOT_NULL_FATAL(list);
+    // Ensure function exited successfully
+    CU_ASSERT_EQUAL(arr_list_sort_with(list, test_compare_reversed, 4),
+                    SUCCESS);
+    // Verify list should now be sorted in descending order
+    int prev = (*int_arr)[0];
+    ssize_t res = INVALID;
+    arr_list_query(list, QUERY_SIZE, &res);
+    for (size_t i = 1; i < (size_t)res; i++) {
+        CU_ASSERT_TRUE_FATAL(prev >= (*int_arr)[i]);
+        prev = (*int_arr)[i];
+    }
+    // Restore the list order for the tests that follow
+    CU_ASSERT_EQUAL(arr_list_sort(list), SUCCESS);
+}
+
+void test_arr_list_sorted_mode() {
+    // Should catch if called on an invalid list
+    ssize_t idx = INVALID;
+    CU_ASSERT_EQUAL(arr_list_bsearch((arr_list_t *)INVALID_LIST, data, &idx),
+                    EINVAL);
+    CU_ASSERT_EQUAL(arr_list_insert_sorted((arr_list_t *)INVALID_LIST, data),
+                    EINVAL);
+
+    CU_ASSERT_PTR_NOT_NULL_FATAL(list);
+    // list was sorted by the previous test, so bsearch is available
+    int value = 5;
+    CU_ASSERT_EQUAL(arr_list_bsearch(list, &value, &idx), SUCCESS);
+    CU_ASSERT_EQUAL(idx, 5);
+    // inserting in order keeps the list sorted
+    CU_ASSERT_EQUAL(arr_list_insert_sorted(list, &value), SUCCESS);
+    ssize_t res = INVALID;
+    arr_list_query(list, QUERY_SIZE, &res);
+    int prev = (*int_arr)[0];
+    for (size_t i = 1; i < (size_t)res; i++) {
+        CU_ASSERT_TRUE_FATAL(prev <= (*int_arr)[i]);
+        prev = (*int_arr)[i];
+    }
+    // missing values report a negative index
+    value = 99;
+    CU_ASSERT_EQUAL(arr_list_bsearch(list, &value, &idx), SUCCESS);
+    CU_ASSERT_EQUAL(idx, INVALID);
+    // a positional insert breaks the sorted invariant
+    value = 42;
+    CU_ASSERT_EQUAL(arr_list_insert(list, &value, 0), SUCCESS);
+    CU_ASSERT_EQUAL(arr_list_bsearch(list, &value, &idx), ENOTSUP);
+    CU_ASSERT_EQUAL(arr_list_insert_sorted(list, &value), ENOTSUP);
+    // restore the list for the tests that follow
+    CU_ASSERT_EQUAL(arr_list_pop(list, 0, NULL), SUCCESS);
+    value = 5;
+    CU_ASSERT_EQUAL(arr_list_remove(list, &value), SUCCESS);
+    CU_ASSERT_EQUAL(arr_list_sort(list), SUCCESS);
+}
+
 void test_arr_list_iterator() {
     // Should catch if function is called on an invalid list
     CU_ASSERT_EQUAL(arr_list_iterator_reset((arr_list_t *)INVALID_LIST),
@@ -184,6 +280,36 @@ void test_arr_list_remove() {
     CU_ASSERT_EQUAL_FATAL(res, cur_size - 1);
 }
 
+void test_arr_list_swap_remove() {
+    // Should catch if called on an invalid list
+    CU_ASSERT_EQUAL(arr_list_swap_remove((arr_list_t *)INVALID_LIST, 0, NULL),
+                    EINVAL);
+
+    CU_ASSERT_PTR_NOT_NULL_FATAL(list);
+    ssize_t res = INVALID;
+    arr_list_query(list, QUERY_SIZE, &res);
+    size_t cur_size = res;
+    int head = (*int_arr)[0];
+    int last = (*int_arr)[cur_size - 1];
+    int old = INVALID;
+    // Removing the head swaps the last element into its place
+    CU_ASSERT_EQUAL(arr_list_swap_remove(list, 0, &old), SUCCESS);
+    CU_ASSERT_EQUAL(old, head);
+    CU_ASSERT_EQUAL((*int_arr)[0], last);
+    arr_list_query(list, QUERY_SIZE, &res);
+    CU_ASSERT_EQUAL(res, cur_size - 1);
+    // Removing out of range is rejected
+    CU_ASSERT_EQUAL(arr_list_swap_remove(list, cur_size - 1, NULL), EINVAL);
+    // Put the removed value back for the tests that follow
+    CU_ASSERT_EQUAL(arr_list_insert(list, &old, 0), SUCCESS);
+    // The swap moved the former tail to the front; send it back so the
+    // fixture keeps its original order
+    int moved = INVALID;
+    CU_ASSERT_EQUAL(arr_list_pop(list, 1, &moved), SUCCESS);
+    CU_ASSERT_EQUAL(moved, last);
+    CU_ASSERT_EQUAL(arr_list_insert(list, &moved, cur_size - 1), SUCCESS);
+}
+
 void test_arr_list_index_of() {
     CU_ASSERT_PTR_NOT_NULL_FATAL(list);
     ssize_t res = INVALID;
@@ -292,12 +418,21 @@ int main(void) {
 
         {"Testing arr_list_get():", test_arr_list_get},
 
+        {"Testing arr_list_extend()/splice():", test_arr_list_extend},
+
         {"Testing arr_list_sort():", test_arr_list_sort},
 
+        {"Testing arr_list_sort_with():", test_arr_list_sort_with},
+
+        {"Testing arr_list_bsearch()/insert_sorted():",
+         test_arr_list_sorted_mode},
+
         {"Testing arr_list_iterator():", test_arr_list_iterator},
 
         {"Testing arr_list_remove():", test_arr_list_remove},
 
+        {"Testing arr_list_swap_remove():", test_arr_list_swap_remove},
+
         {"Testing arr_list_index_of():", test_arr_list_index_of},
 
         {"Testing arr_list_set():", test_arr_list_set},
@@ -0,0 +1,140 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <buildingblocks.h>
+#include <errno.h>
+#include <hash_table_concurrent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SUCCESS 0
+#define INVALID_TABLE NULL
+#define NUM_THREADS 4
+#define KEYS_PER_THREAD 64
+
+hash_table_c_t *table = NULL;
+int data[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+char keys[NUM_THREADS][KEYS_PER_THREAD][16];
+
+int init_suite1(void) { return 0; }
+
+int clean_suite1(void) { return 0; }
+
+/**
+ * @brief Test free, does nothing
+ *
+ * @param mem_addr Not used
+ */
+void custom_free(void *mem_addr) { (void)mem_addr; }
+
+/**
+ * @brief Worker that inserts and immediately verifies its own keys.
+ *
+ * @param arg index of the thread, cast to a pointer
+ */
+void *writer_thread(void *arg) {
+    size_t id = (size_t)arg;
+    for (int i = 0; i < KEYS_PER_THREAD; i++) {
+        snprintf(keys[id][i], sizeof(keys[id][i]), "t%zu-key%d", id, i);
+        if (hash_table_c_set(table, &data[i % 10], keys[id][i]) != SUCCESS) {
+            return (void *)1;
+        }
+        if (hash_table_c_lookup(table, keys[id][i]) != &data[i % 10]) {
+            return (void *)1;
+        }
+    }
+    return NULL;
+}
+
+void test_hash_table_c_init() {
+    int err = SUCCESS;
+    CU_ASSERT_PTR_NULL(hash_table_c_init(0, 0, NULL, NULL, &err));
+    CU_ASSERT_EQUAL(err, EINVAL);
+
+    table = hash_table_c_init(0, 0, custom_free, (CMP_F)strcmp, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(table);
+}
+
+void test_hash_table_c_threads() {
+    pthread_t threads[NUM_THREADS];
+    for (size_t n = 0; n < NUM_THREADS; n++) {
+        CU_ASSERT_EQUAL_FATAL(
+            pthread_create(&threads[n], NULL, writer_thread, (void *)n),
+            SUCCESS);
+    }
+    for (size_t n = 0; n < NUM_THREADS; n++) {
+        void *result = NULL;
+        pthread_join(threads[n], &result);
+        CU_ASSERT_PTR_NULL(result);
+    }
+
+    // every thread's keys must be visible afterwards
+    for (size_t n = 0; n < NUM_THREADS; n++) {
+        for (int i = 0; i < KEYS_PER_THREAD; i++) {
+            CU_ASSERT_PTR_EQUAL(hash_table_c_lookup(table, keys[n][i]),
+                                &data[i % 10]);
+        }
+    }
+    ssize_t size = 0;
+    CU_ASSERT_EQUAL(hash_table_c_query(table, QUERY_SIZE, &size), SUCCESS);
+    CU_ASSERT_EQUAL(size, NUM_THREADS * KEYS_PER_THREAD);
+}
+
+void test_hash_table_c_remove() {
+    CU_ASSERT_PTR_NULL(hash_table_c_remove(INVALID_TABLE, "t0-key0"));
+    CU_ASSERT_PTR_EQUAL(hash_table_c_remove(table, "t0-key0"), &data[0]);
+    CU_ASSERT_PTR_NULL(hash_table_c_lookup(table, "t0-key0"));
+    CU_ASSERT_PTR_NULL(hash_table_c_remove(table, "t0-key0"));
+}
+
+void test_hash_table_c_clear() {
+    CU_ASSERT_EQUAL(hash_table_c_clear(INVALID_TABLE), EINVAL);
+    CU_ASSERT_EQUAL(hash_table_c_clear(table), SUCCESS);
+    ssize_t is_empty = 0;
+    CU_ASSERT_EQUAL(hash_table_c_query(table, QUERY_IS_EMPTY, &is_empty),
+                    SUCCESS);
+    CU_ASSERT_TRUE(is_empty);
+}
+
+void test_hash_table_c_destroy() {
+    CU_ASSERT_EQUAL(hash_table_c_destroy(INVALID_TABLE), EINVAL);
+    CU_ASSERT_EQUAL(hash_table_c_destroy(&table), SUCCESS);
+    CU_ASSERT_EQUAL(hash_table_c_destroy(&table), EINVAL);
+}
+
+int main(void) {
+    CU_TestInfo suite1_tests[] = {
+        {"Testing hash_table_c_init():", test_hash_table_c_init},
+
+        {"Testing threaded set/lookup:", test_hash_table_c_threads},
+
+        {"Testing hash_table_c_remove():", test_hash_table_c_remove},
+
+        {"Testing hash_table_c_clear():", test_hash_table_c_clear},
+
+        {"Testing hash_table_c_destroy():", test_hash_table_c_destroy},
+
+        CU_TEST_INFO_NULL};
+
+    CU_SuiteInfo suites[] = {
+        {"Suite-1:", init_suite1, clean_suite1, .pTests = suite1_tests},
+        CU_SUITE_INFO_NULL};
+
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    if (0 != CU_register_suites(suites)) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_basic_show_failures(CU_get_failure_list());
+    int num_failed = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    puts("\n");
+    return num_failed;
+}
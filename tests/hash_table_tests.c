@@ -1,5 +1,7 @@
 #include <CUnit/Basic.h>
 #include <CUnit/CUnit.h>
+#include <buildingblocks.h>
+#include <errno.h>
 #include <hash_table.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,6 +11,7 @@
 #define INVALID_TABLE NULL
 
 hash_table_t *hash_table = NULL;
+hash_table_t *open_table = NULL;
 int data[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
 
 int init_suite1(void) { return 0; }
@@ -92,6 +95,185 @@ void test_hash_table_destroy() {
     CU_ASSERT_EQUAL(hash_table_destroy(&hash_table), EINVAL);
 }
 
+void test_hash_table_init_mode() {
+    int err = SUCCESS;
+    CU_ASSERT_PTR_NULL(
+        hash_table_init_mode(0, custom_free, (CMP_F)strcmp, -1, &err));
+    CU_ASSERT_EQUAL(err, ENOTSUP);
+
+    open_table = hash_table_init_mode(4, custom_free, (CMP_F)strcmp,
+                                      HASH_TABLE_MODE_OPEN, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(open_table);
+}
+
+void test_open_table_set_lookup() {
+    // small initial capacity forces a probe-array resize
+    CU_ASSERT_EQUAL(hash_table_set(open_table, &data[0], "Item one"), SUCCESS);
+    CU_ASSERT_EQUAL(hash_table_set(open_table, &data[1], "Item two"), SUCCESS);
+    CU_ASSERT_EQUAL(hash_table_set(open_table, &data[2], "Item three"),
+                    SUCCESS);
+    CU_ASSERT_EQUAL(hash_table_set(open_table, &data[3], "Item four"), SUCCESS);
+    CU_ASSERT_EQUAL(hash_table_set(open_table, &data[4], "Item five"), SUCCESS);
+    CU_ASSERT_EQUAL(hash_table_set(open_table, &data[5], "Item six"), SUCCESS);
+
+    CU_ASSERT_PTR_EQUAL(hash_table_lookup(open_table, "Item one"), &data[0]);
+    CU_ASSERT_PTR_EQUAL(hash_table_lookup(open_table, "Item six"), &data[5]);
+    CU_ASSERT_PTR_NULL(hash_table_lookup(open_table, "Item seven"));
+
+    // updating an existing key must not grow the table
+    CU_ASSERT_EQUAL(hash_table_set(open_table, &data[6], "Item one"), SUCCESS);
+    CU_ASSERT_PTR_EQUAL(hash_table_lookup(open_table, "Item one"), &data[6]);
+    ssize_t size = 0;
+    CU_ASSERT_EQUAL(hash_table_query(open_table, QUERY_SIZE, &size), SUCCESS);
+    CU_ASSERT_EQUAL(size, 6);
+}
+
+void test_open_table_remove() {
+    // removal leaves a tombstone; later keys must still be reachable
+    CU_ASSERT_PTR_EQUAL(hash_table_remove(open_table, "Item two"), &data[1]);
+    CU_ASSERT_PTR_NULL(hash_table_lookup(open_table, "Item two"));
+    CU_ASSERT_PTR_NULL(hash_table_remove(open_table, "Item two"));
+    CU_ASSERT_PTR_EQUAL(hash_table_lookup(open_table, "Item three"), &data[2]);
+
+    // a removed key can be re-inserted
+    CU_ASSERT_EQUAL(hash_table_set(open_table, &data[1], "Item two"), SUCCESS);
+    CU_ASSERT_PTR_EQUAL(hash_table_lookup(open_table, "Item two"), &data[1]);
+
+    CU_ASSERT_EQUAL(hash_table_clear(open_table), SUCCESS);
+    CU_ASSERT_PTR_NULL(hash_table_lookup(open_table, "Item one"));
+    CU_ASSERT_EQUAL(hash_table_destroy(&open_table), SUCCESS);
+}
+
+void test_hash_table_freeze() {
+    uint8_t *buf = NULL;
+    size_t buf_size = 0;
+    CU_ASSERT_EQUAL(hash_table_freeze(INVALID_TABLE, 0, &buf, &buf_size),
+                    EINVAL);
+
+    hash_table_t *table = hash_table_init(4, custom_free, (CMP_F)strcmp, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(table);
+    static char keys[20][8];
+    static int vals[20];
+    for (int i = 0; i < 20; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "key%d", i);
+        vals[i] = i * 7;
+        CU_ASSERT_EQUAL(hash_table_set(table, &vals[i], keys[i]), SUCCESS);
+    }
+
+    // self-contained snapshot with copied values survives the table
+    CU_ASSERT_EQUAL(hash_table_freeze(table, sizeof(int), &buf, &buf_size),
+                    SUCCESS);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(buf);
+    CU_ASSERT_EQUAL(hash_table_destroy(&table), SUCCESS);
+    for (int i = 0; i < 20; i++) {
+        int *found =
+            hash_table_frozen_lookup(buf, keys[i], (CMP_F)strcmp, NULL);
+        CU_ASSERT_PTR_NOT_NULL_FATAL(found);
+        CU_ASSERT_EQUAL(*found, i * 7);
+    }
+    CU_ASSERT_PTR_NULL(
+        hash_table_frozen_lookup(buf, "missing", (CMP_F)strcmp, NULL));
+    free(buf);
+}
+
+void test_hash_table_bulk() {
+    CU_ASSERT_EQUAL(hash_table_reserve(INVALID_TABLE, 10), EINVAL);
+    CU_ASSERT_EQUAL(hash_table_set_bulk(INVALID_TABLE, NULL, 0), EINVAL);
+
+    hash_table_t *table = hash_table_init(2, custom_free, (CMP_F)strcmp, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(table);
+
+    static char keys[48][8];
+    static hash_table_kv_t pairs[48];
+    for (int i = 0; i < 48; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "key%d", i);
+        pairs[i].key = keys[i];
+        pairs[i].data = &data[i % 10];
+    }
+    CU_ASSERT_EQUAL(hash_table_set_bulk(table, pairs, 48), SUCCESS);
+    for (int i = 0; i < 48; i++) {
+        CU_ASSERT_PTR_EQUAL(hash_table_lookup(table, keys[i]), &data[i % 10]);
+    }
+    ssize_t size = 0;
+    CU_ASSERT_EQUAL(hash_table_query(table, QUERY_SIZE, &size), SUCCESS);
+    CU_ASSERT_EQUAL(size, 48);
+
+    // re-loading the same keys only updates, never duplicates
+    CU_ASSERT_EQUAL(hash_table_set_bulk(table, pairs, 48), SUCCESS);
+    CU_ASSERT_EQUAL(hash_table_query(table, QUERY_SIZE, &size), SUCCESS);
+    CU_ASSERT_EQUAL(size, 48);
+    CU_ASSERT_EQUAL(hash_table_destroy(&table), SUCCESS);
+}
+
+/**
+ * @brief Hash for fixed-length numeric keys, used by the custom hash test
+ *
+ * @param key the key to hash
+ * @param key_len Not used
+ */
+size_t id_hash(const void *key, size_t key_len) {
+    (void)key_len;
+    return *(const unsigned int *)key;
+}
+
+/**
+ * @brief Compare for fixed-length numeric keys
+ *
+ * @param to_find key being searched for
+ * @param node_key key stored in the table
+ */
+int id_cmp(const void *to_find, const void *node_key) {
+    return memcmp(to_find, node_key, sizeof(unsigned int));
+}
+
+void test_hash_table_custom_hash() {
+    // numeric keys with an explicit length: no NUL terminator involved
+    hash_table_t *table = hash_table_init_hash(
+        8, custom_free, id_cmp, id_hash, sizeof(unsigned int),
+        HASH_TABLE_MODE_OPEN, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(table);
+
+    static unsigned int ids[32];
+    for (unsigned int i = 0; i < 32; i++) {
+        // clustered IDs would degenerate under the byte-wise default hash
+        ids[i] = 1000000 + i;
+        CU_ASSERT_EQUAL(hash_table_set(table, &data[i % 10], &ids[i]),
+                        SUCCESS);
+    }
+    for (unsigned int i = 0; i < 32; i++) {
+        CU_ASSERT_PTR_EQUAL(hash_table_lookup(table, &ids[i]), &data[i % 10]);
+    }
+    unsigned int missing = 999;
+    CU_ASSERT_PTR_NULL(hash_table_lookup(table, &missing));
+    CU_ASSERT_PTR_EQUAL(hash_table_remove(table, &ids[4]), &data[4]);
+    CU_ASSERT_PTR_NULL(hash_table_lookup(table, &ids[4]));
+    CU_ASSERT_EQUAL(hash_table_destroy(&table), SUCCESS);
+}
+
+void test_hash_table_incremental_growth() {
+    // drive a small chained table through several growths; every key must
+    // stay reachable while old buckets are still being migrated
+    hash_table_t *table = hash_table_init(2, custom_free, (CMP_F)strcmp, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(table);
+
+    static char keys[64][8];
+    for (int i = 0; i < 64; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "key%d", i);
+        CU_ASSERT_EQUAL(hash_table_set(table, &data[i % 10], keys[i]), SUCCESS);
+        CU_ASSERT_PTR_EQUAL(hash_table_lookup(table, keys[0]), &data[0]);
+    }
+    for (int i = 0; i < 64; i++) {
+        CU_ASSERT_PTR_EQUAL(hash_table_lookup(table, keys[i]), &data[i % 10]);
+    }
+    ssize_t size = 0;
+    CU_ASSERT_EQUAL(hash_table_query(table, QUERY_SIZE, &size), SUCCESS);
+    CU_ASSERT_EQUAL(size, 64);
+
+    CU_ASSERT_PTR_EQUAL(hash_table_remove(table, keys[63]), &data[3]);
+    CU_ASSERT_PTR_NULL(hash_table_lookup(table, keys[63]));
+    CU_ASSERT_EQUAL(hash_table_destroy(&table), SUCCESS);
+}
+
 int main(void) {
     CU_TestInfo suite1_tests[] = {
         {"Testing hash_table_init():", test_hash_table_init},
@@ -108,8 +290,26 @@ int main(void) {
 
         CU_TEST_INFO_NULL};
 
+    CU_TestInfo suite2_tests[] = {
+        {"Testing hash_table_init_mode():", test_hash_table_init_mode},
+
+        {"Testing open table set/lookup:", test_open_table_set_lookup},
+
+        {"Testing open table remove:", test_open_table_remove},
+
+        {"Testing incremental growth:", test_hash_table_incremental_growth},
+
+        {"Testing custom hash/key length:", test_hash_table_custom_hash},
+
+        {"Testing reserve/bulk load:", test_hash_table_bulk},
+
+        {"Testing freeze/frozen lookup:", test_hash_table_freeze},
+
+        CU_TEST_INFO_NULL};
+
     CU_SuiteInfo suites[] = {
         {"Suite-1:", init_suite1, clean_suite1, .pTests = suite1_tests},
+        {"Suite-2:", init_suite1, clean_suite1, .pTests = suite2_tests},
         CU_SUITE_INFO_NULL};
 
     if (CUE_SUCCESS != CU_initialize_registry()) {
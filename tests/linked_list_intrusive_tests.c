@@ -0,0 +1,254 @@
+#include "linked_list_intrusive.h"
+#include "buildingblocks.h"
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SUCCESS 0
+#define INVALID_LIST NULL
+
+// An item with the list link embedded in the middle of the struct
+struct item_t {
+    int value;
+    ilist_link_t link;
+    int extra;
+};
+
+struct item_t items[] = {
+    {1, {NULL}, 0}, {2, {NULL}, 0}, {3, {NULL}, 0},
+    {4, {NULL}, 0}, {5, {NULL}, 0},
+};
+
+#define SIZE sizeof(items) / sizeof(*items)
+
+// The lists to be used by all the tests
+ilist_t *list = NULL;
+ilist_t *no_cmp = NULL;
+
+int test_compare_item(const void *value_to_find, const void *item) {
+    int value_to_find_int = *(int *)value_to_find;
+    int item_int = ((struct item_t *)item)->value;
+    if (item_int > value_to_find_int) {
+        return -1;
+    } else if (item_int < value_to_find_int) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * @brief Sum up the values of all items visited.
+ *
+ * @param item The item being visited
+ * @param addl_data Pointer to the running total
+ * @return int 0 if the function exited successfully
+ */
+int sum_values(void *item, void *addl_data) {
+    *(int *)addl_data += ((struct item_t *)item)->value;
+    return SUCCESS;
+}
+
+int init_suite1(void) { return 0; }
+
+int clean_suite1(void) { return 0; }
+
+void test_ilist_new() {
+    // Verify lists were created correctly
+    no_cmp = ilist_new(offsetof(struct item_t, link), NULL, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(no_cmp); // Function exited correctly
+    list = ilist_new(offsetof(struct item_t, link), test_compare_item, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(list);     // Function exited correctly
+    CU_ASSERT_EQUAL(ilist_size(no_cmp), 0); // list size is correct
+    CU_ASSERT_EQUAL(ilist_size(list), 0);   // list size is correct
+}
+
+void test_ilist_push() {
+    // Should catch if called on an invalid list
+    CU_ASSERT_EQUAL(ilist_push_head(INVALID_LIST, &items[0]), EINVAL);
+    CU_ASSERT_EQUAL(ilist_push_tail(list, NULL), EINVAL);
+
+    // No allocation happens: the items themselves carry the links
+    CU_ASSERT_EQUAL(ilist_push_head(list, &items[1]), SUCCESS);
+    CU_ASSERT_EQUAL(ilist_push_head(list, &items[0]), SUCCESS);
+    for (size_t i = 2; i < SIZE; i++) {
+        CU_ASSERT_EQUAL(ilist_push_tail(list, &items[i]), SUCCESS);
+    }
+    CU_ASSERT_EQUAL(ilist_size(list), SIZE);
+    CU_ASSERT_FALSE(ilist_is_empty(list));
+}
+
+void test_ilist_query() {
+    ssize_t result;
+    // Should catch if called with invalid arguments
+    CU_ASSERT_EQUAL(ilist_query(INVALID_LIST, QUERY_SIZE, &result), EINVAL);
+    CU_ASSERT_EQUAL(ilist_query(list, QUERY_SIZE, NULL), EINVAL);
+    CU_ASSERT_EQUAL(ilist_query(list, -1, &result), ENOTSUP);
+
+    CU_ASSERT_EQUAL(ilist_query(list, QUERY_SIZE, &result), SUCCESS);
+    CU_ASSERT_EQUAL(result, SIZE);
+    CU_ASSERT_EQUAL(ilist_query(list, QUERY_IS_EMPTY, &result), SUCCESS);
+    CU_ASSERT_FALSE(result);
+}
+
+void test_ilist_peek() {
+    // Should catch if called on an invalid list
+    CU_ASSERT_PTR_NULL(ilist_peek_head(INVALID_LIST));
+    CU_ASSERT_PTR_NULL(ilist_peek_tail(no_cmp)); // empty list
+
+    CU_ASSERT_PTR_EQUAL(ilist_peek_head(list), &items[0]);
+    CU_ASSERT_PTR_EQUAL(ilist_peek_tail(list), &items[SIZE - 1]);
+    // Peeking does not remove the item
+    CU_ASSERT_EQUAL(ilist_size(list), SIZE);
+}
+
+void test_ilist_iterate() {
+    // Should catch if called on an invalid list
+    CU_ASSERT_EQUAL(ilist_iterator_reset(INVALID_LIST), EINVAL);
+    int err = SUCCESS;
+    CU_ASSERT_PTR_NULL(ilist_iterator_next(INVALID_LIST, &err));
+    CU_ASSERT_EQUAL(err, EINVAL);
+
+    CU_ASSERT_EQUAL(ilist_iterator_reset(list), SUCCESS);
+    for (size_t i = 0; i < SIZE; i++) {
+        CU_ASSERT_PTR_EQUAL(ilist_iterator_next(list, NULL), &items[i]);
+    }
+    // Iterator reports when it hits the end of the list
+    err = SUCCESS;
+    CU_ASSERT_PTR_NULL(ilist_iterator_next(list, &err));
+    CU_ASSERT_EQUAL(err, ENOTSUP);
+
+    // Sum every item with foreach_call
+    int total = 0;
+    CU_ASSERT_EQUAL(ilist_foreach_call(list, sum_values, &total), SUCCESS);
+    CU_ASSERT_EQUAL(total, 15);
+}
+
+void test_ilist_unlink() {
+    int err = SUCCESS;
+    // Should catch if called with invalid arguments
+    CU_ASSERT_PTR_NULL(ilist_unlink(INVALID_LIST, &items[0], &err));
+    CU_ASSERT_EQUAL(err, EINVAL);
+
+    // An item not in the list is simply not found
+    struct item_t outsider = {99, {NULL}, 0};
+    CU_ASSERT_PTR_NULL(ilist_unlink(list, &outsider, NULL));
+
+    // Unlink from the middle, the head, and the tail
+    CU_ASSERT_PTR_EQUAL(ilist_unlink(list, &items[2], NULL), &items[2]);
+    CU_ASSERT_PTR_EQUAL(ilist_unlink(list, &items[0], NULL), &items[0]);
+    CU_ASSERT_PTR_EQUAL(ilist_unlink(list, &items[SIZE - 1], NULL),
+                        &items[SIZE - 1]);
+    CU_ASSERT_EQUAL(ilist_size(list), SIZE - 3);
+    CU_ASSERT_PTR_EQUAL(ilist_peek_head(list), &items[1]);
+    CU_ASSERT_PTR_EQUAL(ilist_peek_tail(list), &items[3]);
+
+    // Put them back for the later tests
+    CU_ASSERT_EQUAL(ilist_push_head(list, &items[0]), SUCCESS);
+    CU_ASSERT_EQUAL(ilist_push_tail(list, &items[2]), SUCCESS);
+    CU_ASSERT_EQUAL(ilist_push_tail(list, &items[4]), SUCCESS);
+}
+
+void test_ilist_remove() {
+    int err = SUCCESS;
+    // Should catch if called on an invalid list
+    CU_ASSERT_PTR_NULL(ilist_remove(INVALID_LIST, &items[0], &err));
+    CU_ASSERT_EQUAL(err, EINVAL);
+    // Should catch if the list has no compare function
+    err = SUCCESS;
+    CU_ASSERT_PTR_NULL(ilist_remove(no_cmp, &items[0], &err));
+    CU_ASSERT_EQUAL(err, ENOTSUP);
+
+    int value_to_remove = 3;
+    CU_ASSERT_PTR_EQUAL(ilist_remove(list, &value_to_remove, NULL), &items[2]);
+    CU_ASSERT_EQUAL(ilist_size(list), SIZE - 1);
+    // Value is no longer in the list
+    CU_ASSERT_PTR_NULL(ilist_remove(list, &value_to_remove, NULL));
+}
+
+void test_ilist_pop() {
+    // Should catch if called on an invalid list
+    CU_ASSERT_PTR_NULL(ilist_pop_head(INVALID_LIST));
+    CU_ASSERT_PTR_NULL(ilist_pop_tail(no_cmp)); // empty list
+
+    CU_ASSERT_PTR_EQUAL(ilist_pop_head(list), &items[0]);
+    CU_ASSERT_PTR_EQUAL(ilist_pop_tail(list), &items[4]);
+    CU_ASSERT_EQUAL(ilist_size(list), 2);
+
+    // A popped item can be pushed onto another list through the same link
+    CU_ASSERT_EQUAL(ilist_push_head(no_cmp, &items[0]), SUCCESS);
+    CU_ASSERT_EQUAL(ilist_size(no_cmp), 1);
+    CU_ASSERT_PTR_EQUAL(ilist_pop_head(no_cmp), &items[0]);
+}
+
+void test_ilist_clear() {
+    // Should catch if called on an invalid list
+    CU_ASSERT_EQUAL(ilist_clear(INVALID_LIST), EINVAL);
+
+    CU_ASSERT_EQUAL(ilist_clear(list), SUCCESS);
+    // list should now be empty
+    CU_ASSERT_EQUAL(ilist_size(list), 0);
+    CU_ASSERT_TRUE(ilist_is_empty(list));
+    CU_ASSERT_PTR_NULL(ilist_pop_head(list));
+}
+
+void test_ilist_delete() {
+    ilist_t *invalid_list = NULL;
+
+    // Should catch if delete is called on an invalid list
+    CU_ASSERT_EQUAL(ilist_delete(&invalid_list), EINVAL);
+    CU_ASSERT_EQUAL(ilist_delete(NULL), EINVAL);
+
+    // Items still in the list are unlinked, never freed
+    CU_ASSERT_EQUAL(ilist_push_head(no_cmp, &items[0]), SUCCESS);
+    CU_ASSERT_EQUAL(ilist_delete(&no_cmp), SUCCESS);
+    CU_ASSERT_PTR_NULL(no_cmp);
+    CU_ASSERT_EQUAL(ilist_delete(&list), SUCCESS);
+    CU_ASSERT_PTR_NULL(list);
+}
+
+int main(void) {
+    CU_TestInfo suite1_tests[] = {
+        {"Testing ilist_new():", test_ilist_new},
+
+        {"Testing ilist_push_head/tail():", test_ilist_push},
+
+        {"Testing ilist_query():", test_ilist_query},
+
+        {"Testing ilist_peek_head/tail():", test_ilist_peek},
+
+        {"Testing ilist iteration:", test_ilist_iterate},
+
+        {"Testing ilist_unlink():", test_ilist_unlink},
+
+        {"Testing ilist_remove():", test_ilist_remove},
+
+        {"Testing ilist_pop_head/tail():", test_ilist_pop},
+
+        {"Testing ilist_clear():", test_ilist_clear},
+
+        {"Testing ilist_delete():", test_ilist_delete}, CU_TEST_INFO_NULL};
+
+    CU_SuiteInfo suites[] = {
+        {"Suite-1:", init_suite1, clean_suite1, .pTests = suite1_tests},
+        CU_SUITE_INFO_NULL};
+
+    if (0 != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    if (0 != CU_register_suites(suites)) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_basic_show_failures(CU_get_failure_list());
+    int num_failed = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    printf("\n");
+    return num_failed;
+}
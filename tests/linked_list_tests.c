@@ -65,6 +65,92 @@ void test_list_new() {
     CU_ASSERT_EQUAL(list_size(list), 0);   // list size is correct
 }
 
+void test_list_cursor() {
+    // Should catch if called on an invalid list
+    int err = SUCCESS;
+    CU_ASSERT_PTR_NULL(list_cursor_new(INVALID_LIST, &err));
+    CU_ASSERT_EQUAL(err, EINVAL);
+
+    list_t *cursor_list = list_new(NULL, test_compare_node, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(cursor_list);
+    list_cursor_t *cursor = list_cursor_new(cursor_list, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(cursor);
+    // inserting on an empty list leaves the cursor on the sole node
+    CU_ASSERT_EQUAL(list_cursor_insert_after(cursor, &data[0]), SUCCESS);
+    CU_ASSERT_PTR_EQUAL(list_cursor_get(cursor), &data[0]);
+    // build up the rest of the list behind the cursor
+    for (size_t i = SIZE - 1; i > 0; i--) {
+        CU_ASSERT_EQUAL(list_cursor_insert_after(cursor, &data[i]), SUCCESS);
+    }
+    CU_ASSERT_EQUAL(list_size(cursor_list), SIZE);
+    // two cursors traverse independently
+    list_cursor_t *other = list_cursor_new(cursor_list, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(other);
+    CU_ASSERT_PTR_EQUAL(list_cursor_next(other, NULL), &data[1]);
+    CU_ASSERT_PTR_EQUAL(list_cursor_get(cursor), &data[0]);
+    // removing in the middle is O(1) and moves the cursor forward
+    CU_ASSERT_PTR_EQUAL(list_cursor_next(cursor, NULL), &data[1]);
+    CU_ASSERT_PTR_EQUAL(list_cursor_remove(cursor, NULL), &data[1]);
+    CU_ASSERT_PTR_EQUAL(list_cursor_get(cursor), &data[2]);
+    CU_ASSERT_EQUAL(list_size(cursor_list), SIZE - 1);
+    // a cursor past the end reports ENOTSUP
+    while (list_cursor_get(cursor) != NULL) {
+        list_cursor_next(cursor, NULL);
+    }
+    err = SUCCESS;
+    CU_ASSERT_PTR_NULL(list_cursor_remove(cursor, &err));
+    CU_ASSERT_EQUAL(err, ENOTSUP);
+    CU_ASSERT_EQUAL(list_cursor_delete(&cursor), SUCCESS);
+    CU_ASSERT_PTR_NULL(cursor);
+    CU_ASSERT_EQUAL(list_cursor_delete(&other), SUCCESS);
+    CU_ASSERT_EQUAL(list_delete(&cursor_list), SUCCESS);
+}
+
+void test_list_new_pooled() {
+    // A zero block size is rejected
+    int err = SUCCESS;
+    CU_ASSERT_PTR_NULL(list_new_pooled(NULL, NULL, 0, &err));
+    CU_ASSERT_EQUAL(err, EINVAL);
+
+    // A pooled list behaves like any other list
+    list_t *pooled = list_new_pooled(NULL, test_compare_node, 4, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(pooled);
+    for (size_t i = 0; i < SIZE; i++) {
+        CU_ASSERT_EQUAL(list_push_tail(pooled, &data[i]), SUCCESS);
+    }
+    CU_ASSERT_EQUAL(list_size(pooled), SIZE);
+    // popped nodes are recycled through the pool's free list
+    for (size_t i = 0; i < SIZE; i++) {
+        CU_ASSERT_EQUAL(*(int *)list_pop_head(pooled), data[i]);
+        CU_ASSERT_EQUAL(list_push_tail(pooled, &data[i]), SUCCESS);
+    }
+    CU_ASSERT_EQUAL(list_size(pooled), SIZE);
+    CU_ASSERT_EQUAL(list_delete(&pooled), SUCCESS);
+}
+
+void test_list_new_indexed() {
+    // An indexed list behaves like any other list
+    list_t *indexed = list_new_indexed(NULL, test_compare_node, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(indexed);
+    for (size_t i = 0; i < SIZE; i++) {
+        CU_ASSERT_EQUAL(list_push_tail(indexed, &data[i]), SUCCESS);
+    }
+    // positional reads resolve through the index
+    for (size_t i = 0; i < SIZE; i++) {
+        CU_ASSERT_PTR_EQUAL(list_get(indexed, i), &data[i]);
+    }
+    // structural changes invalidate the index; reads still see the new order
+    CU_ASSERT_EQUAL(list_insert(indexed, &data[0], 2), SUCCESS);
+    CU_ASSERT_PTR_EQUAL(list_get(indexed, 2), &data[0]);
+    CU_ASSERT_PTR_EQUAL(list_get(indexed, 3), &data[2]);
+    CU_ASSERT_PTR_EQUAL(list_pop_tail(indexed), &data[SIZE - 1]);
+    CU_ASSERT_PTR_EQUAL(list_pop_tail(indexed), &data[SIZE - 2]);
+    CU_ASSERT_PTR_EQUAL(list_pop_head(indexed), &data[0]);
+    CU_ASSERT_PTR_EQUAL(list_get(indexed, 1), &data[0]);
+    CU_ASSERT_EQUAL(list_size(indexed), SIZE - 2);
+    CU_ASSERT_EQUAL(list_delete(&indexed), SUCCESS);
+}
+
 void test_list_push_tail() {
     // Should catch if push is called on an invalid list
     CU_ASSERT_EQUAL(list_push_tail(INVALID_LIST, &data[0]), EINVAL);
@@ -399,6 +485,12 @@ int main(void) {
     CU_TestInfo suite1_tests[] = {
         {"Testing list_new():", test_list_new},
 
+        {"Testing list_new_pooled():", test_list_new_pooled},
+
+        {"Testing list_new_indexed():", test_list_new_indexed},
+
+        {"Testing list_cursor():", test_list_cursor},
+
         {"Testing list_push_tail():", test_list_push_tail},
 
         {"Testing list_pop_head():", test_list_pop_head},
@@ -114,6 +114,53 @@ void test_queue_p_dequeue() {
     CU_ASSERT(NULL == node);
 }
 
+void test_queue_p_drain_until() {
+    queue_p_node_t *nodes[CAPACITY] = {NULL};
+    // Should catch invalid arguments
+    CU_ASSERT(-1 == queue_p_drain_until(INVALID_QUEUE_P, PRIORITY_0, nodes,
+                                        CAPACITY));
+    CU_ASSERT(-1 == queue_p_drain_until(queue_p, PRIORITY_0, NULL, CAPACITY));
+
+    CU_ASSERT_FATAL(NULL != queue_p);
+    reset_queue(queue_p);
+    // make room first: dequeue pops the highest priority, so the
+    // PRIORITY_1 batch can only be enqueued after the removals finish
+    for (size_t i = 0; i < CAPACITY / 2; i++) {
+        queue_p_node_t *tmp = queue_p_dequeue(queue_p);
+        free(tmp);
+    }
+    for (size_t i = 0; i < CAPACITY / 2; i++) {
+        queue_p_enqueue(queue_p, &priority_data[i], PRIORITY_1);
+    }
+
+    // only the PRIORITY_1 batch is at or above the threshold
+    ssize_t drained =
+        queue_p_drain_until(queue_p, PRIORITY_1, nodes, CAPACITY);
+    CU_ASSERT_FATAL(CAPACITY / 2 == drained);
+    for (ssize_t i = 0; i < drained; i++) {
+        // drained in FIFO order within the priority
+        CU_ASSERT(priority_data[i] == *(int *)nodes[i]->data);
+        CU_ASSERT(PRIORITY_1 == nodes[i]->priority);
+        free(nodes[i]);
+    }
+    CU_ASSERT(CAPACITY / 2 == queue_p_size(queue_p));
+
+    // a full drain respects the caller's buffer size
+    drained = queue_p_drain_until(queue_p, PRIORITY_0, nodes, 2);
+    CU_ASSERT_FATAL(2 == drained);
+    free(nodes[0]);
+    free(nodes[1]);
+    CU_ASSERT((CAPACITY / 2) - 2 == queue_p_size(queue_p));
+
+    // leave the queue empty for the later tests
+    drained = queue_p_drain_until(queue_p, PRIORITY_0, nodes, CAPACITY);
+    CU_ASSERT((CAPACITY / 2) - 2 == drained);
+    for (ssize_t i = 0; i < drained; i++) {
+        free(nodes[i]);
+    }
+    CU_ASSERT(0 == queue_p_size(queue_p));
+}
+
 void test_queue_p_peek() {
     // Should catch if peek is called on an invalid queue_p or empty
     queue_p_node_t *node = queue_p_peek(INVALID_QUEUE_P);
@@ -218,6 +265,8 @@ int main(void) {
 
         {"Testing queue_p_dequeue():", test_queue_p_dequeue},
 
+        {"Testing queue_p_drain_until():", test_queue_p_drain_until},
+
         {"Testing queue_p_peek():", test_queue_p_peek},
 
         {"Testing queue_get():", test_queue_p_get},
@@ -104,6 +104,61 @@ void test_queue_dequeue() {
     CU_ASSERT_PTR_NULL(node);
 }
 
+void test_queue_wrap_around() {
+    CU_ASSERT_PTR_NOT_NULL_FATAL(queue);
+    // fill the queue, drain part of it, and refill so the ring buffer
+    // wraps around its end
+    for (size_t i = 0; i < CAPACITY; i++) {
+        CU_ASSERT_EQUAL(queue_enqueue(queue, &data[i]), SUCCESS);
+    }
+    CU_ASSERT_PTR_EQUAL(queue_dequeue(queue), &data[0]);
+    CU_ASSERT_PTR_EQUAL(queue_dequeue(queue), &data[1]);
+    CU_ASSERT_EQUAL(queue_enqueue(queue, &data[0]), SUCCESS);
+    CU_ASSERT_EQUAL(queue_enqueue(queue, &data[1]), SUCCESS);
+    CU_ASSERT_TRUE(queue_is_full(queue));
+
+    // FIFO order holds across the wrap point
+    for (size_t i = 2; i < CAPACITY; i++) {
+        CU_ASSERT_PTR_EQUAL(queue_dequeue(queue), &data[i]);
+    }
+    CU_ASSERT_PTR_EQUAL(queue_dequeue(queue), &data[0]);
+    CU_ASSERT_PTR_EQUAL(queue_dequeue(queue), &data[1]);
+    CU_ASSERT_TRUE(queue_is_empty(queue));
+}
+
+void test_queue_sized() {
+    // By-value queues require a fixed capacity and an element size
+    CU_ASSERT_PTR_NULL(queue_init_sized(0, sizeof(int), NULL, NULL));
+    CU_ASSERT_PTR_NULL(queue_init_sized(CAPACITY, 0, NULL, NULL));
+
+    queue_t *sized =
+        queue_init_sized(CAPACITY, sizeof(int), test_compare_node, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(sized);
+    for (size_t i = 0; i < CAPACITY; i++) {
+        CU_ASSERT_EQUAL(queue_enqueue(sized, &data[i]), SUCCESS);
+    }
+    CU_ASSERT_TRUE(queue_is_full(sized));
+
+    // the queue owns copies, not the caller's pointers
+    int *copy = queue_peek(sized);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(copy);
+    CU_ASSERT_PTR_NOT_EQUAL(copy, &data[0]);
+    CU_ASSERT_EQUAL(*copy, data[0]);
+    copy = queue_get(sized, 2);
+    CU_ASSERT_EQUAL(*copy, data[2]);
+
+    // lookups compare against the stored copies
+    copy = queue_find_first(sized, &data[1], NULL);
+    CU_ASSERT_EQUAL(*copy, data[1]);
+    copy = queue_remove(sized, &data[1], NULL);
+    CU_ASSERT_EQUAL(*copy, data[1]);
+    CU_ASSERT_EQUAL(queue_size(sized), CAPACITY - 1);
+
+    copy = queue_dequeue(sized);
+    CU_ASSERT_EQUAL(*copy, data[0]);
+    CU_ASSERT_EQUAL(queue_destroy(&sized), SUCCESS);
+}
+
 void test_queue_peek() {
     // Should catch if peek is called on an invalid queue or empty
     CU_ASSERT_PTR_NULL(queue_peek(INVALID_QUEUE));
@@ -227,6 +282,10 @@ int main(void) {
 
         {"Testing queue_dequeue():", test_queue_dequeue},
 
+        {"Testing queue wrap around:", test_queue_wrap_around},
+
+        {"Testing queue_init_sized():", test_queue_sized},
+
         {"Testing queue_peek():", test_queue_peek},
 
         {"Testing queue_get():", test_queue_get},
@@ -31,6 +31,36 @@ void test_stack_init() {
     CU_ASSERT(0 == stack_get_size(stack));
 }
 
+void test_stack_init_sized() {
+    // By-value stacks require a capacity and an element size
+    CU_ASSERT(NULL == stack_init_sized(0, sizeof(int)));
+    CU_ASSERT(NULL == stack_init_sized(CAPACITY, 0));
+
+    stack_t *sized = stack_init_sized(CAPACITY, sizeof(int));
+    CU_ASSERT_FATAL(NULL != sized);
+    for (size_t i = 0; i < CAPACITY; i++) {
+        CU_ASSERT(0 == stack_push(sized, &data[i]));
+    }
+    CU_ASSERT(0 != stack_is_full(sized));
+
+    // the stack owns copies, not the caller's pointers
+    int *copy = stack_peek(sized);
+    CU_ASSERT_FATAL(NULL != copy);
+    CU_ASSERT(copy != &data[CAPACITY - 1]);
+    CU_ASSERT(data[CAPACITY - 1] == *copy);
+    copy = stack_get(sized, 1);
+    CU_ASSERT(data[1] == *copy);
+
+    for (size_t i = CAPACITY; i > 0; i--) {
+        copy = stack_pop(sized);
+        CU_ASSERT_FATAL(NULL != copy);
+        // popped copies stay readable until the next push
+        CU_ASSERT(data[i - 1] == *copy);
+    }
+    CU_ASSERT(NULL == stack_pop(sized));
+    CU_ASSERT(0 == stack_destroy(&sized));
+}
+
 void test_stack_push() {
     stack_t *invalid_stack = NULL;
 
@@ -139,6 +169,8 @@ int main(void) {
     CU_TestInfo suite1_tests[] = {
         {"Testing stack_init():", test_stack_init},
 
+        {"Testing stack_init_sized():", test_stack_init_sized},
+
         {"Testing stack_push():", test_stack_push},
 
         {"Testing stack_pop():", test_stack_pop},